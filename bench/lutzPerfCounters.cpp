@@ -0,0 +1,212 @@
+/***************************************************************************
+ *  lutzPerfCounters.cpp - Hardware performance counters for benchmarks    *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzPerfCounters.cpp
+ * @brief Implements the lutzPerfCounters class
+ * @author Josh Cardenzana
+ */
+
+#include <cerrno>
+#include <cstring>
+#include "lutzPerfCounters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+
+/***************************************************************//**
+ * @brief Open one counter for the calling thread
+ *
+ * @param[in] type          perf event type
+ * @param[in] config        perf event configuration
+ * @return Descriptor of the counter (-1 on failure, with errno set)
+ *******************************************************************/
+int open_counter(uint32_t type, uint64_t config)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = type;
+    attr.config         = config;
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                          PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+
+/***************************************************************//**
+ * @brief Return the configuration of a cache read-miss event
+ *
+ * @param[in] cache         PERF_COUNT_HW_CACHE_* identifier
+ * @return Configuration for PERF_TYPE_HW_CACHE
+ *******************************************************************/
+uint64_t cache_miss(uint64_t cache)
+{
+    return cache | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) |
+           (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+}
+
+#endif
+
+} // namespace
+
+
+/************************************************************//**
+ * @brief Constructor
+ ****************************************************************/
+lutzPerfCounters::lutzPerfCounters()
+{
+    for (int c=0; c < NUM_COUNTERS; c++) m_fd[c] = -1;
+    Reset();
+}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzPerfCounters::~lutzPerfCounters()
+{
+    Close();
+}
+
+
+/************************************************************//**
+ * @brief Open the counters for the calling thread
+ *
+ * @return Number of counters available
+ ****************************************************************/
+int lutzPerfCounters::Open()
+{
+    Close();
+    m_error.clear();
+    int navailable = 0;
+
+#ifdef __linux__
+    const uint32_t types[NUM_COUNTERS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE
+    };
+    const uint64_t configs[NUM_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        cache_miss(PERF_COUNT_HW_CACHE_L1D),
+        cache_miss(PERF_COUNT_HW_CACHE_LL)
+    };
+
+    for (int c=0; c < NUM_COUNTERS; c++) {
+        m_fd[c] = open_counter(types[c], configs[c]);
+        if (m_fd[c] >= 0) {
+            navailable++;
+        } else if (m_error.empty()) {
+            m_error = std::string(Name(LUTZ_COUNTER(c))) + ": " + std::strerror(errno);
+        }
+    }
+#else
+    m_error = "hardware counters are only read on Linux";
+#endif
+
+    return navailable;
+}
+
+
+/************************************************************//**
+ * @brief Close all of the counters
+ ****************************************************************/
+void lutzPerfCounters::Close()
+{
+    for (int c=0; c < NUM_COUNTERS; c++) {
+#ifdef __linux__
+        if (m_fd[c] >= 0) close(m_fd[c]);
+#endif
+        m_fd[c] = -1;
+    }
+}
+
+
+/************************************************************//**
+ * @brief Start counting
+ ****************************************************************/
+void lutzPerfCounters::Start()
+{
+#ifdef __linux__
+    for (int c=0; c < NUM_COUNTERS; c++) {
+        if (m_fd[c] < 0) continue;
+        ioctl(m_fd[c], PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_fd[c], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+
+/************************************************************//**
+ * @brief Stop counting and add the counts to the totals
+ ****************************************************************/
+void lutzPerfCounters::Stop()
+{
+#ifdef __linux__
+    for (int c=0; c < NUM_COUNTERS; c++) {
+        if (m_fd[c] < 0) continue;
+        ioctl(m_fd[c], PERF_EVENT_IOC_DISABLE, 0);
+
+        // Value, time enabled, time running
+        uint64_t values[3];
+        if (read(m_fd[c], values, sizeof(values)) != sizeof(values)) continue;
+        if (values[2] == 0) continue;
+        double scale = double(values[1]) / double(values[2]);
+        m_count[c] += double(values[0]) * scale;
+    }
+#endif
+}
+
+
+/************************************************************//**
+ * @brief Set the totals back to zero
+ ****************************************************************/
+void lutzPerfCounters::Reset()
+{
+    for (int c=0; c < NUM_COUNTERS; c++) m_count[c] = 0.0;
+}
+
+
+/************************************************************//**
+ * @brief Return the name of a counter
+ *
+ * @param[in] counter       Counter
+ * @return Name as printed in reports
+ ****************************************************************/
+const char* lutzPerfCounters::Name(LUTZ_COUNTER counter)
+{
+    static const char* names[NUM_COUNTERS] = {
+        "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses"
+    };
+    return names[counter];
+}
@@ -0,0 +1,126 @@
+/***************************************************************************
+ *  lutzPerfCounters.hpp - Hardware performance counters for benchmarks    *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzPerfCounters.hpp
+ * @brief Hardware performance counters for benchmarks
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZPERFCOUNTERS_HPP
+#define LUTZPERFCOUNTERS_HPP
+
+#include <cstdint>
+#include <string>
+
+/***************************************************************//**
+ * @brief A fixed set of hardware counters read around a region of code
+ *
+ * On Linux the counters are opened with perf_event_open for the calling
+ * thread, counting user space only. Each counter is opened on its own,
+ * so a counter the CPU or the kernel does not offer (or that
+ * perf_event_paranoid forbids) is simply unavailable while the others
+ * still count. When the kernel has to share the hardware between more
+ * counters than it has, the counts are scaled up by the fraction of the
+ * time each one was running. On other systems no counter is available.
+ *******************************************************************/
+class lutzPerfCounters {
+public:
+    // Counters that are read
+    enum LUTZ_COUNTER {
+        CYCLES,
+        INSTRUCTIONS,
+        BRANCH_MISSES,
+        L1D_MISSES,
+        LLC_MISSES,
+        NUM_COUNTERS
+    };
+
+    // Constructors
+    lutzPerfCounters();
+    // Destructor
+    virtual ~lutzPerfCounters();
+
+    /******  Methods  ******/
+
+    // Open the counters, returning how many are available
+    int  Open(void);
+    void Close(void);
+
+    // Count between Start() and Stop(), adding to the totals
+    void Start(void);
+    void Stop(void);
+    void Reset(void);
+
+    bool        IsAvailable(LUTZ_COUNTER counter) const;
+    double      GetCount(LUTZ_COUNTER counter) const;
+    const std::string& GetError(void) const;
+    static const char* Name(LUTZ_COUNTER counter);
+
+protected:
+
+    /****** Variables ******/
+    int         m_fd[NUM_COUNTERS];     //!< Descriptor of each counter (-1 = none)
+    double      m_count[NUM_COUNTERS];  //!< Scaled counts since Reset()
+    std::string m_error;                //!< Why the first missing counter failed
+
+private:
+
+    // The counters own descriptors and cannot be copied
+    lutzPerfCounters(const lutzPerfCounters& other);
+    lutzPerfCounters& operator=(const lutzPerfCounters& other);
+};
+
+
+/************************************************************//**
+ * @brief Return whether a counter could be opened
+ *
+ * @param[in] counter       Counter
+ * @return Whether the counter counts
+ ****************************************************************/
+inline bool lutzPerfCounters::IsAvailable(LUTZ_COUNTER counter) const
+{
+    return (m_fd[counter] >= 0);
+}
+
+
+/************************************************************//**
+ * @brief Return the count accumulated by a counter
+ *
+ * @param[in] counter       Counter
+ * @return Count since the last Reset() (0 if unavailable)
+ ****************************************************************/
+inline double lutzPerfCounters::GetCount(LUTZ_COUNTER counter) const
+{
+    return m_count[counter];
+}
+
+
+/************************************************************//**
+ * @brief Return why a counter could not be opened
+ *
+ * @return Description of the first failure (empty if there was none)
+ ****************************************************************/
+inline const std::string& lutzPerfCounters::GetError() const
+{
+    return m_error;
+}
+
+#endif /* LUTZPERFCOUNTERS_HPP */
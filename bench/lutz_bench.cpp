@@ -0,0 +1,257 @@
+/***************************************************************************
+ *  lutz_bench.cpp - Benchmark driver with hardware counters               *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutz_bench.cpp
+ * @brief Benchmark driver with hardware counters
+ * @author Josh Cardenzana
+ *
+ * Runs lutzOnePass repeatedly on a synthetic frame of noise and sources
+ * and reports the wall time and hardware counters of run(), per frame,
+ * per million pixels and per object found.
+ *
+ *   lutz_bench [-x xpixels] [-y ypixels] [-n frames] [-s sources]
+ *              [-t threshold] [-m direct|pixel|samples|boxes|compact|labels]
+ *
+ * Mode pixel runs the same detection with the pixels tested one at a
+ * time through the virtual pixel tests, as for a subclass that supplies
+ * its own values, so that it can be compared with the row scan of mode
+ * direct.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lutzSamplePass.hpp"
+#include "lutzOnePass.hpp"
+#include "lutzPerfCounters.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Detector that tests every pixel through the virtual methods
+ *******************************************************************/
+class lutzPixelPass : public lutzOnePass {
+public:
+    lutzPixelPass(double* image, int xpixels, int ypixels) :
+        lutzOnePass(image, xpixels, ypixels)
+    {}
+};
+
+
+// Settings taken from the command line
+struct Options {
+    int         m_xpix;
+    int         m_ypix;
+    int         m_frames;
+    int         m_sources;
+    double      m_threshold;
+    std::string m_mode;
+};
+
+
+/***************************************************************//**
+ * @brief Print how the driver is used
+ *******************************************************************/
+void usage()
+{
+    std::printf("usage: lutz_bench [-x xpixels] [-y ypixels] [-n frames] [-s sources]\n"
+                "                  [-t threshold] [-m direct|pixel|samples|boxes|compact|labels]\n");
+}
+
+
+/***************************************************************//**
+ * @brief Read the command line
+ *
+ * @param[in] argc          Number of arguments
+ * @param[in] argv          Arguments
+ * @param[out] options      Settings
+ * @return Whether the command line made sense
+ *******************************************************************/
+bool parse(int argc, char** argv, Options& options)
+{
+    options.m_xpix      = 4096;
+    options.m_ypix      = 4096;
+    options.m_frames    = 10;
+    options.m_sources   = 2000;
+    options.m_threshold = 5.0;
+    options.m_mode      = "direct";
+
+    for (int i=1; i < argc; i++) {
+        if ((std::strlen(argv[i]) != 2) || (argv[i][0] != '-') || (i + 1 >= argc)) {
+            return false;
+        }
+        const char* value = argv[++i];
+        switch (argv[i-1][1]) {
+            case 'x': options.m_xpix      = std::atoi(value); break;
+            case 'y': options.m_ypix      = std::atoi(value); break;
+            case 'n': options.m_frames    = std::atoi(value); break;
+            case 's': options.m_sources   = std::atoi(value); break;
+            case 't': options.m_threshold = std::atof(value); break;
+            case 'm': options.m_mode      = value;            break;
+            default:  return false;
+        }
+    }
+
+    return (options.m_xpix > 0) && (options.m_ypix > 0) && (options.m_frames > 0) &&
+           ((options.m_mode == "direct") || (options.m_mode == "pixel") ||
+            (options.m_mode == "samples") ||
+            (options.m_mode == "boxes")  || (options.m_mode == "compact") ||
+            (options.m_mode == "labels"));
+}
+
+
+/***************************************************************//**
+ * @brief Fill a frame with unit noise and round sources
+ *
+ * @param[in] options       Settings
+ * @param[out] image        Frame of m_xpix x m_ypix values
+ *******************************************************************/
+void make_frame(const Options& options, std::vector<double>& image)
+{
+    std::mt19937 gen(12345);
+    std::normal_distribution<double>       noise(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    image.resize(size_t(options.m_xpix) * options.m_ypix);
+    for (size_t i=0; i < image.size(); i++) image[i] = noise(gen);
+
+    for (int s=0; s < options.m_sources; s++) {
+        double x0    = uniform(gen) * options.m_xpix;
+        double y0    = uniform(gen) * options.m_ypix;
+        double width = 0.8 + 3.0 * uniform(gen);
+        double peak  = 5.0 * std::pow(100.0, uniform(gen));
+        int    reach = int(4.0 * width) + 1;
+
+        for (int y=std::max(0, int(y0) - reach); y < std::min(options.m_ypix, int(y0) + reach); y++) {
+            for (int x=std::max(0, int(x0) - reach); x < std::min(options.m_xpix, int(x0) + reach); x++) {
+                double r2 = ((x - x0) * (x - x0) + (y - y0) * (y - y0)) / (width * width);
+                image[size_t(y) * options.m_xpix + x] += peak * std::exp(-0.5 * r2);
+            }
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Return the number of objects found by the last run
+ *
+ * @param[in] detector      Detector
+ * @param[in] mode          Mode it was run in
+ * @return Number of objects
+ *******************************************************************/
+int num_found(lutzOnePass& detector, const std::string& mode)
+{
+    if (mode == "boxes")   return detector.NumBoxes();
+    if (mode == "compact") return detector.NumCompactObjects();
+    if (mode == "labels")  return detector.NumLabels();
+    return detector.NumObjects();
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    std::vector<double> image;
+    make_frame(options, image);
+
+    // Set up the detector for the chosen mode
+    std::unique_ptr<lutzOnePass> detector;
+    if (options.m_mode == "samples") {
+        detector.reset(new lutzSamplePass<double>(image.data(), options.m_xpix, options.m_ypix));
+    } else if (options.m_mode == "pixel") {
+        detector.reset(new lutzPixelPass(image.data(), options.m_xpix, options.m_ypix));
+    } else {
+        detector.reset(new lutzOnePass(image.data(), options.m_xpix, options.m_ypix));
+    }
+    detector->SetThreshold(options.m_threshold);
+    std::vector<int32_t> labels;
+    if (options.m_mode == "boxes")   detector->SetBoxesOnly(true);
+    if (options.m_mode == "compact") detector->SetCompactObjects(true);
+    if (options.m_mode == "labels") {
+        labels.resize(image.size());
+        detector->SetLabelImage(labels.data(), false);
+    }
+
+    // The first run sizes the scratch state, so it is not counted
+    detector->run();
+
+    lutzPerfCounters counters;
+    counters.Open();
+
+    double seconds = 0.0;
+    double objects = 0.0;
+    for (int f=0; f < options.m_frames; f++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        counters.Start();
+        detector->run();
+        counters.Stop();
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        objects += num_found(*detector, options.m_mode);
+    }
+
+    // Report everything per frame, per million pixels and per object
+    double mpix = 1.0e-6 * double(options.m_xpix) * options.m_ypix * options.m_frames;
+    std::printf("lutz_bench: %d x %d, %d frames, mode %s, %.0f objects per frame\n",
+                options.m_xpix, options.m_ypix, options.m_frames,
+                options.m_mode.c_str(), objects / options.m_frames);
+    std::printf("%-14s %14.3f ms/frame %12.1f Mpix/s\n", "wall",
+                1.0e3 * seconds / options.m_frames, mpix / seconds);
+
+    std::printf("%-14s %14s %14s %14s\n", "counter", "per frame", "per Mpix", "per object");
+    for (int c=0; c < lutzPerfCounters::NUM_COUNTERS; c++) {
+        lutzPerfCounters::LUTZ_COUNTER counter = lutzPerfCounters::LUTZ_COUNTER(c);
+        if (!counters.IsAvailable(counter)) {
+            std::printf("%-14s %14s %14s %14s\n", lutzPerfCounters::Name(counter), "n/a", "n/a", "n/a");
+            continue;
+        }
+        double count = counters.GetCount(counter);
+        std::printf("%-14s %14.4g %14.4g %14.4g\n", lutzPerfCounters::Name(counter),
+                    count / options.m_frames, count / mpix,
+                    (objects > 0.0) ? count / objects : 0.0);
+    }
+
+    if (counters.IsAvailable(lutzPerfCounters::CYCLES) &&
+        counters.IsAvailable(lutzPerfCounters::INSTRUCTIONS) &&
+        (counters.GetCount(lutzPerfCounters::CYCLES) > 0.0)) {
+        std::printf("%-14s %14.3f\n", "IPC",
+                    counters.GetCount(lutzPerfCounters::INSTRUCTIONS) /
+                    counters.GetCount(lutzPerfCounters::CYCLES));
+    }
+    if (!counters.GetError().empty()) {
+        std::printf("some counters are unavailable (%s)\n", counters.GetError().c_str());
+    }
+
+    return 0;
+}
@@ -0,0 +1,282 @@
+/***************************************************************************
+ *  lutzBackground.hpp - Streaming estimate of the image background        *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzBackground.hpp
+ * @brief Streaming estimate of the image background
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZBACKGROUND_HPP
+#define LUTZBACKGROUND_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/***************************************************************//**
+ * @brief Background level and noise of a sequence of frames, gathered
+ *        while the frames are scanned
+ *
+ * Every m_step-th pixel of every m_step-th row is added to a histogram whose
+ * range is centred on the current estimate. At the end of a frame the
+ * median and the 15.87% quantile are read off the histogram. Their
+ * difference is the noise sigma. Only the lower half of the distribution
+ * is used, so objects hardly bias the result. The new values are then
+ * blended with the previous ones:
+ *   estimate = damping * previous + (1 - damping) * new
+ *
+ * Until there is an estimate (the first frame, or after a reset) there is
+ * no histogram range. Samples are instead kept in a buffer of bounded size,
+ * thinned by half each time it fills, and the quantiles are found exactly.
+ *
+ * A reset happens when:
+ *   - Reset() is called;
+ *   - either quantile falls outside the histogram range, in which case the
+ *     next frame starts over from the sample buffer;
+ *   - the median moves by more than m_reset_sigmas sigma in one frame, in
+ *     which case the new values are taken without damping.
+ *******************************************************************/
+class lutzBackground {
+public:
+    // Constructors
+    lutzBackground(int nbins=1024);
+    // Destructor
+    virtual ~lutzBackground();
+
+    /******  Methods  ******/
+
+    // Set how the estimate is gathered and updated
+    void SetDamping(double damping);
+    void SetSampleStep(int step);
+    void SetResetSigmas(double nsigma);
+
+    // Forget the current estimate
+    void Reset(void);
+
+    // Gather the samples of one frame
+    void StartFrame(void);
+    void add(double value);
+    template <typename T>
+    void addRow(const T* row, int npix, int yindx);
+    bool FinishFrame(void);
+    
+    // Which pixels of a row are sampled
+    int  FirstSample(int yindx) const;
+
+    // Get the current estimate
+    bool   IsReady(void) const;
+    double GetMedian(void) const;
+    double GetSigma(void) const;
+    double GetThreshold(double nsigma) const;
+    int    GetSampleStep(void) const;
+    size_t NumSamples(void) const;
+
+protected:
+
+    /******  Methods  ******/
+    void   AddSample(double value);
+    void   SetRange(double low, double high);
+    double Quantile(double fraction) const;
+    void   Update(double median, double sigma);
+
+    /****** Variables ******/
+    std::vector<uint64_t> m_bins;   //!< Histogram of the sampled values
+    double   m_low;                 //!< Value at the lower edge of the histogram
+    double   m_scale;               //!< Bins per unit of value
+    bool     m_ranged;              //!< Whether the histogram range is set
+    size_t   m_under;               //!< Samples below the histogram range
+    size_t   m_over;                //!< Samples above the histogram range
+    size_t   m_nsample;             //!< Samples taken in this frame
+    std::vector<double> m_samples;  //!< Samples kept while there is no range
+    size_t   m_keep;                //!< Every m_keep-th sample goes in m_samples
+    double   m_median;              //!< Estimated background level
+    double   m_sigma;               //!< Estimated background noise
+    bool     m_ready;               //!< Whether there is an estimate
+    double   m_damping;             //!< Weight of the previous estimate
+    double   m_reset_sigmas;        //!< Jump in the median that skips damping
+    int      m_step;                //!< Pixels (and rows) between two samples
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Set how much of the previous estimate is kept each frame
+ *
+ * @param[in] damping       Weight of the previous estimate, from 0 (use
+ *                          each frame on its own) to just below 1
+ ****************************************************************/
+inline void lutzBackground::SetDamping(double damping)
+{
+    m_damping = damping;
+}
+
+
+/************************************************************//**
+ * @brief Set the spacing of the sampled pixels
+ *
+ * @param[in] step          Pixels between two samples along a row, and
+ *                          rows between two sampled rows (1 = every pixel)
+ ****************************************************************/
+inline void lutzBackground::SetSampleStep(int step)
+{
+    m_step = (step > 0) ? step : 1;
+}
+
+
+/************************************************************//**
+ * @brief Set the jump in the median that is taken without damping
+ *
+ * @param[in] nsigma        Jump in units of the current sigma
+ ****************************************************************/
+inline void lutzBackground::SetResetSigmas(double nsigma)
+{
+    m_reset_sigmas = nsigma;
+}
+
+
+/************************************************************//**
+ * @brief Add a sampled value to the current frame
+ *
+ * @param[in] value         Pixel value (NaN values are ignored)
+ ****************************************************************/
+inline void lutzBackground::add(double value)
+{
+    if (std::isnan(value)) return;
+    if (!m_ranged) {
+        AddSample(value);
+        return;
+    }
+
+    m_nsample++;
+    double pos = (value - m_low) * m_scale;
+    if (pos < 0.0) {
+        m_under++;
+    } else if (pos >= m_bins.size()) {
+        m_over++;
+    } else {
+        m_bins[size_t(pos)]++;
+    }
+}
+
+
+/************************************************************//**
+ * @brief Add the sampled pixels of one row to the current frame
+ *
+ * @param[in] row           Row of values
+ * @param[in] npix          Number of values in the row
+ * @param[in] yindx         Row number
+ ****************************************************************/
+template <typename T>
+inline void lutzBackground::addRow(const T* row, int npix, int yindx)
+{
+    for (int xindx=FirstSample(yindx); xindx < npix; xindx += m_step) {
+        add(double(row[xindx]));
+    }
+}
+
+
+/************************************************************//**
+ * @brief Return the first sampled pixel of a row
+ *
+ * @param[in] yindx         Row number
+ * @return x position of the first sample (INT_MAX if the row is skipped)
+ *
+ * Each sampled row starts one pixel further along than the last, so
+ * the samples do not all fall on the same columns.
+ ****************************************************************/
+inline int lutzBackground::FirstSample(int yindx) const
+{
+    if (yindx % m_step != 0) return std::numeric_limits<int>::max();
+    return (yindx / m_step) % m_step;
+}
+
+
+/************************************************************//**
+ * @brief Return whether there is an estimate of the background
+ *
+ * @return Whether a frame has been completed since the last reset
+ ****************************************************************/
+inline bool lutzBackground::IsReady() const
+{
+    return m_ready;
+}
+
+
+/************************************************************//**
+ * @brief Return the estimated background level
+ *
+ * @return Median of the sampled values
+ ****************************************************************/
+inline double lutzBackground::GetMedian() const
+{
+    return m_median;
+}
+
+
+/************************************************************//**
+ * @brief Return the estimated background noise
+ *
+ * @return Difference between the median and the 15.87% quantile
+ ****************************************************************/
+inline double lutzBackground::GetSigma() const
+{
+    return m_sigma;
+}
+
+
+/************************************************************//**
+ * @brief Return a threshold a number of sigma above the background
+ *
+ * @param[in] nsigma        Number of sigma above the median
+ * @return Threshold
+ ****************************************************************/
+inline double lutzBackground::GetThreshold(double nsigma) const
+{
+    return m_median + nsigma * m_sigma;
+}
+
+
+/************************************************************//**
+ * @brief Return the spacing of the sampled pixels along a row
+ *
+ * @return Pixels between two samples
+ ****************************************************************/
+inline int lutzBackground::GetSampleStep() const
+{
+    return m_step;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of samples taken in the current frame
+ *
+ * @return Number of samples
+ ****************************************************************/
+inline size_t lutzBackground::NumSamples() const
+{
+    return m_nsample;
+}
+
+#endif /* LUTZBACKGROUND_HPP */
@@ -0,0 +1,50 @@
+/***************************************************************************
+ *  lutzBox.hpp - Minimal summary of an object found by lutz one pass      *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzBox.hpp
+ * @brief Minimal summary of an object found by lutz one pass
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZBOX_HPP
+#define LUTZBOX_HPP
+
+#include <cstdint>
+
+/***************************************************************//**
+ * @brief Pixel count, bounding box and peak of an object
+ *
+ * This is a plain record with no pixel list, produced by the
+ * count-and-bounding-box mode of lutzOnePass (see SetBoxesOnly()).
+ *******************************************************************/
+struct lutzBox {
+    int32_t m_npix;                 //!< Number of pixels in the object
+    int32_t m_xmin;                 //!< minimum pixel position in x
+    int32_t m_xmax;                 //!< maximum pixel position in x
+    int32_t m_ymin;                 //!< minimum pixel position in y
+    int32_t m_ymax;                 //!< maximum pixel position in y
+    int32_t m_xpeak;                //!< x position of the brightest pixel
+    int32_t m_ypeak;                //!< y position of the brightest pixel
+    uint32_t m_flags;               //!< Combination of lutzObject::LUTZ_FLAG values
+    double  m_peak;                 //!< Value of the brightest pixel
+};
+
+#endif /* LUTZBOX_HPP */
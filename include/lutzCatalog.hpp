@@ -0,0 +1,154 @@
+/***************************************************************************
+ *  lutzCatalog.hpp - Columnar table of object measurements                *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCatalog.hpp
+ * @brief Columnar table of object measurements
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZCATALOG_HPP
+#define LUTZCATALOG_HPP
+
+#include <cstddef>
+#include <vector>
+
+/***************************************************************//**
+ * @brief Table of measurements with one row per object
+ *
+ * Each quantity is held as its own column, a contiguous array of
+ * doubles, so a whole column can be handed to other code (or written
+ * out) without gathering it from per-object records. Only the columns
+ * that were asked for are filled; the others are empty. Resizing keeps
+ * the memory of the columns, so a catalog can be reused frame after
+ * frame. Filled in by lutzMeasure.
+ *******************************************************************/
+class lutzCatalog {
+public:
+    // Columns of the table
+    enum LUTZ_COLUMN {
+        COL_X,          //!< Centroid in x
+        COL_Y,          //!< Centroid in y
+        COL_XX,         //!< Second central moment in x
+        COL_YY,         //!< Second central moment in y
+        COL_XY,         //!< Second central cross moment
+        COL_A,          //!< Semi-major axis of the moment ellipse
+        COL_B,          //!< Semi-minor axis of the moment ellipse
+        COL_THETA,      //!< Angle of the major axis from x (radians)
+        COL_FLUX,       //!< Isophotal flux (sum of the pixel values)
+        COL_NPIX,       //!< Number of pixels
+        COL_PEAK,       //!< Value of the brightest pixel
+        COL_XPEAK,      //!< x position of the brightest pixel
+        COL_YPEAK,      //!< y position of the brightest pixel
+        NUM_COLUMNS
+    };
+
+    // Constructors
+    lutzCatalog();
+    // Destructor
+    virtual ~lutzCatalog();
+
+    /******  Methods  ******/
+
+    // Set the number of rows and which columns are present
+    void resize(size_t nrows, unsigned columns);
+    void clear(void);
+    size_t size(void) const;
+
+    // Access the columns
+    bool HasColumn(LUTZ_COLUMN column) const;
+    const std::vector<double>& GetColumn(LUTZ_COLUMN column) const;
+    std::vector<double>&       GetColumn(LUTZ_COLUMN column);
+    double GetValue(LUTZ_COLUMN column, size_t row) const;
+    static const char* ColumnName(LUTZ_COLUMN column);
+
+protected:
+
+    /****** Variables ******/
+    std::vector<double> m_columns[NUM_COLUMNS]; //!< Values of each column
+    unsigned            m_present;              //!< Bit (1 << column) set for
+                                                //!< each column present
+    size_t              m_nrows;                //!< Number of rows
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Return the number of rows
+ *
+ * @return Number of objects in the table
+ ****************************************************************/
+inline size_t lutzCatalog::size() const
+{
+    return m_nrows;
+}
+
+
+/************************************************************//**
+ * @brief Return whether a column is present
+ *
+ * @param[in] column        Column
+ * @return Whether the column was filled
+ ****************************************************************/
+inline bool lutzCatalog::HasColumn(LUTZ_COLUMN column) const
+{
+    return (m_present >> column) & 1;
+}
+
+
+/************************************************************//**
+ * @brief Return a column
+ *
+ * @param[in] column        Column
+ * @return Values of the column (empty if it is not present)
+ ****************************************************************/
+inline const std::vector<double>& lutzCatalog::GetColumn(LUTZ_COLUMN column) const
+{
+    return m_columns[column];
+}
+
+
+/************************************************************//**
+ * @brief Return a column to be filled
+ *
+ * @param[in] column        Column
+ * @return Values of the column (empty if it is not present)
+ ****************************************************************/
+inline std::vector<double>& lutzCatalog::GetColumn(LUTZ_COLUMN column)
+{
+    return m_columns[column];
+}
+
+
+/************************************************************//**
+ * @brief Return one value of the table
+ *
+ * @param[in] column        Column (must be present)
+ * @param[in] row           Row
+ * @return Value of the column for that row
+ ****************************************************************/
+inline double lutzCatalog::GetValue(LUTZ_COLUMN column, size_t row) const
+{
+    return m_columns[column][row];
+}
+
+#endif /* LUTZCATALOG_HPP */
@@ -0,0 +1,164 @@
+/***************************************************************************
+ *  lutzCatalogReader.hpp - Reads catalogs from shared memory              *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCatalogReader.hpp
+ * @brief Reads catalogs from shared memory
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZCATALOGREADER_HPP
+#define LUTZCATALOGREADER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lutzRingFormat.hpp"
+
+/***************************************************************//**
+ * @brief Reads the catalogs published by a lutzCatalogRing
+ *
+ * Records are read in place, without copying. Since the writer never
+ * waits, a frame must be bracketed by Begin() (or Next() or Latest())
+ * and End(): if End() returns false the slot was overwritten while it
+ * was being read and what was read must be thrown away. Copy() does
+ * this for a caller that would rather have its own copy.
+ *
+ * Next() walks through the frames in order. A reader that falls more
+ * than a ring behind skips to the oldest frame still held, and the
+ * frames it skipped are counted by NumMissed(). Once every frame of a
+ * ring that its writer has retired has been read, Next() attaches to
+ * the ring that replaced it and carries on from its first frame.
+ *******************************************************************/
+class lutzCatalogReader {
+public:
+    // Constructors
+    lutzCatalogReader();
+    // Destructor
+    virtual ~lutzCatalogReader();
+
+    // A frame being read in place
+    struct Frame {
+        const lutzRingRecord* m_records;    //!< First record
+        uint32_t m_nrecords;                //!< Number of records
+        uint32_t m_ndropped;                //!< Objects that did not fit
+        int64_t  m_frame;                   //!< Frame number given by the writer
+        uint64_t m_sequence;                //!< Position of the frame in the ring
+    };
+
+    /******  Methods  ******/
+
+    // Attach to a ring made by lutzCatalogRing::Create()
+    bool Open(const std::string& name);
+    void Close(void);
+    bool IsOpen(void) const;
+
+    // Read frames in place
+    bool Begin(uint64_t sequence, Frame& frame) const;
+    bool End(const Frame& frame) const;
+    bool Next(Frame& frame);
+    bool Latest(Frame& frame, int attempts=100) const;
+    bool Copy(const Frame& frame, std::vector<lutzRingRecord>& records) const;
+
+    uint64_t NumPublished(void) const;
+    uint64_t NumMissed(void) const;
+    uint64_t Generation(void) const;
+    bool     IsRetired(void) const;
+
+protected:
+
+    /******  Methods  ******/
+    const lutzRingSlot* Slot(uint64_t sequence) const;
+    bool Reopen(void);
+
+    /****** Variables ******/
+    std::string           m_name;     //!< Name of the shared memory object
+    int                   m_fd;       //!< Descriptor of the shared memory object
+    const char*           m_base;     //!< Start of the mapping
+    size_t                m_bytes;    //!< Size of the mapping
+    const lutzRingHeader* m_header;   //!< Header at the start of the mapping
+    uint64_t              m_next;     //!< Next frame returned by Next()
+    uint64_t              m_missed;   //!< Frames skipped by Next()
+
+private:
+
+    // The reader owns a mapping and cannot be copied
+    lutzCatalogReader(const lutzCatalogReader& other);
+    lutzCatalogReader& operator=(const lutzCatalogReader& other);
+};
+
+
+/************************************************************//**
+ * @brief Return whether the reader is attached to a ring
+ *
+ * @return Whether frames can be read
+ ****************************************************************/
+inline bool lutzCatalogReader::IsOpen() const
+{
+    return (m_header != nullptr);
+}
+
+
+/************************************************************//**
+ * @brief Return the number of frames published so far
+ *
+ * @return Number of frames the writer has published
+ ****************************************************************/
+inline uint64_t lutzCatalogReader::NumPublished() const
+{
+    return m_header ? m_header->m_published.load(std::memory_order_acquire) : 0;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of frames skipped by Next()
+ *
+ * @return Frames that were overwritten before they could be read
+ ****************************************************************/
+inline uint64_t lutzCatalogReader::NumMissed() const
+{
+    return m_missed;
+}
+
+
+/************************************************************//**
+ * @brief Return the generation of the ring
+ *
+ * @return Number of rings made under the same name before this one
+ *         (0 if the reader is not attached)
+ ****************************************************************/
+inline uint64_t lutzCatalogReader::Generation() const
+{
+    return m_header ? m_header->m_generation : 0;
+}
+
+
+/************************************************************//**
+ * @brief Return whether the writer has closed or replaced the ring
+ *
+ * @return Whether no more frames will be published in this ring
+ ****************************************************************/
+inline bool lutzCatalogReader::IsRetired() const
+{
+    return m_header && (m_header->m_retired.load(std::memory_order_acquire) != 0);
+}
+
+#endif /* LUTZCATALOGREADER_HPP */
@@ -0,0 +1,134 @@
+/***************************************************************************
+ *  lutzCatalogRing.hpp - Publishes catalogs into shared memory            *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCatalogRing.hpp
+ * @brief Publishes catalogs into shared memory
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZCATALOGRING_HPP
+#define LUTZCATALOGRING_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lutzBox.hpp"
+#include "lutzObject.hpp"
+#include "lutzRingFormat.hpp"
+
+/***************************************************************//**
+ * @brief Writes the catalog of each frame into a shared memory ring
+ *
+ * The ring is a POSIX shared memory object holding the last m_nslots
+ * catalogs (see lutzRingFormat.hpp), so any number of processes on the
+ * same host can read them in place with lutzCatalogReader. Each object
+ * is published as a lutzRingRecord.
+ *
+ * The writer never waits for readers: each slot is guarded by a
+ * sequence lock, and a reader that is too slow finds that its frame has
+ * been overwritten rather than holding up the detector. Publishing a
+ * frame costs one pass over its objects. Objects beyond the room of a
+ * slot are dropped, and counted in the slot.
+ *
+ * Only one process may publish into a given ring. Creating a ring under
+ * the name of an existing one retires the old ring and unlinks it rather
+ * than resizing it, so readers still mapping it are never cut short (see
+ * lutzRingHeader).
+ *******************************************************************/
+class lutzCatalogRing {
+public:
+    // Constructors
+    lutzCatalogRing();
+    // Destructor
+    virtual ~lutzCatalogRing();
+
+    /******  Methods  ******/
+
+    // Create the ring (name as for shm_open, e.g. "/lutz_catalog")
+    bool Create(const std::string& name, int nslots=8, int max_records=65536);
+    void Close(bool unlink=true);
+    bool IsOpen(void) const;
+
+    // Publish the catalog of one frame
+    bool Publish(int64_t frame, const std::vector<lutzObject>& objects);
+    bool Publish(int64_t frame, const std::vector<lutzBox>& boxes);
+    uint64_t NumPublished(void) const;
+    uint64_t Generation(void) const;
+
+protected:
+
+    /******  Methods  ******/
+    uint64_t      Retire(const std::string& name) const;
+    lutzRingSlot* BeginSlot(int64_t frame);
+    void          EndSlot(lutzRingSlot* slot, uint32_t nrecords, uint32_t ndropped);
+    lutzRingRecord* Records(lutzRingSlot* slot) const;
+
+    /****** Variables ******/
+    std::string     m_name;         //!< Name of the shared memory object
+    int             m_fd;           //!< Descriptor of the shared memory object
+    char*           m_base;         //!< Start of the mapping
+    size_t          m_bytes;        //!< Size of the mapping
+    lutzRingHeader* m_header;       //!< Header at the start of the mapping
+    uint64_t        m_sequence;     //!< Number of frames published so far
+
+private:
+
+    // The ring owns a mapping and cannot be copied
+    lutzCatalogRing(const lutzCatalogRing& other);
+    lutzCatalogRing& operator=(const lutzCatalogRing& other);
+};
+
+
+/************************************************************//**
+ * @brief Return whether the ring has been created
+ *
+ * @return Whether Publish() can be called
+ ****************************************************************/
+inline bool lutzCatalogRing::IsOpen() const
+{
+    return (m_header != nullptr);
+}
+
+
+/************************************************************//**
+ * @brief Return the number of frames published so far
+ *
+ * @return Number of frames published since Create()
+ ****************************************************************/
+inline uint64_t lutzCatalogRing::NumPublished() const
+{
+    return m_sequence;
+}
+
+
+/************************************************************//**
+ * @brief Return the generation of the ring
+ *
+ * @return Number of rings made under the same name before this one
+ *         (0 if the ring is not open)
+ ****************************************************************/
+inline uint64_t lutzCatalogRing::Generation() const
+{
+    return m_header ? m_header->m_generation : 0;
+}
+
+#endif /* LUTZCATALOGRING_HPP */
@@ -0,0 +1,583 @@
+/***************************************************************************
+ *  lutzCompactObject.hpp - Structure-of-arrays storage for an object      *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCompactObject.hpp
+ * @brief Structure-of-arrays storage for an object
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZCOMPACTOBJECT_HPP
+#define LUTZCOMPACTOBJECT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "lutzObject.hpp"
+
+/***************************************************************//**
+ * @brief Compact container for the pixels of an object
+ *
+ * Where lutzObject keeps an array of 24 byte pixData structures, this
+ * keeps separate arrays of x positions, y positions and values, using
+ * CoordT for positions and ValueT (the sample type of the image) for
+ * values. The per-pixel scale is only stored once one has been set with
+ * SetScale(). With 32 bit positions and double values a pixel takes 16
+ * bytes; with 16 bit positions (images up to 32767 pixels on a side) it
+ * takes 12.
+ *
+ * The reductions (sum, minimum/maximum, centroid) run over the plain
+ * arrays with several independent accumulators, which lets the compiler
+ * keep them in vector registers.
+ *
+ * @tparam CoordT   Integer type used for pixel positions
+ * @tparam ValueT   Type used for pixel values
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+class lutzCompactObject {
+public:
+
+    lutzCompactObject() {}
+    lutzCompactObject(const std::vector<lutzObject::pixData>& pixels);
+    lutzCompactObject(const lutzObject& obj);
+    template <typename OtherCoordT, typename OtherValueT>
+    explicit lutzCompactObject(const lutzCompactObject<OtherCoordT, OtherValueT>& other);
+    virtual ~lutzCompactObject() {}
+
+    /******  Methods  ******/
+
+    void   append(int xbin, int ybin, ValueT value);
+    void   append(const lutzObject::pixData& pixel);
+    void   clear();
+    void   reserve(size_t npixels);
+    void   swap(lutzCompactObject& other);
+    void   centroid(double& xcenter, double& ycenter,
+                    bool weight_bins=true) const;
+    void   to_object(lutzObject& obj) const;
+
+    size_t size() const;
+    int    GetX(size_t index) const;
+    int    GetY(size_t index) const;
+    ValueT GetValue(size_t index) const;
+    double GetScale(size_t index) const;
+    void   SetScale(size_t index, double scale);
+    bool   HasScales() const;
+
+    int    GetXMin() const;
+    int    GetXMax() const;
+    int    GetYMin() const;
+    int    GetYMax() const;
+    ValueT GetMinimum() const;
+    ValueT GetMaximum() const;
+    double Sum() const;
+
+    // Number of bytes used to hold the pixels
+    size_t MemoryUsage() const;
+
+protected:
+
+    /******  Methods  ******/
+
+    template <typename T>
+    static void min_max(const std::vector<T>& values, T& vmin, T& vmax);
+
+    /****** Variables ******/
+
+    std::vector<CoordT> m_xbin;       //!< x position of each pixel
+    std::vector<CoordT> m_ybin;       //!< y position of each pixel
+    std::vector<ValueT> m_value;      //!< Value of each pixel
+    std::vector<double> m_scale;      //!< Scale of each pixel (empty = all 1)
+};
+
+// Commonly used variants
+typedef lutzCompactObject<int32_t, double> lutzCompactObject32;
+typedef lutzCompactObject<int16_t, double> lutzCompactObject16;
+
+
+/***************************************************************//**
+ * @brief Construct an object from a vector of pixels
+ *
+ * @param[in] pixels        Vector containing a list of pixel information
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+lutzCompactObject<CoordT, ValueT>::lutzCompactObject(
+    const std::vector<lutzObject::pixData>& pixels)
+{
+    reserve(pixels.size());
+    for (size_t i=0; i<pixels.size(); i++) {
+        append(pixels[i]);
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Construct a compact copy of a lutzObject
+ *
+ * @param[in] obj           Object to be copied
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+lutzCompactObject<CoordT, ValueT>::lutzCompactObject(const lutzObject& obj)
+{
+    reserve(obj.size());
+    for (size_t i=0; i<obj.size(); i++) {
+        append(obj[i]);
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Construct a copy of a compact object of another variant
+ *
+ * @param[in] other         Object to be copied
+ *
+ * This is how the lutzCompactObject32 records of a detector are turned
+ * into a smaller variant, e.g. lutzCompactObject<int16_t, float> for a
+ * frame of float samples no more than 32767 pixels on a side (8 bytes
+ * per pixel). Positions and values are converted with a plain cast, so
+ * the caller must pick types that hold them.
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+template <typename OtherCoordT, typename OtherValueT>
+lutzCompactObject<CoordT, ValueT>::lutzCompactObject(
+    const lutzCompactObject<OtherCoordT, OtherValueT>& other)
+{
+    reserve(other.size());
+    for (size_t i=0; i<other.size(); i++) {
+        append(other.GetX(i), other.GetY(i), ValueT(other.GetValue(i)));
+    }
+    if (other.HasScales()) {
+        for (size_t i=0; i<other.size(); i++) SetScale(i, other.GetScale(i));
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Append a single pixel to this object
+ *
+ * @param[in] xbin          x position of the pixel
+ * @param[in] ybin          y position of the pixel
+ * @param[in] value         Value of the pixel
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+inline void lutzCompactObject<CoordT, ValueT>::append(int xbin, int ybin,
+                                                      ValueT value)
+{
+    m_xbin.push_back(CoordT(xbin));
+    m_ybin.push_back(CoordT(ybin));
+    m_value.push_back(value);
+    if (!m_scale.empty()) m_scale.push_back(1.0);
+}
+
+
+/***************************************************************//**
+ * @brief Append a single pixel to this object
+ *
+ * @param[in] pixel         Pixel to be appended. Its scale is only
+ *                          stored if it is not 1.
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+inline void lutzCompactObject<CoordT, ValueT>::append(
+    const lutzObject::pixData& pixel)
+{
+    append(pixel.m_xbin, pixel.m_ybin, ValueT(pixel.m_value));
+    if (pixel.m_scale != 1.0) SetScale(size() - 1, pixel.m_scale);
+}
+
+
+/***************************************************************//**
+ * @brief Clear the contents of this object
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+void lutzCompactObject<CoordT, ValueT>::clear()
+{
+    m_xbin.clear();
+    m_ybin.clear();
+    m_value.clear();
+    m_scale.clear();
+}
+
+
+/***************************************************************//**
+ * @brief Reserve room for a number of pixels
+ *
+ * @param[in] npixels       Number of pixels
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+void lutzCompactObject<CoordT, ValueT>::reserve(size_t npixels)
+{
+    m_xbin.reserve(npixels);
+    m_ybin.reserve(npixels);
+    m_value.reserve(npixels);
+}
+
+
+/***************************************************************//**
+ * @brief Exchange the contents of this object with another
+ *
+ * @param[in] other         Object to swap contents with
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+void lutzCompactObject<CoordT, ValueT>::swap(lutzCompactObject& other)
+{
+    m_xbin.swap(other.m_xbin);
+    m_ybin.swap(other.m_ybin);
+    m_value.swap(other.m_value);
+    m_scale.swap(other.m_scale);
+}
+
+
+/********************************************************************//**
+ * @brief Compute the central x,y position of the object
+ *
+ * @param[out] xcenter          Center x-position
+ * @param[out] ycenter          Center y-position
+ * @param[in] weight_bins       Specifies whether to compute a weighted position
+ *                              based on the values in each pixel
+ *
+ * This gives the same result as lutzObject::centroid().
+ ************************************************************************/
+template <typename CoordT, typename ValueT>
+void lutzCompactObject<CoordT, ValueT>::centroid(double& xcenter,
+                                                 double& ycenter,
+                                                 bool weight_bins) const
+{
+    const size_t  n     = size();
+    const CoordT* x     = m_xbin.data();
+    const CoordT* y     = m_ybin.data();
+    const ValueT* v     = m_value.data();
+    const double* scale = m_scale.empty() ? nullptr : m_scale.data();
+
+    // Four independent sets of sums so the loop can be vectorized
+    double sw[4] = {0.0, 0.0, 0.0, 0.0};
+    double sx[4] = {0.0, 0.0, 0.0, 0.0};
+    double sy[4] = {0.0, 0.0, 0.0, 0.0};
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (int k=0; k<4; k++) {
+            double w = weight_bins ? double(v[i+k]) : 1.0;
+            if (scale) w *= scale[i+k];
+            sw[k] += w;
+            sx[k] += w * x[i+k];
+            sy[k] += w * y[i+k];
+        }
+    }
+    for (; i < n; i++) {
+        double w = weight_bins ? double(v[i]) : 1.0;
+        if (scale) w *= scale[i];
+        sw[0] += w;
+        sx[0] += w * x[i];
+        sy[0] += w * y[i];
+    }
+
+    double weight_sum = (sw[0] + sw[1]) + (sw[2] + sw[3]);
+    xcenter = (sx[0] + sx[1]) + (sx[2] + sx[3]);
+    ycenter = (sy[0] + sy[1]) + (sy[2] + sy[3]);
+
+    // Normalize by weights if weight is above 0
+    if (weight_sum > 0.0) {
+        xcenter /= weight_sum;
+        ycenter /= weight_sum;
+    }
+    // Otherwise recompute the centroid without weights
+    else if (weight_bins) {
+        centroid(xcenter, ycenter, false);
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Copy the pixels into a lutzObject
+ *
+ * @param[out] obj          Object to be filled (its contents are replaced)
+ *
+ * The pixels are already distinct, so they are not checked against one
+ * another as lutzObject::append() would.
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+void lutzCompactObject<CoordT, ValueT>::to_object(lutzObject& obj) const
+{
+    std::vector<lutzObject::pixData> pixels(size());
+    for (size_t i=0; i<size(); i++) {
+        pixels[i] = lutzObject::pixData(m_xbin[i], m_ybin[i], m_value[i]);
+        pixels[i].m_scale = GetScale(i);
+    }
+    obj.assign(pixels);
+}
+
+
+/***************************************************************//**
+ * @brief Return number of pixels in this object
+ *
+ * @return Number of pixels in this object
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+inline size_t lutzCompactObject<CoordT, ValueT>::size() const
+{
+    return m_value.size();
+}
+
+
+/***************************************************************//**
+ * @brief Return the x position of a pixel
+ *
+ * @param[in] index         Pixel index
+ * @return x position of the pixel
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+inline int lutzCompactObject<CoordT, ValueT>::GetX(size_t index) const
+{
+    return m_xbin[index];
+}
+
+
+/***************************************************************//**
+ * @brief Return the y position of a pixel
+ *
+ * @param[in] index         Pixel index
+ * @return y position of the pixel
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+inline int lutzCompactObject<CoordT, ValueT>::GetY(size_t index) const
+{
+    return m_ybin[index];
+}
+
+
+/***************************************************************//**
+ * @brief Return the value of a pixel
+ *
+ * @param[in] index         Pixel index
+ * @return Value of the pixel
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+inline ValueT lutzCompactObject<CoordT, ValueT>::GetValue(size_t index) const
+{
+    return m_value[index];
+}
+
+
+/***************************************************************//**
+ * @brief Return the scale of a pixel
+ *
+ * @param[in] index         Pixel index
+ * @return Scale of the pixel (1 unless one has been set)
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+inline double lutzCompactObject<CoordT, ValueT>::GetScale(size_t index) const
+{
+    return m_scale.empty() ? 1.0 : m_scale[index];
+}
+
+
+/***************************************************************//**
+ * @brief Set the scale of a pixel
+ *
+ * @param[in] index         Pixel index
+ * @param[in] scale         Scale of the pixel
+ *
+ * The array of scales is only created the first time this is called.
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+inline void lutzCompactObject<CoordT, ValueT>::SetScale(size_t index,
+                                                        double scale)
+{
+    if (m_scale.empty()) m_scale.assign(size(), 1.0);
+    m_scale[index] = scale;
+}
+
+
+/***************************************************************//**
+ * @brief Return whether any pixel scales have been stored
+ *
+ * @return Whether per-pixel scales are stored
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+inline bool lutzCompactObject<CoordT, ValueT>::HasScales() const
+{
+    return !m_scale.empty();
+}
+
+
+/***************************************************************//**
+ * @brief Return smallest pixel position in x
+ *
+ * @return Smallest pixel position in x
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+int lutzCompactObject<CoordT, ValueT>::GetXMin() const
+{
+    CoordT vmin, vmax;
+    min_max(m_xbin, vmin, vmax);
+    return vmin;
+}
+
+
+/***************************************************************//**
+ * @brief Return largest pixel position in x
+ *
+ * @return Largest pixel position in x
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+int lutzCompactObject<CoordT, ValueT>::GetXMax() const
+{
+    CoordT vmin, vmax;
+    min_max(m_xbin, vmin, vmax);
+    return vmax;
+}
+
+
+/***************************************************************//**
+ * @brief Return smallest pixel position in y
+ *
+ * @return Smallest pixel position in y
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+int lutzCompactObject<CoordT, ValueT>::GetYMin() const
+{
+    CoordT vmin, vmax;
+    min_max(m_ybin, vmin, vmax);
+    return vmin;
+}
+
+
+/***************************************************************//**
+ * @brief Return largest pixel position in y
+ *
+ * @return Largest pixel position in y
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+int lutzCompactObject<CoordT, ValueT>::GetYMax() const
+{
+    CoordT vmin, vmax;
+    min_max(m_ybin, vmin, vmax);
+    return vmax;
+}
+
+
+/***************************************************************//**
+ * @brief Return smallest pixel value
+ *
+ * @return Smallest pixel value
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+ValueT lutzCompactObject<CoordT, ValueT>::GetMinimum() const
+{
+    ValueT vmin, vmax;
+    min_max(m_value, vmin, vmax);
+    return vmin;
+}
+
+
+/***************************************************************//**
+ * @brief Return largest pixel value
+ *
+ * @return Largest pixel value
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+ValueT lutzCompactObject<CoordT, ValueT>::GetMaximum() const
+{
+    ValueT vmin, vmax;
+    min_max(m_value, vmin, vmax);
+    return vmax;
+}
+
+
+/***************************************************************//**
+ * @brief Return sum of all pixel values
+ *
+ * @return Sum of all pixel values
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+double lutzCompactObject<CoordT, ValueT>::Sum() const
+{
+    const size_t  n = size();
+    const ValueT* v = m_value.data();
+
+    double sum[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (int k=0; k<4; k++) sum[k] += v[i+k];
+    }
+    for (; i < n; i++) sum[0] += v[i];
+
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+
+/***************************************************************//**
+ * @brief Return the number of bytes used to hold the pixels
+ *
+ * @return Memory used by the pixel arrays
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+size_t lutzCompactObject<CoordT, ValueT>::MemoryUsage() const
+{
+    return m_xbin.capacity()  * sizeof(CoordT) +
+           m_ybin.capacity()  * sizeof(CoordT) +
+           m_value.capacity() * sizeof(ValueT) +
+           m_scale.capacity() * sizeof(double);
+}
+
+
+/***************************************************************//**
+ * @brief Find the smallest and largest entries of an array
+ *
+ * @param[in] values        Array to search
+ * @param[out] vmin         Smallest entry (0 if the array is empty)
+ * @param[out] vmax         Largest entry (0 if the array is empty)
+ *******************************************************************/
+template <typename CoordT, typename ValueT>
+template <typename T>
+void lutzCompactObject<CoordT, ValueT>::min_max(const std::vector<T>& values,
+                                                T& vmin, T& vmax)
+{
+    const size_t n = values.size();
+    if (n == 0) {
+        vmin = vmax = T(0);
+        return;
+    }
+
+    const T* v = values.data();
+    T lo[4] = {v[0], v[0], v[0], v[0]};
+    T hi[4] = {v[0], v[0], v[0], v[0]};
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (int k=0; k<4; k++) {
+            lo[k] = (v[i+k] < lo[k]) ? v[i+k] : lo[k];
+            hi[k] = (v[i+k] > hi[k]) ? v[i+k] : hi[k];
+        }
+    }
+    for (; i < n; i++) {
+        lo[0] = (v[i] < lo[0]) ? v[i] : lo[0];
+        hi[0] = (v[i] > hi[0]) ? v[i] : hi[0];
+    }
+
+    vmin = lo[0];
+    vmax = hi[0];
+    for (int k=1; k<4; k++) {
+        if (lo[k] < vmin) vmin = lo[k];
+        if (hi[k] > vmax) vmax = hi[k];
+    }
+}
+
+#endif /* LUTZCOMPACTOBJECT_HPP */
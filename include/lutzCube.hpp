@@ -0,0 +1,250 @@
+/***************************************************************************
+ *  lutzCube.hpp - Lutz one pass algorithm extended to data cubes          *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCube.hpp
+ * @brief Lutz one pass algorithm extended to data cubes
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZCUBE_HPP
+#define LUTZCUBE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "lutzCubeObject.hpp"
+
+/***************************************************************//**
+ * @brief Single pass extraction of 3D objects from a data cube
+ *
+ * The cube is read one (x,y) plane at a time, in order of z. Voxels above
+ * the threshold are grouped with 26-connectivity: two voxels belong to
+ * the same object if they differ by at most one in each of x, y and z.
+ *
+ * Each plane is scanned row by row. Every run of image voxels is joined
+ * to the objects touching it on the row above and on the three nearest
+ * rows of the previous plane, which are found through a label plane.
+ * Only the label planes of the previous and the current plane are kept,
+ * along with the voxels of the objects that are still open. An object
+ * that has no voxels in a plane can not grow any further, so it is
+ * written as soon as that plane is complete.
+ *
+ * A whole cube in memory is processed with run(). Planes arriving one at
+ * a time are processed with StartCube(), AddPlane() for each plane and
+ * FinishCube(); objects completed so far can be collected after every
+ * AddPlane(). Subclasses may override WriteObject() to consume objects
+ * as they complete instead of storing them.
+ *******************************************************************/
+class lutzCube {
+public:
+    // Constructors
+    lutzCube();
+    lutzCube(double* cube,
+             int xpixels, int ypixels, int zpixels);
+    // Destructor
+    virtual ~lutzCube();
+    
+    /******  Methods  ******/
+    
+    // Set cube information
+    virtual void SetCube(double* cube);
+    virtual void SetXpixels(int xpixels);
+    virtual void SetYpixels(int ypixels);
+    virtual void SetZpixels(int zpixels);
+    virtual void SetThreshold(double threshold);
+    virtual void SetNPixelMin(int npixelmin);
+    
+    // Run the analysis on the whole cube
+    virtual void run();
+    
+    // Run the analysis one plane at a time
+    virtual void StartCube(void);
+    virtual void AddPlane(const double* plane);
+    virtual void FinishCube(void);
+    
+    // Assess whether or not a voxel value is an image voxel
+    virtual bool AssessVoxel(double value);
+    
+    // Return the found objects
+    lutzCubeObject GetObject(const int& obj_id);
+    std::vector<lutzCubeObject> GetObjects(void);
+    int NumObjects(void);
+    
+    // Number of objects still open after the last plane
+    int NumOpenObjects(void);
+    
+protected:
+    
+    /******  Methods  ******/
+    virtual void WriteObject(lutzCubeObject& obj);
+    void ClosePlane(void);
+    int  NewSlot(void);
+    int  FindSlot(int slot);
+    int  LinkSlot(int slot, int other);
+    
+    /****** Variables ******/
+    int     m_xpix;                 //!< Number of bins in x
+    int     m_ypix;                 //!< Number of bins in y
+    int     m_zpix;                 //!< Number of planes
+    int     m_npixelmin;            //!< Minimum number of voxels required to store an object
+    double* m_cube;                 //!< Cube values (1D, x fastest then y then z)
+    double  m_threshold;            //!< Threshold above which a voxel is
+                                    //!< considered an image voxel
+    int     m_zindx;                //!< Index of the next plane
+    
+    std::vector<lutzCubeObject> m_Objects; //!< List of completed objects
+    
+    // Objects being assembled are held in slots joined by union-find
+    std::vector<lutzCubeObject> m_SLOTS;   //!< Voxels of each open object
+    std::vector<int>     m_PARENT;    //!< Union-find parent of each slot
+    std::vector<int>     m_LASTZ;     //!< Last plane holding voxels of each slot
+    std::vector<int>     m_ACTIVE;    //!< Slots in use
+    std::vector<int>     m_FREE;      //!< Slots available for reuse
+    std::vector<int32_t> m_PREV;      //!< Slot + 1 of each voxel of the previous plane
+    std::vector<int32_t> m_CUR;       //!< Slot + 1 of each voxel of the current plane
+    
+private:
+    
+};
+
+/************************************************************//**
+ * @brief Set the cube values
+ *
+ * @param[in] cube          m_xpix x m_ypix x m_zpix values, x fastest
+ ****************************************************************/
+inline void lutzCube::SetCube(double* cube)
+{
+    m_cube = cube;
+}
+
+
+/************************************************************//**
+ * @brief Set the number of pixels in x
+ *
+ * @param[in] xpixels       Number of pixels in x
+ ****************************************************************/
+inline void lutzCube::SetXpixels(int xpixels)
+{
+    m_xpix = xpixels;
+}
+
+
+/************************************************************//**
+ * @brief Set the number of pixels in y
+ *
+ * @param[in] ypixels       Number of pixels in y
+ ****************************************************************/
+inline void lutzCube::SetYpixels(int ypixels)
+{
+    m_ypix = ypixels;
+}
+
+
+/************************************************************//**
+ * @brief Set the number of planes in z
+ *
+ * @param[in] zpixels       Number of planes
+ ****************************************************************/
+inline void lutzCube::SetZpixels(int zpixels)
+{
+    m_zpix = zpixels;
+}
+
+
+/************************************************************//**
+ * @brief Set the threshold for considering a voxel as an "image" voxel
+ *
+ * @param[in] threshold     Threshold value
+ ****************************************************************/
+inline void lutzCube::SetThreshold(double threshold)
+{
+    m_threshold = threshold;
+}
+
+
+/************************************************************//**
+ * @brief Set the minimum number of voxels required to save an object
+ *
+ * @param[in] npixelmin     Minimum number of voxels
+ ****************************************************************/
+inline void lutzCube::SetNPixelMin(int npixelmin)
+{
+    m_npixelmin = npixelmin;
+}
+
+
+/************************************************************//**
+ * @brief Assess whether or not a voxel value is an image voxel
+ *
+ * @param[in] value         Voxel value
+ * @return Whether the value is above threshold
+ ****************************************************************/
+inline bool lutzCube::AssessVoxel(double value)
+{
+    return (value > m_threshold);
+}
+
+
+/************************************************************//**
+ * @brief Return the voxel information for a given object
+ *
+ * @param[in] obj_id        Object ID
+ * @return Object information
+ ****************************************************************/
+inline lutzCubeObject lutzCube::GetObject(const int& obj_id)
+{
+    return m_Objects[obj_id];
+}
+
+
+/************************************************************//**
+ * @brief Return all of the found objects
+ *
+ * @return Vector of object information
+ ****************************************************************/
+inline std::vector<lutzCubeObject> lutzCube::GetObjects(void)
+{
+    return m_Objects;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of found objects
+ *
+ * @return Number of objects found so far
+ ****************************************************************/
+inline int lutzCube::NumObjects()
+{
+    return m_Objects.size();
+}
+
+
+/************************************************************//**
+ * @brief Return the number of objects that are still open
+ *
+ * @return Number of objects that touch the last plane added
+ ****************************************************************/
+inline int lutzCube::NumOpenObjects()
+{
+    return m_ACTIVE.size();
+}
+
+#endif /* LUTZCUBE_HPP */
@@ -0,0 +1,263 @@
+/***************************************************************************
+ *  lutzCubeObject.hpp - Defines an object extracted from a data cube      *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCubeObject.hpp
+ * @brief Defines an object extracted from a data cube
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZCUBEOBJECT_HPP
+#define LUTZCUBEOBJECT_HPP
+
+#include <cstddef>
+#include <vector>
+
+/***************************************************************//**
+ * @brief Connected set of voxels found by lutzCube
+ *
+ * The 3D counterpart of lutzObject: a list of voxels along with the
+ * bounding box and the minimum, maximum and sum of the voxel values.
+ *******************************************************************/
+class lutzCubeObject {
+public:
+    
+    /* ============================================================= */
+    
+    // Create a class for holding the voxel information
+    class voxData {
+    public:
+        voxData(int x=0, int y=0, int z=0, double val=0.0) :
+            m_xbin(x), m_ybin(y), m_zbin(z), m_value(val)
+        {}
+        
+        /****** Operators ******/
+        operator double() const;
+        
+        /****** Variables ******/
+        int    m_xbin;
+        int    m_ybin;
+        int    m_zbin;
+        double m_value;
+    };
+    
+    /* ============================================================= */
+    
+    lutzCubeObject();
+    virtual ~lutzCubeObject();
+    
+    /****** Operators ******/
+    
+    voxData&       operator[] (const int& index);
+    const voxData& operator[] (const int& index) const;
+    
+    /******  Methods  ******/
+    
+    void   append(const voxData& voxel);
+    void   append(lutzCubeObject& other);
+    void   clear();
+    void   centroid(double& xcenter, double& ycenter, double& zcenter,
+                    bool weight_bins=true) const;
+    void   swap(lutzCubeObject& other);
+    
+    size_t size() const;
+    int    GetXMin() const;
+    int    GetXMax() const;
+    int    GetYMin() const;
+    int    GetYMax() const;
+    int    GetZMin() const;
+    int    GetZMax() const;
+    double GetMinimum() const;
+    double GetMaximum() const;
+    double Sum() const;
+    
+protected:
+    
+    /****** Variables ******/
+    
+    int    m_xmin;                    //!< minimum voxel position in x
+    int    m_xmax;                    //!< maximum voxel position in x
+    int    m_ymin;                    //!< minimum voxel position in y
+    int    m_ymax;                    //!< maximum voxel position in y
+    int    m_zmin;                    //!< minimum voxel position in z
+    int    m_zmax;                    //!< maximum voxel position in z
+    double m_value_max;               //!< maximum voxel value
+    double m_value_min;               //!< minimum voxel value
+    double m_value_sum;               //!< Sum of all voxel values
+    std::vector<voxData> m_voxInfo;   //!< Container for voxel information
+    
+};
+
+/***************************************************************//**
+ * @brief Return the voxel at a given index
+ *
+ * @param[in] index         Voxel index to be returned
+ * @return voxel data associated with a given index
+ *******************************************************************/
+inline
+lutzCubeObject::voxData& lutzCubeObject::operator[] (const int& index)
+{
+    return m_voxInfo[index];
+}
+
+
+/***************************************************************//**
+ * @brief Return the voxel at a given index
+ *
+ * @param[in] index         Voxel index to be returned
+ * @return voxel data associated with a given index
+ *******************************************************************/
+inline
+const lutzCubeObject::voxData& lutzCubeObject::operator[] (const int& index) const
+{
+    return m_voxInfo[index];
+}
+
+
+/***************************************************************//**
+ * @brief Return number of voxels in this object
+ *
+ * @return Number of voxels in this object
+ *******************************************************************/
+inline
+size_t lutzCubeObject::size() const
+{
+    return m_voxInfo.size();
+}
+
+
+/***************************************************************//**
+ * @brief Return smallest voxel position in x
+ *
+ * @return Smallest voxel position in x
+ *******************************************************************/
+inline
+int lutzCubeObject::GetXMin() const
+{
+    return m_xmin;
+}
+
+
+/***************************************************************//**
+ * @brief Return largest voxel position in x
+ *
+ * @return Largest voxel position in x
+ *******************************************************************/
+inline
+int lutzCubeObject::GetXMax() const
+{
+    return m_xmax;
+}
+
+
+/***************************************************************//**
+ * @brief Return smallest voxel position in y
+ *
+ * @return Smallest voxel position in y
+ *******************************************************************/
+inline
+int lutzCubeObject::GetYMin() const
+{
+    return m_ymin;
+}
+
+
+/***************************************************************//**
+ * @brief Return largest voxel position in y
+ *
+ * @return Largest voxel position in y
+ *******************************************************************/
+inline
+int lutzCubeObject::GetYMax() const
+{
+    return m_ymax;
+}
+
+
+/***************************************************************//**
+ * @brief Return smallest voxel position in z
+ *
+ * @return Smallest voxel position in z
+ *******************************************************************/
+inline
+int lutzCubeObject::GetZMin() const
+{
+    return m_zmin;
+}
+
+
+/***************************************************************//**
+ * @brief Return largest voxel position in z
+ *
+ * @return Largest voxel position in z
+ *******************************************************************/
+inline
+int lutzCubeObject::GetZMax() const
+{
+    return m_zmax;
+}
+
+
+/***************************************************************//**
+ * @brief Return smallest voxel value
+ *
+ * @return Smallest voxel value
+ *******************************************************************/
+inline
+double lutzCubeObject::GetMinimum() const
+{
+    return m_value_min;
+}
+
+
+/***************************************************************//**
+ * @brief Return largest voxel value
+ *
+ * @return Largest voxel value
+ *******************************************************************/
+inline
+double lutzCubeObject::GetMaximum() const
+{
+    return m_value_max;
+}
+
+
+/***************************************************************//**
+ * @brief Return sum of all voxel values
+ *
+ * @return Sum of all voxel values
+ *******************************************************************/
+inline
+double lutzCubeObject::Sum() const
+{
+    return m_value_sum;
+}
+
+
+/***************************************************************//**
+ * @brief Overload operator double() for a voxel to return the value
+ *******************************************************************/
+inline
+lutzCubeObject::voxData::operator double() const
+{
+    return m_value;
+}
+
+#endif /* LUTZCUBEOBJECT_HPP */
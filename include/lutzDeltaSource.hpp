@@ -0,0 +1,85 @@
+/***************************************************************************
+ *  lutzDeltaSource.hpp - Rows of a delta and zigzag coded frame           *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzDeltaSource.hpp
+ * @brief Rows of a delta and zigzag coded frame
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZDELTASOURCE_HPP
+#define LUTZDELTASOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "lutzRowSource.hpp"
+
+/***************************************************************//**
+ * @brief Row source for frames coded as zigzag varint differences
+ *
+ * Each pixel is stored as its difference from the pixel to its left
+ * (the first pixel of a row from 0). The difference d is mapped to an
+ * unsigned value by zigzag coding, (d << 1) ^ (d >> 31), so that small
+ * differences of either sign give small values. That value is written
+ * 7 bits per byte, low bits first, with the top bit of each byte set
+ * when more bytes follow. A smooth background therefore takes one byte
+ * per pixel.
+ *
+ * Rows follow one another with no padding. Encode() produces the format.
+ *******************************************************************/
+class lutzDeltaSource : public lutzRowSource {
+public:
+    // Constructors
+    lutzDeltaSource();
+    lutzDeltaSource(const uint8_t* data, size_t nbytes,
+                    int xpixels, int ypixels);
+    // Destructor
+    virtual ~lutzDeltaSource();
+
+    /******  Methods  ******/
+
+    // Set the coded frame
+    virtual void SetData(const uint8_t* data, size_t nbytes,
+                         int xpixels, int ypixels);
+
+    // Go back to the first row of the frame
+    virtual void Rewind(void);
+
+    // Decode the next row
+    virtual bool ReadRow(uint16_t* row);
+
+    // Code a frame
+    static void Encode(const uint16_t* image, int xpixels, int ypixels,
+                       std::vector<uint8_t>& data);
+
+protected:
+
+    /****** Variables ******/
+    const uint8_t* m_data;          //!< Coded frame
+    size_t         m_nbytes;        //!< Number of bytes in m_data
+    size_t         m_pos;           //!< Position of the next row in m_data
+
+private:
+
+};
+
+#endif /* LUTZDELTASOURCE_HPP */
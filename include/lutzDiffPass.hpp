@@ -0,0 +1,192 @@
+/***************************************************************************
+ *  lutzDiffPass.hpp - Lutz one pass algorithm on a difference image       *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzDiffPass.hpp
+ * @brief Lutz one pass algorithm on a difference image
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZDIFFPASS_HPP
+#define LUTZDIFFPASS_HPP
+
+#include <vector>
+
+#include "lutzOnePass.hpp"
+
+/***************************************************************//**
+ * @brief Lutz one pass algorithm run on the difference of two frames
+ *
+ * For transient searches. The value of a pixel is
+ *   (science - scale * reference - offset) / noise
+ * where the division only applies when a noise map is set (see
+ * SetNoiseMap()), making the value a significance. Pixels with a noise
+ * map value of 0 or less have a value of 0.
+ *
+ * The difference is computed a row at a time while scanning, so no
+ * difference image is ever stored. With SetNegative(true) the same row
+ * is also thresholded for pixels below -threshold, which are grouped
+ * into objects of their own by a second detector (see GetNegative()).
+ * Its objects carry the negated difference as their value, so they are
+ * ranked and centred like positive ones. It uses the same Config as
+ * this detector; with an adaptive threshold it cuts at nsigma below the
+ * background level. A label image or queue for negative objects is set
+ * on GetNegative() directly.
+ *******************************************************************/
+class lutzDiffPass : public lutzOnePass {
+public:
+    // Constructors
+    lutzDiffPass();
+    lutzDiffPass(const double* science, const double* reference,
+                 int xpixels, int ypixels);
+    // Destructor
+    virtual ~lutzDiffPass();
+
+    /******  Methods  ******/
+
+    // Set the frames to be differenced
+    void SetScience(const double* science);
+    void SetReference(const double* reference);
+    void SetScale(double scale, double offset=0.0);
+    void SetNoiseMap(const double* noise_map);
+
+    // Also find objects below -threshold
+    void SetNegative(bool negative);
+    lutzOnePass& GetNegative(void);
+
+    // Get the difference at a given bin
+    virtual double GetPixValue(int xbin, int ybin);
+
+    // Assess whether or not this pixel is an image pixel
+    virtual bool AssessPixel(int xbin, int ybin);
+    virtual bool HasDirectRows(void) const;
+
+protected:
+
+    // Groups the pixels below -threshold, driven by the parent's scan
+    class Negative : public lutzOnePass {
+    public:
+        Negative(lutzDiffPass& parent);
+        virtual double GetPixValue(int xbin, int ybin);
+        virtual bool   AssessPixel(int xbin, int ybin);
+        virtual bool   HasDirectRows(void) const;
+    protected:
+        friend class lutzDiffPass;
+        void Start(void);
+        void Finish(void);
+        lutzDiffPass& m_parent;
+    };
+
+    /******  Methods  ******/
+    virtual void init_members(void);
+    virtual void ScanImage(void);
+    void DiffRow(int yindx, uint64_t* bits, uint64_t* negative_bits);
+
+    /****** Variables ******/
+    const double* m_science;        //!< Science frame (1D)
+    const double* m_reference;      //!< Reference frame (1D)
+    const double* m_noise_map;      //!< Optional per-pixel noise level
+    double        m_scale;          //!< Factor applied to the reference
+    double        m_offset;         //!< Offset subtracted from the difference
+    bool          m_find_negative;  //!< Whether objects below -threshold are found
+    Negative      m_negative;       //!< Detector of the negative objects
+    std::vector<double>   m_rowvalues; //!< Difference of every pixel on row m_row
+    std::vector<uint64_t> m_NEGBITS;   //!< Negative bits of the current and previous rows
+    int           m_row;            //!< Row held in m_rowvalues (-1 = none)
+
+private:
+
+    // m_negative refers back to this object, so a copy would be left
+    // pointing at the original
+    lutzDiffPass(const lutzDiffPass& other);
+    lutzDiffPass& operator=(const lutzDiffPass& other);
+};
+
+
+/************************************************************//**
+ * @brief Set the science frame
+ *
+ * @param[in] science       m_xpix x m_ypix science values
+ ****************************************************************/
+inline void lutzDiffPass::SetScience(const double* science)
+{
+    m_science = science;
+}
+
+
+/************************************************************//**
+ * @brief Set the reference frame
+ *
+ * @param[in] reference     m_xpix x m_ypix reference values, aligned with
+ *                          the science frame
+ ****************************************************************/
+inline void lutzDiffPass::SetReference(const double* reference)
+{
+    m_reference = reference;
+}
+
+
+/************************************************************//**
+ * @brief Set how the reference is matched to the science frame
+ *
+ * @param[in] scale         Factor applied to the reference
+ * @param[in] offset        Offset subtracted from the difference
+ ****************************************************************/
+inline void lutzDiffPass::SetScale(double scale, double offset)
+{
+    m_scale  = scale;
+    m_offset = offset;
+}
+
+
+/************************************************************//**
+ * @brief Set the noise of the difference, making values significances
+ *
+ * @param[in] noise_map     m_xpix x m_ypix noise levels (nullptr to disable)
+ ****************************************************************/
+inline void lutzDiffPass::SetNoiseMap(const double* noise_map)
+{
+    m_noise_map = noise_map;
+}
+
+
+/************************************************************//**
+ * @brief Set whether objects below -threshold are also found
+ *
+ * @param[in] negative      Whether to find negative objects
+ ****************************************************************/
+inline void lutzDiffPass::SetNegative(bool negative)
+{
+    m_find_negative = negative;
+}
+
+
+/************************************************************//**
+ * @brief Return the detector holding the negative objects
+ *
+ * @return Detector whose GetObjects(), GetBoxes() etc. hold the objects
+ *         found below -threshold in the last run
+ ****************************************************************/
+inline lutzOnePass& lutzDiffPass::GetNegative()
+{
+    return m_negative;
+}
+
+#endif /* LUTZDIFFPASS_HPP */
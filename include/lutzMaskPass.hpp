@@ -0,0 +1,127 @@
+/***************************************************************************
+ *  lutzMaskPass.hpp - Lutz one pass algorithm on a bit-packed mask        *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzMaskPass.hpp
+ * @brief Lutz one pass algorithm on a bit-packed mask
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZMASKPASS_HPP
+#define LUTZMASKPASS_HPP
+
+#include <cstdint>
+
+#include "lutzOnePass.hpp"
+
+/***************************************************************//**
+ * @brief Lutz one pass algorithm run on an already thresholded mask
+ *
+ * The mask holds one bit per pixel, 64 pixels per word. Pixel x of a row
+ * is bit (x % 64) of word (x / 64), counting from the least significant
+ * bit, and every row starts on a new word. A set bit marks an image
+ * pixel; the threshold is not used.
+ *
+ * Rather than visiting every pixel, each row only visits the positions
+ * where the algorithm can change state: set bits, the pixel after each
+ * run of set bits, and the same positions on the previous row where
+ * markers were left (see lutzOnePass::ScanBitRow()). These are found
+ * with count-trailing-zeros, so words that are empty on both rows are
+ * skipped outright.
+ *
+ * If an image is supplied with SetImage() it provides the values of the
+ * object pixels (and is only read there). Otherwise every object pixel
+ * has a value of 1.
+ *******************************************************************/
+class lutzMaskPass : public lutzOnePass {
+public:
+    // Constructors
+    lutzMaskPass();
+    lutzMaskPass(const uint64_t* mask,
+                 int xpixels, int ypixels);
+    // Destructor
+    virtual ~lutzMaskPass();
+
+    /******  Methods  ******/
+
+    // Set the mask
+    virtual void SetMask(const uint64_t* mask, int words_per_row=0);
+
+    // Get the current value of a given bin
+    virtual double GetPixValue(int xbin, int ybin);
+
+    // Assess whether or not this pixel is an image pixel
+    virtual bool AssessPixel(int xbin, int ybin);
+    virtual bool HasDirectRows(void) const;
+    // Number of words per row for a given number of pixels in x
+    static int WordsPerRow(int xpixels);
+
+protected:
+
+    /******  Methods  ******/
+    virtual void ScanImage(void);
+    int  RowStride(void) const;
+
+    /****** Variables ******/
+    const uint64_t* m_mask;         //!< Bit-packed mask (1 = image pixel)
+    int             m_stride;       //!< Words per row (0 = packed tightly)
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Set the mask
+ *
+ * @param[in] mask          Bit-packed mask
+ * @param[in] words_per_row Number of words between the starts of two
+ *                          rows (0 means rows are packed tightly)
+ ****************************************************************/
+inline void lutzMaskPass::SetMask(const uint64_t* mask, int words_per_row)
+{
+    m_mask   = mask;
+    m_stride = words_per_row;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of words needed to hold a row
+ *
+ * @param[in] xpixels       Number of pixels in x
+ * @return Number of 64 bit words per tightly packed row
+ ****************************************************************/
+inline int lutzMaskPass::WordsPerRow(int xpixels)
+{
+    return (xpixels + 63) / 64;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of words between the starts of two rows
+ *
+ * @return Words per row
+ ****************************************************************/
+inline int lutzMaskPass::RowStride() const
+{
+    return (m_stride > 0) ? m_stride : WordsPerRow(m_xpix);
+}
+
+#endif /* LUTZMASKPASS_HPP */
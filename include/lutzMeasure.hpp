@@ -0,0 +1,194 @@
+/***************************************************************************
+ *  lutzMeasure.hpp - Parallel measurement of detected objects             *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzMeasure.hpp
+ * @brief Parallel measurement of detected objects
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZMEASURE_HPP
+#define LUTZMEASURE_HPP
+
+#include <vector>
+
+#include "lutzCatalog.hpp"
+#include "lutzObject.hpp"
+
+/***************************************************************//**
+ * @brief Measures a list of objects on several threads at once
+ *
+ * The features to be measured are chosen with SetFeatures():
+ *   - FEATURE_CENTROID: value weighted centroid (COL_X, COL_Y), as in
+ *     lutzObject::centroid()
+ *   - FEATURE_MOMENTS:  value weighted second central moments (COL_XX,
+ *     COL_YY, COL_XY)
+ *   - FEATURE_ELLIPSE:  semi-axes and angle of the moment ellipse (COL_A,
+ *     COL_B, COL_THETA), which implies FEATURE_MOMENTS
+ *   - FEATURE_FLUX:     isophotal flux and pixel count (COL_FLUX, COL_NPIX)
+ *   - FEATURE_PEAK:     brightest pixel and its position (COL_PEAK,
+ *     COL_XPEAK, COL_YPEAK)
+ * Pixel weights are the pixel value times its m_scale. Objects whose
+ * weights do not sum to more than 0 are measured without weights.
+ *
+ * The work is cut into tasks of about m_grain pixels: runs of whole
+ * small objects, or slices of one large object. Threads take tasks
+ * until none are left, so a giant object is shared between the threads
+ * rather than holding up the run. The sums of the slices are combined
+ * once the threads are done. The results do not depend on the number
+ * of threads.
+ *
+ * Objects truncated by the memory limits of lutzOnePass have no pixels.
+ * They get the centre of their bounding box, their stored flux and peak
+ * value, and NaN for everything else.
+ *******************************************************************/
+class lutzMeasure {
+public:
+    // Features that can be measured
+    enum LUTZ_FEATURE {
+        FEATURE_CENTROID = 1,
+        FEATURE_MOMENTS  = 2,
+        FEATURE_ELLIPSE  = 4,
+        FEATURE_FLUX     = 8,
+        FEATURE_PEAK     = 16,
+        FEATURE_ALL      = 31
+    };
+
+    // Constructors
+    lutzMeasure(unsigned features=FEATURE_ALL);
+    // Destructor
+    virtual ~lutzMeasure();
+
+    /******  Methods  ******/
+
+    // Set what is measured and how the work is shared out
+    void SetFeatures(unsigned features);
+    void SetThreads(int nthreads);
+    void SetGrain(int npix);
+    unsigned GetFeatures(void) const;
+
+    // Measure every object into one row of the catalog each
+    virtual void run(const std::vector<lutzObject>& objects,
+                     lutzCatalog& catalog);
+
+protected:
+
+    // Running sums over some of the pixels of an object
+    struct Sums {
+        Sums() { clear(); }
+        void clear();
+        void merge(const Sums& other);
+
+        /****** Variables ******/
+        double m_w;                 //!< Sum of weights
+        double m_wx;                //!< Weighted sums of x and y, and of
+        double m_wy;                //!< their squares and product
+        double m_wxx;
+        double m_wyy;
+        double m_wxy;
+        double m_n;                 //!< Unweighted sums of the same
+        double m_x;
+        double m_y;
+        double m_xx;
+        double m_yy;
+        double m_xy;
+        double m_flux;              //!< Sum of the pixel values
+        double m_peak;              //!< Value of the brightest pixel
+        int    m_xpeak;             //!< x position of the brightest pixel
+        int    m_ypeak;             //!< y position of the brightest pixel
+    };
+
+    // A share of the work: whole objects [m_first, m_last), or pixels
+    // [m_begin, m_end) of object m_first when m_part >= 0
+    struct Task {
+        int m_first;
+        int m_last;
+        int m_begin;
+        int m_end;
+        int m_part;                 //!< Slot in m_parts (-1 = whole objects)
+    };
+
+    /******  Methods  ******/
+    void PlanTasks(const std::vector<lutzObject>& objects);
+    void RunTask(const Task& task, const std::vector<lutzObject>& objects,
+                 lutzCatalog& catalog);
+    void Accumulate(const lutzObject& object, int begin, int end,
+                    Sums& sums) const;
+    void Finish(const lutzObject& object, const Sums& sums, size_t row,
+                lutzCatalog& catalog) const;
+    unsigned Columns(void) const;
+
+    /****** Variables ******/
+    unsigned          m_features;   //!< Combination of LUTZ_FEATURE values
+    int               m_nthreads;   //!< Threads to use (0 = one per core)
+    int               m_grain;      //!< Pixels per task
+    std::vector<Task> m_tasks;      //!< Work of the current run
+    std::vector<Sums> m_parts;      //!< Sums of the slices of large objects
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Set the features to be measured
+ *
+ * @param[in] features      Combination of LUTZ_FEATURE values
+ ****************************************************************/
+inline void lutzMeasure::SetFeatures(unsigned features)
+{
+    m_features = features;
+}
+
+
+/************************************************************//**
+ * @brief Set the number of threads
+ *
+ * @param[in] nthreads      Threads to use, including the calling one
+ *                          (0 = one per core)
+ ****************************************************************/
+inline void lutzMeasure::SetThreads(int nthreads)
+{
+    m_nthreads = nthreads;
+}
+
+
+/************************************************************//**
+ * @brief Set the size of the tasks the work is cut into
+ *
+ * @param[in] npix          Pixels per task
+ ****************************************************************/
+inline void lutzMeasure::SetGrain(int npix)
+{
+    m_grain = (npix > 0) ? npix : 1;
+}
+
+
+/************************************************************//**
+ * @brief Return the features to be measured
+ *
+ * @return Combination of LUTZ_FEATURE values
+ ****************************************************************/
+inline unsigned lutzMeasure::GetFeatures() const
+{
+    return m_features;
+}
+
+#endif /* LUTZMEASURE_HPP */
@@ -0,0 +1,146 @@
+/***************************************************************************
+ *  lutzMultiBand.hpp - Lutz one pass algorithm on several bands at once   *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzMultiBand.hpp
+ * @brief Lutz one pass algorithm on several bands at once
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZMULTIBAND_HPP
+#define LUTZMULTIBAND_HPP
+
+#include <vector>
+
+#include "lutzOnePass.hpp"
+
+/***************************************************************//**
+ * @brief Lutz one pass algorithm run on a combination of aligned bands
+ *
+ * Each band is an image of m_xpix x m_ypix values with a weight w and a
+ * noise level sigma, given either as one number or as a per-pixel noise
+ * map. The detection statistic of a pixel is
+ *   - COMBINE_CHI2:         sum over bands of w (v / sigma)^2
+ *   - COMBINE_WEIGHTED_SUM: sum over bands of w v / sigma, divided by
+ *                           the square root of the sum of w^2
+ * and pixels whose statistic is above the threshold are image pixels.
+ * Pixels with a noise map value of 0 or less do not contribute. A band
+ * without a noise map must have a noise level above 0, and AddBand()
+ * refuses one that does not rather than let it turn every statistic
+ * into inf or NaN.
+ *
+ * The statistic is computed a row at a time while scanning, so each
+ * band is read once and no combined image is ever stored. Object pixels
+ * carry the statistic as their value, and every lutzObject that is
+ * built also holds the value of each of its pixels in every band (see
+ * lutzObject::GetBandValue()). Compact objects do not hold band values.
+ *******************************************************************/
+class lutzMultiBand : public lutzOnePass {
+public:
+    // Constructors
+    lutzMultiBand();
+    lutzMultiBand(int xpixels, int ypixels);
+    // Destructor
+    virtual ~lutzMultiBand();
+
+    // Ways of combining the bands
+    enum LUTZ_COMBINE {COMBINE_CHI2, COMBINE_WEIGHTED_SUM};
+
+    /******  Methods  ******/
+
+    // Manage the list of bands
+    virtual bool AddBand(const double* image, double weight=1.0,
+                         double noise=1.0, const double* noise_map=nullptr);
+    void ClearBands(void);
+    int  NumBands(void);
+
+    // Set how the bands are combined
+    void SetCombination(LUTZ_COMBINE combine);
+
+    // Get the detection statistic of a given bin
+    virtual double GetPixValue(int xbin, int ybin);
+
+    // Assess whether or not this pixel is an image pixel
+    virtual bool AssessPixel(int xbin, int ybin);
+    virtual bool HasDirectRows(void) const;
+protected:
+
+    // Information on one band
+    struct Band {
+        const double* m_image;      //!< Band values (1D)
+        double        m_weight;     //!< Weight of the band
+        double        m_noise;      //!< Noise level (if there is no map)
+        const double* m_noise_map;  //!< Per-pixel noise level (or nullptr)
+        double        m_scale;      //!< Factor applied to values without a map
+    };
+
+    /******  Methods  ******/
+    virtual void init_members(void);
+    virtual void ScanImage(void);
+    virtual void BuildObject(ObjectInfo& obj, lutzObject& object);
+    void   UpdateFactors(void);
+    void   CombineRow(int yindx, double* values) const;
+    double BandTerm(const Band& band, size_t index) const;
+
+    /****** Variables ******/
+    std::vector<Band>   m_bands;     //!< Bands to be combined
+    LUTZ_COMBINE        m_combine;   //!< How the bands are combined
+    double              m_norm;      //!< Normalisation of the weighted sum
+    std::vector<double> m_rowvalues; //!< Statistic of every pixel on row m_row
+    int                 m_row;       //!< Row held in m_rowvalues (-1 = none)
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Return the number of bands
+ *
+ * @return Number of bands
+ ****************************************************************/
+inline int lutzMultiBand::NumBands()
+{
+    return m_bands.size();
+}
+
+
+/************************************************************//**
+ * @brief Return the contribution of one band to a pixel's statistic
+ *
+ * @param[in] band          Band
+ * @param[in] index         Index of the pixel in the image
+ * @return Term of the sum for this band
+ ****************************************************************/
+inline double lutzMultiBand::BandTerm(const Band& band, size_t index) const
+{
+    double value = band.m_image[index];
+    if (band.m_noise_map) {
+        double noise = band.m_noise_map[index];
+        if (noise <= 0.0) return 0.0;
+        double snr = value / noise;
+        return (m_combine == COMBINE_CHI2) ? band.m_weight * snr * snr
+                                           : band.m_weight * snr;
+    }
+    return (m_combine == COMBINE_CHI2) ? band.m_scale * value * value
+                                       : band.m_scale * value;
+}
+
+#endif /* LUTZMULTIBAND_HPP */
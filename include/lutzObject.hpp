@@ -63,13 +63,22 @@ public:
     
     /* ============================================================= */
     
+    // Flags describing how an object was recorded
+    enum LUTZ_FLAG {
+        FLAG_TRUNCATED = 1,         //!< Pixel list dropped, statistics only
+        FLAG_BAD_PIXEL = 2          //!< Touches a masked or NaN pixel
+    };
+    
     lutzObject();
     lutzObject(std::vector<pixData>& pixels);
     lutzObject(const lutzObject& other);
+    lutzObject(lutzObject&& other) noexcept;
     virtual ~lutzObject();
     
     /****** Operators ******/
     
+    lutzObject&    operator= (const lutzObject& other);
+    lutzObject&    operator= (lutzObject&& other) noexcept;
     pixData&       operator[] (const int& index);
     const pixData& operator[] (const int& index) const;
     
@@ -77,15 +86,25 @@ public:
     
     void   append(const pixData& pixel);
     void   append(std::vector<pixData>& pixels);
+    void   assign(const std::vector<pixData>& pixels);
     void   clear();
     void   centroid(double& xcenter, double& ycenter,
-                    bool weight_bins=true);
+                    bool weight_bins=true) const;
     bool   contains(const pixData& pixel) const;
     bool   overlaps(const lutzObject& other) const;
     void   remove(const int& index);
     void   sort();
+    void   swap(lutzObject& other);
+    void   SetSummary(int npix, int xmin, int xmax, int ymin, int ymax,
+                      double value_min, double value_max, double value_sum);
+    void   SetBandValues(int nbands, std::vector<double>& values);
     
     size_t size() const;
+    int    NumPixels() const;
+    unsigned GetFlags() const;
+    void   SetFlags(unsigned flags);
+    int    NumBands() const;
+    double GetBandValue(int index, int band) const;
     int    GetXMin() const;
     int    GetXMax() const;
     int    GetYMin() const;
@@ -109,7 +128,11 @@ protected:
     double m_value_max;               //!< maximum pixel value
     double m_value_min;               //!< minimum pixel value
     double m_value_sum;               //!< Sum of all pixel values
+    int    m_npix;                    //!< Number of pixels in the object
+    unsigned m_flags;                 //!< Combination of LUTZ_FLAG values
+    int    m_nbands;                  //!< Number of band values per pixel
     std::vector<pixData> m_pixInfo;   //!< Container for pixel information
+    std::vector<double>  m_bandInfo;  //!< Band values, m_nbands per pixel
     
 };
 
@@ -151,6 +174,71 @@ size_t lutzObject::size() const
 }
 
 
+/***************************************************************//**
+ * @brief Return the number of pixels in the object
+ *
+ * @return Number of pixels, including any whose list was dropped
+ *
+ * This is the same as size() unless the object only holds a summary
+ * (see SetSummary()).
+ *******************************************************************/
+inline
+int lutzObject::NumPixels() const
+{
+    return m_npix;
+}
+
+
+/***************************************************************//**
+ * @brief Return the flags describing how the object was recorded
+ *
+ * @return Combination of LUTZ_FLAG values
+ *******************************************************************/
+inline
+unsigned lutzObject::GetFlags() const
+{
+    return m_flags;
+}
+
+
+/***************************************************************//**
+ * @brief Set the flags describing how the object was recorded
+ *
+ * @param[in] flags         Combination of LUTZ_FLAG values
+ *******************************************************************/
+inline
+void lutzObject::SetFlags(unsigned flags)
+{
+    m_flags = flags;
+}
+
+
+/***************************************************************//**
+ * @brief Return the number of band values stored for each pixel
+ *
+ * @return Number of bands (0 if none were stored)
+ *******************************************************************/
+inline
+int lutzObject::NumBands() const
+{
+    return m_nbands;
+}
+
+
+/***************************************************************//**
+ * @brief Return the value of a pixel in one band
+ *
+ * @param[in] index         Pixel index
+ * @param[in] band          Band index
+ * @return Value of the pixel in the requested band
+ *******************************************************************/
+inline
+double lutzObject::GetBandValue(int index, int band) const
+{
+    return m_bandInfo[size_t(index) * m_nbands + band];
+}
+
+
 /***************************************************************//**
  * @brief Return smallest pixel position in x
  *
@@ -222,15 +310,6 @@ double lutzObject::GetMaximum() const
     return m_value_max;
 }
 
-/***************************************************************//**
- * @brief Sort pixels from lowest value to largest value
- *******************************************************************/
-inline
-void lutzObject::sort()
-{
-    std::sort(m_pixInfo.begin(), m_pixInfo.end());
-}
-
 /*****************************************************************
  * @brief Return sum of all pixel values
  *
@@ -0,0 +1,158 @@
+/***************************************************************************
+ *  lutzObjectFilter.hpp - Cuts applied to objects during the scan         *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzObjectFilter.hpp
+ * @brief Cuts applied to objects during the scan
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZOBJECTFILTER_HPP
+#define LUTZOBJECTFILTER_HPP
+
+#include "lutzOnePass.hpp"
+
+/***************************************************************//**
+ * @brief Decides which objects are kept, from their running statistics
+ *
+ * Used through lutzOnePass::SetObjectFilter(). Accept() is called once
+ * an object is complete, and Abort() whenever the bounding box of an
+ * open object grows. Both see only the counters that lutzOnePass keeps
+ * for every object (lutzOnePass::ObjectInfo), never its pixel list, so a
+ * filter works the same in every output mode.
+ *
+ * The built-in cuts are all off by default:
+ *   - SetPixelRange():    number of pixels
+ *   - SetMaxExtent():     width and height of the bounding box
+ *   - SetMaxElongation(): ratio of the axes of the object's shape
+ *   - SetPeakRange():     value of the brightest pixel
+ *   - SetRejectEdges():   objects touching the edge of the image
+ * The default Abort() gives up on an object once its extent, edge contact,
+ * pixel count or peak rules it out, since these only ever grow. To
+ * apply other cuts, derive from this class and override Accept(), and
+ * Abort() for any cut that can only get worse as an object grows.
+ * The methods are const, so one filter can serve several detectors.
+ *******************************************************************/
+class lutzObjectFilter {
+public:
+    // Constructors
+    lutzObjectFilter();
+    // Destructor
+    virtual ~lutzObjectFilter();
+
+    /******  Methods  ******/
+
+    // Set the built-in cuts (0 = no limit)
+    void SetPixelRange(int npixmin, int npixmax=0);
+    void SetMaxExtent(int xextent, int yextent);
+    void SetMaxElongation(double elongation);
+    void SetPeakRange(double peakmin, double peakmax);
+    void SetRejectEdges(bool reject);
+
+    // Whether a complete object is kept
+    virtual bool Accept(const lutzOnePass::ObjectInfo& obj,
+                        int xpixels, int ypixels) const;
+
+    // Whether an open object can already be dropped
+    virtual bool Abort(const lutzOnePass::ObjectInfo& obj,
+                       int xpixels, int ypixels) const;
+
+    // Shape of an object from its running sums
+    static double Elongation(const lutzOnePass::ObjectInfo& obj);
+
+protected:
+
+    /****** Variables ******/
+    int    m_npixmin;           //!< Fewest pixels an object may have
+    int    m_npixmax;           //!< Most pixels an object may have (0 = any)
+    int    m_xextent;           //!< Widest bounding box allowed (0 = any)
+    int    m_yextent;           //!< Tallest bounding box allowed (0 = any)
+    double m_elongation;        //!< Largest ratio of the axes (0 = any)
+    double m_peakmin;           //!< Faintest peak allowed
+    double m_peakmax;           //!< Brightest peak allowed
+    bool   m_reject_edges;      //!< Whether objects on the edge are dropped
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Set the range of the number of pixels
+ *
+ * @param[in] npixmin       Fewest pixels an object may have
+ * @param[in] npixmax       Most pixels an object may have (0 = any)
+ ****************************************************************/
+inline void lutzObjectFilter::SetPixelRange(int npixmin, int npixmax)
+{
+    m_npixmin = npixmin;
+    m_npixmax = npixmax;
+}
+
+
+/************************************************************//**
+ * @brief Set the largest bounding box
+ *
+ * @param[in] xextent       Widest bounding box in pixels (0 = any)
+ * @param[in] yextent       Tallest bounding box in pixels (0 = any)
+ ****************************************************************/
+inline void lutzObjectFilter::SetMaxExtent(int xextent, int yextent)
+{
+    m_xextent = xextent;
+    m_yextent = yextent;
+}
+
+
+/************************************************************//**
+ * @brief Set the largest elongation
+ *
+ * @param[in] elongation    Largest ratio of the major to the minor axis
+ *                          (0 = any, see Elongation())
+ ****************************************************************/
+inline void lutzObjectFilter::SetMaxElongation(double elongation)
+{
+    m_elongation = elongation;
+}
+
+
+/************************************************************//**
+ * @brief Set the range of the peak value
+ *
+ * @param[in] peakmin       Faintest peak allowed
+ * @param[in] peakmax       Brightest peak allowed
+ ****************************************************************/
+inline void lutzObjectFilter::SetPeakRange(double peakmin, double peakmax)
+{
+    m_peakmin = peakmin;
+    m_peakmax = peakmax;
+}
+
+
+/************************************************************//**
+ * @brief Set whether objects touching the edge of the image are dropped
+ *
+ * @param[in] reject        Whether to drop them
+ ****************************************************************/
+inline void lutzObjectFilter::SetRejectEdges(bool reject)
+{
+    m_reject_edges = reject;
+}
+
+#endif /* LUTZOBJECTFILTER_HPP */
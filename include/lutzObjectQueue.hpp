@@ -0,0 +1,187 @@
+/***************************************************************************
+ *  lutzObjectQueue.hpp - Lock-free queue for handing off finished objects *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzObjectQueue.hpp
+ * @brief Lock-free queue for handing off finished objects
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZOBJECTQUEUE_HPP
+#define LUTZOBJECTQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "lutzObject.hpp"
+
+/***************************************************************//**
+ * @brief Bounded queue for passing completed objects between threads
+ *
+ * The queue is filled by a single producer (the lutzOnePass::run() loop)
+ * and may be drained by any number of consumer threads. It is a ring of
+ * cells with per-cell sequence numbers, so neither side ever takes a
+ * lock. When the ring is full push() waits for a consumer to free a cell,
+ * which throttles detection to the speed of measurement.
+ *
+ * Each frame is bracketed by open() and close(). open() numbers the frames
+ * 1, 2, 3, ... and every object pushed is tagged with the frame it belongs
+ * to. Consumers ask pop() for the objects of one frame. Once that frame
+ * has been closed and all of its objects taken, pop() returns false,
+ * which is the consumers' end-of-frame signal. Objects of a later frame
+ * are never handed out in its place, so a slow consumer that only looks
+ * after the producer has moved on to the next frame still sees the end
+ * of the one it was working on:
+ *
+ *     for (size_t frame=1; ; frame++) {
+ *         while (queue.pop(obj, frame)) { ... }
+ *         // frame is complete
+ *     }
+ *******************************************************************/
+class lutzObjectQueue {
+public:
+    // Constructors
+    lutzObjectQueue(size_t capacity=1024);
+    // Destructor
+    virtual ~lutzObjectQueue();
+
+    /******  Methods  ******/
+
+    // Producer side (only one thread may call these)
+    bool   try_push(lutzObject& obj);
+    void   push(lutzObject& obj);
+
+    // Consumer side (any number of threads may call these)
+    bool   try_pop(lutzObject& obj, size_t frame=0);
+    bool   pop(lutzObject& obj, size_t frame);
+
+    // Frame bookkeeping
+    size_t open();
+    void   close();
+    size_t frame() const;
+    bool   closed(size_t frame) const;
+
+    size_t capacity() const;
+    size_t size() const;
+
+protected:
+
+    /******  Methods  ******/
+    bool   take(lutzObject& obj, size_t frame, bool& behind);
+
+    // A single slot in the ring
+    struct Cell {
+        std::atomic<size_t> m_sequence;   //!< Position this cell is ready for
+        std::atomic<size_t> m_frame;      //!< Frame the stored object belongs to
+        lutzObject          m_object;     //!< Object stored in this cell
+    };
+
+    /****** Variables ******/
+    size_t                  m_mask;       //!< Ring size minus one (size is a power of 2)
+    std::unique_ptr<Cell[]> m_cells;      //!< Ring of cells
+
+    // Keep the two positions on separate cache lines so the producer and
+    // the consumers do not fight over the same line
+    alignas(64) std::atomic<size_t> m_enqueue_pos;  //!< Next position to write
+    alignas(64) std::atomic<size_t> m_dequeue_pos;  //!< Next position to read
+    alignas(64) std::atomic<size_t> m_frame;        //!< Last frame opened
+    alignas(64) std::atomic<size_t> m_closed;       //!< Last frame closed
+
+private:
+
+    // The queue owns atomics and cannot be copied
+    lutzObjectQueue(const lutzObjectQueue& other);
+    lutzObjectQueue& operator=(const lutzObjectQueue& other);
+};
+
+
+/************************************************************//**
+ * @brief Mark the start of a new frame
+ *
+ * @return Number of the new frame (the first frame is 1)
+ ****************************************************************/
+inline size_t lutzObjectQueue::open()
+{
+    size_t frame = m_frame.load(std::memory_order_relaxed) + 1;
+    m_frame.store(frame, std::memory_order_release);
+    return frame;
+}
+
+
+/************************************************************//**
+ * @brief Signal that no more objects will be pushed for this frame
+ ****************************************************************/
+inline void lutzObjectQueue::close()
+{
+    m_closed.store(m_frame.load(std::memory_order_relaxed),
+                   std::memory_order_release);
+}
+
+
+/************************************************************//**
+ * @brief Return the number of the last frame opened
+ *
+ * @return Frame number (0 before the first open())
+ ****************************************************************/
+inline size_t lutzObjectQueue::frame() const
+{
+    return m_frame.load(std::memory_order_acquire);
+}
+
+
+/************************************************************//**
+ * @brief Return whether a frame has been closed
+ *
+ * @param[in] frame         Frame number
+ * @return Whether close() has been called for this frame
+ ****************************************************************/
+inline bool lutzObjectQueue::closed(size_t frame) const
+{
+    return m_closed.load(std::memory_order_acquire) >= frame;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of objects the queue can hold
+ *
+ * @return Capacity of the queue
+ ****************************************************************/
+inline size_t lutzObjectQueue::capacity() const
+{
+    return m_mask + 1;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of objects currently waiting
+ *
+ * @return Approximate number of queued objects
+ *
+ * The value is only a snapshot when other threads are active.
+ ****************************************************************/
+inline size_t lutzObjectQueue::size() const
+{
+    size_t head = m_dequeue_pos.load(std::memory_order_relaxed);
+    size_t tail = m_enqueue_pos.load(std::memory_order_relaxed);
+    return (tail > head) ? (tail - head) : 0;
+}
+
+#endif /* LUTZOBJECTQUEUE_HPP */
@@ -28,11 +28,20 @@
 #ifndef LUTZONEPASS_HPP
 #define LUTZONEPASS_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <typeinfo>
 
+#include "lutzBackground.hpp"
+#include "lutzBox.hpp"
+#include "lutzCompactObject.hpp"
 #include "lutzObject.hpp"
+#include "lutzObjectQueue.hpp"
+
+class lutzObjectFilter;
 
 class lutzOnePass {
 public:
@@ -51,6 +60,7 @@ public:
     virtual void SetYpixels(int ypixels);
     virtual void SetThreshold(double threshold);
     virtual void SetNPixelMin(int npixelmin);
+    virtual void SetObjectQueue(lutzObjectQueue* queue);
     
     // Run the actual analysis
     virtual void run();
@@ -61,6 +71,9 @@ public:
     // Assess whether or not this pixel is an image pixel
     virtual bool AssessPixel(int xbin, int ybin);
     
+    // Whether the scan may threshold the rows of m_image itself
+    virtual bool HasDirectRows(void) const;
+    
     // Return the list of pixel information for a given object
     lutzObject GetObject(const int& obj_id);
     std::vector<lutzObject> GetObjects(void);
@@ -69,14 +82,154 @@ public:
     // enums
     enum LUTZSTATUS {COMPLETE, INCOMPLETE, OBJECT, NONOBJECT};
     enum LUTZ_STACK_ACTION {PUSH, POP};
+    enum LUTZ_RANK {RANK_SUM, RANK_MAXIMUM};
+    enum LUTZ_BAD_ACTION {BAD_EXCLUDE, BAD_BRIDGE, BAD_FLAG};
+    
+    // Keep only the brightest objects
+    virtual void SetMaxObjects(int nobjects, LUTZ_RANK rank=RANK_SUM);
     
     // Define a vector of pixel data as an Object
     typedef std::vector<lutzObject::pixData> Object;
     
+    /* ============================================================= */
+    
+    // Running information on an object while it is being assembled
+    class ObjectInfo {
+    public:
+        ObjectInfo() { clear(); }
+        void clear();
+        
+        /******  Methods  ******/
+        // Empty the pixel list and free its storage
+        void release();
+        // Add a pixel, optionally without storing it in m_pixels
+        void add(const lutzObject::pixData& pixel, bool keep_pixel=true);
+        // Absorb another object, leaving the other one empty
+        void merge(ObjectInfo& other);
+        // Shift all pixel positions
+        void translate(int dx, int dy);
+        bool empty() const;
+        
+        /****** Variables ******/
+        static const size_t RESERVE_PIXELS = 16; //!< Capacity each list is given up front
+        Object m_pixels;            //!< Pixels of the object (if they are kept)
+        int    m_npix;              //!< Number of pixels in the object
+        int    m_xmin;              //!< minimum pixel position in x
+        int    m_xmax;              //!< maximum pixel position in x
+        int    m_ymin;              //!< minimum pixel position in y
+        int    m_ymax;              //!< maximum pixel position in y
+        int    m_xpeak;             //!< x position of the brightest pixel
+        int    m_ypeak;             //!< y position of the brightest pixel
+        double m_peak;              //!< Value of the brightest pixel
+        double m_min;               //!< Value of the faintest pixel
+        double m_sum;               //!< Sum of all pixel values
+        int    m_label;             //!< Provisional label in the label image
+        bool   m_truncated;         //!< Whether the pixel list was dropped
+        int    m_nbad;              //!< Bad pixels bridged over (not in m_npix)
+        unsigned m_flags;           //!< Combination of lutzObject::LUTZ_FLAG values
+        double m_sx;                //!< Sums of x and y over the pixels, and
+        double m_sy;                //!< of their squares and product, for
+        double m_sxx;               //!< the shape of the object
+        double m_syy;
+        double m_sxy;
+        bool   m_rejected;          //!< Whether a filter has given up on it
+    };
+    
+    /* ============================================================= */
+    
+    // Write a per-pixel object ID map during the scan
+    virtual void SetLabelImage(int32_t* labels, bool keep_pixels=true);
+    int NumLabels(void);
+    
+    // Only record the pixel count, bounding box and peak of each object
+    virtual void SetBoxesOnly(bool boxes_only);
+    const std::vector<lutzBox>& GetBoxes(void);
+    int NumBoxes(void);
+    
+    // Store objects in structure-of-arrays form
+    virtual void SetCompactObjects(bool compact);
+    const std::vector<lutzCompactObject32>& GetCompactObjects(void);
+    int NumCompactObjects(void);
+    
+    // Limit the memory used for pixel lists (0 = no limit)
+    virtual void SetMaxObjectPixels(int npix);
+    virtual void SetMaxRetainedPixels(size_t npix);
+    virtual void SetMaxOpenObjects(int nobjects);
+    int NumTruncated(void);
+    
+    // Limit the storage a pixel list keeps for the next object (0 = no limit)
+    virtual void SetMaxSparePixels(size_t npix);
+    
+    // Mark pixels as bad (nullptr = none) and choose how they are treated
+    virtual void SetBadPixelMask(const uint8_t* mask);
+    virtual void SetBadPixelBits(const uint64_t* bits, int words_per_row=0);
+    virtual void SetBadPixelAction(LUTZ_BAD_ACTION action);
+    
+    // Drop objects that fail a filter before they are built
+    virtual void SetObjectFilter(const lutzObjectFilter* filter);
+    
+    // Derive each frame's threshold from the background of earlier frames
+    virtual void SetAdaptiveThreshold(double nsigma, double damping=0.5);
+    lutzBackground& GetBackground(void);
+    double GetRunThreshold(void) const;
+    
+    /* ============================================================= */
+    
+    // Detection parameters, kept apart from the state of a run
+    struct Config {
+        Config();
+        
+        /****** Variables ******/
+        double    m_threshold;          //!< Threshold above which a pixel is
+                                        //!< considered an image pixel
+        int       m_npixelmin;          //!< Minimum number of pixels required to store an object
+        int       m_maxobjects;         //!< Maximum number of objects to keep (0 = all)
+        LUTZ_RANK m_rank;               //!< Quantity used to rank objects for m_maxobjects
+        bool      m_boxes_only;         //!< Whether only lutzBox records are produced
+        bool      m_compact;            //!< Whether objects are stored as lutzCompactObjects
+        int       m_max_object_pixels;  //!< Maximum pixels kept for one object (0 = no limit)
+        size_t    m_max_retained;       //!< Maximum pixels kept in total (0 = no limit)
+        int       m_max_open;           //!< Maximum open objects keeping pixels (0 = no limit)
+        size_t    m_max_spare;          //!< Capacity an emptied pixel list may keep (0 = no limit)
+        LUTZ_BAD_ACTION m_bad_action;   //!< How bad and NaN pixels are treated
+        double    m_adaptive_nsigma;    //!< Threshold in background sigma above the
+                                        //!< background level (0 = fixed threshold)
+        const lutzObjectFilter* m_filter; //!< Test objects must pass (nullptr = none)
+    };
+    
+    /* ============================================================= */
+    
+    // Set all of the detection parameters at once
+    virtual void SetConfig(const Config& config);
+    const Config& GetConfig(void) const;
+    
+    // Give back the memory kept from one run to the next
+    virtual void ReleaseMemory(void);
+    
 protected:
     
     /******  Methods  ******/
     virtual void init_members(void);
+    virtual void ScanImage(void);
+    void ScanImageDirect(void);
+    void SampleRow(int yindx);
+    bool ThresholdRow(const double* row, uint64_t* bits) const;
+    void ScanBitRow(const uint64_t* cur, const uint64_t* prev,
+                    int yindx, int& co, int& pstop);
+    void StartRow(void);
+    void ProcessPixel(int xindx, int yindx, bool is_image_pixel,
+                      int& co, int& pstop);
+    
+    // Methods for handling bad pixels
+    bool IsMaskedPixel(int xbin, int ybin) const;
+    bool AssessBadPixel(int xbin, int ybin, bool is_image_pixel);
+    void FindNaNs(const double* row, uint64_t* bits) const;
+    void ApplyBadPixels(int yindx, const uint64_t* nan_bits,
+                        uint64_t* bits) const;
+    virtual bool HasExcludedPixel(int xlo, int xhi, int yindx);
+    bool RowHasExcluded(int yindx);
+    bool NearExcluded(int yindx);
+    void FlagExcluded(ObjectInfo& info, int xstart, int xend, int ylo, int yhi);
     
     // Methods for managing OBSTACK and PSSTACK
     void ModOBSTACK(LUTZ_STACK_ACTION status,
@@ -90,28 +243,82 @@ protected:
     virtual void ProcessNewMarker(char& prev_marker,
                                   int& xindx, int& co, int& pstop);
     virtual void StoreClearance(void);
-    virtual void WriteObject(Object& obj);
+    virtual void WriteObject(ObjectInfo& obj);
+    void CloseObject(ObjectInfo& obj);
+    void MergeObjects(ObjectInfo& obj, ObjectInfo& other);
+    void JoinPixels(ObjectInfo& obj, ObjectInfo& other);
+    void ReservePixels(ObjectInfo& obj, size_t npix);
+    void KeepPixels(ObjectInfo& obj);
+    static int SpareClass(size_t capacity);
+    void CheckLimits(ObjectInfo& obj);
+    void DropPixels(ObjectInfo& obj);
+    void CheckFilter(ObjectInfo& obj);
+    virtual void BuildObject(ObjectInfo& obj, lutzObject& object);
+    
+    // Methods for maintaining the label image
+    int  NewLabel(void);
+    int  FindLabel(int label);
+    void PaintLabels(ObjectInfo& obj, int32_t label);
+    
+    // Methods for maintaining the list of brightest objects
+    void   KeepBrightest(ObjectInfo& obj);
+    void   FinishBrightest(void);
+    double RankValue(const lutzObject& obj) const;
     
     /****** Variables ******/
     int     m_xpix;                 //!< Number of bins in x
     int     m_ypix;                 //!< Number of bins in y
-    int     m_npixelmin;            //!< Minimum number of pixels required to store an object
     double* m_image;                //!< Image values (1D)
-    double  m_threshold;            //!< Threshold above which a pixel is
-                                    //!< considered an image pixel
+    Config  m_config;               //!< Detection parameters
+    lutzObjectQueue* m_queue;       //!< Optional queue receiving completed objects
+    int32_t* m_labels;              //!< Optional label image (1D)
+    bool    m_label_pixels;         //!< Whether pixel lists are kept alongside m_labels
+    bool    m_keep_pixels;          //!< Whether pixel lists are kept for each object
+    bool    m_provisional;          //!< Whether provisional labels are written during the scan
+    int     m_nlabels;              //!< Number of labels written so far
+    std::vector<int> m_label_parent; //!< Union-find table of provisional labels
+    bool    m_limited;              //!< Whether any of the limits above apply
+    int     m_open;                 //!< Open objects currently keeping pixels
+    size_t  m_open_pixels;          //!< Pixels held by open objects
+    size_t  m_retained;             //!< Pixels held by completed objects
+    int     m_ntruncated;           //!< Number of objects written without pixels
+    const uint8_t*  m_bad_mask;     //!< Optional bad pixel flags, one byte per pixel
+    const uint64_t* m_bad_bits;     //!< Optional bad pixel flags, bit-packed rows
+    int     m_bad_stride;           //!< Words per row of m_bad_bits (0 = packed tightly)
+    bool    m_bad_rows;             //!< Whether rows need the bad pixel treatment
+    bool    m_check_bad;            //!< Whether image pixels may be bad ones
+    bool    m_flag_excluded;        //!< Whether objects next to excluded pixels are flagged
+    bool    m_flag_row;             //!< Whether the current row still needs that check
+    int     m_segment_start;        //!< First pixel of the segment being scanned
+    int     m_prev_segment_start;   //!< First pixel of the segment above being passed
+    std::vector<char> m_EXROWS;     //!< Per row: 0 = not yet looked at, 1 = no
+                                    //!< excluded pixel, 2 = has one
+    lutzBackground m_background;    //!< Background of the frames scanned so far
+    bool    m_adaptive;             //!< Whether this run samples the background
+    double  m_threshold;            //!< Threshold of this run (m_config.m_threshold
+                                    //!< unless the threshold is adaptive)
     
     std::vector<Object> m_pixData;  //!< Pixel data for all objects
+    std::vector<lutzObject> m_spare;  //!< Emptied objects from the last run, for reuse
+    std::vector<lutzCompactObject32> m_spare_compact; //!< Emptied compact objects, for reuse
+    static const int SPARE_CLASSES = 48;    //!< Size classes of kept pixel list storage
+    std::vector<Object> m_spare_pixels[SPARE_CLASSES]; //!< Storage of the pixel lists of
+                                                       //!< written objects, by SpareClass()
     
     // Some book keeping parameters
     std::vector<char>        m_MARKER;
     std::vector<lutzObject> m_Objects;   //!< List of completed objects
-    std::vector<Object>      m_STORE;     //!< Stores cached objects
+    std::vector<lutzBox>     m_Boxes;     //!< Completed objects in boxes-only mode
+    std::vector<lutzCompactObject32> m_Compact; //!< Completed objects in compact mode
+    std::vector<uint64_t>    m_ROWBITS;   //!< Thresholded bits of the current and previous rows
+    std::vector<uint64_t>    m_NANBITS;   //!< NaN pixels of the current row
+    std::vector<ObjectInfo>  m_STORE;     //!< Stores cached objects
     std::vector<LUTZSTATUS>  m_PSSTACK;   //!< Pixel status from previous line
     
     // The following store information relevant to OBSTACK
     std::vector<int>         m_START;     //!< Identifies first pixel associated with object 'co'
     std::vector<int>         m_END;       //!< Last pixel associated with object 'co'
-    std::vector<Object>      m_INFO;      //!< Caches objects currently being processed
+    std::vector<ObjectInfo>  m_INFO;      //!< Caches objects currently being processed
     LUTZSTATUS m_PS;                      //!< Status relevant to pixels on previous row
     LUTZSTATUS m_CS;                      //!< Status of current pixel
     
@@ -159,7 +366,7 @@ inline void lutzOnePass::SetYpixels(int ypixels)
  ****************************************************************/
 inline void lutzOnePass::SetThreshold(double threshold)
 {
-    m_threshold = threshold;
+    m_config.m_threshold = threshold;
 }
 
 
@@ -170,9 +377,507 @@ inline void lutzOnePass::SetThreshold(double threshold)
  ****************************************************************/
 inline void lutzOnePass::SetNPixelMin(int npixelmin)
 {
-    m_npixelmin = npixelmin;
+    m_config.m_npixelmin = npixelmin;
+}
+
+
+/************************************************************//**
+ * @brief Hand completed objects to a queue instead of storing them
+ *
+ * @param[in] queue         Queue to receive objects (nullptr to disable)
+ *
+ * When a queue is set, each object is pushed the moment it is complete
+ * so that consumer threads can measure it while the scan continues.
+ * The queue is opened at the start of run() and closed at the end, so
+ * each run() is one frame of the queue (see lutzObjectQueue::pop()), and
+ * objects handed to it are not kept in the list returned by GetObjects().
+ ****************************************************************/
+inline void lutzOnePass::SetObjectQueue(lutzObjectQueue* queue)
+{
+    m_queue = queue;
+}
+
+/************************************************************//**
+ * @brief Keep only the brightest objects found in the image
+ *
+ * @param[in] nobjects      Number of objects to keep (0 keeps all of them)
+ * @param[in] rank          Whether to rank objects by their summed value
+ *                          (RANK_SUM) or their peak value (RANK_MAXIMUM)
+ *
+ * Objects are held in a min-heap of size nobjects while the image is
+ * scanned. An object that cannot make the cut is discarded along with
+ * its pixels as soon as it is complete, so the memory used for results
+ * does not depend on how crowded the image is. After run() the objects
+ * are ordered from brightest to faintest. If an object queue is also set,
+ * the survivors are pushed to it at the end of the frame.
+ ****************************************************************/
+inline void lutzOnePass::SetMaxObjects(int nobjects, LUTZ_RANK rank)
+{
+    m_config.m_maxobjects = nobjects;
+    m_config.m_rank       = rank;
+}
+
+
+/************************************************************//**
+ * @brief Write the object ID of every pixel into a label image
+ *
+ * @param[in] labels        Buffer of m_xpix x m_ypix labels (nullptr to disable)
+ * @param[in] keep_pixels   Whether to keep a pixel list for each object
+ *
+ * The buffer is zeroed at the start of run(), and the pixels of each
+ * object are given the label 1, 2, 3, ... in the order the objects are
+ * written, so label n is object n-1 of GetObjects(). When only the
+ * brightest objects are kept, labels follow the final brightness order.
+ *
+ * With keep_pixels = false no pixel lists are built at all and no
+ * lutzObjects are produced. Pixels are instead given a provisional
+ * (negative) label as they are scanned, and objects that are joined by
+ * the scan have their provisional labels united. When an object is
+ * complete only its bounding box is relabelled, so there is never a
+ * second pass over the whole image.
+ ****************************************************************/
+inline void lutzOnePass::SetLabelImage(int32_t* labels, bool keep_pixels)
+{
+    m_labels       = labels;
+    m_label_pixels = keep_pixels;
+}
+
+
+/************************************************************//**
+ * @brief Only record the pixel count, bounding box and peak of objects
+ *
+ * @param[in] boxes_only    Whether to produce lutzBox records only
+ *
+ * In this mode no pixel lists are kept and no lutzObjects are built.
+ * Each open object carries just a handful of counters through the scan,
+ * and every object of at least the minimum number of pixels is appended
+ * to a flat array of lutzBox records (see GetBoxes()). The minimum size is the
+ * only selection applied; the brightest-object and queue options do
+ * not apply to boxes. A label image can still be written alongside.
+ ****************************************************************/
+inline void lutzOnePass::SetBoxesOnly(bool boxes_only)
+{
+    m_config.m_boxes_only = boxes_only;
+}
+
+
+/************************************************************//**
+ * @brief Return the records found in boxes-only mode
+ *
+ * @return Flat array of object records
+ ****************************************************************/
+inline const std::vector<lutzBox>& lutzOnePass::GetBoxes(void)
+{
+    return m_Boxes;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of records found in boxes-only mode
+ *
+ * @return Number of objects found in the image
+ ****************************************************************/
+inline int lutzOnePass::NumBoxes()
+{
+    return m_Boxes.size();
+}
+
+
+/************************************************************//**
+ * @brief Store completed objects in structure-of-arrays form
+ *
+ * @param[in] compact       Whether to produce lutzCompactObjects
+ *
+ * Objects are kept as lutzCompactObject32 records (see
+ * GetCompactObjects()) in place of the lutzObjects returned by
+ * GetObjects(). These hold 16 bytes per pixel rather than 24, which
+ * matters for catalogs of large objects. Objects handed to a queue or
+ * kept by SetMaxObjects(), and objects truncated by the memory limits
+ * (see SetMaxObjectPixels()), are still lutzObjects.
+ *
+ * Only the 32 bit variant is stored, since every frame size fits it and
+ * values reach the scan as doubles through GetPixValue() whatever the
+ * sample type. A record can be copied into a smaller variant, such as
+ * lutzCompactObject16 (12 bytes per pixel) or 16 bit positions with
+ * the sample type of the image (8 bytes for float samples).
+ ****************************************************************/
+inline void lutzOnePass::SetCompactObjects(bool compact)
+{
+    m_config.m_compact = compact;
+}
+
+
+/************************************************************//**
+ * @brief Return the objects found in compact mode
+ *
+ * @return List of compact objects
+ ****************************************************************/
+inline const std::vector<lutzCompactObject32>& lutzOnePass::GetCompactObjects(void)
+{
+    return m_Compact;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of objects found in compact mode
+ *
+ * @return Number of objects found in the image
+ ****************************************************************/
+inline int lutzOnePass::NumCompactObjects()
+{
+    return m_Compact.size();
+}
+
+
+/************************************************************//**
+ * @brief Limit the number of pixels kept for a single object
+ *
+ * @param[in] npix          Maximum number of pixels (0 = no limit)
+ *
+ * An object that grows beyond this many pixels drops its pixel list and
+ * is tracked through the rest of the scan by its statistics alone (pixel
+ * count, bounding box, peak, minimum and sum). It is written as a
+ * lutzObject with no pixels, the lutzObject::FLAG_TRUNCATED flag set and
+ * its pixel count in lutzObject::NumPixels(). A truncated object is not
+ * painted into a label image, but keeps its label number.
+ ****************************************************************/
+inline void lutzOnePass::SetMaxObjectPixels(int npix)
+{
+    m_config.m_max_object_pixels = npix;
+}
+
+
+/************************************************************//**
+ * @brief Limit the total number of pixels kept during a run
+ *
+ * @param[in] npix          Maximum number of pixels (0 = no limit)
+ *
+ * This counts the pixels held by open objects and by the completed
+ * objects kept in the results. When a pixel would take the total over
+ * the limit, the object it belongs to is truncated as described for
+ * SetMaxObjectPixels(). Objects handed to a queue no longer count.
+ ****************************************************************/
+inline void lutzOnePass::SetMaxRetainedPixels(size_t npix)
+{
+    m_config.m_max_retained = npix;
+}
+
+
+/************************************************************//**
+ * @brief Limit the number of open objects that keep their pixels
+ *
+ * @param[in] nobjects      Maximum number of objects (0 = no limit)
+ *
+ * A new object that starts while this many objects are open and keeping
+ * pixels is tracked by its statistics alone from the start, as described
+ * for SetMaxObjectPixels().
+ ****************************************************************/
+inline void lutzOnePass::SetMaxOpenObjects(int nobjects)
+{
+    m_config.m_max_open = nobjects;
+}
+
+
+/************************************************************//**
+ * @brief Limit the storage an emptied pixel list keeps for reuse
+ *
+ * @param[in] npix          Largest capacity kept, in pixels (0 = no limit)
+ *
+ * The storage of a written object's pixel list is kept, and handed to
+ * the next object that outgrows its own, so that frame after frame of
+ * the same kind are scanned without allocating. The detector then holds
+ * on to room for the largest objects it has seen. Storage for more than
+ * npix pixels is freed instead, trading allocations for memory. With
+ * any of the memory limits above set, it is always freed.
+ ****************************************************************/
+inline void lutzOnePass::SetMaxSparePixels(size_t npix)
+{
+    m_config.m_max_spare = npix;
+}
+
+
+/************************************************************//**
+ * @brief Set a mask of bad pixels with one byte per pixel
+ *
+ * @param[in] mask          m_xpix x m_ypix flags, non-zero for a bad pixel
+ *                          (nullptr to disable)
+ *
+ * The mask is read during the scan alongside the image, so known hot
+ * pixels and bad columns need not be cleaned out of a copy of the frame
+ * beforehand. What happens to bad pixels is set by SetBadPixelAction().
+ * Pixels whose value is NaN are treated as bad whether or not there is
+ * a mask. lutzSparsePass and lutzPyramid do not read the mask.
+ ****************************************************************/
+inline void lutzOnePass::SetBadPixelMask(const uint8_t* mask)
+{
+    m_bad_mask = mask;
+    m_bad_bits = nullptr;
+}
+
+
+/************************************************************//**
+ * @brief Set a bit-packed mask of bad pixels
+ *
+ * @param[in] bits          Rows of bits, bit x % 64 of word x / 64 set for
+ *                          a bad pixel (nullptr to disable)
+ * @param[in] words_per_row Number of words between the starts of two rows
+ *                          (0 means rows are packed tightly)
+ *
+ * Same as SetBadPixelMask(), with the layout used by lutzMaskPass.
+ ****************************************************************/
+inline void lutzOnePass::SetBadPixelBits(const uint64_t* bits, int words_per_row)
+{
+    m_bad_bits   = bits;
+    m_bad_stride = words_per_row;
+    m_bad_mask   = nullptr;
+}
+
+
+/************************************************************//**
+ * @brief Choose how bad pixels are treated
+ *
+ * @param[in] action        One of
+ *   - BAD_EXCLUDE (default): bad pixels are never image pixels, so they
+ *     split objects
+ *   - BAD_BRIDGE: bad pixels join the objects around them without
+ *     adding a value, so objects are not split by a bad column
+ *   - BAD_FLAG: masked pixels are thresholded as usual, and NaN pixels
+ *     are bridged
+ *
+ * With BAD_BRIDGE and BAD_FLAG, objects containing a bad pixel get the
+ * lutzObject::FLAG_BAD_PIXEL flag (also set on lutzBox records, but not
+ * carried by compact objects). Bridged pixels are not counted in the
+ * number of pixels of an object. With BAD_EXCLUDE the flag goes to the
+ * objects next to (8-connected with) an excluded pixel instead, as such
+ * an object may have been cut short by it.
+ ****************************************************************/
+inline void lutzOnePass::SetBadPixelAction(LUTZ_BAD_ACTION action)
+{
+    m_config.m_bad_action = action;
+}
+
+
+/************************************************************//**
+ * @brief Return whether the mask marks a pixel as bad
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Whether the pixel is masked
+ ****************************************************************/
+inline bool lutzOnePass::IsMaskedPixel(int xbin, int ybin) const
+{
+    if (m_bad_mask) return (m_bad_mask[size_t(ybin) * m_xpix + xbin] != 0);
+    if (m_bad_bits) {
+        int stride = (m_bad_stride > 0) ? m_bad_stride : (m_xpix + 63) / 64;
+        return (m_bad_bits[size_t(ybin) * stride + xbin / 64] >> (xbin % 64)) & 1;
+    }
+    return false;
+}
+
+
+/************************************************************//**
+ * @brief Return whether a row holds an excluded pixel
+ *
+ * @param[in] yindx         Row of the image
+ * @return Whether any pixel of the row is masked or NaN
+ *
+ * Each row is looked at in full once per run, the first time it is
+ * asked about, so the spans of clean rows need no checking.
+ ****************************************************************/
+inline bool lutzOnePass::RowHasExcluded(int yindx)
+{
+    if (m_EXROWS[yindx] == 0) {
+        m_EXROWS[yindx] = HasExcludedPixel(0, m_xpix - 1, yindx) ? 2 : 1;
+    }
+    return (m_EXROWS[yindx] == 2);
 }
 
+
+/************************************************************//**
+ * @brief Return whether the rows a segment is checked against may hold
+ *        an excluded pixel
+ *
+ * @param[in] yindx         Current row
+ * @return Whether the current row or the one above holds one
+ *
+ * If neither does, the checks are switched off for the rest of the row.
+ ****************************************************************/
+inline bool lutzOnePass::NearExcluded(int yindx)
+{
+    m_flag_row = RowHasExcluded(yindx) || ((yindx > 0) && RowHasExcluded(yindx - 1));
+    return m_flag_row;
+}
+
+
+/************************************************************//**
+ * @brief Flag an object if an excluded pixel touches one of its segments
+ *
+ * @param[in,out] info      Object the segment belongs to
+ * @param[in] xstart        First pixel of the segment
+ * @param[in] xend          Last pixel of the segment
+ * @param[in] ylo           First row to check
+ * @param[in] yhi           Last row to check
+ *
+ * With BAD_EXCLUDE a bad pixel is background, so without this an object
+ * it cut short would carry no sign of it. The segment is checked against
+ * its own row and the row above when it ends, and against the row below
+ * when the scan of that row reaches its end marker. That way only rows
+ * the scan has just read are looked at.
+ ****************************************************************/
+inline void lutzOnePass::FlagExcluded(ObjectInfo& info, int xstart, int xend,
+                                      int ylo, int yhi)
+{
+    if (info.m_flags & lutzObject::FLAG_BAD_PIXEL) return;
+    
+    int xlo = std::max(xstart - 1, 0);
+    int xhi = std::min(xend + 1, m_xpix - 1);
+    for (int y=std::max(ylo, 0); y <= yhi; y++) {
+        if (RowHasExcluded(y) && HasExcludedPixel(xlo, xhi, y)) {
+            info.m_flags |= lutzObject::FLAG_BAD_PIXEL;
+            return;
+        }
+    }
+}
+
+
+
+/************************************************************//**
+ * @brief Set all of the detection parameters at once
+ *
+ * @param[in] config        Detection parameters
+ *
+ * A lutzOnePass holds the scratch state of a detection, which keeps its
+ * memory from one run() to the next, so after the first frame of a
+ * given size no further allocations are needed for it. A Config is
+ * never modified by a run, so several threads can each copy the same
+ * Config into their own detector.
+ ****************************************************************/
+inline void lutzOnePass::SetConfig(const Config& config)
+{
+    m_config = config;
+}
+
+
+/************************************************************//**
+ * @brief Return the detection parameters
+ *
+ * @return Detection parameters
+ ****************************************************************/
+inline const lutzOnePass::Config& lutzOnePass::GetConfig() const
+{
+    return m_config;
+}
+
+
+/************************************************************//**
+ * @brief Drop objects that fail a filter before they are built
+ *
+ * @param[in] filter        Filter objects must pass (nullptr to disable)
+ *
+ * The filter is applied to the running statistics of each object when
+ * it is complete (see lutzObjectFilter::Accept()), after the minimum
+ * number of pixels, so rejected objects never become a lutzObject,
+ * lutzBox or compact object and are never labelled or queued. Whenever
+ * the bounding box of an open object grows, the filter may also give up
+ * on it straight away (see lutzObjectFilter::Abort()), after which its
+ * pixels are no longer kept. The filter is not copied, and must outlive
+ * the runs that use it.
+ ****************************************************************/
+inline void lutzOnePass::SetObjectFilter(const lutzObjectFilter* filter)
+{
+    m_config.m_filter = filter;
+}
+
+
+/************************************************************//**
+ * @brief Derive the threshold from the background of earlier frames
+ *
+ * @param[in] nsigma        Threshold in units of the background noise above
+ *                          the background level (0 switches this off)
+ * @param[in] damping       Weight given to the previous estimate each frame
+ *
+ * For continuous acquisition. While each frame is scanned, a sample of
+ * its pixels is added to a streaming histogram (see lutzBackground), so
+ * no extra pass over the image is needed. Each run() then thresholds at
+ * the background level plus nsigma times the noise estimated from the
+ * earlier frames, in place of the configured threshold, which is left as
+ * it was. The first frame, and any frame after GetBackground().Reset(),
+ * uses the configured threshold.
+ *
+ * Every scan that thresholds the whole image takes part. lutzMaskPass has
+ * no threshold, and lutzSparsePass only sees its hits, so neither does.
+ ****************************************************************/
+inline void lutzOnePass::SetAdaptiveThreshold(double nsigma, double damping)
+{
+    m_config.m_adaptive_nsigma = nsigma;
+    m_background.SetDamping(damping);
+}
+
+
+/************************************************************//**
+ * @brief Return the threshold the last run used
+ *
+ * @return The configured threshold, or the one derived from the
+ *         background if the threshold is adaptive (see
+ *         SetAdaptiveThreshold())
+ ****************************************************************/
+inline double lutzOnePass::GetRunThreshold() const
+{
+    return m_threshold;
+}
+
+
+/************************************************************//**
+ * @brief Return the background estimate used by the adaptive threshold
+ *
+ * @return Background estimate, which can be tuned or reset
+ ****************************************************************/
+inline lutzBackground& lutzOnePass::GetBackground()
+{
+    return m_background;
+}
+
+
+/************************************************************//**
+ * @brief Return whether the scan may read the rows of m_image directly
+ *
+ * @return Whether the pixel values are those of m_image and an image
+ *         pixel is one above the threshold
+ *
+ * When this is true the scan thresholds whole rows of m_image at once
+ * and never calls GetPixValue() or AssessPixel() for them. It is only
+ * true for a lutzOnePass itself, so a subclass that overrides either of
+ * those is always scanned through them. A subclass whose pixel tests
+ * are those of m_image may override this to take the faster scan.
+ ****************************************************************/
+inline bool lutzOnePass::HasDirectRows() const
+{
+    return (m_image != nullptr) && (typeid(*this) == typeid(lutzOnePass));
+}
+
+
+/************************************************************//**
+ * @brief Return the number of objects truncated by the last run
+ *
+ * @return Number of objects written without their pixels
+ ****************************************************************/
+inline int lutzOnePass::NumTruncated()
+{
+    return m_ntruncated;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of labels written by the last run
+ *
+ * @return Number of labelled objects
+ ****************************************************************/
+inline int lutzOnePass::NumLabels()
+{
+    return m_nlabels;
+}
+
+
 /************************************************************//**
  * @brief Return the pixel data associated with a given object
  *
@@ -206,4 +911,55 @@ inline int lutzOnePass::NumObjects()
     return m_Objects.size();
 }
 
+
+/*==========================================================================
+ =                                                                         =
+ =                    lutzOnePass::ObjectInfo methods                      =
+ =                                                                         =
+ ==========================================================================*/
+
+/***************************************************************//**
+ * @brief Add a pixel to the object
+ *
+ * @param[in] pixel         Pixel to be added
+ * @param[in] keep_pixel    Whether to store the pixel in m_pixels
+ *******************************************************************/
+inline
+void lutzOnePass::ObjectInfo::add(const lutzObject::pixData& pixel,
+                                  bool keep_pixel)
+{
+    if (pixel.m_xbin < m_xmin) m_xmin = pixel.m_xbin;
+    if (pixel.m_xbin > m_xmax) m_xmax = pixel.m_xbin;
+    if (pixel.m_ybin < m_ymin) m_ymin = pixel.m_ybin;
+    if (pixel.m_ybin > m_ymax) m_ymax = pixel.m_ybin;
+    if (pixel.m_value > m_peak) {
+        m_peak  = pixel.m_value;
+        m_xpeak = pixel.m_xbin;
+        m_ypeak = pixel.m_ybin;
+    }
+    if (pixel.m_value < m_min) m_min = pixel.m_value;
+    m_sum += pixel.m_value;
+    m_npix++;
+    double x = pixel.m_xbin;
+    double y = pixel.m_ybin;
+    m_sx  += x;
+    m_sy  += y;
+    m_sxx += x * x;
+    m_syy += y * y;
+    m_sxy += x * y;
+    if (keep_pixel) m_pixels.push_back(pixel);
+}
+
+
+/***************************************************************//**
+ * @brief Return whether the object has no pixels
+ *
+ * @return Whether the object is empty
+ *******************************************************************/
+inline
+bool lutzOnePass::ObjectInfo::empty() const
+{
+    return (m_npix == 0) && (m_nbad == 0);
+}
+
 #endif /* LUTZONEPASS_HPP */
@@ -0,0 +1,185 @@
+/***************************************************************************
+ *  lutzPyramid.hpp - Coarse-to-fine detection for large sparse images     *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzPyramid.hpp
+ * @brief Coarse-to-fine detection for large sparse images
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZPYRAMID_HPP
+#define LUTZPYRAMID_HPP
+
+#include <vector>
+
+#include "lutzOnePass.hpp"
+
+/***************************************************************//**
+ * @brief Two level coarse-to-fine version of the Lutz one pass algorithm
+ *
+ * The image is first reduced into cells of binning x binning pixels and
+ * the one pass algorithm is run on the reduced image. Each object found
+ * there is a candidate region, and the full resolution algorithm is then
+ * run only inside the bounding box of each candidate.
+ *
+ * With the default REDUCE_MAX reduction a cell is a candidate whenever
+ * any of its pixels is above threshold, and two 8-connected pixels always
+ * fall in the same or in 8-connected cells. Every full resolution object
+ * therefore lies inside exactly one candidate and the objects found are
+ * identical to those of lutzOnePass::run() (their order may differ).
+ * This relies on AssessPixel() being the default comparison of
+ * GetPixValue() against the threshold.
+ *
+ * Building the reduced image still reads every pixel once, whole rows
+ * at a time (see BuildCoarseImage()). What the pyramid saves is the Lutz
+ * scan itself, which only visits the pixels of the candidates. Since
+ * lutzOnePass thresholds whole rows too, that only pays off on nearly
+ * empty frames, of about one object per 100 000 pixels or fewer.
+ *
+ * With REDUCE_MEAN cells are averaged and compared to a separate coarse
+ * threshold, which suppresses isolated noise pixels but can miss or clip
+ * faint objects. SetPadding() grows each candidate by a number of cells
+ * to reduce the clipping.
+ *******************************************************************/
+class lutzPyramid : public lutzOnePass {
+public:
+    // Constructors
+    lutzPyramid();
+    lutzPyramid(double* image,
+                int xpixels, int ypixels);
+    // Destructor
+    virtual ~lutzPyramid();
+
+    // enums
+    enum LUTZ_REDUCTION {REDUCE_MAX, REDUCE_MEAN};
+
+    /******  Methods  ******/
+
+    // Set the reduction parameters
+    virtual void SetBinning(int binning);
+    virtual void SetReduction(LUTZ_REDUCTION reduction);
+    virtual void SetCoarseThreshold(double threshold);
+    virtual void SetPadding(int ncells);
+
+    // Return the candidate regions found on the reduced image
+    std::vector<lutzObject> GetCandidates(void);
+    int NumCandidates(void);
+
+    virtual bool HasDirectRows(void) const;
+
+protected:
+
+    /******  Methods  ******/
+    virtual void ScanImage(void);
+    void BuildCoarseImage(void);
+    void ReduceRow(const double* row, double* cells) const;
+    void FindCandidates(void);
+
+    /****** Variables ******/
+    int    m_binning;                     //!< Pixels per cell along each axis
+    int    m_padding;                     //!< Cells added around each candidate
+    LUTZ_REDUCTION m_reduction;           //!< How pixels are combined into a cell
+    double m_coarse_threshold;            //!< Threshold applied to cells for REDUCE_MEAN
+    bool   m_coarse_threshold_set;        //!< Whether m_coarse_threshold was supplied
+
+    int    m_xcells;                      //!< Number of cells in x
+    int    m_ycells;                      //!< Number of cells in y
+    std::vector<double>     m_coarse;     //!< Reduced image
+    std::vector<double>     m_rowvalues;  //!< Row gathered through GetPixValue()
+    std::vector<int>        m_cell_label; //!< Candidate number (+1) of each cell
+    std::vector<lutzObject> m_candidates; //!< Candidates found on the reduced image
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Set the number of pixels along each axis of a cell
+ *
+ * @param[in] binning       Reduction factor (values below 2 are raised to 2)
+ ****************************************************************/
+inline void lutzPyramid::SetBinning(int binning)
+{
+    m_binning = (binning < 2) ? 2 : binning;
+}
+
+
+/************************************************************//**
+ * @brief Set how pixels are combined into a cell
+ *
+ * @param[in] reduction     REDUCE_MAX (exact) or REDUCE_MEAN
+ ****************************************************************/
+inline void lutzPyramid::SetReduction(LUTZ_REDUCTION reduction)
+{
+    m_reduction = reduction;
+}
+
+
+/************************************************************//**
+ * @brief Set the threshold applied to averaged cells
+ *
+ * @param[in] threshold     Threshold for REDUCE_MEAN cells
+ *
+ * If this is never called the full resolution threshold is used.
+ * The value is ignored for REDUCE_MAX, which must use the full
+ * resolution threshold to stay exact.
+ ****************************************************************/
+inline void lutzPyramid::SetCoarseThreshold(double threshold)
+{
+    m_coarse_threshold     = threshold;
+    m_coarse_threshold_set = true;
+}
+
+
+/************************************************************//**
+ * @brief Set the number of cells to grow each candidate by
+ *
+ * @param[in] ncells        Number of cells of padding
+ ****************************************************************/
+inline void lutzPyramid::SetPadding(int ncells)
+{
+    m_padding = (ncells < 0) ? 0 : ncells;
+}
+
+
+/************************************************************//**
+ * @brief Return the candidate regions from the last run
+ *
+ * @return Candidates, with positions given in cells. Each cell has a
+ *         value of 1.
+ ****************************************************************/
+inline std::vector<lutzObject> lutzPyramid::GetCandidates(void)
+{
+    return m_candidates;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of candidate regions from the last run
+ *
+ * @return Number of candidates
+ ****************************************************************/
+inline int lutzPyramid::NumCandidates(void)
+{
+    return m_candidates.size();
+}
+
+#endif /* LUTZPYRAMID_HPP */
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *  lutzRiceSource.hpp - Rows of a Rice coded frame                        *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzRiceSource.hpp
+ * @brief Rows of a Rice coded frame
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZRICESOURCE_HPP
+#define LUTZRICESOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "lutzRowSource.hpp"
+
+/***************************************************************//**
+ * @brief Row source for Rice coded frames
+ *
+ * The coding follows the Rice scheme used for 16 bit FITS tiles. Bits
+ * are written most significant first, and each row starts on a new byte:
+ *   - the first pixel of the row, in 16 bits
+ *   - the rest of the row in blocks of m_block pixels, each block being
+ *     a 4 bit parameter k followed by one code per pixel
+ *
+ * Each pixel is coded as its difference from the pixel to its left,
+ * mapped to an unsigned value z by zigzag coding. A code is z >> k
+ * written in unary (that many 0 bits and then a 1), followed by the low
+ * k bits of z. When z >> k would be 32 or more, 32 zeros and a 1 are
+ * written instead, followed by all 17 bits of z. A block with k = 15
+ * holds the pixel values themselves, 16 bits each. Encode() chooses k
+ * for each block from the mean of its z values, or 15 when that is no
+ * larger.
+ *
+ * A block must hold at least one pixel. A source given a smaller block
+ * holds no data, so ReadRow() fails, and Encode() refuses to code one.
+ *******************************************************************/
+class lutzRiceSource : public lutzRowSource {
+public:
+    // Constructors
+    lutzRiceSource();
+    lutzRiceSource(const uint8_t* data, size_t nbytes,
+                   int xpixels, int ypixels, int block=32);
+    // Destructor
+    virtual ~lutzRiceSource();
+
+    /******  Methods  ******/
+
+    // Set the coded frame
+    virtual void SetData(const uint8_t* data, size_t nbytes,
+                         int xpixels, int ypixels, int block=32);
+
+    // Go back to the first row of the frame
+    virtual void Rewind(void);
+
+    // Decode the next row
+    virtual bool ReadRow(uint16_t* row);
+
+    // Code a frame
+    static bool Encode(const uint16_t* image, int xpixels, int ypixels,
+                       std::vector<uint8_t>& data, int block=32);
+
+protected:
+
+    /****** Variables ******/
+    const uint8_t* m_data;          //!< Coded frame
+    size_t         m_nbytes;        //!< Number of bytes in m_data
+    size_t         m_pos;           //!< Position of the next row in m_data
+    int            m_block;         //!< Pixels per block
+
+private:
+
+};
+
+#endif /* LUTZRICESOURCE_HPP */
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *  lutzRingFormat.hpp - Layout of a catalog ring in shared memory         *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzRingFormat.hpp
+ * @brief Layout of a catalog ring in shared memory
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZRINGFORMAT_HPP
+#define LUTZRINGFORMAT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/***************************************************************//**
+ * @brief Summary of one object as published in a catalog ring
+ *
+ * A plain record, so that readers in other processes can use it in
+ * place. Fields that are not known for an object are NaN (for example
+ * the centroid and sum of a lutzBox).
+ *******************************************************************/
+struct lutzRingRecord {
+    int32_t  m_npix;                //!< Number of pixels in the object
+    int32_t  m_xmin;                //!< minimum pixel position in x
+    int32_t  m_xmax;                //!< maximum pixel position in x
+    int32_t  m_ymin;                //!< minimum pixel position in y
+    int32_t  m_ymax;                //!< maximum pixel position in y
+    uint32_t m_flags;               //!< Combination of lutzObject::LUTZ_FLAG values
+    double   m_x;                   //!< Centroid in x
+    double   m_y;                   //!< Centroid in y
+    double   m_sum;                 //!< Sum of all pixel values
+    double   m_peak;                //!< Value of the brightest pixel
+    double   m_min;                 //!< Value of the faintest pixel
+};
+
+
+/***************************************************************//**
+ * @brief Start of a catalog ring, followed by its slots
+ *
+ * The format is versioned so that a reader built against a different
+ * layout refuses the ring instead of misreading it.
+ *
+ * A ring that is closed or replaced by its writer is marked as retired
+ * before it is unlinked, and the ring that replaces it has the next
+ * generation. Readers still attached to the old ring can then tell that
+ * its frames have come to an end and move on to the new one.
+ *******************************************************************/
+struct lutzRingHeader {
+    uint32_t m_magic;               //!< LUTZ_RING_MAGIC
+    uint32_t m_version;             //!< LUTZ_RING_VERSION
+    uint32_t m_record_size;         //!< sizeof(lutzRingRecord) of the writer
+    uint32_t m_nslots;              //!< Number of frames held in the ring
+    uint32_t m_max_records;         //!< Records a slot has room for
+    std::atomic<uint32_t> m_retired;   //!< Set once no more frames will be published
+    uint64_t m_slot_bytes;          //!< Distance between two slots
+    std::atomic<uint64_t> m_published; //!< Number of frames published so far
+    uint64_t m_generation;          //!< Rings made under this name before this one
+};
+
+
+/***************************************************************//**
+ * @brief Start of one slot, followed by its records
+ *
+ * Frame n goes to slot n % m_nslots. While it is being written m_lock
+ * is 2n+1, and once it is complete m_lock is 2n+2, so a reader can tell
+ * both a slot in the middle of an update and a slot that has moved on
+ * to a later frame.
+ *******************************************************************/
+struct lutzRingSlot {
+    std::atomic<uint64_t> m_lock;   //!< Sequence lock (see above)
+    int64_t  m_frame;               //!< Frame number given by the writer
+    uint32_t m_nrecords;            //!< Number of records in the slot
+    uint32_t m_ndropped;            //!< Objects that did not fit in the slot
+    uint64_t m_reserved;
+};
+
+
+// Identification of the format
+const uint32_t LUTZ_RING_MAGIC   = 0x5a54554c;      // "LUTZ"
+const uint32_t LUTZ_RING_VERSION = 2;
+
+// Alignment of the header and of every slot
+const size_t   LUTZ_RING_ALIGN   = 64;
+
+
+/************************************************************//**
+ * @brief Return the offset of the first slot from the start of the ring
+ *
+ * @return Size of the header, rounded up to LUTZ_RING_ALIGN
+ ****************************************************************/
+inline size_t lutzRingSlotOffset()
+{
+    return (sizeof(lutzRingHeader) + LUTZ_RING_ALIGN - 1) / LUTZ_RING_ALIGN * LUTZ_RING_ALIGN;
+}
+
+
+/************************************************************//**
+ * @brief Return the size of one slot
+ *
+ * @param[in] max_records   Records a slot has room for
+ * @return Size of a slot, rounded up to LUTZ_RING_ALIGN
+ ****************************************************************/
+inline size_t lutzRingSlotBytes(size_t max_records)
+{
+    size_t bytes = sizeof(lutzRingSlot) + max_records * sizeof(lutzRingRecord);
+    return (bytes + LUTZ_RING_ALIGN - 1) / LUTZ_RING_ALIGN * LUTZ_RING_ALIGN;
+}
+
+#endif /* LUTZRINGFORMAT_HPP */
@@ -0,0 +1,93 @@
+/***************************************************************************
+ *  lutzRowSource.hpp - Source of image rows decoded on demand             *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzRowSource.hpp
+ * @brief Source of image rows decoded on demand
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZROWSOURCE_HPP
+#define LUTZROWSOURCE_HPP
+
+#include <cstdint>
+
+/***************************************************************//**
+ * @brief Source of the 16 bit rows of a frame, one row at a time
+ *
+ * Implementations decode a compressed frame row by row into a buffer
+ * supplied by the caller, so the whole decompressed frame never needs
+ * to exist (see lutzStreamPass). Rows are read in order from the top of
+ * the frame. Rewind() goes back to the first row.
+ *******************************************************************/
+class lutzRowSource {
+public:
+    // Constructors
+    lutzRowSource(int xpixels=0, int ypixels=0) :
+        m_xpix(xpixels), m_ypix(ypixels)
+    {}
+    // Destructor
+    virtual ~lutzRowSource() {}
+
+    /******  Methods  ******/
+
+    // Go back to the first row of the frame
+    virtual void Rewind(void) = 0;
+
+    // Decode the next row into m_xpix values
+    virtual bool ReadRow(uint16_t* row) = 0;
+
+    // Get the frame size
+    int GetXpixels(void) const;
+    int GetYpixels(void) const;
+
+protected:
+
+    /****** Variables ******/
+    int m_xpix;                     //!< Number of pixels in x
+    int m_ypix;                     //!< Number of pixels in y
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Return the number of pixels in x
+ *
+ * @return Number of pixels in a row
+ ****************************************************************/
+inline int lutzRowSource::GetXpixels() const
+{
+    return m_xpix;
+}
+
+
+/************************************************************//**
+ * @brief Return the number of pixels in y
+ *
+ * @return Number of rows in the frame
+ ****************************************************************/
+inline int lutzRowSource::GetYpixels() const
+{
+    return m_ypix;
+}
+
+#endif /* LUTZROWSOURCE_HPP */
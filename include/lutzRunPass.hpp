@@ -0,0 +1,183 @@
+/***************************************************************************
+ *  lutzRunPass.hpp - Run based labelling with a choice of engine          *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzRunPass.hpp
+ * @brief Run based labelling with a choice of engine
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZRUNPASS_HPP
+#define LUTZRUNPASS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "lutzOnePass.hpp"
+
+/***************************************************************//**
+ * @brief Finds objects by joining runs of image pixels with union-find
+ *
+ * The Lutz scan of lutzOnePass does little work per background pixel,
+ * which suits sparse fields, but it branches on every image pixel. In
+ * crowded frames it is faster to first cut each thresholded row into
+ * runs of image pixels, join each run with the runs it touches on the
+ * row above (union-find over runs), and then gather the pixels of each
+ * object in one sweep over the runs. This is ENGINE_RUNS.
+ *
+ * Both engines feed the same object output as lutzOnePass, so every
+ * setting (output modes, label image, brightest objects, queue, bad
+ * pixels, memory limits, filters, adaptive threshold) applies. They also
+ * write the same objects in the same order: ENGINE_RUNS writes them in
+ * the order the Lutz scan completes them, and with either engine the
+ * pixels of an object are in raster order (which costs the Lutz engine
+ * a sort of the objects that were joined from several pieces), so all
+ * that is measured from the pixels agrees exactly. The sums kept for
+ * truncated objects are added in another order and may differ by
+ * rounding, and the brightest pixel of a lutzBox may differ between
+ * pixels of the same value. ENGINE_RUNS holds all objects until the end
+ * of the frame, so whenever memory limits or an object filter are set
+ * the Lutz engine is used instead, even if ENGINE_RUNS was asked for
+ * (GetLastEngine() tells which engine ran).
+ *
+ * ENGINE_AUTO samples the fraction of the frame above threshold before
+ * each run and takes ENGINE_RUNS from SetEngine()'s density, and the
+ * Lutz scan otherwise. On 2048 x 2048 frames of random pixels or of
+ * discs, the Lutz scan is up to 1.5 times faster below a density of
+ * 0.01, the two are within about 10% of each other up to 0.3, and
+ * ENGINE_RUNS takes half the time from 0.45 on random pixels. The default of 0.3 keeps the Lutz scan, which hands out
+ * objects as they complete, wherever the two are close.
+ *
+ * Like the direct scan of lutzOnePass, both engines read the image
+ * directly rather than through GetPixValue(). Without an image, or in a
+ * subclass that has its own pixel tests (see HasDirectRows()), the scan
+ * is that of lutzOnePass.
+ *******************************************************************/
+class lutzRunPass : public lutzOnePass {
+public:
+    // Labelling engines
+    enum LUTZ_ENGINE {ENGINE_LUTZ, ENGINE_RUNS, ENGINE_AUTO};
+
+    // Constructors
+    lutzRunPass();
+    lutzRunPass(double* image, int xpixels, int ypixels);
+    // Destructor
+    virtual ~lutzRunPass();
+
+    /******  Methods  ******/
+
+    // Choose the engine, and the density above which AUTO takes runs
+    void SetEngine(LUTZ_ENGINE engine, double density=0.3);
+    LUTZ_ENGINE GetEngine(void) const;
+
+    // Engine used by the last run and the density it sampled
+    LUTZ_ENGINE GetLastEngine(void) const;
+    double      GetLastDensity(void) const;
+
+    // Give back the memory kept from one run to the next
+    virtual void ReleaseMemory(void);
+
+    virtual bool HasDirectRows(void) const;
+
+protected:
+
+    // A run of image pixels on one row
+    struct Run {
+        int m_y;                    //!< Row of the run
+        int m_xstart;               //!< First pixel of the run
+        int m_xend;                 //!< Last pixel of the run
+    };
+
+    /******  Methods  ******/
+    virtual void ScanImage(void);
+    double SampleDensity(void);
+    void   ScanRuns(void);
+    void   FindRuns(const uint64_t* bits, int yindx);
+    void   JoinRows(int prev_start, int cur_start, int cur_end);
+    int    FindRoot(int run);
+    void   GatherObjects(void);
+    virtual void WriteObject(ObjectInfo& obj);
+    void   SortPixels(ObjectInfo& obj);
+
+    /****** Variables ******/
+    LUTZ_ENGINE m_engine;               //!< Engine asked for
+    double      m_density;              //!< Density above which AUTO takes runs
+    LUTZ_ENGINE m_last_engine;          //!< Engine used by the last run
+    double      m_last_density;         //!< Density sampled by the last run (-1 = none)
+    std::vector<Run> m_runs;            //!< Runs of the frame, row by row
+    std::vector<int> m_root;            //!< Union-find parent of each run
+    std::vector<uint64_t>   m_bits;     //!< Thresholded bits of the current row
+    std::vector<ObjectInfo> m_objects;  //!< Objects being gathered
+    std::vector<int>        m_finish;   //!< Run after which each object is written
+    Object                  m_sorted;   //!< Pixels of an object ordered by x
+    std::vector<int>        m_count;    //!< Pixels per column or row of an object
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Choose the labelling engine
+ *
+ * @param[in] engine        ENGINE_LUTZ, ENGINE_RUNS or ENGINE_AUTO
+ * @param[in] density       Fraction of pixels above threshold from which
+ *                          ENGINE_AUTO uses ENGINE_RUNS
+ ****************************************************************/
+inline void lutzRunPass::SetEngine(LUTZ_ENGINE engine, double density)
+{
+    m_engine  = engine;
+    m_density = density;
+}
+
+
+/************************************************************//**
+ * @brief Return the engine asked for
+ *
+ * @return Engine set with SetEngine()
+ ****************************************************************/
+inline lutzRunPass::LUTZ_ENGINE lutzRunPass::GetEngine() const
+{
+    return m_engine;
+}
+
+
+/************************************************************//**
+ * @brief Return the engine used by the last run
+ *
+ * @return ENGINE_LUTZ or ENGINE_RUNS
+ ****************************************************************/
+inline lutzRunPass::LUTZ_ENGINE lutzRunPass::GetLastEngine() const
+{
+    return m_last_engine;
+}
+
+
+/************************************************************//**
+ * @brief Return the fraction of pixels above threshold in the last run
+ *
+ * @return Sampled density (-1 unless ENGINE_AUTO took a sample)
+ ****************************************************************/
+inline double lutzRunPass::GetLastDensity() const
+{
+    return m_last_density;
+}
+
+#endif /* LUTZRUNPASS_HPP */
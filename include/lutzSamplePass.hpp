@@ -0,0 +1,396 @@
+/***************************************************************************
+ *  lutzSamplePass.hpp - Lutz one pass algorithm on typed samples          *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzSamplePass.hpp
+ * @brief Lutz one pass algorithm on typed samples
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZSAMPLEPASS_HPP
+#define LUTZSAMPLEPASS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "lutzOnePass.hpp"
+#include "lutzTrace.hpp"
+
+/***************************************************************//**
+ * @brief Lutz one pass algorithm run on samples of any type
+ *
+ * The image is read directly as PixelT samples (e.g. uint16_t straight
+ * from a camera), so there is no conversion to double beforehand. Rows
+ * are thresholded 64 samples at a time into packed bits, and integer
+ * samples are compared with an integer cut, which gives the same answer
+ * as comparing their values with the threshold. Only floating point
+ * samples are looked at for NaNs.
+ *
+ * The objects, and the values of their pixels, are those of lutzOnePass
+ * run on the same samples converted to double.
+ *
+ * @tparam PixelT   Type of the image samples
+ *******************************************************************/
+template <typename PixelT=double>
+class lutzSamplePass : public lutzOnePass {
+public:
+    // Constructors
+    lutzSamplePass();
+    lutzSamplePass(const PixelT* pixels, int xpixels, int ypixels);
+    // Destructor
+    virtual ~lutzSamplePass() {}
+
+    /******  Methods  ******/
+
+    // Set the image samples
+    virtual void SetPixels(const PixelT* pixels);
+
+    // Get the current value of a given bin
+    virtual double GetPixValue(int xbin, int ybin);
+
+    // Assess whether or not this pixel is an image pixel
+    virtual bool AssessPixel(int xbin, int ybin);
+    virtual bool HasDirectRows(void) const;
+protected:
+
+    /******  Methods  ******/
+    virtual void ScanImage(void);
+    virtual bool HasExcludedPixel(int xlo, int xhi, int yindx);
+    void ThresholdPixels(const PixelT* row, uint64_t* bits, int nwords) const;
+    void FindNaNPixels(const PixelT* row, uint64_t* bits, int nwords) const;
+    void ScanBits(const uint64_t* cur, const uint64_t* prev, int nwords,
+                  int yindx, int& co, int& pstop);
+    template <typename CutT>
+    static uint64_t PackWord(const PixelT* pix, CutT cut);
+    static int LowestBit(uint64_t word);
+
+    /****** Variables ******/
+    const PixelT* m_pixels;                     //!< Image samples (1D)
+
+private:
+
+};
+
+
+/***************************************************************//**
+ * @brief Default constructor
+ *******************************************************************/
+template <typename PixelT>
+lutzSamplePass<PixelT>::lutzSamplePass() :
+    lutzOnePass(),
+    m_pixels(nullptr)
+{}
+
+
+/***************************************************************//**
+ * @brief Primary constructor from the image samples
+ *
+ * @param[in] pixels        Image samples (1D)
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ *******************************************************************/
+template <typename PixelT>
+lutzSamplePass<PixelT>::lutzSamplePass(const PixelT* pixels,
+                                       int xpixels, int ypixels) :
+    lutzOnePass(nullptr, xpixels, ypixels),
+    m_pixels(pixels)
+{}
+
+
+/***************************************************************//**
+ * @brief Set the image samples
+ *
+ * @param[in] pixels        Image samples (1D)
+ *******************************************************************/
+template <typename PixelT>
+void lutzSamplePass<PixelT>::SetPixels(const PixelT* pixels)
+{
+    m_pixels = pixels;
+}
+
+
+/***************************************************************//**
+ * @brief Return value of given pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Value of the pixel
+ *******************************************************************/
+template <typename PixelT>
+double lutzSamplePass<PixelT>::GetPixValue(int xbin, int ybin)
+{
+    return double(m_pixels[size_t(ybin) * m_xpix + xbin]);
+}
+
+
+/***************************************************************//**
+ * @brief Assess whether or not this pixel is an image pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Whether the pixel is above threshold
+ *******************************************************************/
+template <typename PixelT>
+bool lutzSamplePass<PixelT>::AssessPixel(int xbin, int ybin)
+{
+    return (GetPixValue(xbin, ybin) > m_threshold);
+}
+
+
+/***************************************************************//**
+ * @brief Return whether the scan may read the rows of m_image directly
+ *
+ * @return Always false, since the samples are read from m_pixels
+ *******************************************************************/
+template <typename PixelT>
+bool lutzSamplePass<PixelT>::HasDirectRows() const
+{
+    return false;
+}
+
+
+/***************************************************************//**
+ * @brief Scan the image, thresholding each row into packed bits
+ *******************************************************************/
+template <typename PixelT>
+void lutzSamplePass<PixelT>::ScanImage()
+{
+    int co(0), pstop(0);
+    const int nwords = (m_xpix + 63) / 64;
+    m_ROWBITS.assign(2 * nwords, 0);
+    uint64_t* bits = m_ROWBITS.data();
+    LUTZ_TRACE_ROWS();
+    
+    for (int yindx=0; yindx < m_ypix; yindx++) {
+        
+        LUTZ_TRACE_ROW(yindx);
+        uint64_t* cur  = bits + (yindx & 1) * nwords;
+        uint64_t* prev = (yindx > 0) ? bits + ((yindx - 1) & 1) * nwords : nullptr;
+        
+        const PixelT* row = m_pixels + size_t(yindx) * m_xpix;
+        ThresholdPixels(row, cur, nwords);
+        if (m_adaptive) m_background.addRow(row, m_xpix, yindx);
+        if (m_bad_rows) {
+            // Only floating point samples can hold a NaN
+            bool find_nans = m_check_bad &&
+                             std::numeric_limits<PixelT>::has_quiet_NaN;
+            if (find_nans) FindNaNPixels(row, m_NANBITS.data(), nwords);
+            ApplyBadPixels(yindx, find_nans ? m_NANBITS.data() : nullptr, cur);
+        }
+        ScanBits(cur, prev, nwords, yindx, co, pstop);
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Return whether a span of a row holds an excluded pixel
+ *
+ * @param[in] xlo           First pixel of the span
+ * @param[in] xhi           Last pixel of the span
+ * @param[in] yindx         Row of the image
+ * @return Whether any pixel of the span is masked or NaN
+ *
+ * Integer samples are never NaN, so for them only the mask is read.
+ *******************************************************************/
+template <typename PixelT>
+bool lutzSamplePass<PixelT>::HasExcludedPixel(int xlo, int xhi, int yindx)
+{
+    if (m_bad_mask || m_bad_bits) {
+        for (int xindx=xlo; xindx <= xhi; xindx++) {
+            if (IsMaskedPixel(xindx, yindx)) return true;
+        }
+    }
+    if (std::numeric_limits<PixelT>::has_quiet_NaN) {
+        const PixelT* row = m_pixels + size_t(yindx) * m_xpix;
+        for (int xindx=xlo; xindx <= xhi; xindx++) {
+            if (std::isnan(row[xindx])) return true;
+        }
+    }
+    return false;
+}
+
+
+/***************************************************************//**
+ * @brief Threshold a row of samples into packed bits
+ *
+ * @param[in] row           Row of samples
+ * @param[out] bits         nwords words, bit set above threshold
+ * @param[in] nwords        Number of words in the row
+ *
+ * All words but the last are full, and so is the last one when the
+ * width is a multiple of 64.
+ *******************************************************************/
+template <typename PixelT>
+void lutzSamplePass<PixelT>::ThresholdPixels(const PixelT* row,
+                                                  uint64_t* bits,
+                                                  int nwords) const
+{
+    const double threshold = m_threshold;
+    const int    nfull = (m_xpix % 64 == 0) ? nwords : nwords - 1;
+    
+    // Integer samples are compared with an integer cut, which gives the
+    // same answer without converting every sample
+    if (std::numeric_limits<PixelT>::is_integer &&
+        (threshold >= double(std::numeric_limits<PixelT>::lowest())) &&
+        (threshold < double(std::numeric_limits<PixelT>::max()))) {
+        const PixelT cut = PixelT(std::floor(threshold));
+        for (int w=0; w < nfull; w++) bits[w] = PackWord(row + 64 * w, cut);
+    } else {
+        for (int w=0; w < nfull; w++) bits[w] = PackWord(row + 64 * w, threshold);
+    }
+    
+    // Partial last word
+    if (nfull < nwords) {
+        const PixelT* pix  = row + 64 * nfull;
+        uint64_t      word = 0;
+        for (int b=0; b < m_xpix - 64 * nfull; b++) {
+            word |= uint64_t(double(pix[b]) > threshold) << b;
+        }
+        bits[nfull] = word;
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Find the NaN samples of a row
+ *
+ * @param[in] row           Row of samples
+ * @param[out] bits         nwords words, bit set where the sample is NaN
+ * @param[in] nwords        Number of words in the row
+ *******************************************************************/
+template <typename PixelT>
+void lutzSamplePass<PixelT>::FindNaNPixels(const PixelT* row,
+                                                uint64_t* bits,
+                                                int nwords) const
+{
+    for (int w=0; w < nwords; w++) {
+        const PixelT* pix = row + 64 * w;
+        int      npix = std::min(64, m_xpix - 64 * w);
+        uint64_t word = 0;
+        for (int b=0; b < npix; b++) {
+            word |= uint64_t(pix[b] != pix[b]) << b;
+        }
+        bits[w] = word;
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Threshold 64 samples into one word
+ *
+ * @param[in] pix           64 samples
+ * @param[in] cut           Threshold
+ * @return Word with bit b set if pix[b] > cut
+ *
+ * The comparisons are made into an array of bytes, a loop the compiler
+ * can vectorise, and every 8 bytes are then gathered into 8 bits with
+ * one multiplication.
+ *******************************************************************/
+template <typename PixelT>
+template <typename CutT>
+inline uint64_t lutzSamplePass<PixelT>::PackWord(const PixelT* pix,
+                                                      CutT cut)
+{
+    uint8_t above[64];
+    for (int b=0; b < 64; b++) above[b] = (pix[b] > cut);
+    
+    uint64_t word = 0;
+    for (int k=0; k < 8; k++) {
+        const uint8_t* a = above + 8 * k;
+        uint64_t bytes = uint64_t(a[0])       | uint64_t(a[1]) << 8  |
+                         uint64_t(a[2]) << 16 | uint64_t(a[3]) << 24 |
+                         uint64_t(a[4]) << 32 | uint64_t(a[5]) << 40 |
+                         uint64_t(a[6]) << 48 | uint64_t(a[7]) << 56;
+        word |= ((bytes * 0x0102040810204080ULL) >> 56) << (8 * k);
+    }
+    return word;
+}
+
+
+/***************************************************************//**
+ * @brief Run the algorithm over one row given as packed bits
+ *
+ * @param[in] cur           Bits of this row (1 = image pixel)
+ * @param[in] prev          Bits of the previous row (nullptr on the first)
+ * @param[in] nwords        Number of words in the row
+ * @param[in] yindx         Current row
+ * @param[in] co            Current object ID
+ * @param[in] pstop         Current postion in PSSTACK
+ *
+ * The same as lutzOnePass::ScanBitRow(), but the bits beyond the end of
+ * the row are always clear, so no word needs masking.
+ *******************************************************************/
+template <typename PixelT>
+void lutzSamplePass<PixelT>::ScanBits(const uint64_t* cur,
+                                           const uint64_t* prev, int nwords,
+                                           int yindx, int& co, int& pstop)
+{
+    StartRow();
+    
+    // Bits carried over from the top of the previous word
+    uint64_t ccarry = 0;
+    uint64_t pcarry = 0;
+    
+    for (int w=0; w < nwords; w++) {
+        uint64_t c = cur[w];
+        uint64_t p = prev ? prev[w] : 0;
+        
+        // An event at m_xpix is left to the end-of-row call below
+        uint64_t events = c | (c << 1) | ccarry | p | (p << 1) | pcarry;
+        ccarry = c >> 63;
+        pcarry = p >> 63;
+        
+        while (events) {
+            int xindx = 64 * w + LowestBit(events);
+            events &= events - 1;
+            if (xindx >= m_xpix) break;
+            ProcessPixel(xindx, yindx, (c >> (xindx & 63)) & 1, co, pstop);
+        }
+    }
+    
+    // Handle the markers beyond the last pixel of the row
+    ProcessPixel(m_xpix, yindx, false, co, pstop);
+}
+
+
+/***************************************************************//**
+ * @brief Return the position of the lowest set bit of a non-zero word
+ *
+ * @param[in] word          Non-zero word
+ * @return Position of the lowest set bit
+ *******************************************************************/
+template <typename PixelT>
+inline int lutzSamplePass<PixelT>::LowestBit(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int n = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+#endif /* LUTZSAMPLEPASS_HPP */
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *  lutzSparsePass.hpp - Lutz one pass algorithm on a sparse hit list      *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzSparsePass.hpp
+ * @brief Lutz one pass algorithm on a sparse hit list
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZSPARSEPASS_HPP
+#define LUTZSPARSEPASS_HPP
+
+#include <vector>
+
+#include "lutzOnePass.hpp"
+
+/***************************************************************//**
+ * @brief Lutz one pass algorithm run on a list of occupied pixels
+ *
+ * The hits are given in compressed sparse row form: the hits of row y
+ * are entries row_start[y] to row_start[y+1]-1 of the xpos and values
+ * arrays, so row_start holds ypixels+1 entries. Within a row the hits
+ * must be sorted by x with no repeats. Every pixel without a hit has a
+ * value of 0.
+ *
+ * Each row only visits its hits above threshold, the pixel after each
+ * of them, and the same positions on the previous row (where that row's
+ * markers were left), so the cost follows the number of hits rather than
+ * the area of the detector. For a non-negative threshold the objects are
+ * identical, in the same order, to running lutzOnePass on the dense
+ * image.
+ *
+ * This holds for the bad pixel settings and the adaptive threshold too:
+ * the mask and the NaN test are applied to each hit, and the background
+ * is sampled from the hits, 0 where there is none. A bad pixel mask is
+ * read a whole row at a time when the rows near an object are checked
+ * for excluded pixels, and with BAD_BRIDGE on every row, so with a mask
+ * the cost also follows the area of the detector.
+ *******************************************************************/
+class lutzSparsePass : public lutzOnePass {
+public:
+    // Constructors
+    lutzSparsePass();
+    lutzSparsePass(const int* row_start, const int* xpos,
+                   const double* values,
+                   int xpixels, int ypixels);
+    // Destructor
+    virtual ~lutzSparsePass();
+
+    /******  Methods  ******/
+
+    // Set the list of hits
+    virtual void SetHits(const int* row_start, const int* xpos,
+                         const double* values);
+
+    // Get the current value of a given bin
+    virtual double GetPixValue(int xbin, int ybin);
+
+    // Assess whether or not this pixel is an image pixel
+    virtual bool AssessPixel(int xbin, int ybin);
+    virtual bool HasDirectRows(void) const;
+protected:
+
+    /******  Methods  ******/
+    virtual void ScanImage(void);
+    virtual bool HasExcludedPixel(int xlo, int xhi, int yindx);
+    void FindImagePixels(int yindx);
+    void SampleHits(int yindx);
+    void FillRowEvents(void);
+
+    /****** Variables ******/
+    const int*    m_row_start;      //!< First hit of each row (ypixels+1 entries)
+    const int*    m_xpos;           //!< x position of each hit
+    const double* m_values;         //!< Value of each hit
+    int           m_cursor;         //!< Hit currently being processed (-1 = none)
+
+    std::vector<int> m_cur_pix;     //!< Image pixels on the current row
+    std::vector<int> m_cur_hits;    //!< Hit at each of them (-1 = none)
+    std::vector<int> m_prev_pix;    //!< Image pixels on the previous row
+    std::vector<int> m_masked;      //!< Masked pixels of the current row
+    std::vector<int> m_events;      //!< Positions to visit on the current row
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Set the list of hits
+ *
+ * @param[in] row_start     Index of the first hit of each row, followed
+ *                          by the total number of hits
+ * @param[in] xpos          x position of each hit
+ * @param[in] values        Value of each hit
+ ****************************************************************/
+inline void lutzSparsePass::SetHits(const int* row_start, const int* xpos,
+                                    const double* values)
+{
+    m_row_start = row_start;
+    m_xpos      = xpos;
+    m_values    = values;
+}
+
+#endif /* LUTZSPARSEPASS_HPP */
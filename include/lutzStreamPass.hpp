@@ -0,0 +1,108 @@
+/***************************************************************************
+ *  lutzStreamPass.hpp - Lutz one pass algorithm on a stream of rows       *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzStreamPass.hpp
+ * @brief Lutz one pass algorithm on a stream of rows
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZSTREAMPASS_HPP
+#define LUTZSTREAMPASS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "lutzSamplePass.hpp"
+#include "lutzRowSource.hpp"
+
+/***************************************************************//**
+ * @brief Lutz one pass algorithm run on rows decoded as they are needed
+ *
+ * Each row is decoded from a lutzRowSource (e.g. lutzRiceSource or
+ * lutzDeltaSource) into a single row buffer and thresholded straight
+ * away, while it is still in cache. The decompressed frame is never
+ * held in memory. The objects are identical to those of lutzOnePass
+ * run on the decompressed frame.
+ *
+ * Only the row being scanned is available, so GetPixValue() may only be
+ * called for that row, which is all the scan itself needs. If the source
+ * runs out of data, the scan stops there as if the frame ended (see
+ * NumRowsRead()).
+ *******************************************************************/
+class lutzStreamPass : public lutzSamplePass<uint16_t> {
+public:
+    // Constructors
+    lutzStreamPass();
+    lutzStreamPass(lutzRowSource* source);
+    // Destructor
+    virtual ~lutzStreamPass();
+
+    /******  Methods  ******/
+
+    // Set the source of the rows
+    virtual void SetSource(lutzRowSource* source);
+
+    // Get the value of a pixel on the row being scanned
+    virtual double GetPixValue(int xbin, int ybin);
+
+    // Number of rows decoded by the last run
+    int NumRowsRead(void);
+
+protected:
+
+    /******  Methods  ******/
+    virtual void ScanImage(void);
+
+    /****** Variables ******/
+    lutzRowSource*        m_source;     //!< Source of the rows
+    std::vector<uint16_t> m_row;        //!< Row being scanned
+    int                   m_rows_read;  //!< Rows decoded by the last run
+
+private:
+
+};
+
+
+/************************************************************//**
+ * @brief Return the value of a pixel on the row being scanned
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel (must be the current row)
+ * @return Value of the pixel
+ ****************************************************************/
+inline double lutzStreamPass::GetPixValue(int xbin, int /*ybin*/)
+{
+    return m_row[xbin];
+}
+
+
+/************************************************************//**
+ * @brief Return the number of rows decoded by the last run
+ *
+ * @return Number of rows, less than the frame height if the source
+ *         ran out of data
+ ****************************************************************/
+inline int lutzStreamPass::NumRowsRead()
+{
+    return m_rows_read;
+}
+
+#endif /* LUTZSTREAMPASS_HPP */
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *  lutzTrace.hpp - Timeline tracing of detection runs                     *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzTrace.hpp
+ * @brief Timeline tracing of detection runs
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZTRACE_HPP
+#define LUTZTRACE_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/***************************************************************//**
+ * @brief Recorder of timed events, written out as a Chrome trace
+ *
+ * Events are appended to a buffer owned by the calling thread, so
+ * recording never takes a lock. Write() produces the JSON trace event
+ * format read by chrome://tracing and the Perfetto UI.
+ *
+ * The library only records events when it is built with the LUTZ_TRACE
+ * option (which defines the LUTZ_TRACE macro). Otherwise the
+ * LUTZ_TRACE_* macros expand to nothing and Write() produces an empty
+ * trace. The recorded events are:
+ *   - "run", "init", "scan", "store_clearance", "finish_brightest":
+ *     the phases of lutzOnePass::run()
+ *   - "rows": each band of LUTZ_TRACE_ROW_BAND rows (arg = first row).
+ *     Rows skipped by the sparse scan are not counted.
+ *   - "write_object", "build_object", "queue_push": per object, for
+ *     objects of at least GetObjectCutoff() pixels (arg = pixels)
+ *   - "join": joins where both pieces reach the cutoff (arg = pixels in
+ *     the smaller piece)
+ *   - "plane": each plane added to a lutzCube (arg = plane index)
+ *
+ * Event names must be string literals. Write() and clear() must not be
+ * called while a detection is running.
+ *******************************************************************/
+class lutzTrace {
+public:
+
+    /******  Methods  ******/
+
+    // Nanoseconds since the first call in this process
+    static uint64_t Now(void);
+
+    // Record a completed event on the calling thread
+    static void Record(const char* name, uint64_t start, uint64_t end,
+                       int64_t arg=-1);
+
+    // Write all recorded events as Chrome trace JSON
+    static void Write(std::ostream& out);
+    static bool Write(const std::string& filename);
+
+    // Drop all recorded events
+    static void clear(void);
+
+    // Number of recorded events across all threads
+    static size_t size(void);
+
+    // Minimum object size for per-object events
+    static void SetObjectCutoff(int npix);
+    static int  GetObjectCutoff(void);
+
+    /* ============================================================= */
+
+    // Records an event covering the lifetime of the object
+    class Scope {
+    public:
+        Scope(const char* name, int64_t arg=-1, bool enabled=true) :
+            m_name(name), m_arg(arg), m_start(enabled ? Now() : 0),
+            m_enabled(enabled) {}
+        ~Scope() {
+            if (m_enabled) Record(m_name, m_start, Now(), m_arg);
+        }
+    private:
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+        const char* m_name;         //!< Name of the event
+        int64_t     m_arg;          //!< Argument shown with the event
+        uint64_t    m_start;        //!< Start time of the event
+        bool        m_enabled;      //!< Whether the event is recorded
+    };
+
+    /* ============================================================= */
+
+    // Records one "rows" event per band of LUTZ_TRACE_ROW_BAND rows
+    class RowBands {
+    public:
+        RowBands() : m_first(-1), m_start(0) {}
+        ~RowBands() { close(); }
+        // Call at the start of every row
+        void row(int yindx);
+        void close(void);
+    private:
+        int      m_first;           //!< First row of the open band (-1 = none)
+        uint64_t m_start;           //!< Start time of the open band
+    };
+};
+
+// Number of rows covered by each "rows" event
+#ifndef LUTZ_TRACE_ROW_BAND
+#define LUTZ_TRACE_ROW_BAND 64
+#endif
+
+#define LUTZ_TRACE_CONCAT_(a, b) a ## b
+#define LUTZ_TRACE_CONCAT(a, b) LUTZ_TRACE_CONCAT_(a, b)
+
+#ifdef LUTZ_TRACE
+// Time the rest of the enclosing block
+#define LUTZ_TRACE_SCOPE(name) \
+    lutzTrace::Scope LUTZ_TRACE_CONCAT(lutz_trace_, __LINE__)(name)
+// Same, with an argument shown alongside the event
+#define LUTZ_TRACE_SCOPE_ARG(name, arg) \
+    lutzTrace::Scope LUTZ_TRACE_CONCAT(lutz_trace_, __LINE__)(name, (arg))
+// Same, for an object of 'npix' pixels (skipped below the cutoff)
+#define LUTZ_TRACE_OBJECT(name, npix) \
+    lutzTrace::Scope LUTZ_TRACE_CONCAT(lutz_trace_, __LINE__)(name, (npix), \
+        (npix) >= lutzTrace::GetObjectCutoff())
+// Declare the row bands of a scan, then mark the start of each row
+#define LUTZ_TRACE_ROWS() lutzTrace::RowBands lutz_trace_rows
+#define LUTZ_TRACE_ROW(yindx) lutz_trace_rows.row(yindx)
+#else
+#define LUTZ_TRACE_SCOPE(name)
+#define LUTZ_TRACE_SCOPE_ARG(name, arg)
+#define LUTZ_TRACE_OBJECT(name, npix)
+#define LUTZ_TRACE_ROWS()
+#define LUTZ_TRACE_ROW(yindx)
+#endif
+
+
+/***************************************************************//**
+ * @brief Mark the start of a row, closing the band when it is full
+ *
+ * @param[in] yindx         Row about to be scanned
+ *******************************************************************/
+inline void lutzTrace::RowBands::row(int yindx)
+{
+    if ((m_first >= 0) && (yindx - m_first < LUTZ_TRACE_ROW_BAND)) return;
+    close();
+    m_first = yindx;
+    m_start = Now();
+}
+
+
+/***************************************************************//**
+ * @brief Record the open band, if there is one
+ *******************************************************************/
+inline void lutzTrace::RowBands::close()
+{
+    if (m_first < 0) return;
+    Record("rows", m_start, Now(), m_first);
+    m_first = -1;
+}
+
+#endif /* LUTZTRACE_HPP */
@@ -0,0 +1,220 @@
+/***************************************************************************
+ *  lutzBackground.cpp - Streaming estimate of the image background        *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzBackground.cpp
+ * @brief Implements the lutzBackground class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include "lutzBackground.hpp"
+
+
+/************************************************************//**
+ * @brief Constructor
+ *
+ * @param[in] nbins         Number of bins in the histogram
+ *
+ * By default every 8th pixel of every 8th row is sampled, half of the
+ * previous estimate is kept each frame and a jump of more than 5 sigma
+ * skips the damping.
+ ****************************************************************/
+lutzBackground::lutzBackground(int nbins) :
+    m_bins(std::max(nbins, 16), 0),
+    m_low(0.0),
+    m_scale(0.0),
+    m_ranged(false),
+    m_under(0),
+    m_over(0),
+    m_nsample(0),
+    m_keep(1),
+    m_median(0.0),
+    m_sigma(0.0),
+    m_ready(false),
+    m_damping(0.5),
+    m_reset_sigmas(5.0),
+    m_step(8)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzBackground::~lutzBackground()
+{}
+
+
+/************************************************************//**
+ * @brief Forget the current estimate
+ *
+ * The next frame is gathered without a histogram range and its result
+ * is taken as it is.
+ ****************************************************************/
+void lutzBackground::Reset()
+{
+    m_ready  = false;
+    m_ranged = false;
+    StartFrame();
+}
+
+
+/************************************************************//**
+ * @brief Start gathering the samples of a new frame
+ ****************************************************************/
+void lutzBackground::StartFrame()
+{
+    std::fill(m_bins.begin(), m_bins.end(), 0);
+    m_under   = 0;
+    m_over    = 0;
+    m_nsample = 0;
+    m_samples.clear();
+    m_keep    = 1;
+}
+
+
+/************************************************************//**
+ * @brief Finish a frame and update the estimate
+ *
+ * @return Whether the estimate was updated
+ *
+ * The histogram is centred on the new estimate, 8 sigma either side,
+ * ready for the next frame.
+ ****************************************************************/
+bool lutzBackground::FinishFrame()
+{
+    if (m_nsample == 0) return false;
+
+    double median, sigma;
+    if (!m_ranged) {
+        // Exact quantiles of the buffered samples
+        size_t nlow = size_t(0.1587 * m_samples.size());
+        size_t nmid = m_samples.size() / 2;
+        std::nth_element(m_samples.begin(), m_samples.begin() + nmid,
+                         m_samples.end());
+        median = m_samples[nmid];
+        std::nth_element(m_samples.begin(), m_samples.begin() + nlow,
+                         m_samples.begin() + nmid);
+        sigma  = median - m_samples[nlow];
+        m_samples.clear();
+    } else {
+        // Both quantiles must lie inside the histogram range
+        if ((m_under > 0.1587 * m_nsample) || (m_over >= 0.5 * m_nsample)) {
+            m_ranged = false;
+            return false;
+        }
+        median = Quantile(0.5);
+        sigma  = median - Quantile(0.1587);
+
+        // The noise cannot be resolved below one bin
+        sigma  = std::max(sigma, 1.0 / m_scale);
+    }
+
+    Update(median, sigma);
+    double width = (m_sigma > 0.0) ? m_sigma : std::max(std::fabs(m_median), 1.0);
+    SetRange(m_median - 8.0 * width, m_median + 8.0 * width);
+    return true;
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Keep a sample while there is no histogram range
+ *
+ * @param[in] value         Sampled value
+ *
+ * When the buffer fills, every other sample is dropped and from then on
+ * only half as many are kept, so the buffer stays bounded while still
+ * spanning the whole frame.
+ ****************************************************************/
+void lutzBackground::AddSample(double value)
+{
+    const size_t max_samples = 64 * m_bins.size();
+    if (m_nsample++ % m_keep != 0) return;
+
+    m_samples.push_back(value);
+    if (m_samples.size() >= max_samples) {
+        for (size_t i=0; i < m_samples.size() / 2; i++) {
+            m_samples[i] = m_samples[2 * i];
+        }
+        m_samples.resize(m_samples.size() / 2);
+        m_keep *= 2;
+    }
+}
+
+
+/************************************************************//**
+ * @brief Set the range of values covered by the histogram
+ *
+ * @param[in] low           Value at the lower edge of the first bin
+ * @param[in] high          Value at the upper edge of the last bin
+ ****************************************************************/
+void lutzBackground::SetRange(double low, double high)
+{
+    m_low    = low;
+    m_scale  = m_bins.size() / (high - low);
+    m_ranged = true;
+}
+
+
+/************************************************************//**
+ * @brief Return a quantile of the histogram
+ *
+ * @param[in] fraction      Fraction of the samples below the quantile
+ * @return Value of the quantile, interpolated within its bin
+ ****************************************************************/
+double lutzBackground::Quantile(double fraction) const
+{
+    double target = fraction * m_nsample;
+    double count  = m_under;
+    for (size_t i=0; i < m_bins.size(); i++) {
+        if (count + m_bins[i] >= target) {
+            double part = (m_bins[i] > 0) ? (target - count) / m_bins[i] : 0.0;
+            return m_low + (i + part) / m_scale;
+        }
+        count += m_bins[i];
+    }
+    return m_low + m_bins.size() / m_scale;
+}
+
+
+/************************************************************//**
+ * @brief Blend the values of the last frame into the estimate
+ *
+ * @param[in] median        Median of the last frame
+ * @param[in] sigma         Noise of the last frame
+ ****************************************************************/
+void lutzBackground::Update(double median, double sigma)
+{
+    if (!m_ready ||
+        (std::fabs(median - m_median) > m_reset_sigmas * m_sigma)) {
+        m_median = median;
+        m_sigma  = sigma;
+    } else {
+        m_median = m_damping * m_median + (1.0 - m_damping) * median;
+        m_sigma  = m_damping * m_sigma  + (1.0 - m_damping) * sigma;
+    }
+    m_ready = true;
+}
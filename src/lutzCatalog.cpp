@@ -0,0 +1,91 @@
+/***************************************************************************
+ *  lutzCatalog.cpp - Columnar table of object measurements                *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCatalog.cpp
+ * @brief Implements the lutzCatalog class
+ * @author Josh Cardenzana
+ */
+
+#include "lutzCatalog.hpp"
+
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzCatalog::lutzCatalog() :
+    m_present(0),
+    m_nrows(0)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzCatalog::~lutzCatalog()
+{}
+
+
+/************************************************************//**
+ * @brief Set the number of rows and which columns are present
+ *
+ * @param[in] nrows         Number of rows
+ * @param[in] columns       Bit (1 << column) set for each column wanted
+ *
+ * Present columns hold nrows values (their previous contents are not
+ * kept), the others are emptied. No memory is given back.
+ ****************************************************************/
+void lutzCatalog::resize(size_t nrows, unsigned columns)
+{
+    m_nrows   = nrows;
+    m_present = columns;
+    for (int c=0; c < NUM_COLUMNS; c++) {
+        if ((columns >> c) & 1) {
+            m_columns[c].resize(nrows);
+        } else {
+            m_columns[c].clear();
+        }
+    }
+}
+
+
+/************************************************************//**
+ * @brief Remove all rows and columns
+ ****************************************************************/
+void lutzCatalog::clear()
+{
+    resize(0, 0);
+}
+
+
+/************************************************************//**
+ * @brief Return the name of a column
+ *
+ * @param[in] column        Column
+ * @return Short name, e.g. for a table header
+ ****************************************************************/
+const char* lutzCatalog::ColumnName(LUTZ_COLUMN column)
+{
+    static const char* names[NUM_COLUMNS] = {
+        "x", "y", "xx", "yy", "xy", "a", "b", "theta",
+        "flux", "npix", "peak", "xpeak", "ypeak"
+    };
+    return ((column >= 0) && (column < NUM_COLUMNS)) ? names[column] : "";
+}
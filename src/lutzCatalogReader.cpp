@@ -0,0 +1,281 @@
+/***************************************************************************
+ *  lutzCatalogReader.cpp - Reads catalogs from shared memory              *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCatalogReader.cpp
+ * @brief Implements the lutzCatalogReader class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "lutzCatalogReader.hpp"
+
+
+/************************************************************//**
+ * @brief Constructor
+ ****************************************************************/
+lutzCatalogReader::lutzCatalogReader() :
+    m_fd(-1),
+    m_base(nullptr),
+    m_bytes(0),
+    m_header(nullptr),
+    m_next(0),
+    m_missed(0)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzCatalogReader::~lutzCatalogReader()
+{
+    Close();
+}
+
+
+/************************************************************//**
+ * @brief Attach to a ring
+ *
+ * @param[in] name          Name given to lutzCatalogRing::Create()
+ * @return Whether the ring exists and has a layout this reader knows
+ *
+ * Next() starts with the oldest frame still held in the ring.
+ ****************************************************************/
+bool lutzCatalogReader::Open(const std::string& name)
+{
+    Close();
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (size_t(info.st_size) < lutzRingSlotOffset())) {
+        close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    m_name   = name;
+    m_fd     = fd;
+    m_base   = static_cast<const char*>(base);
+    m_bytes  = info.st_size;
+    m_header = reinterpret_cast<const lutzRingHeader*>(m_base);
+
+    // Refuse a ring that is not finished or was written with another layout
+    bool valid = (m_header->m_magic == LUTZ_RING_MAGIC);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    valid = valid && (m_header->m_version == LUTZ_RING_VERSION) &&
+            (m_header->m_record_size == sizeof(lutzRingRecord)) &&
+            (m_header->m_nslots > 0) &&
+            (m_header->m_slot_bytes >= lutzRingSlotBytes(m_header->m_max_records)) &&
+            (lutzRingSlotOffset() + m_header->m_nslots * m_header->m_slot_bytes <= m_bytes);
+    if (!valid) {
+        Close();
+        return false;
+    }
+
+    uint64_t published = NumPublished();
+    m_next   = (published > m_header->m_nslots) ? published - m_header->m_nslots : 0;
+    m_missed = 0;
+    return true;
+}
+
+
+/************************************************************//**
+ * @brief Detach from the ring
+ ****************************************************************/
+void lutzCatalogReader::Close()
+{
+    if (m_base) munmap(const_cast<char*>(m_base), m_bytes);
+    if (m_fd >= 0) close(m_fd);
+
+    m_fd     = -1;
+    m_base   = nullptr;
+    m_bytes  = 0;
+    m_header = nullptr;
+}
+
+
+/************************************************************//**
+ * @brief Start reading a frame in place
+ *
+ * @param[in] sequence      Position of the frame (0 for the first frame
+ *                          published)
+ * @param[out] frame        Frame, valid until End() says otherwise
+ * @return Whether the frame is in the ring and not being written
+ ****************************************************************/
+bool lutzCatalogReader::Begin(uint64_t sequence, Frame& frame) const
+{
+    if (m_header == nullptr) return false;
+
+    const lutzRingSlot* slot = Slot(sequence);
+    if (slot->m_lock.load(std::memory_order_acquire) != 2 * sequence + 2) {
+        return false;
+    }
+
+    frame.m_records  = reinterpret_cast<const lutzRingRecord*>(slot + 1);
+    frame.m_nrecords = slot->m_nrecords;
+    frame.m_ndropped = slot->m_ndropped;
+    frame.m_frame    = slot->m_frame;
+    frame.m_sequence = sequence;
+    if (frame.m_nrecords > m_header->m_max_records) frame.m_nrecords = 0;
+    return End(frame);
+}
+
+
+/************************************************************//**
+ * @brief Check that a frame was not overwritten while it was read
+ *
+ * @param[in] frame         Frame from Begin(), Next() or Latest()
+ * @return Whether everything read from the frame is consistent
+ ****************************************************************/
+bool lutzCatalogReader::End(const Frame& frame) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const lutzRingSlot* slot = Slot(frame.m_sequence);
+    return (slot->m_lock.load(std::memory_order_relaxed) == 2 * frame.m_sequence + 2);
+}
+
+
+/************************************************************//**
+ * @brief Start reading the next frame in place
+ *
+ * @param[out] frame        Frame, valid until End() says otherwise
+ * @return Whether there was a new frame
+ ****************************************************************/
+bool lutzCatalogReader::Next(Frame& frame)
+{
+    if (m_header == nullptr) return false;
+
+    for (;;) {
+        uint64_t published = NumPublished();
+        if (m_next >= published) {
+            // Frames published after the writer retired this ring go to
+            // the one that replaced it
+            if (IsRetired() && (m_next >= NumPublished()) && Reopen()) continue;
+            return false;
+        }
+
+        // Skip the frames that have already been overwritten
+        if (published - m_next > m_header->m_nslots) {
+            m_missed += published - m_header->m_nslots - m_next;
+            m_next    = published - m_header->m_nslots;
+        }
+        if (Begin(m_next, frame)) {
+            m_next++;
+            return true;
+        }
+
+        // The writer got to this slot first
+        m_missed++;
+        m_next++;
+    }
+}
+
+
+/************************************************************//**
+ * @brief Start reading the most recent frame in place
+ *
+ * @param[out] frame        Frame, valid until End() says otherwise
+ * @param[in] attempts      Number of times to try before giving up
+ * @return Whether a frame could be read. This is false if no frame has
+ *         been published, or if the writer overwrote the latest frame
+ *         on every attempt.
+ ****************************************************************/
+bool lutzCatalogReader::Latest(Frame& frame, int attempts) const
+{
+    for (int i=0; i < attempts; i++) {
+        uint64_t published = NumPublished();
+        if (published == 0) return false;
+        if (Begin(published - 1, frame)) return true;
+    }
+    return false;
+}
+
+
+/************************************************************//**
+ * @brief Copy the records of a frame
+ *
+ * @param[in] frame         Frame from Begin(), Next() or Latest()
+ * @param[out] records      Copy of the records of the frame
+ * @return Whether the copy is consistent (if not, the frame is lost)
+ ****************************************************************/
+bool lutzCatalogReader::Copy(const Frame& frame,
+                             std::vector<lutzRingRecord>& records) const
+{
+    records.assign(frame.m_records, frame.m_records + frame.m_nrecords);
+    if (End(frame)) return true;
+    records.clear();
+    return false;
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Return the slot holding a frame
+ *
+ * @param[in] sequence      Position of the frame
+ * @return Slot the frame is (or was) written to
+ ****************************************************************/
+const lutzRingSlot* lutzCatalogReader::Slot(uint64_t sequence) const
+{
+    size_t index = sequence % m_header->m_nslots;
+    return reinterpret_cast<const lutzRingSlot*>(
+        m_base + lutzRingSlotOffset() + index * m_header->m_slot_bytes);
+}
+
+
+/************************************************************//**
+ * @brief Attach to the ring that has replaced this one
+ *
+ * @return Whether there was a new ring to attach to. If not the reader
+ *         stays attached to the retired ring.
+ *
+ * The new ring's frames are numbered from 0 again, so Next() starts
+ * over with the oldest frame it holds.
+ ****************************************************************/
+bool lutzCatalogReader::Reopen()
+{
+    // The writer may not have made the new ring yet, or not unlinked the
+    // old one, so the name may still lead back to a retired ring
+    lutzCatalogReader fresh;
+    if (!fresh.Open(m_name) || fresh.IsRetired()) return false;
+
+    uint64_t missed = m_missed + fresh.m_next;
+    std::swap(m_fd,     fresh.m_fd);
+    std::swap(m_base,   fresh.m_base);
+    std::swap(m_bytes,  fresh.m_bytes);
+    std::swap(m_header, fresh.m_header);
+    m_next   = fresh.m_next;
+    m_missed = missed;
+    return true;
+}
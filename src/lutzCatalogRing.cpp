@@ -0,0 +1,314 @@
+/***************************************************************************
+ *  lutzCatalogRing.cpp - Publishes catalogs into shared memory            *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCatalogRing.cpp
+ * @brief Implements the lutzCatalogRing class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fcntl.h>
+#include <limits>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "lutzCatalogRing.hpp"
+
+
+/************************************************************//**
+ * @brief Constructor
+ ****************************************************************/
+lutzCatalogRing::lutzCatalogRing() :
+    m_fd(-1),
+    m_base(nullptr),
+    m_bytes(0),
+    m_header(nullptr),
+    m_sequence(0)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzCatalogRing::~lutzCatalogRing()
+{
+    Close();
+}
+
+
+/************************************************************//**
+ * @brief Create the shared memory ring
+ *
+ * @param[in] name          Name of the shared memory object, starting
+ *                          with '/'. An existing object is retired and
+ *                          unlinked, and the new ring takes its place.
+ * @param[in] nslots        Number of frames held in the ring
+ * @param[in] max_records   Objects a frame has room for
+ * @return Whether the ring could be created
+ *
+ * The old object is never truncated, since a reader touching a page
+ * that no longer exists would be killed by SIGBUS. Readers keep their
+ * mapping of it and find the new ring once they have read all of it.
+ ****************************************************************/
+bool lutzCatalogRing::Create(const std::string& name, int nslots, int max_records)
+{
+    // Our own ring is retired by Close(), anyone else's by Retire()
+    uint64_t generation = (m_header && (m_name == name)) ? m_header->m_generation + 1 : 0;
+    Close();
+    if ((nslots < 1) || (max_records < 0)) return false;
+
+    size_t slot_bytes = lutzRingSlotBytes(max_records);
+    size_t bytes      = lutzRingSlotOffset() + size_t(nslots) * slot_bytes;
+
+    generation = std::max(generation, Retire(name));
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, bytes) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    m_name     = name;
+    m_fd       = fd;
+    m_base     = static_cast<char*>(base);
+    m_bytes    = bytes;
+    m_sequence = 0;
+
+    // Lay out the slots, then the header. The magic number goes last, so
+    // a reader that finds it also finds the rest of the header.
+    for (int s=0; s < nslots; s++) {
+        lutzRingSlot* slot = new (m_base + lutzRingSlotOffset() + s * slot_bytes) lutzRingSlot;
+        slot->m_lock.store(0, std::memory_order_relaxed);
+        slot->m_frame    = 0;
+        slot->m_nrecords = 0;
+        slot->m_ndropped = 0;
+        slot->m_reserved = 0;
+    }
+    m_header = new (m_base) lutzRingHeader;
+    m_header->m_version     = LUTZ_RING_VERSION;
+    m_header->m_record_size = sizeof(lutzRingRecord);
+    m_header->m_nslots      = nslots;
+    m_header->m_max_records = max_records;
+    m_header->m_retired.store(0, std::memory_order_relaxed);
+    m_header->m_slot_bytes  = slot_bytes;
+    m_header->m_published.store(0, std::memory_order_relaxed);
+    m_header->m_generation  = generation;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->m_magic = LUTZ_RING_MAGIC;
+
+    return true;
+}
+
+
+/************************************************************//**
+ * @brief Unmap the ring
+ *
+ * @param[in] unlink        Whether to remove the shared memory object.
+ *                          Readers that have it open keep their mapping,
+ *                          and the ring is marked as retired for them.
+ ****************************************************************/
+void lutzCatalogRing::Close(bool unlink)
+{
+    if (unlink && m_header) m_header->m_retired.store(1, std::memory_order_release);
+    if (m_base) munmap(m_base, m_bytes);
+    if (m_fd >= 0) close(m_fd);
+    if (unlink && (m_fd >= 0)) shm_unlink(m_name.c_str());
+
+    m_fd     = -1;
+    m_base   = nullptr;
+    m_bytes  = 0;
+    m_header = nullptr;
+}
+
+
+/************************************************************//**
+ * @brief Publish the objects found in one frame
+ *
+ * @param[in] frame         Frame number passed on to the readers
+ * @param[in] objects       Objects, e.g. from lutzOnePass::GetObjects()
+ * @return Whether the frame was published
+ ****************************************************************/
+bool lutzCatalogRing::Publish(int64_t frame, const std::vector<lutzObject>& objects)
+{
+    lutzRingSlot* slot = BeginSlot(frame);
+    if (slot == nullptr) return false;
+
+    uint32_t nrecords = std::min(objects.size(), size_t(m_header->m_max_records));
+    lutzRingRecord* records = Records(slot);
+    for (uint32_t i=0; i < nrecords; i++) {
+        const lutzObject& object = objects[i];
+        lutzRingRecord&   record = records[i];
+        record.m_npix  = object.NumPixels();
+        record.m_xmin  = object.GetXMin();
+        record.m_xmax  = object.GetXMax();
+        record.m_ymin  = object.GetYMin();
+        record.m_ymax  = object.GetYMax();
+        record.m_flags = object.GetFlags();
+        object.centroid(record.m_x, record.m_y);
+        record.m_sum   = object.Sum();
+        record.m_peak  = object.GetMaximum();
+        record.m_min   = object.GetMinimum();
+    }
+
+    EndSlot(slot, nrecords, objects.size() - nrecords);
+    return true;
+}
+
+
+/************************************************************//**
+ * @brief Publish the records found in one frame in boxes-only mode
+ *
+ * @param[in] frame         Frame number passed on to the readers
+ * @param[in] boxes         Records, e.g. from lutzOnePass::GetBoxes()
+ * @return Whether the frame was published
+ *
+ * A box does not know its centroid, sum or minimum, so these are NaN.
+ * Readers wanting a position can take the bounding box or the
+ * brightest pixel.
+ ****************************************************************/
+bool lutzCatalogRing::Publish(int64_t frame, const std::vector<lutzBox>& boxes)
+{
+    lutzRingSlot* slot = BeginSlot(frame);
+    if (slot == nullptr) return false;
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    uint32_t nrecords = std::min(boxes.size(), size_t(m_header->m_max_records));
+    lutzRingRecord* records = Records(slot);
+    for (uint32_t i=0; i < nrecords; i++) {
+        const lutzBox&  box    = boxes[i];
+        lutzRingRecord& record = records[i];
+        record.m_npix  = box.m_npix;
+        record.m_xmin  = box.m_xmin;
+        record.m_xmax  = box.m_xmax;
+        record.m_ymin  = box.m_ymin;
+        record.m_ymax  = box.m_ymax;
+        record.m_flags = box.m_flags;
+        record.m_x     = nan;
+        record.m_y     = nan;
+        record.m_sum   = nan;
+        record.m_peak  = box.m_peak;
+        record.m_min   = nan;
+    }
+
+    EndSlot(slot, nrecords, boxes.size() - nrecords);
+    return true;
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Retire the ring left under a name by an earlier writer
+ *
+ * @param[in] name          Name of the shared memory object
+ * @return Generation of the ring to be made in its place (0 if there
+ *         was no ring of this format)
+ ****************************************************************/
+uint64_t lutzCatalogRing::Retire(const std::string& name) const
+{
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) return 0;
+
+    // Only the header is needed
+    uint64_t generation = 0;
+    size_t   bytes      = lutzRingSlotOffset();
+    struct stat info;
+    if ((fstat(fd, &info) == 0) && (size_t(info.st_size) >= bytes)) {
+        void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base != MAP_FAILED) {
+            lutzRingHeader* header = static_cast<lutzRingHeader*>(base);
+            if ((header->m_magic == LUTZ_RING_MAGIC) &&
+                (header->m_version == LUTZ_RING_VERSION)) {
+                generation = header->m_generation + 1;
+                header->m_retired.store(1, std::memory_order_release);
+            }
+            munmap(base, bytes);
+        }
+    }
+    close(fd);
+    return generation;
+}
+
+
+/************************************************************//**
+ * @brief Lock the slot of the next frame for writing
+ *
+ * @param[in] frame         Frame number passed on to the readers
+ * @return Slot to be written (nullptr if the ring is not open)
+ ****************************************************************/
+lutzRingSlot* lutzCatalogRing::BeginSlot(int64_t frame)
+{
+    if (m_header == nullptr) return nullptr;
+
+    size_t index = m_sequence % m_header->m_nslots;
+    lutzRingSlot* slot = reinterpret_cast<lutzRingSlot*>(
+        m_base + lutzRingSlotOffset() + index * m_header->m_slot_bytes);
+
+    // An odd lock tells readers the slot is changing under them
+    slot->m_lock.store(2 * m_sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->m_frame = frame;
+    return slot;
+}
+
+
+/************************************************************//**
+ * @brief Release a slot once its records are written
+ *
+ * @param[in] slot          Slot returned by BeginSlot()
+ * @param[in] nrecords      Number of records written
+ * @param[in] ndropped      Number of objects that did not fit
+ ****************************************************************/
+void lutzCatalogRing::EndSlot(lutzRingSlot* slot, uint32_t nrecords, uint32_t ndropped)
+{
+    slot->m_nrecords = nrecords;
+    slot->m_ndropped = ndropped;
+    slot->m_lock.store(2 * m_sequence + 2, std::memory_order_release);
+
+    m_sequence++;
+    m_header->m_published.store(m_sequence, std::memory_order_release);
+}
+
+
+/************************************************************//**
+ * @brief Return the records of a slot
+ *
+ * @param[in] slot          Slot
+ * @return First record of the slot
+ ****************************************************************/
+lutzRingRecord* lutzCatalogRing::Records(lutzRingSlot* slot) const
+{
+    return reinterpret_cast<lutzRingRecord*>(slot + 1);
+}
@@ -0,0 +1,314 @@
+/***************************************************************************
+ *  lutzCube.cpp - Lutz one pass algorithm extended to data cubes          *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCube.cpp
+ * @brief Implements the lutzCube class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include "lutzCube.hpp"
+#include "lutzTrace.hpp"
+
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzCube::lutzCube() :
+    m_xpix(0),
+    m_ypix(0),
+    m_zpix(0),
+    m_npixelmin(1),
+    m_cube(nullptr),
+    m_threshold(0.0),
+    m_zindx(0)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from a cube held in memory
+ *
+ * @param[in] cube          m_xpix x m_ypix x m_zpix values, x fastest
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ * @param[in] zpixels       Number of planes
+ ****************************************************************/
+lutzCube::lutzCube(double* cube, int xpixels, int ypixels, int zpixels) :
+    m_xpix(xpixels),
+    m_ypix(ypixels),
+    m_zpix(zpixels),
+    m_npixelmin(1),
+    m_cube(cube),
+    m_threshold(0.0),
+    m_zindx(0)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzCube::~lutzCube()
+{}
+
+
+/************************************************************//**
+ * @brief Find all of the objects in the cube set by SetCube()
+ ****************************************************************/
+void lutzCube::run()
+{
+    LUTZ_TRACE_SCOPE("run");
+    
+    size_t plane_size = size_t(m_xpix) * m_ypix;
+    StartCube();
+    for (int zindx=0; zindx < m_zpix; zindx++) {
+        AddPlane(m_cube + zindx * plane_size);
+    }
+    FinishCube();
+}
+
+
+/************************************************************//**
+ * @brief Reset the detector before the first plane of a cube
+ *
+ * The plane size must be set beforehand. Objects found in a previous
+ * cube are dropped.
+ ****************************************************************/
+void lutzCube::StartCube()
+{
+    size_t plane_size = size_t(m_xpix) * m_ypix;
+    m_Objects.clear();
+    m_SLOTS.clear();
+    m_PARENT.clear();
+    m_LASTZ.clear();
+    m_ACTIVE.clear();
+    m_FREE.clear();
+    m_PREV.assign(plane_size, 0);
+    m_CUR.assign(plane_size, 0);
+    m_zindx = 0;
+}
+
+
+/************************************************************//**
+ * @brief Process the next plane of the cube
+ *
+ * @param[in] plane         m_xpix x m_ypix values of the plane, x fastest
+ *
+ * The plane is only read during this call. When it returns, the objects
+ * that ended on the previous plane have been written.
+ ****************************************************************/
+void lutzCube::AddPlane(const double* plane)
+{
+    LUTZ_TRACE_SCOPE_ARG("plane", m_zindx);
+    
+    for (int yindx=0; yindx < m_ypix; yindx++) {
+        
+        const double* row = plane + size_t(yindx) * m_xpix;
+        int32_t* cur   = &m_CUR[size_t(yindx) * m_xpix];
+        int32_t* above = (yindx > 0) ? cur - m_xpix : nullptr;
+        int ylo = std::max(yindx - 1, 0);
+        int yhi = std::min(yindx + 1, m_ypix - 1);
+        
+        int xindx = 0;
+        while (xindx < m_xpix) {
+            if (!AssessVoxel(row[xindx])) {
+                xindx++;
+                continue;
+            }
+            
+            // Find the run of image voxels starting here
+            int xstart = xindx;
+            while ((xindx < m_xpix) && AssessVoxel(row[xindx])) xindx++;
+            int xlo = std::max(xstart - 1, 0);
+            int xhi = std::min(xindx, m_xpix - 1);
+            
+            // Join every object touching the run, on the row above and on
+            // the neighbouring rows of the previous plane
+            int slot = -1;
+            int32_t last = 0;
+            if (above) {
+                for (int x=xlo; x<=xhi; x++) {
+                    if (above[x] && (above[x] != last)) {
+                        last = above[x];
+                        slot = LinkSlot(slot, last - 1);
+                    }
+                }
+            }
+            if (m_zindx > 0) {
+                for (int y=ylo; y<=yhi; y++) {
+                    const int32_t* prev = &m_PREV[size_t(y) * m_xpix];
+                    last = 0;
+                    for (int x=xlo; x<=xhi; x++) {
+                        if (prev[x] && (prev[x] != last)) {
+                            last = prev[x];
+                            slot = LinkSlot(slot, last - 1);
+                        }
+                    }
+                }
+            }
+            if (slot < 0) slot = NewSlot();
+            
+            // Add the run to the object
+            lutzCubeObject& obj = m_SLOTS[slot];
+            for (int x=xstart; x<xindx; x++) {
+                cur[x] = slot + 1;
+                obj.append(lutzCubeObject::voxData(x, yindx, m_zindx, row[x]));
+            }
+        }
+    }
+    
+    ClosePlane();
+}
+
+
+/************************************************************//**
+ * @brief Write all of the objects that are still open
+ ****************************************************************/
+void lutzCube::FinishCube()
+{
+    for (int i=0; i<m_ACTIVE.size(); i++) {
+        int slot = m_ACTIVE[i];
+        WriteObject(m_SLOTS[slot]);
+        m_SLOTS[slot].clear();
+        m_FREE.push_back(slot);
+    }
+    m_ACTIVE.clear();
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Store a completed object
+ *
+ * @param[in] obj           Completed object (may be left empty)
+ ****************************************************************/
+void lutzCube::WriteObject(lutzCubeObject& obj)
+{
+    if (obj.size() < m_npixelmin) return;
+    m_Objects.push_back(lutzCubeObject());
+    m_Objects.back().swap(obj);
+}
+
+
+/************************************************************//**
+ * @brief Finish the current plane
+ *
+ * Points every voxel of the label plane at the root slot of its object,
+ * so that slots absorbed by another object are no longer referenced.
+ * Objects without voxels on this plane are complete and are written.
+ ****************************************************************/
+void lutzCube::ClosePlane()
+{
+    size_t plane_size = size_t(m_xpix) * m_ypix;
+    for (size_t i=0; i<plane_size; i++) {
+        if (m_CUR[i] == 0) continue;
+        int root = FindSlot(m_CUR[i] - 1);
+        m_CUR[i] = root + 1;
+        m_LASTZ[root] = m_zindx;
+    }
+    
+    // Keep only the objects that continue onto this plane
+    int nactive = 0;
+    for (int i=0; i<m_ACTIVE.size(); i++) {
+        int slot = m_ACTIVE[i];
+        if (m_PARENT[slot] == slot) {
+            if (m_LASTZ[slot] == m_zindx) {
+                m_ACTIVE[nactive++] = slot;
+                continue;
+            }
+            WriteObject(m_SLOTS[slot]);
+        }
+        m_SLOTS[slot].clear();
+        m_FREE.push_back(slot);
+    }
+    m_ACTIVE.resize(nactive);
+    
+    // This plane becomes the previous plane
+    m_PREV.swap(m_CUR);
+    std::fill(m_CUR.begin(), m_CUR.end(), 0);
+    ++m_zindx;
+}
+
+
+/************************************************************//**
+ * @brief Start a new object
+ *
+ * @return Slot holding the object
+ ****************************************************************/
+int lutzCube::NewSlot()
+{
+    int slot;
+    if (!m_FREE.empty()) {
+        slot = m_FREE.back();
+        m_FREE.pop_back();
+    } else {
+        slot = m_SLOTS.size();
+        m_SLOTS.push_back(lutzCubeObject());
+        m_PARENT.push_back(0);
+        m_LASTZ.push_back(0);
+    }
+    m_PARENT[slot] = slot;
+    m_LASTZ[slot]  = -1;
+    m_ACTIVE.push_back(slot);
+    return slot;
+}
+
+
+/************************************************************//**
+ * @brief Return the slot at the root of a slot's object
+ *
+ * @param[in] slot          Slot to look up
+ * @return Root slot
+ ****************************************************************/
+int lutzCube::FindSlot(int slot)
+{
+    while (m_PARENT[slot] != slot) {
+        m_PARENT[slot] = m_PARENT[m_PARENT[slot]];
+        slot = m_PARENT[slot];
+    }
+    return slot;
+}
+
+
+/************************************************************//**
+ * @brief Join an object to the object held by a root slot
+ *
+ * @param[in] slot          Root slot (or -1 for none)
+ * @param[in] other         Any slot of the other object
+ * @return Root slot of the joined object
+ *
+ * The smaller object is moved into the larger one.
+ ****************************************************************/
+int lutzCube::LinkSlot(int slot, int other)
+{
+    int root = FindSlot(other);
+    if ((slot < 0) || (slot == root)) return root;
+    
+    if (m_SLOTS[slot].size() < m_SLOTS[root].size()) std::swap(slot, root);
+    m_SLOTS[slot].append(m_SLOTS[root]);
+    m_PARENT[root] = slot;
+    m_LASTZ[slot]  = std::max(m_LASTZ[slot], m_LASTZ[root]);
+    return slot;
+}
@@ -0,0 +1,171 @@
+/***************************************************************************
+ *  lutzCubeObject.cpp - Defines an object extracted from a data cube      *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzCubeObject.cpp
+ * @brief Implements the lutzCubeObject class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include "lutzCubeObject.hpp"
+
+
+/***************************************************************//**
+ * @brief Default constructor for lutzCubeObject
+ *******************************************************************/
+lutzCubeObject::lutzCubeObject()
+{
+    clear();
+}
+
+
+/***************************************************************//**
+ * @brief Deconstructor
+ *******************************************************************/
+lutzCubeObject::~lutzCubeObject()
+{}
+
+
+/***************************************************************//**
+ * @brief Append a single voxel to this object
+ *
+ * @param[in] voxel         Voxel to be appended
+ *
+ * Unlike lutzObject::append() this does not check for duplicates.
+ *******************************************************************/
+void lutzCubeObject::append(const voxData& voxel)
+{
+    if (voxel.m_xbin < m_xmin) m_xmin = voxel.m_xbin;
+    if (voxel.m_xbin > m_xmax) m_xmax = voxel.m_xbin;
+    if (voxel.m_ybin < m_ymin) m_ymin = voxel.m_ybin;
+    if (voxel.m_ybin > m_ymax) m_ymax = voxel.m_ybin;
+    if (voxel.m_zbin < m_zmin) m_zmin = voxel.m_zbin;
+    if (voxel.m_zbin > m_zmax) m_zmax = voxel.m_zbin;
+    if (voxel.m_value < m_value_min) m_value_min = voxel.m_value;
+    if (voxel.m_value > m_value_max) m_value_max = voxel.m_value;
+    m_value_sum += voxel.m_value;
+    m_voxInfo.push_back(voxel);
+}
+
+
+/***************************************************************//**
+ * @brief Move all of the voxels of another object into this one
+ *
+ * @param[in] other         Object to be merged in (left empty)
+ *******************************************************************/
+void lutzCubeObject::append(lutzCubeObject& other)
+{
+    if (other.m_voxInfo.empty()) return;
+    if (m_voxInfo.empty()) {
+        swap(other);
+        return;
+    }
+    
+    m_xmin = std::min(m_xmin, other.m_xmin);
+    m_xmax = std::max(m_xmax, other.m_xmax);
+    m_ymin = std::min(m_ymin, other.m_ymin);
+    m_ymax = std::max(m_ymax, other.m_ymax);
+    m_zmin = std::min(m_zmin, other.m_zmin);
+    m_zmax = std::max(m_zmax, other.m_zmax);
+    m_value_min = std::min(m_value_min, other.m_value_min);
+    m_value_max = std::max(m_value_max, other.m_value_max);
+    m_value_sum += other.m_value_sum;
+    m_voxInfo.insert(m_voxInfo.end(),
+                     other.m_voxInfo.begin(), other.m_voxInfo.end());
+    other.clear();
+}
+
+
+/***************************************************************//**
+ * @brief Clear the contents of this object
+ *******************************************************************/
+void lutzCubeObject::clear()
+{
+    m_voxInfo.clear();
+    m_xmin = 1e7;
+    m_xmax = -1e7;
+    m_ymin = 1e7;
+    m_ymax = -1e7;
+    m_zmin = 1e7;
+    m_zmax = -1e7;
+    m_value_min = 1.0e30;
+    m_value_max = -1.0e30;
+    m_value_sum = 0.0;
+}
+
+
+/********************************************************************//**
+ * @brief Compute the central x,y,z position of the object
+ *
+ * @param[out] xcenter          Center x-position
+ * @param[out] ycenter          Center y-position
+ * @param[out] zcenter          Center z-position
+ * @param[in] weight_bins       Specifies whether to weight each voxel by
+ *                              its value
+ *
+ * As for lutzObject::centroid(), the unweighted centre is returned if
+ * the weights do not sum to a positive value.
+ ************************************************************************/
+void lutzCubeObject::centroid(double& xcenter, double& ycenter,
+                              double& zcenter, bool weight_bins) const
+{
+    double weight_sum(0.0);
+    xcenter = 0.0;
+    ycenter = 0.0;
+    zcenter = 0.0;
+    
+    for (int v=0; v<size(); v++) {
+        double weight = weight_bins ? m_voxInfo[v].m_value : 1.0;
+        xcenter += weight * m_voxInfo[v].m_xbin;
+        ycenter += weight * m_voxInfo[v].m_ybin;
+        zcenter += weight * m_voxInfo[v].m_zbin;
+        weight_sum += weight;
+    }
+    
+    if (weight_sum > 0.0) {
+        xcenter /= weight_sum;
+        ycenter /= weight_sum;
+        zcenter /= weight_sum;
+    }
+    else if (weight_bins) {
+        centroid(xcenter, ycenter, zcenter, false);
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Exchange the contents of this object with another
+ *
+ * @param[in] other         Another lutzCubeObject to swap contents with
+ *******************************************************************/
+void lutzCubeObject::swap(lutzCubeObject& other)
+{
+    std::swap(m_xmin, other.m_xmin);
+    std::swap(m_xmax, other.m_xmax);
+    std::swap(m_ymin, other.m_ymin);
+    std::swap(m_ymax, other.m_ymax);
+    std::swap(m_zmin, other.m_zmin);
+    std::swap(m_zmax, other.m_zmax);
+    std::swap(m_value_min, other.m_value_min);
+    std::swap(m_value_max, other.m_value_max);
+    std::swap(m_value_sum, other.m_value_sum);
+    m_voxInfo.swap(other.m_voxInfo);
+}
@@ -0,0 +1,160 @@
+/***************************************************************************
+ *  lutzDeltaSource.cpp - Rows of a delta and zigzag coded frame           *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzDeltaSource.cpp
+ * @brief Implements the lutzDeltaSource class
+ * @author Josh Cardenzana
+ */
+
+#include "lutzDeltaSource.hpp"
+
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzDeltaSource::lutzDeltaSource() :
+    lutzRowSource(),
+    m_data(nullptr),
+    m_nbytes(0),
+    m_pos(0)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from a coded frame
+ *
+ * @param[in] data          Coded frame
+ * @param[in] nbytes        Number of bytes in data
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ ****************************************************************/
+lutzDeltaSource::lutzDeltaSource(const uint8_t* data, size_t nbytes,
+                                 int xpixels, int ypixels) :
+    lutzRowSource(xpixels, ypixels),
+    m_data(data),
+    m_nbytes(nbytes),
+    m_pos(0)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzDeltaSource::~lutzDeltaSource()
+{}
+
+
+/************************************************************//**
+ * @brief Set the coded frame
+ *
+ * @param[in] data          Coded frame
+ * @param[in] nbytes        Number of bytes in data
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ ****************************************************************/
+void lutzDeltaSource::SetData(const uint8_t* data, size_t nbytes,
+                              int xpixels, int ypixels)
+{
+    m_data   = data;
+    m_nbytes = nbytes;
+    m_xpix   = xpixels;
+    m_ypix   = ypixels;
+    m_pos    = 0;
+}
+
+
+/************************************************************//**
+ * @brief Go back to the first row of the frame
+ ****************************************************************/
+void lutzDeltaSource::Rewind()
+{
+    m_pos = 0;
+}
+
+
+/************************************************************//**
+ * @brief Decode the next row
+ *
+ * @param[out] row          m_xpix values to be filled
+ * @return Whether a whole row could be decoded
+ ****************************************************************/
+bool lutzDeltaSource::ReadRow(uint16_t* row)
+{
+    const uint8_t* pos = m_data + m_pos;
+    const uint8_t* end = m_data + m_nbytes;
+    uint32_t value = 0;
+
+    for (int xindx=0; xindx < m_xpix; xindx++) {
+        // Single byte differences are by far the most common
+        if ((pos < end) && (*pos < 0x80)) {
+            uint32_t zz = *pos++;
+            value += (zz >> 1) ^ (0u - (zz & 1));
+            row[xindx] = uint16_t(value);
+            continue;
+        }
+
+        uint32_t zz = 0;
+        int shift = 0;
+        while (true) {
+            if ((pos == end) || (shift > 28)) return false;
+            uint8_t byte = *pos++;
+            zz |= uint32_t(byte & 0x7f) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+        value += (zz >> 1) ^ (0u - (zz & 1));
+        row[xindx] = uint16_t(value);
+    }
+
+    m_pos = pos - m_data;
+    return true;
+}
+
+
+/************************************************************//**
+ * @brief Code a frame
+ *
+ * @param[in] image         xpixels x ypixels values
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ * @param[out] data         Coded frame (replaces any contents)
+ ****************************************************************/
+void lutzDeltaSource::Encode(const uint16_t* image, int xpixels, int ypixels,
+                             std::vector<uint8_t>& data)
+{
+    data.clear();
+    data.reserve(size_t(xpixels) * ypixels);
+
+    for (int yindx=0; yindx < ypixels; yindx++) {
+        const uint16_t* row = image + size_t(yindx) * xpixels;
+        int32_t prev = 0;
+        for (int xindx=0; xindx < xpixels; xindx++) {
+            int32_t  diff = int32_t(row[xindx]) - prev;
+            uint32_t zz   = (uint32_t(diff) << 1) ^ uint32_t(diff >> 31);
+            while (zz >= 0x80) {
+                data.push_back(uint8_t(zz | 0x80));
+                zz >>= 7;
+            }
+            data.push_back(uint8_t(zz));
+            prev = row[xindx];
+        }
+    }
+}
@@ -0,0 +1,322 @@
+/***************************************************************************
+ *  lutzDiffPass.cpp - Lutz one pass algorithm on a difference image       *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzDiffPass.cpp
+ * @brief Implements the lutzDiffPass class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "lutzDiffPass.hpp"
+#include "lutzTrace.hpp"
+
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzDiffPass::lutzDiffPass() :
+    lutzOnePass(),
+    m_science(nullptr),
+    m_reference(nullptr),
+    m_noise_map(nullptr),
+    m_scale(1.0),
+    m_offset(0.0),
+    m_find_negative(false),
+    m_negative(*this),
+    m_row(-1)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from the two frames
+ *
+ * @param[in] science       Science frame
+ * @param[in] reference     Reference frame, aligned with the science frame
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ ****************************************************************/
+lutzDiffPass::lutzDiffPass(const double* science, const double* reference,
+                           int xpixels, int ypixels) :
+    lutzOnePass(nullptr, xpixels, ypixels),
+    m_science(science),
+    m_reference(reference),
+    m_noise_map(nullptr),
+    m_scale(1.0),
+    m_offset(0.0),
+    m_find_negative(false),
+    m_negative(*this),
+    m_row(-1)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzDiffPass::~lutzDiffPass()
+{}
+
+
+/************************************************************//**
+ * @brief Return the difference at a given pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Difference (or significance) of the pixel
+ ****************************************************************/
+double lutzDiffPass::GetPixValue(int xbin, int ybin)
+{
+    if (ybin == m_row) return m_rowvalues[xbin];
+
+    size_t index = size_t(ybin) * m_xpix + xbin;
+    double value = m_science[index] - m_scale * m_reference[index] - m_offset;
+    if (m_noise_map) {
+        double noise = m_noise_map[index];
+        value = (noise > 0.0) ? value / noise : 0.0;
+    }
+    return value;
+}
+
+
+/************************************************************//**
+ * @brief Assess whether or not this pixel is an image pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Whether the difference is above threshold
+ ****************************************************************/
+bool lutzDiffPass::AssessPixel(int xbin, int ybin)
+{
+    return (GetPixValue(xbin, ybin) > m_threshold);
+}
+
+
+/************************************************************//**
+ * @brief Return whether the scan may read the rows of m_image directly
+ *
+ * @return Always false, since the pixel values are differences
+ ****************************************************************/
+bool lutzDiffPass::HasDirectRows() const
+{
+    return false;
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Initialize the data structures of both detectors
+ ****************************************************************/
+void lutzDiffPass::init_members()
+{
+    lutzOnePass::init_members();
+    m_rowvalues.assign(m_xpix, 0.0);
+    m_row = -1;
+    if (!m_find_negative) return;
+
+    // The negative detector follows this one's settings
+    m_negative.m_xpix       = m_xpix;
+    m_negative.m_ypix       = m_ypix;
+    m_negative.m_config     = m_config;
+    m_negative.m_bad_mask   = m_bad_mask;
+    m_negative.m_bad_bits   = m_bad_bits;
+    m_negative.m_bad_stride = m_bad_stride;
+    m_negative.m_config.m_adaptive_nsigma = 0.0;
+    m_negative.Start();
+    if (m_adaptive && m_background.IsReady()) {
+        m_negative.m_threshold =
+            m_config.m_adaptive_nsigma * m_background.GetSigma() - m_background.GetMedian();
+    }
+}
+
+
+/************************************************************//**
+ * @brief Scan the difference, one row at a time, for both signs
+ ****************************************************************/
+void lutzDiffPass::ScanImage()
+{
+    int co(0), pstop(0);
+    int nco(0), npstop(0);
+    int nwords = (m_xpix + 63) / 64;
+    m_ROWBITS.assign(2 * nwords, 0);
+    m_NEGBITS.assign(m_find_negative ? 2 * nwords : 0, 0);
+    LUTZ_TRACE_ROWS();
+
+    for (int yindx=0; yindx < m_ypix; yindx++) {
+
+        LUTZ_TRACE_ROW(yindx);
+        int cur_off  = (yindx & 1) * nwords;
+        int prev_off = ((yindx - 1) & 1) * nwords;
+        uint64_t* cur  = &m_ROWBITS[cur_off];
+        uint64_t* prev = (yindx > 0) ? &m_ROWBITS[prev_off] : nullptr;
+        uint64_t* ncur = m_find_negative ? &m_NEGBITS[cur_off] : nullptr;
+
+        // Difference the row and threshold it for both signs
+        DiffRow(yindx, cur, ncur);
+        m_row = yindx;
+        if (m_adaptive) m_background.addRow(m_rowvalues.data(), m_xpix, yindx);
+        if (m_bad_rows) {
+            if (m_check_bad) FindNaNs(m_rowvalues.data(), m_NANBITS.data());
+            const uint64_t* nan_bits = m_check_bad ? m_NANBITS.data() : nullptr;
+            ApplyBadPixels(yindx, nan_bits, cur);
+            if (ncur) m_negative.ApplyBadPixels(yindx, nan_bits, ncur);
+        }
+
+        ScanBitRow(cur, prev, yindx, co, pstop);
+        if (ncur) {
+            uint64_t* nprev = (yindx > 0) ? &m_NEGBITS[prev_off] : nullptr;
+            m_negative.ScanBitRow(ncur, nprev, yindx, nco, npstop);
+        }
+    }
+
+    if (m_find_negative) m_negative.Finish();
+    m_row = -1;
+}
+
+
+/************************************************************//**
+ * @brief Compute the difference of every pixel on a row
+ *
+ * @param[in] yindx         Row to difference
+ * @param[out] bits         Pixels above the threshold
+ * @param[out] negative_bits Pixels below minus the negative detector's
+ *                          threshold (nullptr to skip)
+ *
+ * The values are left in m_rowvalues.
+ ****************************************************************/
+void lutzDiffPass::DiffRow(int yindx, uint64_t* bits, uint64_t* negative_bits)
+{
+    size_t offset = size_t(yindx) * m_xpix;
+    const double* science   = m_science + offset;
+    const double* reference = m_reference + offset;
+    const double* noise     = m_noise_map ? m_noise_map + offset : nullptr;
+    double* values = m_rowvalues.data();
+
+    for (int xindx=0; xindx < m_xpix; xindx++) {
+        values[xindx] = science[xindx] - m_scale * reference[xindx] - m_offset;
+    }
+    if (noise) {
+        for (int xindx=0; xindx < m_xpix; xindx++) {
+            values[xindx] = (noise[xindx] > 0.0) ? values[xindx] / noise[xindx] : 0.0;
+        }
+    }
+
+    if (negative_bits == nullptr) {
+        ThresholdRow(values, bits);
+        return;
+    }
+
+    // Threshold for both signs in the same sweep
+    double threshold  = m_threshold;
+    double nthreshold = -m_negative.m_threshold;
+    int nwords = (m_xpix + 63) / 64;
+    for (int w=0; w < nwords; w++) {
+        const double* pix = values + 64 * w;
+        int      npix  = std::min(64, m_xpix - 64 * w);
+        uint64_t word  = 0;
+        uint64_t nword = 0;
+        for (int b=0; b < npix; b++) {
+            word  |= uint64_t(pix[b] > threshold) << b;
+            nword |= uint64_t(pix[b] < nthreshold) << b;
+        }
+        bits[w]          = word;
+        negative_bits[w] = nword;
+    }
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                     lutzDiffPass::Negative methods                      =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Constructor
+ *
+ * @param[in] parent        Detector whose scan drives this one
+ ****************************************************************/
+lutzDiffPass::Negative::Negative(lutzDiffPass& parent) :
+    lutzOnePass(),
+    m_parent(parent)
+{}
+
+
+/************************************************************//**
+ * @brief Return the negated difference at a given pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Minus the parent's value of the pixel
+ ****************************************************************/
+double lutzDiffPass::Negative::GetPixValue(int xbin, int ybin)
+{
+    return -m_parent.GetPixValue(xbin, ybin);
+}
+
+
+/************************************************************//**
+ * @brief Assess whether or not this pixel is an image pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Whether the negated difference is above threshold
+ ****************************************************************/
+bool lutzDiffPass::Negative::AssessPixel(int xbin, int ybin)
+{
+    return (GetPixValue(xbin, ybin) > m_threshold);
+}
+
+
+/************************************************************//**
+ * @brief Return whether the scan may read the rows of m_image directly
+ *
+ * @return Always false, since the pixel values are negated differences
+ ****************************************************************/
+bool lutzDiffPass::Negative::HasDirectRows() const
+{
+    return false;
+}
+
+
+/************************************************************//**
+ * @brief Get ready for the parent's scan, as run() would
+ ****************************************************************/
+void lutzDiffPass::Negative::Start()
+{
+    init_members();
+    if (m_queue) m_queue->open();
+}
+
+
+/************************************************************//**
+ * @brief Complete the objects after the parent's scan, as run() would
+ ****************************************************************/
+void lutzDiffPass::Negative::Finish()
+{
+    StoreClearance();
+    if (m_config.m_maxobjects > 0) FinishBrightest();
+    if (m_queue) m_queue->close();
+}
@@ -0,0 +1,134 @@
+/***************************************************************************
+ *  lutzMaskPass.cpp - Lutz one pass algorithm on a bit-packed mask        *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzMaskPass.cpp
+ * @brief Implements the lutzMaskPass class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include "lutzMaskPass.hpp"
+#include "lutzTrace.hpp"
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzMaskPass::lutzMaskPass() :
+    lutzOnePass(),
+    m_mask(nullptr),
+    m_stride(0)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from a mask
+ *
+ * @param[in] mask          Bit-packed mask, rows packed tightly
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ ****************************************************************/
+lutzMaskPass::lutzMaskPass(const uint64_t* mask,
+                           int xpixels, int ypixels) :
+    lutzOnePass(nullptr, xpixels, ypixels),
+    m_mask(mask),
+    m_stride(0)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzMaskPass::~lutzMaskPass()
+{}
+
+
+/************************************************************//**
+ * @brief Return value of given pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Value from the image if one was supplied, otherwise 1
+ ****************************************************************/
+double lutzMaskPass::GetPixValue(int xbin, int ybin)
+{
+    if (m_image == nullptr) return 1.0;
+    return lutzOnePass::GetPixValue(xbin, ybin);
+}
+
+
+/************************************************************//**
+ * @brief Assess whether or not this pixel is an image pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Whether the pixel's bit is set in the mask
+ ****************************************************************/
+bool lutzMaskPass::AssessPixel(int xbin, int ybin)
+{
+    uint64_t word = m_mask[ybin * RowStride() + (xbin >> 6)];
+    return (word >> (xbin & 63)) & 1;
+}
+
+
+/************************************************************//**
+ * @brief Return whether the scan may read the rows of m_image directly
+ *
+ * @return Always false, since image pixels are set by the mask
+ ****************************************************************/
+bool lutzMaskPass::HasDirectRows() const
+{
+    return false;
+}
+
+
+/************************************************************//**
+ * @brief Scan the mask, visiting only the pixels that matter
+ *
+ * Rows are handed straight to ScanBitRow(), which only advances the
+ * algorithm where it can change state. When bad pixels have to be
+ * handled, each row is first copied so the bad pixels can be applied
+ * without touching the caller's mask.
+ ****************************************************************/
+void lutzMaskPass::ScanImage()
+{
+    int co(0), pstop(0);
+    int stride = RowStride();
+    int nwords = WordsPerRow(m_xpix);
+    bool find_nans = m_check_bad && (m_image != nullptr);
+    if (m_bad_rows) m_ROWBITS.assign(2 * nwords, 0);
+    LUTZ_TRACE_ROWS();
+
+    for (int yindx=0; yindx < m_ypix; yindx++) {
+        LUTZ_TRACE_ROW(yindx);
+        const uint64_t* cur  = m_mask + yindx * stride;
+        const uint64_t* prev = (yindx > 0) ? (cur - stride) : nullptr;
+
+        if (m_bad_rows) {
+            uint64_t* bits = &m_ROWBITS[(yindx & 1) * nwords];
+            std::copy(cur, cur + nwords, bits);
+            if (find_nans) FindNaNs(m_image + size_t(yindx) * m_xpix, m_NANBITS.data());
+            ApplyBadPixels(yindx, find_nans ? m_NANBITS.data() : nullptr, bits);
+            cur  = bits;
+            prev = (yindx > 0) ? &m_ROWBITS[((yindx - 1) & 1) * nwords] : nullptr;
+        }
+        ScanBitRow(cur, prev, yindx, co, pstop);
+    }
+}
@@ -0,0 +1,376 @@
+/***************************************************************************
+ *  lutzMeasure.cpp - Parallel measurement of detected objects             *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzMeasure.cpp
+ * @brief Implements the lutzMeasure class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include "lutzMeasure.hpp"
+#include "lutzTrace.hpp"
+
+
+/************************************************************//**
+ * @brief Constructor
+ *
+ * @param[in] features      Combination of LUTZ_FEATURE values
+ ****************************************************************/
+lutzMeasure::lutzMeasure(unsigned features) :
+    m_features(features),
+    m_nthreads(0),
+    m_grain(16384)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzMeasure::~lutzMeasure()
+{}
+
+
+/************************************************************//**
+ * @brief Measure every object into one row of the catalog each
+ *
+ * @param[in] objects       Objects, e.g. from lutzOnePass::GetObjects()
+ * @param[out] catalog      Table with one row per object, in order
+ ****************************************************************/
+void lutzMeasure::run(const std::vector<lutzObject>& objects,
+                      lutzCatalog& catalog)
+{
+    LUTZ_TRACE_SCOPE("measure");
+    catalog.resize(objects.size(), Columns());
+    PlanTasks(objects);
+
+    int nthreads = m_nthreads;
+    if (nthreads <= 0) nthreads = std::thread::hardware_concurrency();
+    if (nthreads > int(m_tasks.size())) nthreads = m_tasks.size();
+    if (nthreads < 1) nthreads = 1;
+
+    // Each thread takes the next task until there are none left
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        size_t t;
+        while ((t = next.fetch_add(1)) < m_tasks.size()) {
+            RunTask(m_tasks[t], objects, catalog);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i=1; i < nthreads; i++) threads.push_back(std::thread(worker));
+    worker();
+    for (int i=0; i < threads.size(); i++) threads[i].join();
+
+    // Combine the slices of the large objects, in order
+    for (int t=0; t < m_tasks.size(); t++) {
+        const Task& task = m_tasks[t];
+        if ((task.m_part < 0) || (task.m_begin > 0)) continue;
+        Sums sums = m_parts[task.m_part];
+        for (int p=t+1; (p < m_tasks.size()) && (m_tasks[p].m_first == task.m_first) &&
+                        (m_tasks[p].m_part >= 0); p++) {
+            sums.merge(m_parts[m_tasks[p].m_part]);
+        }
+        Finish(objects[task.m_first], sums, task.m_first, catalog);
+    }
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Cut the work into tasks of about m_grain pixels
+ *
+ * @param[in] objects       Objects to be measured
+ ****************************************************************/
+void lutzMeasure::PlanTasks(const std::vector<lutzObject>& objects)
+{
+    m_tasks.clear();
+    int nparts = 0;
+    int nobjects = objects.size();
+
+    int first  = 0;
+    size_t npix = 0;
+    for (int i=0; i < nobjects; i++) {
+        int size = objects[i].size();
+
+        // Slice up an object too large for one task
+        if (size > m_grain) {
+            if (i > first) {
+                Task task = {first, i, 0, 0, -1};
+                m_tasks.push_back(task);
+            }
+            for (int begin=0; begin < size; begin += m_grain) {
+                int end = (size - begin > m_grain) ? begin + m_grain : size;
+                Task task = {i, i + 1, begin, end, nparts++};
+                m_tasks.push_back(task);
+            }
+            first = i + 1;
+            npix  = 0;
+            continue;
+        }
+
+        // Otherwise gather objects until there are enough pixels
+        npix += (size > 0) ? size : 1;
+        if (npix >= m_grain) {
+            Task task = {first, i + 1, 0, 0, -1};
+            m_tasks.push_back(task);
+            first = i + 1;
+            npix  = 0;
+        }
+    }
+    if (first < nobjects) {
+        Task task = {first, nobjects, 0, 0, -1};
+        m_tasks.push_back(task);
+    }
+
+    m_parts.resize(nparts);
+}
+
+
+/************************************************************//**
+ * @brief Carry out one task
+ *
+ * @param[in] task          Task
+ * @param[in] objects       Objects to be measured
+ * @param[out] catalog      Table of results
+ ****************************************************************/
+void lutzMeasure::RunTask(const Task& task,
+                          const std::vector<lutzObject>& objects,
+                          lutzCatalog& catalog)
+{
+    if (task.m_part >= 0) {
+        Sums& sums = m_parts[task.m_part];
+        sums.clear();
+        Accumulate(objects[task.m_first], task.m_begin, task.m_end, sums);
+        return;
+    }
+
+    Sums sums;
+    for (int i=task.m_first; i < task.m_last; i++) {
+        sums.clear();
+        Accumulate(objects[i], 0, objects[i].size(), sums);
+        Finish(objects[i], sums, i, catalog);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Add some of the pixels of an object to a set of sums
+ *
+ * @param[in] object        Object
+ * @param[in] begin         First pixel
+ * @param[in] end           One past the last pixel
+ * @param[in,out] sums      Sums to add to
+ *
+ * Positions are taken from the corner of the object's bounding box, so
+ * that the second moments do not lose precision far from the origin.
+ ****************************************************************/
+void lutzMeasure::Accumulate(const lutzObject& object, int begin, int end,
+                             Sums& sums) const
+{
+    const bool second = (m_features & (FEATURE_MOMENTS | FEATURE_ELLIPSE));
+    const int  x0 = object.GetXMin();
+    const int  y0 = object.GetYMin();
+
+    for (int p=begin; p < end; p++) {
+        const lutzObject::pixData& pixel = object[p];
+        double x = pixel.m_xbin - x0;
+        double y = pixel.m_ybin - y0;
+        double w = pixel.m_scale * pixel.m_value;
+
+        sums.m_w  += w;
+        sums.m_wx += w * x;
+        sums.m_wy += w * y;
+        sums.m_n  += 1.0;
+        sums.m_x  += x;
+        sums.m_y  += y;
+        if (second) {
+            sums.m_wxx += w * x * x;
+            sums.m_wyy += w * y * y;
+            sums.m_wxy += w * x * y;
+            sums.m_xx  += x * x;
+            sums.m_yy  += y * y;
+            sums.m_xy  += x * y;
+        }
+        sums.m_flux += pixel.m_value;
+        if (pixel.m_value > sums.m_peak) {
+            sums.m_peak  = pixel.m_value;
+            sums.m_xpeak = pixel.m_xbin;
+            sums.m_ypeak = pixel.m_ybin;
+        }
+    }
+}
+
+
+/************************************************************//**
+ * @brief Turn the sums of an object into its row of the catalog
+ *
+ * @param[in] object        Object
+ * @param[in] sums          Sums over all of the object's pixels
+ * @param[in] row           Row of the catalog
+ * @param[out] catalog      Table of results
+ ****************************************************************/
+void lutzMeasure::Finish(const lutzObject& object, const Sums& sums,
+                         size_t row, lutzCatalog& catalog) const
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    double x, y, xx, yy, xy, flux, peak, xpeak, ypeak;
+
+    if ((object.size() == 0) && (object.NumPixels() > 0)) {
+        // Only the summary of a truncated object is known
+        x  = 0.5 * (object.GetXMin() + object.GetXMax());
+        y  = 0.5 * (object.GetYMin() + object.GetYMax());
+        xx = yy = xy = nan;
+        flux  = object.Sum();
+        peak  = object.GetMaximum();
+        xpeak = ypeak = nan;
+    } else {
+        // Fall back to equal weights as lutzObject::centroid() does
+        bool   weighted = (sums.m_w > 0.0);
+        double s  = weighted ? sums.m_w  : sums.m_n;
+        double mx = (weighted ? sums.m_wx : sums.m_x) / s;
+        double my = (weighted ? sums.m_wy : sums.m_y) / s;
+        x  = object.GetXMin() + mx;
+        y  = object.GetYMin() + my;
+        xx = (weighted ? sums.m_wxx : sums.m_xx) / s - mx * mx;
+        yy = (weighted ? sums.m_wyy : sums.m_yy) / s - my * my;
+        xy = (weighted ? sums.m_wxy : sums.m_xy) / s - mx * my;
+        flux  = sums.m_flux;
+        peak  = sums.m_peak;
+        xpeak = sums.m_xpeak;
+        ypeak = sums.m_ypeak;
+    }
+
+    if (m_features & FEATURE_CENTROID) {
+        catalog.GetColumn(lutzCatalog::COL_X)[row] = x;
+        catalog.GetColumn(lutzCatalog::COL_Y)[row] = y;
+    }
+    if (m_features & (FEATURE_MOMENTS | FEATURE_ELLIPSE)) {
+        catalog.GetColumn(lutzCatalog::COL_XX)[row] = xx;
+        catalog.GetColumn(lutzCatalog::COL_YY)[row] = yy;
+        catalog.GetColumn(lutzCatalog::COL_XY)[row] = xy;
+    }
+    if (m_features & FEATURE_ELLIPSE) {
+        double mean = 0.5 * (xx + yy);
+        double root = std::sqrt(0.25 * (xx - yy) * (xx - yy) + xy * xy);
+        catalog.GetColumn(lutzCatalog::COL_A)[row] = std::sqrt(mean + root);
+        catalog.GetColumn(lutzCatalog::COL_B)[row] = std::sqrt(std::max(mean - root, 0.0));
+        catalog.GetColumn(lutzCatalog::COL_THETA)[row] = 0.5 * std::atan2(2.0 * xy, xx - yy);
+    }
+    if (m_features & FEATURE_FLUX) {
+        catalog.GetColumn(lutzCatalog::COL_FLUX)[row] = flux;
+        catalog.GetColumn(lutzCatalog::COL_NPIX)[row] = object.NumPixels();
+    }
+    if (m_features & FEATURE_PEAK) {
+        catalog.GetColumn(lutzCatalog::COL_PEAK)[row]  = peak;
+        catalog.GetColumn(lutzCatalog::COL_XPEAK)[row] = xpeak;
+        catalog.GetColumn(lutzCatalog::COL_YPEAK)[row] = ypeak;
+    }
+}
+
+
+/************************************************************//**
+ * @brief Return the catalog columns filled for the chosen features
+ *
+ * @return Bit (1 << column) set for each column
+ ****************************************************************/
+unsigned lutzMeasure::Columns() const
+{
+    unsigned columns = 0;
+    if (m_features & FEATURE_CENTROID) {
+        columns |= (1u << lutzCatalog::COL_X) | (1u << lutzCatalog::COL_Y);
+    }
+    if (m_features & (FEATURE_MOMENTS | FEATURE_ELLIPSE)) {
+        columns |= (1u << lutzCatalog::COL_XX) | (1u << lutzCatalog::COL_YY) |
+                   (1u << lutzCatalog::COL_XY);
+    }
+    if (m_features & FEATURE_ELLIPSE) {
+        columns |= (1u << lutzCatalog::COL_A) | (1u << lutzCatalog::COL_B) |
+                   (1u << lutzCatalog::COL_THETA);
+    }
+    if (m_features & FEATURE_FLUX) {
+        columns |= (1u << lutzCatalog::COL_FLUX) | (1u << lutzCatalog::COL_NPIX);
+    }
+    if (m_features & FEATURE_PEAK) {
+        columns |= (1u << lutzCatalog::COL_PEAK) | (1u << lutzCatalog::COL_XPEAK) |
+                   (1u << lutzCatalog::COL_YPEAK);
+    }
+    return columns;
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                        lutzMeasure::Sums methods                        =
+ =                                                                         =
+ ==========================================================================*/
+
+/***************************************************************//**
+ * @brief Reset all of the sums
+ *******************************************************************/
+void lutzMeasure::Sums::clear()
+{
+    m_w = m_wx = m_wy = m_wxx = m_wyy = m_wxy = 0.0;
+    m_n = m_x  = m_y  = m_xx  = m_yy  = m_xy  = 0.0;
+    m_flux  = 0.0;
+    m_peak  = -std::numeric_limits<double>::infinity();
+    m_xpeak = 0;
+    m_ypeak = 0;
+}
+
+
+/***************************************************************//**
+ * @brief Add the sums over a later slice of the same object
+ *
+ * @param[in] other         Sums to add
+ *
+ * On a tie the brightest pixel found first is kept, as in a single pass.
+ *******************************************************************/
+void lutzMeasure::Sums::merge(const Sums& other)
+{
+    m_w   += other.m_w;
+    m_wx  += other.m_wx;
+    m_wy  += other.m_wy;
+    m_wxx += other.m_wxx;
+    m_wyy += other.m_wyy;
+    m_wxy += other.m_wxy;
+    m_n   += other.m_n;
+    m_x   += other.m_x;
+    m_y   += other.m_y;
+    m_xx  += other.m_xx;
+    m_yy  += other.m_yy;
+    m_xy  += other.m_xy;
+    m_flux += other.m_flux;
+    if (other.m_peak > m_peak) {
+        m_peak  = other.m_peak;
+        m_xpeak = other.m_xpeak;
+        m_ypeak = other.m_ypeak;
+    }
+}
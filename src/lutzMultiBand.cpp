@@ -0,0 +1,278 @@
+/***************************************************************************
+ *  lutzMultiBand.cpp - Lutz one pass algorithm on several bands at once   *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzMultiBand.cpp
+ * @brief Implements the lutzMultiBand class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "lutzMultiBand.hpp"
+#include "lutzTrace.hpp"
+
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzMultiBand::lutzMultiBand() :
+    lutzOnePass(),
+    m_combine(COMBINE_CHI2),
+    m_norm(1.0),
+    m_row(-1)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from the image size
+ *
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ *
+ * Bands are supplied afterwards with AddBand().
+ ****************************************************************/
+lutzMultiBand::lutzMultiBand(int xpixels, int ypixels) :
+    lutzOnePass(nullptr, xpixels, ypixels),
+    m_combine(COMBINE_CHI2),
+    m_norm(1.0),
+    m_row(-1)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzMultiBand::~lutzMultiBand()
+{}
+
+
+/************************************************************//**
+ * @brief Add a band to be combined
+ *
+ * @param[in] image         Band values, aligned with the other bands
+ * @param[in] weight        Weight of the band
+ * @param[in] noise         Noise level of the band
+ * @param[in] noise_map     Per-pixel noise level, used instead of noise
+ *                          when supplied
+ * @return Whether the band was added. Without a noise map the noise
+ *         level must be above 0.
+ ****************************************************************/
+bool lutzMultiBand::AddBand(const double* image, double weight,
+                            double noise, const double* noise_map)
+{
+    // The band would divide by a noise of zero (or less) at every pixel
+    if ((noise_map == nullptr) && !(noise > 0.0)) return false;
+
+    Band band;
+    band.m_image     = image;
+    band.m_weight    = weight;
+    band.m_noise     = noise;
+    band.m_noise_map = noise_map;
+    band.m_scale     = 0.0;
+    m_bands.push_back(band);
+    UpdateFactors();
+    return true;
+}
+
+
+/************************************************************//**
+ * @brief Remove all of the bands
+ ****************************************************************/
+void lutzMultiBand::ClearBands()
+{
+    m_bands.clear();
+    UpdateFactors();
+}
+
+
+/************************************************************//**
+ * @brief Set how the bands are combined
+ *
+ * @param[in] combine       COMBINE_CHI2 (default) or COMBINE_WEIGHTED_SUM
+ ****************************************************************/
+void lutzMultiBand::SetCombination(LUTZ_COMBINE combine)
+{
+    m_combine = combine;
+    UpdateFactors();
+}
+
+
+/************************************************************//**
+ * @brief Return the detection statistic of a given pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Combined value of the pixel over all bands
+ *
+ * During the scan the statistic of the current row has already been
+ * computed, so it is simply looked up.
+ ****************************************************************/
+double lutzMultiBand::GetPixValue(int xbin, int ybin)
+{
+    if (ybin == m_row) return m_rowvalues[xbin];
+
+    size_t index = size_t(ybin) * m_xpix + xbin;
+    double value = 0.0;
+    for (int b=0; b<m_bands.size(); b++) {
+        value += BandTerm(m_bands[b], index);
+    }
+    if (m_combine == COMBINE_WEIGHTED_SUM) value *= m_norm;
+    return value;
+}
+
+
+/************************************************************//**
+ * @brief Assess whether or not this pixel is an image pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Whether the detection statistic is above threshold
+ ****************************************************************/
+bool lutzMultiBand::AssessPixel(int xbin, int ybin)
+{
+    return (GetPixValue(xbin, ybin) > m_threshold);
+}
+
+
+/************************************************************//**
+ * @brief Return whether the scan may read the rows of m_image directly
+ *
+ * @return Always false, since the pixel values combine several bands
+ ****************************************************************/
+bool lutzMultiBand::HasDirectRows() const
+{
+    return false;
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Initialize the data structures
+ ****************************************************************/
+void lutzMultiBand::init_members()
+{
+    lutzOnePass::init_members();
+    m_rowvalues.assign(m_xpix, 0.0);
+    m_row = -1;
+}
+
+
+/************************************************************//**
+ * @brief Recompute the factors applied to each band
+ ****************************************************************/
+void lutzMultiBand::UpdateFactors()
+{
+    double weight2 = 0.0;
+    for (int b=0; b<m_bands.size(); b++) {
+        Band& band = m_bands[b];
+        band.m_scale = (m_combine == COMBINE_CHI2) ?
+                       band.m_weight / (band.m_noise * band.m_noise) :
+                       band.m_weight / band.m_noise;
+        weight2 += band.m_weight * band.m_weight;
+    }
+    m_norm = (weight2 > 0.0) ? 1.0 / std::sqrt(weight2) : 1.0;
+}
+
+
+/************************************************************//**
+ * @brief Scan the bands, combining them one row at a time
+ ****************************************************************/
+void lutzMultiBand::ScanImage()
+{
+    int co(0), pstop(0);
+    int nwords = (m_xpix + 63) / 64;
+    m_ROWBITS.assign(2 * nwords, 0);
+    LUTZ_TRACE_ROWS();
+
+    for (int yindx=0; yindx < m_ypix; yindx++) {
+
+        LUTZ_TRACE_ROW(yindx);
+        uint64_t* cur  = &m_ROWBITS[(yindx & 1) * nwords];
+        uint64_t* prev = (yindx > 0) ? &m_ROWBITS[((yindx - 1) & 1) * nwords] : nullptr;
+
+        // Combine the bands and threshold the result into bits
+        CombineRow(yindx, m_rowvalues.data());
+        m_row = yindx;
+        ThresholdRow(m_rowvalues.data(), cur);
+        if (m_adaptive) m_background.addRow(m_rowvalues.data(), m_xpix, yindx);
+        if (m_bad_rows) {
+            if (m_check_bad) FindNaNs(m_rowvalues.data(), m_NANBITS.data());
+            ApplyBadPixels(yindx, m_check_bad ? m_NANBITS.data() : nullptr, cur);
+        }
+
+        ScanBitRow(cur, prev, yindx, co, pstop);
+    }
+    m_row = -1;
+}
+
+
+/************************************************************//**
+ * @brief Build a lutzObject and attach the band values of its pixels
+ *
+ * @param[in] obj           Completed object
+ * @param[out] object       Object to be filled
+ ****************************************************************/
+void lutzMultiBand::BuildObject(ObjectInfo& obj, lutzObject& object)
+{
+    lutzOnePass::BuildObject(obj, object);
+    if (object.size() == 0) return;
+
+    int nbands = m_bands.size();
+    std::vector<double> values(object.size() * nbands);
+    for (int i=0; i<object.size(); i++) {
+        size_t index = size_t(object[i].m_ybin) * m_xpix + object[i].m_xbin;
+        for (int b=0; b<nbands; b++) {
+            values[size_t(i) * nbands + b] = m_bands[b].m_image[index];
+        }
+    }
+    object.SetBandValues(nbands, values);
+}
+
+
+/************************************************************//**
+ * @brief Compute the detection statistic of every pixel on a row
+ *
+ * @param[in] yindx         Row to combine
+ * @param[out] values       m_xpix values to be filled
+ *
+ * The bands are taken one at a time, so each is read in order.
+ ****************************************************************/
+void lutzMultiBand::CombineRow(int yindx, double* values) const
+{
+    size_t offset = size_t(yindx) * m_xpix;
+    std::fill(values, values + m_xpix, 0.0);
+
+    for (int b=0; b<m_bands.size(); b++) {
+        const Band& band = m_bands[b];
+        for (int xindx=0; xindx < m_xpix; xindx++) {
+            values[xindx] += BandTerm(band, offset + xindx);
+        }
+    }
+
+    if (m_combine == COMBINE_WEIGHTED_SUM) {
+        for (int xindx=0; xindx < m_xpix; xindx++) values[xindx] *= m_norm;
+    }
+}
@@ -60,6 +60,19 @@ lutzObject::lutzObject(const lutzObject& other)
 }
 
 
+/***************************************************************//**
+ * @brief Move constructor
+ *
+ * @param[in] other     Another lutzObject whose contents are taken over
+ *                      (left empty)
+ *******************************************************************/
+lutzObject::lutzObject(lutzObject&& other) noexcept
+{
+    clear();
+    swap(other);
+}
+
+
 /***************************************************************//**
  * @brief Deconstructor
  *******************************************************************/
@@ -67,6 +80,37 @@ lutzObject::~lutzObject()
 {}
 
 
+/***************************************************************//**
+ * @brief Copy assignment operator
+ *
+ * @param[in] other     Another lutzObject to be copied
+ * @return This object
+ *******************************************************************/
+lutzObject& lutzObject::operator=(const lutzObject& other)
+{
+    if (this != &other) copy_members(other);
+    return *this;
+}
+
+
+/***************************************************************//**
+ * @brief Move assignment operator
+ *
+ * @param[in] other     Another lutzObject whose contents are taken over.
+ *                      It is left holding this object's old contents, so
+ *                      that their storage can be reused.
+ * @return This object
+ *
+ * Without this the heap of brightest objects in lutzOnePass would copy
+ * every pixel list it shifts.
+ *******************************************************************/
+lutzObject& lutzObject::operator=(lutzObject&& other) noexcept
+{
+    swap(other);
+    return *this;
+}
+
+
 /***************************************************************//**
  * @brief Append a single pixel to this object
  *
@@ -86,6 +130,10 @@ void lutzObject::append(const pixData& pixel)
     if (pixel.m_value > m_value_max) m_value_max = pixel.m_value;
     m_pixInfo.push_back(pixel);
     m_value_sum += pixel.m_value;
+    m_npix++;
+    
+    // Keep the band values lined up with the pixels
+    if (m_nbands > 0) m_bandInfo.resize(m_bandInfo.size() + m_nbands, 0.0);
 }
 
 /***************************************************************//**
@@ -101,6 +149,33 @@ void lutzObject::append(std::vector<pixData>& pixels)
     }
 }
 
+/***************************************************************//**
+ * @brief Replace the pixels of this object with a list of distinct pixels
+ *
+ * @param[in] pixels        Pixels, each at a different position
+ *
+ * Unlike append(), the pixels are not checked against those already in
+ * the object, which makes filling an object from a detector's pixel list
+ * linear in its size. Any band values and flags are cleared.
+ *******************************************************************/
+void lutzObject::assign(const std::vector<pixData>& pixels)
+{
+    clear();
+    m_pixInfo.assign(pixels.begin(), pixels.end());
+    for (int i=0; i<pixels.size(); i++) {
+        const pixData& pixel = pixels[i];
+        if (pixel.m_xbin < m_xmin) m_xmin = pixel.m_xbin;
+        if (pixel.m_xbin > m_xmax) m_xmax = pixel.m_xbin;
+        if (pixel.m_ybin < m_ymin) m_ymin = pixel.m_ybin;
+        if (pixel.m_ybin > m_ymax) m_ymax = pixel.m_ybin;
+        if (pixel.m_value < m_value_min) m_value_min = pixel.m_value;
+        if (pixel.m_value > m_value_max) m_value_max = pixel.m_value;
+        m_value_sum += pixel.m_value;
+    }
+    m_npix = pixels.size();
+}
+
+
 /***************************************************************//**
  * @brief Remove a single pixel from the container
  *
@@ -110,6 +185,11 @@ void lutzObject::remove(const int& index)
 {
     m_value_sum -= m_pixInfo[index];
     m_pixInfo.erase(m_pixInfo.begin() + index);
+    m_npix--;
+    if (m_nbands > 0) {
+        m_bandInfo.erase(m_bandInfo.begin() + size_t(index) * m_nbands,
+                         m_bandInfo.begin() + size_t(index + 1) * m_nbands);
+    }
 }
 
 
@@ -126,6 +206,93 @@ void lutzObject::clear()
     m_value_min = 1.0e30;
     m_value_max = -1.0e30;
     m_value_sum = 0.0;
+    m_npix = 0;
+    m_flags = 0;
+    m_nbands = 0;
+    m_bandInfo.clear();
+}
+
+
+/***************************************************************//**
+ * @brief Sort pixels from lowest value to largest value
+ *
+ * Any band values are reordered along with their pixels.
+ *******************************************************************/
+void lutzObject::sort()
+{
+    if (m_nbands == 0) {
+        std::sort(m_pixInfo.begin(), m_pixInfo.end());
+        return;
+    }
+    
+    // Sort an index so the band values can follow their pixels
+    std::vector<int> order(m_pixInfo.size());
+    for (int i=0; i<order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_pixInfo[a] < m_pixInfo[b];
+    });
+    
+    std::vector<pixData> pixels(order.size());
+    std::vector<double>  bands(m_bandInfo.size());
+    for (int i=0; i<order.size(); i++) {
+        pixels[i] = m_pixInfo[order[i]];
+        std::copy(m_bandInfo.begin() + size_t(order[i]) * m_nbands,
+                  m_bandInfo.begin() + size_t(order[i] + 1) * m_nbands,
+                  bands.begin() + size_t(i) * m_nbands);
+    }
+    m_pixInfo.swap(pixels);
+    m_bandInfo.swap(bands);
+}
+
+
+/***************************************************************//**
+ * @brief Attach per-band values to the pixels of this object
+ *
+ * @param[in] nbands        Number of values per pixel
+ * @param[in] values        nbands values for each pixel, in pixel order
+ *                          (taken over, leaving the vector empty)
+ *
+ * Pixels appended afterwards get band values of 0.
+ *******************************************************************/
+void lutzObject::SetBandValues(int nbands, std::vector<double>& values)
+{
+    m_nbands = nbands;
+    m_bandInfo.clear();
+    m_bandInfo.swap(values);
+}
+
+
+/***************************************************************//**
+ * @brief Replace the contents of this object with a summary
+ *
+ * @param[in] npix          Number of pixels
+ * @param[in] xmin          minimum pixel position in x
+ * @param[in] xmax          maximum pixel position in x
+ * @param[in] ymin          minimum pixel position in y
+ * @param[in] ymax          maximum pixel position in y
+ * @param[in] value_min     minimum pixel value
+ * @param[in] value_max     maximum pixel value
+ * @param[in] value_sum     Sum of all pixel values
+ *
+ * The object is left without a pixel list, as happens when the detector
+ * drops the pixels of an object to stay within its memory limits. The
+ * flags are not changed.
+ *******************************************************************/
+void lutzObject::SetSummary(int npix, int xmin, int xmax, int ymin, int ymax,
+                            double value_min, double value_max,
+                            double value_sum)
+{
+    std::vector<pixData>().swap(m_pixInfo);
+    std::vector<double>().swap(m_bandInfo);
+    m_nbands = 0;
+    m_npix = npix;
+    m_xmin = xmin;
+    m_xmax = xmax;
+    m_ymin = ymin;
+    m_ymax = ymax;
+    m_value_min = value_min;
+    m_value_max = value_max;
+    m_value_sum = value_sum;
 }
 
 
@@ -150,10 +317,18 @@ void lutzObject::clear()
  *      xcenter = \frac{1}{\sum_{n=1}^{nbins}w_{n}} \sum_{n=1}^{nbins} w_{n} x_{n}
  *      ycenter = \frac{1}{Nbins} \sum_{n=1}^{nbins} y_{n}
  * \f]
+ * An object that only holds a summary returns the centre of its
+ * bounding box.
  ************************************************************************/
 void lutzObject::centroid(double& xcenter, double& ycenter,
-                          bool weight_bins)
+                          bool weight_bins) const
 {
+    if (m_pixInfo.empty() && (m_npix > 0)) {
+        xcenter = 0.5 * (m_xmin + m_xmax);
+        ycenter = 0.5 * (m_ymin + m_ymax);
+        return;
+    }
+
     // Initialize the sum of weights and reset the center positions
     double weight_sum(0.0);
     xcenter = 0.0;
@@ -179,7 +354,7 @@ void lutzObject::centroid(double& xcenter, double& ycenter,
         ycenter /= weight_sum;
     }
     // Otherwise recompute the centroid without weights
-    else {
+    else if (weight_bins) {
         centroid(xcenter, ycenter, false);
     }
     
@@ -224,6 +399,31 @@ bool lutzObject::overlaps(const lutzObject& other) const
 }
 
 
+/***************************************************************//**
+ * @brief Exchange the contents of this object with another
+ *
+ * @param[in] other         Another lutzObject to swap contents with
+ *
+ * Unlike copying, this does not duplicate the pixel container, which
+ * makes it the cheap way to hand an object from one owner to another.
+ *******************************************************************/
+void lutzObject::swap(lutzObject& other)
+{
+    std::swap(m_xmin, other.m_xmin);
+    std::swap(m_xmax, other.m_xmax);
+    std::swap(m_ymin, other.m_ymin);
+    std::swap(m_ymax, other.m_ymax);
+    std::swap(m_value_min, other.m_value_min);
+    std::swap(m_value_max, other.m_value_max);
+    std::swap(m_value_sum, other.m_value_sum);
+    std::swap(m_npix, other.m_npix);
+    std::swap(m_flags, other.m_flags);
+    std::swap(m_nbands, other.m_nbands);
+    m_pixInfo.swap(other.m_pixInfo);
+    m_bandInfo.swap(other.m_bandInfo);
+}
+
+
 /*==========================================================================
  =                                                                         =
  =                           Protected methods                             =
@@ -246,7 +446,11 @@ void lutzObject::copy_members(const lutzObject& other)
     m_value_min = other.m_value_min;
     m_value_max = other.m_value_max;
     m_value_sum = other.m_value_sum;
+    m_npix = other.m_npix;
+    m_flags = other.m_flags;
+    m_nbands = other.m_nbands;
     m_pixInfo = other.m_pixInfo;
+    m_bandInfo = other.m_bandInfo;
 }
 
 
@@ -0,0 +1,124 @@
+/***************************************************************************
+ *  lutzObjectFilter.cpp - Cuts applied to objects during the scan         *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzObjectFilter.cpp
+ * @brief Implements the lutzObjectFilter class
+ * @author Josh Cardenzana
+ */
+
+#include <cmath>
+#include <limits>
+#include "lutzObjectFilter.hpp"
+
+
+/************************************************************//**
+ * @brief Constructor, with every cut off
+ ****************************************************************/
+lutzObjectFilter::lutzObjectFilter() :
+    m_npixmin(0),
+    m_npixmax(0),
+    m_xextent(0),
+    m_yextent(0),
+    m_elongation(0.0),
+    m_peakmin(-std::numeric_limits<double>::infinity()),
+    m_peakmax(std::numeric_limits<double>::infinity()),
+    m_reject_edges(false)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzObjectFilter::~lutzObjectFilter()
+{}
+
+
+/************************************************************//**
+ * @brief Return whether a complete object is kept
+ *
+ * @param[in] obj           Running statistics of the object
+ * @param[in] xpixels       Number of pixels in x of the image
+ * @param[in] ypixels       Number of pixels in y of the image
+ * @return Whether the object passes every cut
+ ****************************************************************/
+bool lutzObjectFilter::Accept(const lutzOnePass::ObjectInfo& obj,
+                              int xpixels, int ypixels) const
+{
+    if (Abort(obj, xpixels, ypixels)) return false;
+    if (obj.m_npix < m_npixmin) return false;
+    if (obj.m_peak < m_peakmin) return false;
+    if ((m_elongation > 0.0) && (Elongation(obj) > m_elongation)) return false;
+    return true;
+}
+
+
+/************************************************************//**
+ * @brief Return whether an open object can already be dropped
+ *
+ * @param[in] obj           Running statistics of the object so far
+ * @param[in] xpixels       Number of pixels in x of the image
+ * @param[in] ypixels       Number of pixels in y of the image
+ * @return Whether no object containing this one could be accepted
+ ****************************************************************/
+bool lutzObjectFilter::Abort(const lutzOnePass::ObjectInfo& obj,
+                             int xpixels, int ypixels) const
+{
+    if ((m_xextent > 0) && (obj.m_xmax - obj.m_xmin + 1 > m_xextent)) return true;
+    if ((m_yextent > 0) && (obj.m_ymax - obj.m_ymin + 1 > m_yextent)) return true;
+    if ((m_npixmax > 0) && (obj.m_npix > m_npixmax)) return true;
+    if (obj.m_peak > m_peakmax) return true;
+    if (m_reject_edges &&
+        ((obj.m_xmin <= 0) || (obj.m_ymin <= 0) ||
+         (obj.m_xmax >= xpixels - 1) || (obj.m_ymax >= ypixels - 1))) {
+        return true;
+    }
+    return false;
+}
+
+
+/************************************************************//**
+ * @brief Return the elongation of an object
+ *
+ * @param[in] obj           Running statistics of the object
+ * @return Ratio of the major to the minor axis of the object's shape
+ *
+ * The axes come from the unweighted second moments of the pixel
+ * positions. Each pixel is taken as a square of uniform brightness,
+ * which adds 1/12 to both variances, so a single pixel or a line one
+ * pixel wide still has a finite elongation.
+ ****************************************************************/
+double lutzObjectFilter::Elongation(const lutzOnePass::ObjectInfo& obj)
+{
+    if (obj.m_npix == 0) return 1.0;
+
+    double n  = obj.m_npix;
+    double mx = obj.m_sx / n;
+    double my = obj.m_sy / n;
+    double xx = obj.m_sxx / n - mx * mx + 1.0 / 12.0;
+    double yy = obj.m_syy / n - my * my + 1.0 / 12.0;
+    double xy = obj.m_sxy / n - mx * my;
+
+    double mean = 0.5 * (xx + yy);
+    double root = std::sqrt(0.25 * (xx - yy) * (xx - yy) + xy * xy);
+    double minor = mean - root;
+    if (minor <= 0.0) return std::numeric_limits<double>::infinity();
+    return std::sqrt((mean + root) / minor);
+}
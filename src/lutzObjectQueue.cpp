@@ -0,0 +1,215 @@
+/***************************************************************************
+ *  lutzObjectQueue.cpp - Lock-free queue for handing off finished objects *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzObjectQueue.cpp
+ * @brief Implements the lutzObjectQueue class
+ * @author Josh Cardenzana
+ */
+
+#include <thread>
+#include "lutzObjectQueue.hpp"
+
+
+/************************************************************//**
+ * @brief Constructor
+ *
+ * @param[in] capacity      Number of objects the queue can hold. This is
+ *                          rounded up to the next power of two.
+ ****************************************************************/
+lutzObjectQueue::lutzObjectQueue(size_t capacity) :
+    m_mask(0),
+    m_enqueue_pos(0),
+    m_dequeue_pos(0),
+    m_frame(0),
+    m_closed(0)
+{
+    // Round the capacity up to a power of two so that positions can be
+    // mapped onto cells with a mask
+    size_t ncells = 2;
+    while (ncells < capacity) ncells <<= 1;
+    m_mask  = ncells - 1;
+    m_cells = std::unique_ptr<Cell[]>(new Cell[ncells]);
+
+    // Each cell starts out ready to be written at its own position
+    for (size_t i=0; i<ncells; i++) {
+        m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+        m_cells[i].m_frame.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzObjectQueue::~lutzObjectQueue()
+{}
+
+
+/************************************************************//**
+ * @brief Add an object to the queue if there is room
+ *
+ * @param[in,out] obj       Object to be queued. On success its contents
+ *                          are moved into the queue and obj is left empty.
+ * @return Whether the object was queued
+ ****************************************************************/
+bool lutzObjectQueue::try_push(lutzObject& obj)
+{
+    // Only one producer, so the enqueue position is ours alone
+    size_t pos  = m_enqueue_pos.load(std::memory_order_relaxed);
+    Cell&  cell = m_cells[pos & m_mask];
+    size_t seq  = cell.m_sequence.load(std::memory_order_acquire);
+
+    // The cell still holds an object that hasn't been consumed
+    if (seq != pos) return false;
+
+    m_enqueue_pos.store(pos + 1, std::memory_order_relaxed);
+    cell.m_object.clear();
+    cell.m_object.swap(obj);
+    cell.m_frame.store(m_frame.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+
+    // Publish the object to the consumers
+    cell.m_sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+
+/************************************************************//**
+ * @brief Add an object to the queue, waiting for room if necessary
+ *
+ * @param[in,out] obj       Object to be queued. Its contents are moved
+ *                          into the queue and obj is left empty.
+ ****************************************************************/
+void lutzObjectQueue::push(lutzObject& obj)
+{
+    while (!try_push(obj)) {
+        std::this_thread::yield();
+    }
+}
+
+
+/************************************************************//**
+ * @brief Take an object from the queue if one is available
+ *
+ * @param[out] obj          Filled with the dequeued object
+ * @param[in] frame         Only take an object of this frame (0 takes an
+ *                          object of any frame)
+ * @return Whether an object was dequeued
+ ****************************************************************/
+bool lutzObjectQueue::try_pop(lutzObject& obj, size_t frame)
+{
+    bool behind;
+    return take(obj, frame, behind);
+}
+
+
+/************************************************************//**
+ * @brief Take an object of a frame, waiting for one if necessary
+ *
+ * @param[out] obj          Filled with the dequeued object
+ * @param[in] frame         Frame to take an object from (see open())
+ * @return Whether an object was dequeued. False means the frame has been
+ *         closed and every object in it has been consumed.
+ ****************************************************************/
+bool lutzObjectQueue::pop(lutzObject& obj, size_t frame)
+{
+    for (;;) {
+        bool behind = false;
+        if (take(obj, frame, behind)) return true;
+
+        // Check once more after seeing the close, since the producer may
+        // have pushed its last objects just before closing. Objects of an
+        // earlier frame still ahead of this one mean it has not been
+        // reached yet, however long ago it was closed.
+        if (!behind && closed(frame)) {
+            if (take(obj, frame, behind)) return true;
+            if (!behind) return false;
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Take the object at the head of the queue if it may be taken
+ *
+ * @param[out] obj          Filled with the dequeued object
+ * @param[in] frame         Only take an object of this frame (0 takes an
+ *                          object of any frame)
+ * @param[out] behind       Set when the head holds an object of an earlier
+ *                          frame, which this consumer may not take
+ * @return Whether an object was dequeued
+ ****************************************************************/
+bool lutzObjectQueue::take(lutzObject& obj, size_t frame, bool& behind)
+{
+    behind = false;
+    size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    Cell*  cell;
+
+    for (;;) {
+        cell = &m_cells[pos & m_mask];
+        size_t seq = cell->m_sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t dif = std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1);
+
+        if (dif == 0) {
+            // Objects of a later frame wait for the consumers of that frame.
+            // The tag is only trusted if the cell was not taken and refilled
+            // while it was read.
+            if (frame != 0) {
+                size_t tag = cell->m_frame.load(std::memory_order_acquire);
+                if (cell->m_sequence.load(std::memory_order_relaxed) != seq) {
+                    pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (tag != frame) {
+                    behind = (tag < frame);
+                    return false;
+                }
+            }
+            
+            // The cell is filled, try to claim it before another consumer
+            if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                                    std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            // Nothing has been written here yet, the queue is empty
+            return false;
+        } else {
+            // Another consumer got here first
+            pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    obj.clear();
+    obj.swap(cell->m_object);
+
+    // Hand the cell back to the producer for the next lap of the ring
+    cell->m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
@@ -24,7 +24,32 @@
  * @author Josh Cardenzana
  */
 
+#include <algorithm>
+#include <cmath>
+#include "lutzObjectFilter.hpp"
 #include "lutzOnePass.hpp"
+#include "lutzTrace.hpp"
+
+namespace {
+
+/************************************************************//**
+ * @brief Return the position of the lowest set bit of a non-zero word
+ ****************************************************************/
+inline int count_trailing_zeros(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int n = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+} // namespace
 
 /************************************************************//**
  * @brief Default constructor
@@ -33,8 +58,28 @@ lutzOnePass::lutzOnePass() :
     m_image(nullptr),
     m_xpix(0),
     m_ypix(0),
-    m_threshold(0.0),
-    m_npixelmin(0)
+    m_queue(nullptr),
+    m_labels(nullptr),
+    m_label_pixels(true),
+    m_keep_pixels(true),
+    m_provisional(false),
+    m_nlabels(0),
+    m_limited(false),
+    m_open(0),
+    m_open_pixels(0),
+    m_retained(0),
+    m_ntruncated(0),
+    m_bad_mask(nullptr),
+    m_bad_bits(nullptr),
+    m_bad_stride(0),
+    m_bad_rows(false),
+    m_check_bad(false),
+    m_flag_excluded(false),
+    m_flag_row(false),
+    m_segment_start(0),
+    m_prev_segment_start(0),
+    m_adaptive(false),
+    m_threshold(0.0)
 {}
 
 
@@ -50,8 +95,28 @@ lutzOnePass::lutzOnePass(double* image,
     m_image(image),
     m_xpix(xpixels),
     m_ypix(ypixels),
-    m_threshold(0.0),
-    m_npixelmin(0)
+    m_queue(nullptr),
+    m_labels(nullptr),
+    m_label_pixels(true),
+    m_keep_pixels(true),
+    m_provisional(false),
+    m_nlabels(0),
+    m_limited(false),
+    m_open(0),
+    m_open_pixels(0),
+    m_retained(0),
+    m_ntruncated(0),
+    m_bad_mask(nullptr),
+    m_bad_bits(nullptr),
+    m_bad_stride(0),
+    m_bad_rows(false),
+    m_check_bad(false),
+    m_flag_excluded(false),
+    m_flag_row(false),
+    m_segment_start(0),
+    m_prev_segment_start(0),
+    m_adaptive(false),
+    m_threshold(0.0)
 {}
 
 
@@ -68,82 +133,488 @@ lutzOnePass::~lutzOnePass()
  ****************************************************************/
 void lutzOnePass::run()
 {
+    LUTZ_TRACE_SCOPE("run");
+    
     // Reset all of the data structures
-    init_members();
+    {
+        LUTZ_TRACE_SCOPE("init");
+        init_members();
+    }
+    
+    // Let consumers know a new frame is starting
+    if (m_queue) m_queue->open();
+    
+    // Find all of the objects
+    {
+        LUTZ_TRACE_SCOPE("scan");
+        ScanImage();
+    }
+    
+    // Carry the background of this frame forward to the next
+    if (m_adaptive) m_background.FinishFrame();
+    {
+        LUTZ_TRACE_SCOPE("store_clearance");
+        StoreClearance();
+    }
+    
+    // Order the surviving brightest objects
+    if (m_config.m_maxobjects > 0) {
+        LUTZ_TRACE_SCOPE("finish_brightest");
+        FinishBrightest();
+    }
+    
+    // Signal the end of the frame to any consumers
+    if (m_queue) m_queue->close();
+}
+
+
+/************************************************************//**
+ * @brief Give back the memory kept from one run to the next
+ *
+ * The found objects are kept, but the scratch state and the emptied
+ * objects held for reuse are freed. The next run() allocates them again.
+ ****************************************************************/
+void lutzOnePass::ReleaseMemory()
+{
+    std::vector<lutzObject>().swap(m_spare);
+    std::vector<lutzCompactObject32>().swap(m_spare_compact);
+    for (int c=0; c < SPARE_CLASSES; c++) std::vector<Object>().swap(m_spare_pixels[c]);
+    std::vector<char>().swap(m_MARKER);
+    std::vector<LUTZSTATUS>().swap(m_PSSTACK);
+    std::vector<int>().swap(m_START);
+    std::vector<int>().swap(m_END);
+    std::vector<ObjectInfo>().swap(m_INFO);
+    std::vector<ObjectInfo>().swap(m_STORE);
+    std::vector<uint64_t>().swap(m_ROWBITS);
+    std::vector<uint64_t>().swap(m_NANBITS);
+    std::vector<char>().swap(m_EXROWS);
+    std::vector<int>().swap(m_label_parent);
+}
+
+
+/************************************************************//**
+ * @brief Scan the image row by row, writing objects as they complete
+ *
+ * When the pixel tests are those of m_image (see HasDirectRows()) the
+ * faster ScanImageDirect() is used instead.
+ ****************************************************************/
+void lutzOnePass::ScanImage()
+{
+    if (HasDirectRows()) {
+        ScanImageDirect();
+        return;
+    }
+    
     int co(0), pstop(0);
-    char prev_marker;
+    LUTZ_TRACE_ROWS();
     
     // Loop through each row of the image
     for (int yindx=0; yindx < m_ypix; yindx++) {
         
-        // Reset PS and CS
-        m_PS = COMPLETE;
-        m_CS = NONOBJECT;
+        LUTZ_TRACE_ROW(yindx);
+        StartRow();
         
-        int xindx;
-        for (xindx=0; xindx < m_xpix; xindx++) {
-            
-            // Store the information for this bin
-            lutzObject::pixData pixel (xindx, yindx);
-            pixel.m_value = GetPixValue(xindx, yindx);
-            
-            // Get the value of the marker in the previous row and
-            // reset the marker value so we can fill it from this row
-            prev_marker = m_MARKER[xindx];
-            m_MARKER[xindx] = 0;
-            
-            // Check if this bin is an image pixel
+        for (int xindx=0; xindx < m_xpix; xindx++) {
             bool is_image_pixel = AssessPixel(xindx, yindx);
+            if (m_bad_rows) {
+                is_image_pixel = AssessBadPixel(xindx, yindx, is_image_pixel);
+            }
             
-            // If this is an image pixel, do some assessment on the current
-            // object status
-            if (is_image_pixel) {
-                
-                // Check whether or not we're currently analyzing a pixel
-                if (m_CS == NONOBJECT) {
-                    // Previous pixel is not an image pixel
-                    
-                    // Start a new segment
-                    StartSegment(xindx, co, pstop);
-                }
-                
-                // Process previous marker based
-                if (prev_marker) ProcessNewMarker(prev_marker, xindx, co, pstop);
-                
-                // Update INFO
-                m_INFO[co].push_back(pixel);
-                
-            } // end if(is_image_pixel)
+            // For a background pixel ProcessPixel() only handles the marker
+            // left by the previous row and ends the current segment. With
+            // neither there is nothing to do, and skipping the call about
+            // halves the time of this loop on a sparse frame.
+            if (!is_image_pixel && !m_MARKER[xindx] && (m_CS == NONOBJECT)) {
+                continue;
+            }
+            ProcessPixel(xindx, yindx, is_image_pixel, co, pstop);
+        }
+        
+        // Handle the markers beyond the last pixel of the row
+        ProcessPixel(m_xpix, yindx, false, co, pstop);
+        if (m_adaptive) SampleRow(yindx);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Scan the image buffer directly, skipping the background
+ *
+ * Each row is first thresholded into a packed row of bits with a tight
+ * loop over m_image, and the algorithm is then only advanced where it
+ * can change state (see ScanBitRow()). This gives the same objects as
+ * calling AssessPixel() on every pixel.
+ ****************************************************************/
+void lutzOnePass::ScanImageDirect()
+{
+    int co(0), pstop(0);
+    int nwords = (m_xpix + 63) / 64;
+    m_ROWBITS.assign(2 * nwords, 0);
+    LUTZ_TRACE_ROWS();
+    
+    for (int yindx=0; yindx < m_ypix; yindx++) {
+        
+        LUTZ_TRACE_ROW(yindx);
+        uint64_t* cur  = &m_ROWBITS[(yindx & 1) * nwords];
+        uint64_t* prev = (yindx > 0) ? &m_ROWBITS[((yindx - 1) & 1) * nwords] : nullptr;
+        
+        // Threshold this row into bits
+        const double* row = m_image + size_t(yindx) * m_xpix;
+        bool has_nan = ThresholdRow(row, cur);
+        if (m_flag_excluded && !m_bad_mask && !m_bad_bits) {
+            m_EXROWS[yindx] = has_nan ? 2 : 1;
+        }
+        if (m_adaptive) m_background.addRow(row, m_xpix, yindx);
+        if (m_bad_rows) {
+            if (m_check_bad) FindNaNs(row, m_NANBITS.data());
+            ApplyBadPixels(yindx, m_check_bad ? m_NANBITS.data() : nullptr, cur);
+        }
+        ScanBitRow(cur, prev, yindx, co, pstop);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Add the sampled pixels of a row to the background estimate
+ *
+ * @param[in] yindx         Row of the image
+ *
+ * For scans that do not hold the row as an array of values.
+ ****************************************************************/
+void lutzOnePass::SampleRow(int yindx)
+{
+    int step = m_background.GetSampleStep();
+    for (int xindx=m_background.FirstSample(yindx); xindx < m_xpix; xindx += step) {
+        m_background.add(GetPixValue(xindx, yindx));
+    }
+}
+
+
+/************************************************************//**
+ * @brief Threshold a row of values into packed bits
+ *
+ * @param[in] row           m_xpix values
+ * @param[out] bits         (m_xpix + 63) / 64 words, bit set where the
+ *                          value is above m_threshold
+ * @return Whether any value of the row is NaN
+ *
+ * The NaN test rides along with the threshold, so that a scan without
+ * a mask knows which rows hold excluded pixels (see FlagExcluded()) at
+ * no extra cost.
+ ****************************************************************/
+bool lutzOnePass::ThresholdRow(const double* row, uint64_t* bits) const
+{
+    int nwords = (m_xpix + 63) / 64;
+    uint64_t nan = 0;
+    for (int w=0; w < nwords; w++) {
+        const double* pix = row + 64 * w;
+        int      npix = std::min(64, m_xpix - 64 * w);
+        uint64_t word = 0;
+        for (int b=0; b < npix; b++) {
+            word |= uint64_t(pix[b] > m_threshold) << b;
+            nan  |= uint64_t(pix[b] != pix[b]);
+        }
+        bits[w] = word;
+    }
+    return nan != 0;
+}
+
+
+/************************************************************//**
+ * @brief Find the NaN values of a row
+ *
+ * @param[in] row           m_xpix values
+ * @param[out] bits         (m_xpix + 63) / 64 words, bit set where the
+ *                          value is NaN
+ ****************************************************************/
+void lutzOnePass::FindNaNs(const double* row, uint64_t* bits) const
+{
+    int nwords = (m_xpix + 63) / 64;
+    for (int w=0; w < nwords; w++) {
+        const double* pix = row + 64 * w;
+        int      npix = std::min(64, m_xpix - 64 * w);
+        uint64_t word = 0;
+        for (int b=0; b < npix; b++) {
+            word |= uint64_t(std::isnan(pix[b])) << b;
+        }
+        bits[w] = word;
+    }
+}
+
+
+/************************************************************//**
+ * @brief Apply the bad pixel treatment to one pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @param[in] is_image_pixel Whether the pixel passed AssessPixel()
+ * @return Whether the scan should treat the pixel as an image pixel
+ ****************************************************************/
+bool lutzOnePass::AssessBadPixel(int xbin, int ybin, bool is_image_pixel)
+{
+    switch (m_config.m_bad_action) {
+        case BAD_EXCLUDE:
+            return is_image_pixel && !IsMaskedPixel(xbin, ybin);
+        case BAD_BRIDGE:
+            return is_image_pixel || IsMaskedPixel(xbin, ybin) ||
+                   std::isnan(GetPixValue(xbin, ybin));
+        case BAD_FLAG:
+        default:
+            return is_image_pixel || std::isnan(GetPixValue(xbin, ybin));
+    }
+}
+
+
+/************************************************************//**
+ * @brief Apply the bad pixel treatment to a thresholded row
+ *
+ * @param[in] yindx         Row of the image
+ * @param[in] nan_bits      Bits of the NaN pixels on the row (nullptr if
+ *                          there are none or they were not looked for)
+ * @param[in,out] bits      Thresholded bits of the row
+ *
+ * Masked pixels are cleared with BAD_EXCLUDE and set with BAD_BRIDGE.
+ * NaN pixels are set unless the action is BAD_EXCLUDE, in which case the
+ * threshold has already rejected them. ProcessPixel() then decides what
+ * each bad pixel contributes to its object.
+ ****************************************************************/
+void lutzOnePass::ApplyBadPixels(int yindx, const uint64_t* nan_bits,
+                                 uint64_t* bits) const
+{
+    int nwords = (m_xpix + 63) / 64;
+    LUTZ_BAD_ACTION action = m_config.m_bad_action;
+    
+    for (int w=0; w < nwords; w++) {
+        // Gather the mask bits of this word
+        uint64_t masked = 0;
+        if (m_bad_mask) {
+            const uint8_t* flags = m_bad_mask + size_t(yindx) * m_xpix + 64 * w;
+            int npix = std::min(64, m_xpix - 64 * w);
+            for (int b=0; b < npix; b++) {
+                masked |= uint64_t(flags[b] != 0) << b;
+            }
+        } else if (m_bad_bits) {
+            int stride = (m_bad_stride > 0) ? m_bad_stride : nwords;
+            masked = m_bad_bits[size_t(yindx) * stride + w];
+        }
+        uint64_t nan = nan_bits ? nan_bits[w] : 0;
+        
+        if (action == BAD_EXCLUDE) {
+            bits[w] &= ~masked;
+        } else if (action == BAD_BRIDGE) {
+            bits[w] |= masked | nan;
+        } else {
+            bits[w] |= nan;
+        }
+    }
+    
+    // Keep any padding bits of the mask out of the last word
+    int nlast = m_xpix - 64 * (nwords - 1);
+    if (nlast < 64) bits[nwords - 1] &= (uint64_t(1) << nlast) - 1;
+}
+
+
+/************************************************************//**
+ * @brief Return whether a span of a row holds an excluded pixel
+ *
+ * @param[in] xlo           First pixel of the span
+ * @param[in] xhi           Last pixel of the span
+ * @param[in] yindx         Row of the image
+ * @return Whether any pixel of the span is masked or NaN
+ *
+ * May be called for any row up to the one being scanned. A subclass
+ * whose values cannot be NaN, or that can only give the values of the
+ * current row, overrides this.
+ ****************************************************************/
+bool lutzOnePass::HasExcludedPixel(int xlo, int xhi, int yindx)
+{
+    if (m_bad_mask || m_bad_bits) {
+        for (int xindx=xlo; xindx <= xhi; xindx++) {
+            if (IsMaskedPixel(xindx, yindx)) return true;
+        }
+    }
+    if (HasDirectRows()) {
+        const double* row = m_image + size_t(yindx) * m_xpix;
+        for (int xindx=xlo; xindx <= xhi; xindx++) {
+            if (std::isnan(row[xindx])) return true;
+        }
+    } else {
+        for (int xindx=xlo; xindx <= xhi; xindx++) {
+            if (std::isnan(GetPixValue(xindx, yindx))) return true;
+        }
+    }
+    return false;
+}
+
+
+/************************************************************//**
+ * @brief Run the algorithm over one row given as packed bits
+ *
+ * @param[in] cur           Bits of this row (1 = image pixel)
+ * @param[in] prev          Bits of the previous row (nullptr on the first)
+ * @param[in] yindx         Current row
+ * @param[in] co            Current object ID
+ * @param[in] pstop         Current postion in PSSTACK
+ *
+ * Pixel x is bit (x % 64) of word (x / 64). Bits beyond m_xpix are
+ * ignored. A word of events is built for each word of the row: this
+ * row's bits, those bits shifted one pixel right (the pixel that ends
+ * each segment) and the same two for the previous row (where its markers
+ * were left). Only the events are handed to ProcessPixel(), found with
+ * count-trailing-zeros, so words that are empty on both rows cost next
+ * to nothing.
+ ****************************************************************/
+void lutzOnePass::ScanBitRow(const uint64_t* cur, const uint64_t* prev,
+                             int yindx, int& co, int& pstop)
+{
+    int nwords = (m_xpix + 63) / 64;
+    
+    // Bits of the last word that lie inside the image
+    int      nlast    = m_xpix - 64 * (nwords - 1);
+    uint64_t lastmask = (nlast == 64) ? ~uint64_t(0) : ((uint64_t(1) << nlast) - 1);
+    
+    StartRow();
+    
+    // Bits carried over from the top of the previous word
+    uint64_t ccarry = 0;
+    uint64_t pcarry = 0;
+    
+    for (int w=0; w < nwords; w++) {
+        uint64_t valid = (w == nwords - 1) ? lastmask : ~uint64_t(0);
+        uint64_t c = cur[w] & valid;
+        uint64_t p = prev ? (prev[w] & valid) : 0;
+        
+        uint64_t events = c | (c << 1) | ccarry | p | (p << 1) | pcarry;
+        events &= valid;
+        ccarry = c >> 63;
+        pcarry = p >> 63;
+        
+        while (events) {
+            int bit = count_trailing_zeros(events);
+            events &= events - 1;
+            ProcessPixel(64 * w + bit, yindx, (c >> bit) & 1, co, pstop);
+        }
+    }
+    
+    // Handle the markers beyond the last pixel of the row
+    ProcessPixel(m_xpix, yindx, false, co, pstop);
+}
+
+
+/************************************************************//**
+ * @brief Reset the status flags at the start of a row
+ ****************************************************************/
+void lutzOnePass::StartRow()
+{
+    m_PS = COMPLETE;
+    m_CS = NONOBJECT;
+    m_flag_row = m_flag_excluded;
+}
+
+
+/************************************************************//**
+ * @brief Advance the algorithm by one pixel of the current row
+ *
+ * @param[in] xindx         x-bin position along current row
+ * @param[in] yindx         Current row
+ * @param[in] is_image_pixel Whether this pixel is an image pixel
+ * @param[in] co            Current object ID
+ * @param[in] pstop         Current postion in PSSTACK
+ *
+ * Calling this with xindx = m_xpix (and is_image_pixel = false) closes
+ * off the row. A non-image pixel with no marker above it and no open
+ * segment does nothing, so scans that know where the image pixels are
+ * only need to call this at image pixels, at the first pixel after each
+ * run of image pixels, and wherever the previous row left a marker.
+ ****************************************************************/
+void lutzOnePass::ProcessPixel(int xindx, int yindx, bool is_image_pixel,
+                               int& co, int& pstop)
+{
+    // Get the value of the marker in the previous row and
+    // reset the marker value so we can fill it from this row
+    char prev_marker = m_MARKER[xindx];
+    m_MARKER[xindx] = 0;
+    
+    // A segment of the previous row is checked against this row once
+    // its end marker is reached, while it still belongs to m_INFO[co]
+    if (m_flag_row && prev_marker && NearExcluded(yindx)) {
+        if ((prev_marker == 'S') || (prev_marker == 's')) {
+            m_prev_segment_start = xindx;
+        } else {
+            FlagExcluded(m_INFO[co], m_prev_segment_start, xindx - 1, yindx, yindx);
+        }
+    }
+    
+    // If this is an image pixel, do some assessment on the current
+    // object status
+    if (is_image_pixel) {
+        
+        // Check whether or not we're currently analyzing a pixel
+        if (m_CS == NONOBJECT) {
+            // Previous pixel is not an image pixel
             
-            // If this is not an image pixel then handle the values from the
-            // previous line
-            else {
-                
-                if (prev_marker) {
-                    ProcessNewMarker(prev_marker, xindx, co, pstop);
-                }
-                
-                if (m_CS == OBJECT) {
-                    EndSegment(xindx, co, pstop);
+            // Start a new segment
+            m_segment_start = xindx;
+            StartSegment(xindx, co, pstop);
+        }
+        
+        // Process previous marker based
+        if (prev_marker) ProcessNewMarker(prev_marker, xindx, co, pstop);
+        
+        // Update INFO
+        ObjectInfo& info = m_INFO[co];
+        double value = GetPixValue(xindx, yindx);
+        
+        // Bad pixels mark the object, and bridged ones add nothing to it
+        if (m_check_bad) {
+            bool is_nan = std::isnan(value);
+            if (is_nan || IsMaskedPixel(xindx, yindx)) {
+                info.m_flags |= lutzObject::FLAG_BAD_PIXEL;
+                if (is_nan || (m_config.m_bad_action == BAD_BRIDGE)) {
+                    info.m_nbad++;
+                    return;
                 }
             }
         }
         
-        // Get the value of the marker in the previous row and
-        // reset the marker value so we can fill it from this row
-        prev_marker = m_MARKER.back();
-        m_MARKER.back() = 0;
+        bool keep_pixel = m_keep_pixels && !info.m_truncated;
+        bool grows = (xindx < info.m_xmin) || (xindx > info.m_xmax) ||
+                     (yindx > info.m_ymax);
+        if (keep_pixel && (info.m_pixels.size() == info.m_pixels.capacity())) {
+            ReservePixels(info, info.m_pixels.size() + 1);
+        }
+        info.add(lutzObject::pixData(xindx, yindx, value), keep_pixel);
+        if (grows && m_config.m_filter && !info.m_rejected) CheckFilter(info);
+        
+        // Fall back to statistics only once the object is over a limit
+        if (keep_pixel) {
+            m_open_pixels++;
+            if (m_limited) CheckLimits(info);
+        }
+        
+        // Without pixel lists the label image is filled in as we go
+        if (m_provisional) {
+            m_labels[yindx * m_xpix + xindx] = -m_INFO[co].m_label;
+        }
+        
+    } // end if(is_image_pixel)
+    
+    // If this is not an image pixel then handle the values from the
+    // previous line
+    else {
         
         if (prev_marker) {
             ProcessNewMarker(prev_marker, xindx, co, pstop);
         }
         
         if (m_CS == OBJECT) {
+            if (m_flag_row && NearExcluded(yindx)) {
+                FlagExcluded(m_INFO[co], m_segment_start, xindx - 1,
+                             yindx - 1, yindx);
+            }
             EndSegment(xindx, co, pstop);
         }
     }
-    
-    StoreClearance();
 }
 
 
@@ -229,22 +700,16 @@ void lutzOnePass::ProcessNewMarker(char& prev_marker, int& xindx, int& co, int&
             // Modify the PSSTACK at this point to be complete
             m_PSSTACK[pstop++] = COMPLETE;
             
-            // Fill INFO from STORE
-            m_INFO[++co] = m_STORE[xindx];
+            // Fill INFO from STORE. This also empties the STORE so that
+            // we dont duplicate entries when we refill it from INFO
+            m_INFO[++co].clear();
+            m_INFO[co].merge(m_STORE[xindx]);
             m_START[co] = -1;
             
-            // Empty the STORE so that we dont duplicate entries when we
-            // refill it from INFO
-            m_STORE[xindx].clear();
-            
         } else {
             // we are currently analyzing a segment that we need to now associate with
             // an object from the previous line
-            for (int i=0; i<m_STORE[xindx].size(); i++) {
-                m_INFO[co].push_back(m_STORE[xindx][i]);
-            }
-            // Reset the store at this position
-            m_STORE[xindx].clear();
+            MergeObjects(m_INFO[co], m_STORE[xindx]);
         }
         m_PS = OBJECT;
         
@@ -255,6 +720,9 @@ void lutzOnePass::ProcessNewMarker(char& prev_marker, int& xindx, int& co, int&
             pstop--;
             int k = m_START[co];
             
+            // Merge the current object into the one it joins
+            MergeObjects(m_INFO[co-1], m_INFO[co]);
+            
             if (m_START[--co] == -1) {
                 m_START[co] = k;
             } else {
@@ -275,13 +743,12 @@ void lutzOnePass::ProcessNewMarker(char& prev_marker, int& xindx, int& co, int&
             if (m_START[co] == -1) {
                 // We didnt find any of this object on this row,
                 // so no more of object to come EVER!
-                WriteObject( m_INFO[co] );
-                m_INFO[co].clear();
+                CloseObject( m_INFO[co] );
                 
             } else {
                 // There may still be more of this object on next row
                 m_MARKER[m_END[co]] = 'F';
-                m_STORE[m_START[co]] = m_INFO[co];
+                JoinPixels(m_STORE[m_START[co]], m_INFO[co]);
                 
             }
             
@@ -301,23 +768,505 @@ void lutzOnePass::StoreClearance()
     // to the list of objects
     for (int i=0; i<m_STORE.size(); i++) {
         // If the STORE isn't empty, then save it as a new object
-        WriteObject( m_STORE[i] );
-        m_STORE[i].clear();
+        CloseObject( m_STORE[i] );
     }
 }
 
 
 /************************************************************//**
  * @brief Save an object to the list of objects
+ *
+ * @param[in] obj           Completed object
+ *
+ * If an object queue has been supplied, the object is pushed onto it
+ * instead. This blocks while the queue is full.
  ****************************************************************/
-void lutzOnePass::WriteObject(Object& obj)
+void lutzOnePass::WriteObject(ObjectInfo& obj)
 {
-    if (!obj.empty() && (obj.size() >= m_npixelmin)) {
+    if (obj.empty()) return;
+    LUTZ_TRACE_OBJECT("write_object", obj.m_npix);
+    
+    // Objects made only of bridged bad pixels are dropped as well, and so
+    // are those the filter rejects
+    if ((obj.m_npix < m_config.m_npixelmin) || (obj.m_npix == 0) ||
+        obj.m_rejected ||
+        (m_config.m_filter && !m_config.m_filter->Accept(obj, m_xpix, m_ypix))) {
+        // Remove any provisional labels the scan left behind
+        if (m_provisional) PaintLabels(obj, 0);
+        return;
+    }
+    
+    // Label the pixels of this object. The brightest objects are only
+    // labelled once their final order is known.
+    if (m_labels && ((m_config.m_maxobjects == 0) || m_provisional)) {
+        ++m_nlabels;
+        if (!obj.m_truncated) PaintLabels(obj, m_nlabels);
+    }
+    
+    // Only the summary is wanted
+    if (m_config.m_boxes_only) {
+        lutzBox box;
+        box.m_npix  = obj.m_npix;
+        box.m_xmin  = obj.m_xmin;
+        box.m_xmax  = obj.m_xmax;
+        box.m_ymin  = obj.m_ymin;
+        box.m_ymax  = obj.m_ymax;
+        box.m_xpeak = obj.m_xpeak;
+        box.m_ypeak = obj.m_ypeak;
+        box.m_flags = obj.m_flags;
+        box.m_peak  = obj.m_peak;
+        m_Boxes.push_back(box);
+        return;
+    }
+    
+    // Without a pixel list there is no lutzObject to build, unless the
+    // list was dropped to stay within the memory limits
+    if (obj.m_pixels.empty() && !obj.m_truncated) return;
+    
+    // Keeping this object's pixels may still break the overall limit
+    if (m_limited && !obj.m_truncated &&
+        (((m_config.m_max_object_pixels > 0) &&
+          (obj.m_pixels.size() > m_config.m_max_object_pixels)) ||
+         ((m_config.m_max_retained > 0) &&
+          (m_open_pixels + m_retained + obj.m_pixels.size() >
+           m_config.m_max_retained)))) {
+        obj.m_truncated = true;
+        obj.release();
+    }
+    if (obj.m_truncated) m_ntruncated++;
+    
+    if (m_config.m_maxobjects > 0) {
+        // Only the brightest objects are kept
+        KeepBrightest(obj);
+    } else if (m_queue) {
+        // Hand the object straight to the consumers
+        lutzObject object;
+        BuildObject(obj, object);
+        LUTZ_TRACE_OBJECT("queue_push", obj.m_npix);
+        m_queue->push(object);
+    } else if (m_config.m_compact && !obj.m_truncated) {
+        // Store the pixels as separate position and value arrays
+        LUTZ_TRACE_OBJECT("build_object", obj.m_npix);
+        m_Compact.push_back(lutzCompactObject32());
+        if (!m_spare_compact.empty()) {
+            m_Compact.back().swap(m_spare_compact.back());
+            m_spare_compact.pop_back();
+        }
+        lutzCompactObject32& compact = m_Compact.back();
+        compact.reserve(obj.m_pixels.size());
+        for (int i=0; i<obj.m_pixels.size(); i++) {
+            compact.append(obj.m_pixels[i]);
+        }
+        m_retained += obj.m_pixels.size();
+    } else {
         // Create a lutzObject from the supplied object and append it to
         // the final list of objects
         m_Objects.push_back(lutzObject());
-        m_Objects.back().append(obj);
+        if (!m_spare.empty()) {
+            m_Objects.back().swap(m_spare.back());
+            m_spare.pop_back();
+        }
+        BuildObject(obj, m_Objects.back());
+        m_retained += m_Objects.back().size();
+    }
+}
+
+
+/************************************************************//**
+ * @brief Write an object that the scan has completed
+ *
+ * @param[in] obj           Completed object (left empty)
+ ****************************************************************/
+void lutzOnePass::CloseObject(ObjectInfo& obj)
+{
+    if (!obj.empty()) {
+        if (!obj.m_truncated) m_open--;
+        m_open_pixels -= obj.m_pixels.size();
     }
+    WriteObject(obj);
+    
+    if (obj.m_pixels.capacity() > ObjectInfo::RESERVE_PIXELS) KeepPixels(obj);
+    obj.clear();
+}
+
+
+/************************************************************//**
+ * @brief Join two objects, making room for the pixels first
+ *
+ * @param[in] obj           Object that will hold the combined object
+ * @param[in] other         Object to be absorbed (left empty)
+ *
+ * The pixels end up in the longer of the two lists (see
+ * ObjectInfo::merge()), which is given room for both beforehand.
+ ****************************************************************/
+void lutzOnePass::JoinPixels(ObjectInfo& obj, ObjectInfo& other)
+{
+    size_t npix = obj.m_pixels.size() + other.m_pixels.size();
+    if (!obj.empty() && !other.empty()) {
+        ObjectInfo& longer = (obj.m_pixels.size() < other.m_pixels.size()) ? other : obj;
+        ReservePixels(longer, npix);
+    }
+    obj.merge(other);
+}
+
+
+/************************************************************//**
+ * @brief Make room in a pixel list, from kept storage if there is some
+ *
+ * @param[in] obj           Object whose pixel list is to grow
+ * @param[in] npix          Number of pixels it must be able to hold
+ *
+ * Kept storage that is large enough, from the smallest size class that
+ * has some, takes over the pixels, and the list's own storage is kept
+ * in its place. Only when there is none is more memory allocated,
+ * doubling the list as push_back() would.
+ ****************************************************************/
+void lutzOnePass::ReservePixels(ObjectInfo& obj, size_t npix)
+{
+    if (obj.m_pixels.capacity() >= npix) return;
+    
+    int size_class = SpareClass(npix);
+    while ((size_class < SPARE_CLASSES) &&
+           (m_spare_pixels[size_class].empty() ||
+            (m_spare_pixels[size_class].back().capacity() < npix))) {
+        size_class++;
+    }
+    if (size_class == SPARE_CLASSES) {
+        obj.m_pixels.reserve(std::max(npix, 2 * obj.m_pixels.capacity()));
+        return;
+    }
+    
+    Object storage;
+    storage.swap(m_spare_pixels[size_class].back());
+    m_spare_pixels[size_class].pop_back();
+    storage.assign(obj.m_pixels.begin(), obj.m_pixels.end());
+    storage.swap(obj.m_pixels);
+    storage.clear();
+    if (storage.capacity() > 0) {
+        std::vector<Object>& kept = m_spare_pixels[SpareClass(storage.capacity())];
+        kept.push_back(Object());
+        kept.back().swap(storage);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Keep the storage of a written object's pixel list
+ *
+ * @param[in] obj           Object that has been written
+ *
+ * The storage is traded for the smallest kept so far, if that is
+ * smaller, so that the slot the object was in still has room for a
+ * small object. Under the memory limits, or over the limit set with
+ * SetMaxSparePixels(), it is freed instead.
+ ****************************************************************/
+void lutzOnePass::KeepPixels(ObjectInfo& obj)
+{
+    size_t capacity = obj.m_pixels.capacity();
+    if (m_limited || ((m_config.m_max_spare > 0) && (capacity > m_config.m_max_spare))) {
+        obj.release();
+        return;
+    }
+    
+    Object storage;
+    int size_class = 0;
+    while ((size_class < SPARE_CLASSES) && m_spare_pixels[size_class].empty()) size_class++;
+    if ((size_class < SPARE_CLASSES) &&
+        (m_spare_pixels[size_class].back().capacity() < capacity)) {
+        storage.swap(m_spare_pixels[size_class].back());
+        m_spare_pixels[size_class].pop_back();
+    }
+    
+    obj.m_pixels.clear();
+    std::vector<Object>& kept = m_spare_pixels[SpareClass(capacity)];
+    kept.push_back(Object());
+    kept.back().swap(obj.m_pixels);
+    obj.m_pixels.swap(storage);
+}
+
+
+/************************************************************//**
+ * @brief Return the size class of kept storage
+ *
+ * @param[in] capacity      Capacity of the storage in pixels
+ * @return Base 2 logarithm of the capacity, rounded down
+ ****************************************************************/
+int lutzOnePass::SpareClass(size_t capacity)
+{
+    int size_class = 0;
+    while ((capacity >>= 1) && (size_class < SPARE_CLASSES - 1)) size_class++;
+    return size_class;
+}
+
+
+/************************************************************//**
+ * @brief Build a lutzObject from a completed object
+ *
+ * @param[in] obj           Completed object
+ * @param[out] object       Object to be filled
+ *
+ * A truncated object becomes a summary with the FLAG_TRUNCATED flag.
+ * Any other flags gathered during the scan are passed on as well.
+ ****************************************************************/
+void lutzOnePass::BuildObject(ObjectInfo& obj, lutzObject& object)
+{
+    LUTZ_TRACE_OBJECT("build_object", obj.m_npix);
+    if (obj.m_truncated) {
+        object.SetSummary(obj.m_npix, obj.m_xmin, obj.m_xmax,
+                          obj.m_ymin, obj.m_ymax,
+                          obj.m_min, obj.m_peak, obj.m_sum);
+        object.SetFlags(object.GetFlags() | lutzObject::FLAG_TRUNCATED);
+    } else {
+        object.assign(obj.m_pixels);
+    }
+    if (obj.m_flags) object.SetFlags(object.GetFlags() | obj.m_flags);
+}
+
+
+/************************************************************//**
+ * @brief Join two objects that the scan has found to be connected
+ *
+ * @param[in] obj           Object that will hold the combined object
+ * @param[in] other         Object to be absorbed (left empty)
+ ****************************************************************/
+void lutzOnePass::MergeObjects(ObjectInfo& obj, ObjectInfo& other)
+{
+    // Only joins of two sizeable pieces are worth a trace event
+    LUTZ_TRACE_OBJECT("join", std::min(obj.m_npix, other.m_npix));
+    
+    // A segment that has only just been opened simply takes the place of
+    // (or disappears into) the other object
+    if (obj.empty() || other.empty()) {
+        ObjectInfo& opened = obj.empty() ? obj : other;
+        if (!opened.m_truncated) m_open--;
+        obj.merge(other);
+        return;
+    }
+    
+    // Pixels already given either provisional label belong together now
+    if (m_provisional) {
+        m_label_parent[FindLabel(other.m_label)] = FindLabel(obj.m_label);
+    }
+    
+    // If either part has dropped its pixels the whole object must
+    if (obj.m_truncated != other.m_truncated) {
+        DropPixels(obj.m_truncated ? other : obj);
+    } else if (!obj.m_truncated) {
+        m_open--;
+    }
+    JoinPixels(obj, other);
+    
+    // The joined object has a larger bounding box than either part
+    if (m_config.m_filter && !obj.m_rejected) CheckFilter(obj);
+}
+
+
+/************************************************************//**
+ * @brief Drop the pixel list of an open object that is over a limit
+ *
+ * @param[in] obj           Object that has just gained a pixel
+ ****************************************************************/
+void lutzOnePass::CheckLimits(ObjectInfo& obj)
+{
+    if (((m_config.m_max_object_pixels > 0) &&
+         (obj.m_pixels.size() > m_config.m_max_object_pixels)) ||
+        ((m_config.m_max_retained > 0) &&
+         (m_open_pixels + m_retained > m_config.m_max_retained))) {
+        DropPixels(obj);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Drop the pixel list of an open object
+ *
+ * @param[in] obj           Object to continue with statistics only
+ ****************************************************************/
+void lutzOnePass::DropPixels(ObjectInfo& obj)
+{
+    if (!obj.m_truncated) {
+        obj.m_truncated = true;
+        m_open--;
+    }
+    m_open_pixels -= obj.m_pixels.size();
+    obj.release();
+}
+
+
+/************************************************************//**
+ * @brief Give up on an open object the filter can no longer accept
+ *
+ * @param[in] obj           Object whose bounding box has just grown
+ *
+ * A rejected object is still followed to its end, so that the pixels
+ * joined to it are not found as objects of their own, but it keeps no
+ * pixels and is dropped when it is complete.
+ ****************************************************************/
+void lutzOnePass::CheckFilter(ObjectInfo& obj)
+{
+    if (m_config.m_filter->Abort(obj, m_xpix, m_ypix)) {
+        obj.m_rejected = true;
+        DropPixels(obj);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Create a new provisional label
+ *
+ * @return The new label
+ ****************************************************************/
+int lutzOnePass::NewLabel()
+{
+    m_label_parent.push_back(m_label_parent.size());
+    return m_label_parent.size() - 1;
+}
+
+
+/************************************************************//**
+ * @brief Return the representative of a provisional label
+ *
+ * @param[in] label         Provisional label
+ * @return Representative label of all labels joined to this one
+ ****************************************************************/
+int lutzOnePass::FindLabel(int label)
+{
+    while (m_label_parent[label] != label) {
+        // Halve the path as we go so later lookups are quicker
+        m_label_parent[label] = m_label_parent[m_label_parent[label]];
+        label = m_label_parent[label];
+    }
+    return label;
+}
+
+
+/************************************************************//**
+ * @brief Write the final label of an object into the label image
+ *
+ * @param[in] obj           Completed object
+ * @param[in] label         Label to write (0 removes the object)
+ *
+ * Objects with a pixel list are labelled pixel by pixel. Otherwise the
+ * object's bounding box is searched for pixels carrying one of its
+ * provisional labels.
+ ****************************************************************/
+void lutzOnePass::PaintLabels(ObjectInfo& obj, int32_t label)
+{
+    if (!obj.m_pixels.empty()) {
+        for (int i=0; i<obj.m_pixels.size(); i++) {
+            const lutzObject::pixData& pixel = obj.m_pixels[i];
+            m_labels[pixel.m_ybin * m_xpix + pixel.m_xbin] = label;
+        }
+        return;
+    }
+    
+    int root = FindLabel(obj.m_label);
+    for (int yindx=obj.m_ymin; yindx <= obj.m_ymax; yindx++) {
+        int32_t* row = m_labels + yindx * m_xpix;
+        for (int xindx=obj.m_xmin; xindx <= obj.m_xmax; xindx++) {
+            if ((row[xindx] < 0) && (FindLabel(-row[xindx]) == root)) {
+                row[xindx] = label;
+            }
+        }
+    }
+}
+
+
+/************************************************************//**
+ * @brief Offer an object to the list of brightest objects
+ *
+ * @param[in] obj           Completed object
+ *
+ * m_Objects is kept as a min-heap on RankValue() so the faintest kept
+ * object is always at the front. Objects fainter than that are dropped
+ * before a lutzObject is ever built for them.
+ ****************************************************************/
+void lutzOnePass::KeepBrightest(ObjectInfo& obj)
+{
+    // Compute the ranking value directly from the pixels
+    Object& pixels = obj.m_pixels;
+    double value;
+    if (obj.m_truncated) {
+        value = (m_config.m_rank == RANK_SUM) ? obj.m_sum : obj.m_peak;
+    } else {
+        value = (m_config.m_rank == RANK_SUM) ? 0.0 : pixels[0].m_value;
+        for (int i=0; i<pixels.size(); i++) {
+            if (m_config.m_rank == RANK_SUM) {
+                value += pixels[i].m_value;
+            } else if (pixels[i].m_value > value) {
+                value = pixels[i].m_value;
+            }
+        }
+    }
+    
+    auto fainter = [this](const lutzObject& a, const lutzObject& b) {
+        return RankValue(a) > RankValue(b);
+    };
+    
+    if ((m_Objects.size() < m_config.m_maxobjects) ||
+        (value > RankValue(m_Objects.front()))) {
+        if (m_Objects.size() < m_config.m_maxobjects) {
+            // Still room in the list, fill one of last run's objects
+            m_Objects.push_back(lutzObject());
+            if (!m_spare.empty()) {
+                m_Objects.back().swap(m_spare.back());
+                m_spare.pop_back();
+            }
+        } else {
+            // Replace the faintest object we are keeping, reusing its storage
+            std::pop_heap(m_Objects.begin(), m_Objects.end(), fainter);
+            m_retained -= m_Objects.back().size();
+            m_Objects.back().clear();
+        }
+        BuildObject(obj, m_Objects.back());
+        m_retained += m_Objects.back().size();
+        std::push_heap(m_Objects.begin(), m_Objects.end(), fainter);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Sort the brightest objects once the image has been scanned
+ *
+ * Objects are ordered from brightest to faintest. If an object queue is
+ * in use the objects are handed to it here.
+ ****************************************************************/
+void lutzOnePass::FinishBrightest()
+{
+    auto fainter = [this](const lutzObject& a, const lutzObject& b) {
+        return RankValue(a) > RankValue(b);
+    };
+    std::sort_heap(m_Objects.begin(), m_Objects.end(), fainter);
+    
+    // Now that the order is known, label the objects
+    if (m_labels) {
+        for (int i=0; i<m_Objects.size(); i++) {
+            for (int p=0; p<m_Objects[i].size(); p++) {
+                const lutzObject::pixData& pixel = m_Objects[i][p];
+                m_labels[pixel.m_ybin * m_xpix + pixel.m_xbin] = i + 1;
+            }
+        }
+        m_nlabels = m_Objects.size();
+    }
+    
+    if (m_queue) {
+        for (int i=0; i<m_Objects.size(); i++) {
+            m_queue->push(m_Objects[i]);
+        }
+        m_Objects.clear();
+    }
+}
+
+
+/************************************************************//**
+ * @brief Return the value used to rank an object's brightness
+ *
+ * @param[in] obj           Object to rank
+ * @return Sum or maximum of the object's pixel values
+ ****************************************************************/
+double lutzOnePass::RankValue(const lutzObject& obj) const
+{
+    return (m_config.m_rank == RANK_SUM) ? obj.Sum() : obj.GetMaximum();
 }
 
 
@@ -357,21 +1306,107 @@ bool lutzOnePass::AssessPixel(int xbin, int ybin)
  ****************************************************************/
 void lutzOnePass::init_members()
 {
-    m_Objects.clear();
     m_pixData.clear();
-    m_MARKER.clear();
-    m_PSSTACK.clear();
-    m_START.clear();
-    m_END.clear();
-    m_INFO.clear();
-    m_STORE.clear();
     
-    m_MARKER  = std::vector<char>(m_xpix + 1, 0);
-    m_PSSTACK = std::vector<LUTZSTATUS>(m_xpix , COMPLETE);
-    m_START   = std::vector<int>(m_xpix , -1);
-    m_END     = std::vector<int>(m_xpix , -1);
-    m_INFO    = std::vector<Object>(m_xpix , Object(0));
-    m_STORE   = std::vector<Object>(m_xpix, Object(0));
+    // The objects of the last run are emptied and kept for reuse, last
+    // first, so that the same frame gets back the same containers
+    for (int i=m_Objects.size()-1; i>=0; i--) {
+        m_Objects[i].clear();
+        m_spare.push_back(lutzObject());
+        m_spare.back().swap(m_Objects[i]);
+    }
+    for (int i=m_Compact.size()-1; i>=0; i--) {
+        m_Compact[i].clear();
+        m_spare_compact.push_back(lutzCompactObject32());
+        m_spare_compact.back().swap(m_Compact[i]);
+    }
+    m_Objects.clear();
+    m_Compact.clear();
+    m_Boxes.clear();
+    
+    // Reset the scratch state without giving up its memory
+    m_MARKER.assign(m_xpix + 1, 0);
+    m_PSSTACK.assign(m_xpix + 1, COMPLETE);
+    m_START.assign(m_xpix + 1, -1);
+    m_END.assign(m_xpix + 1, -1);
+    m_INFO.resize(m_xpix + 1);
+    m_STORE.resize(m_xpix + 1);
+    for (int i=0; i<=m_xpix; i++) {
+        m_INFO[i].clear();
+        m_STORE[i].clear();
+    }
+    
+    // Free any kept storage over the limit
+    if (m_config.m_max_spare > 0) {
+        for (int i=0; i<=m_xpix; i++) {
+            if (m_INFO[i].m_pixels.capacity() > m_config.m_max_spare) m_INFO[i].release();
+            if (m_STORE[i].m_pixels.capacity() > m_config.m_max_spare) m_STORE[i].release();
+        }
+        for (int c=SpareClass(m_config.m_max_spare); c < SPARE_CLASSES; c++) {
+            std::vector<Object>& kept = m_spare_pixels[c];
+            for (size_t i=kept.size(); i-- > 0; ) {
+                if (kept[i].capacity() > m_config.m_max_spare) {
+                    kept[i].swap(kept.back());
+                    kept.pop_back();
+                }
+            }
+        }
+    }
+    
+    // Decide what needs to be tracked for each object
+    m_keep_pixels = !m_config.m_boxes_only &&
+                    ((m_labels == nullptr) || m_label_pixels);
+    m_provisional = (m_labels != nullptr) && !m_keep_pixels;
+    
+    // Give every slot room for a small object up front, so that the
+    // objects of the first runs do not allocate each time they grow
+    if (m_keep_pixels) {
+        for (int i=0; i<=m_xpix; i++) {
+            m_INFO[i].m_pixels.reserve(ObjectInfo::RESERVE_PIXELS);
+            m_STORE[i].m_pixels.reserve(ObjectInfo::RESERVE_PIXELS);
+        }
+    }
+    
+    // Reset the memory accounting
+    m_limited = m_keep_pixels && ((m_config.m_max_object_pixels > 0) ||
+                                  (m_config.m_max_retained > 0) ||
+                                  (m_config.m_max_open > 0));
+    m_open        = 0;
+    m_open_pixels = 0;
+    m_retained    = 0;
+    m_ntruncated  = 0;
+    
+    // Take the threshold from the background of the earlier frames
+    m_threshold = m_config.m_threshold;
+    m_adaptive  = (m_config.m_adaptive_nsigma > 0.0);
+    if (m_adaptive) {
+        if (m_background.IsReady()) {
+            m_threshold = m_background.GetThreshold(m_config.m_adaptive_nsigma);
+        }
+        m_background.StartFrame();
+    }
+    
+    // Decide how much bad pixel handling the scan needs
+    m_check_bad     = (m_config.m_bad_action != BAD_EXCLUDE);
+    m_flag_excluded = !m_check_bad;
+    m_bad_rows      = m_check_bad || (m_bad_mask != nullptr) || (m_bad_bits != nullptr);
+    if (m_check_bad) {
+        m_NANBITS.assign((m_xpix + 63) / 64, 0);
+    } else {
+        m_NANBITS.clear();
+    }
+    if (m_flag_excluded) {
+        m_EXROWS.assign(m_ypix, 0);
+    } else {
+        m_EXROWS.clear();
+    }
+    
+    // Reset the label image
+    m_nlabels = 0;
+    m_label_parent.assign(1, 0);
+    if (m_labels) {
+        std::fill(m_labels, m_labels + size_t(m_xpix) * m_ypix, 0);
+    }
 }
 
 
@@ -391,12 +1426,18 @@ void lutzOnePass::ModOBSTACK(lutzOnePass::LUTZ_STACK_ACTION status,
         co++;
         m_START[co] = xbin;
         m_INFO[co].clear();
+        if (m_provisional) m_INFO[co].m_label = NewLabel();
+        
+        // Too many objects already hold pixels, so keep statistics only
+        if (m_limited && (m_config.m_max_open > 0) &&
+            (m_open >= m_config.m_max_open)) {
+            m_INFO[co].m_truncated = true;
+        } else {
+            m_open++;
+        }
     } else if (status == POP) {
         ModPSSTACK(POP, pstop);
-        for (int i=0; i<m_INFO[co].size(); i++) {
-            m_STORE[ m_START[co] ].push_back(m_INFO[co][i]);
-        }
-        m_INFO[co].clear();
+        JoinPixels(m_STORE[ m_START[co] ], m_INFO[co]);
         m_START[co] = -1;
         m_END[co] = -1;
         co--;
@@ -421,3 +1462,182 @@ void lutzOnePass::ModPSSTACK(lutzOnePass::LUTZ_STACK_ACTION status, int& pstop)
         m_PS = m_PSSTACK[--pstop];
     }
 }
+
+
+/*==========================================================================
+ =                                                                         =
+ =                       lutzOnePass::Config methods                       =
+ =                                                                         =
+ ==========================================================================*/
+
+/***************************************************************//**
+ * @brief Default detection parameters
+ *
+ * Every pixel above a threshold of 0 is kept, all objects are stored
+ * with their pixel lists and there are no memory limits.
+ *******************************************************************/
+lutzOnePass::Config::Config() :
+    m_threshold(0.0),
+    m_npixelmin(0),
+    m_maxobjects(0),
+    m_rank(RANK_SUM),
+    m_boxes_only(false),
+    m_compact(false),
+    m_max_object_pixels(0),
+    m_max_retained(0),
+    m_max_open(0),
+    m_max_spare(0),
+    m_bad_action(BAD_EXCLUDE),
+    m_adaptive_nsigma(0.0),
+    m_filter(nullptr)
+{}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                    lutzOnePass::ObjectInfo methods                      =
+ =                                                                         =
+ ==========================================================================*/
+
+/***************************************************************//**
+ * @brief Clear all of the information associated with this object
+ *
+ * The pixel list is emptied but keeps its storage, so that it can be
+ * refilled without allocating (see SetMaxSparePixels()).
+ *******************************************************************/
+void lutzOnePass::ObjectInfo::clear()
+{
+    m_pixels.clear();
+    m_npix  = 0;
+    m_xmin  = 1e7;
+    m_xmax  = -1e7;
+    m_ymin  = 1e7;
+    m_ymax  = -1e7;
+    m_xpeak = 0;
+    m_ypeak = 0;
+    m_peak  = -1.0e30;
+    m_min   = 1.0e30;
+    m_sum   = 0.0;
+    m_label = 0;
+    m_truncated = false;
+    m_nbad  = 0;
+    m_flags = 0;
+    m_sx  = 0.0;
+    m_sy  = 0.0;
+    m_sxx = 0.0;
+    m_syy = 0.0;
+    m_sxy = 0.0;
+    m_rejected = false;
+}
+
+
+/***************************************************************//**
+ * @brief Absorb the contents of another object
+ *
+ * @param[in] other         Object to be absorbed (left empty)
+ *
+ * If this object is empty it simply takes over the other's contents,
+ * including its label, without copying any pixels. An empty object
+ * leaves this one untouched: it is a segment opened on this pixel, and
+ * whether it was marked truncated (by SetMaxOpenObjects()) or rejected
+ * was decided before the scan knew it belonged to this object. Otherwise the shorter of the two pixel
+ * lists is appended to the longer one, so the order of the pixels
+ * follows whichever part was larger. The other object is left holding
+ * the shorter list's storage, ready for the next object.
+ *******************************************************************/
+void lutzOnePass::ObjectInfo::merge(ObjectInfo& other)
+{
+    if (other.empty()) {
+        // Nothing to take, not even the state of a newly opened segment
+    } else if (empty()) {
+        m_pixels.swap(other.m_pixels);
+        m_npix  = other.m_npix;
+        m_xmin  = other.m_xmin;
+        m_xmax  = other.m_xmax;
+        m_ymin  = other.m_ymin;
+        m_ymax  = other.m_ymax;
+        m_xpeak = other.m_xpeak;
+        m_ypeak = other.m_ypeak;
+        m_peak  = other.m_peak;
+        m_min   = other.m_min;
+        m_sum   = other.m_sum;
+        m_label = other.m_label;
+        m_truncated = other.m_truncated;
+        m_nbad  = other.m_nbad;
+        m_flags = other.m_flags;
+        m_sx  = other.m_sx;
+        m_sy  = other.m_sy;
+        m_sxx = other.m_sxx;
+        m_syy = other.m_syy;
+        m_sxy = other.m_sxy;
+        m_rejected = other.m_rejected;
+    } else {
+        // Keep the longer pixel list and append the shorter one to it, so
+        // that a large object is not copied each time a piece joins it
+        if (m_pixels.size() < other.m_pixels.size()) {
+            m_pixels.swap(other.m_pixels);
+        }
+        m_pixels.insert(m_pixels.end(),
+                        other.m_pixels.begin(), other.m_pixels.end());
+        m_npix += other.m_npix;
+        m_xmin  = std::min(m_xmin, other.m_xmin);
+        m_xmax  = std::max(m_xmax, other.m_xmax);
+        m_ymin  = std::min(m_ymin, other.m_ymin);
+        m_ymax  = std::max(m_ymax, other.m_ymax);
+        if (other.m_peak > m_peak) {
+            m_peak  = other.m_peak;
+            m_xpeak = other.m_xpeak;
+            m_ypeak = other.m_ypeak;
+        }
+        m_min = std::min(m_min, other.m_min);
+        m_sum += other.m_sum;
+        m_truncated = m_truncated || other.m_truncated;
+        m_nbad  += other.m_nbad;
+        m_flags |= other.m_flags;
+        m_sx  += other.m_sx;
+        m_sy  += other.m_sy;
+        m_sxx += other.m_sxx;
+        m_syy += other.m_syy;
+        m_sxy += other.m_sxy;
+        m_rejected = m_rejected || other.m_rejected;
+    }
+    other.clear();
+}
+
+
+/***************************************************************//**
+ * @brief Empty the pixel list and free its storage
+ *******************************************************************/
+void lutzOnePass::ObjectInfo::release()
+{
+    Object().swap(m_pixels);
+}
+
+
+/***************************************************************//**
+ * @brief Shift the position of every pixel in the object
+ *
+ * @param[in] dx            Shift in x
+ * @param[in] dy            Shift in y
+ *******************************************************************/
+void lutzOnePass::ObjectInfo::translate(int dx, int dy)
+{
+    for (int i=0; i<m_pixels.size(); i++) {
+        m_pixels[i].m_xbin += dx;
+        m_pixels[i].m_ybin += dy;
+    }
+    m_xmin += dx;
+    m_xmax += dx;
+    m_ymin += dy;
+    m_ymax += dy;
+    m_xpeak += dx;
+    m_ypeak += dy;
+    
+    // Shift the sums the same way, in terms of the old ones
+    double n = m_npix;
+    m_sxx += 2.0 * dx * m_sx + double(dx) * dx * n;
+    m_syy += 2.0 * dy * m_sy + double(dy) * dy * n;
+    m_sxy += dx * m_sy + dy * m_sx + double(dx) * dy * n;
+    m_sx  += dx * n;
+    m_sy  += dy * n;
+}
@@ -0,0 +1,320 @@
+/***************************************************************************
+ *  lutzPyramid.cpp - Coarse-to-fine detection for large sparse images     *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzPyramid.cpp
+ * @brief Implements the lutzPyramid class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include "lutzPyramid.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Runs the full resolution scan inside one candidate region
+ *
+ * Pixel positions are translated into the parent image, and only pixels
+ * whose cell belongs to the candidate are considered, so an object that
+ * happens to overlap the bounding box of another candidate is not found
+ * twice. Completed objects are collected rather than stored, so that the
+ * parent can apply its own selection to them.
+ *******************************************************************/
+class lutzWindowPass : public lutzOnePass {
+public:
+    lutzWindowPass(lutzPyramid& parent, const std::vector<int>& cell_label,
+                   int xcells, int binning) :
+        lutzOnePass(),
+        m_parent(parent),
+        m_cell_label(cell_label),
+        m_xcells(xcells),
+        m_binning(binning),
+        m_label(0), m_x0(0), m_y0(0)
+    {}
+
+    // Select the window to be scanned
+    void SetWindow(int label, int x0, int y0, int x1, int y1)
+    {
+        m_label = label;
+        m_x0 = x0;
+        m_y0 = y0;
+        SetXpixels(x1 - x0);
+        SetYpixels(y1 - y0);
+    }
+
+    virtual double GetPixValue(int xbin, int ybin)
+    {
+        return m_parent.GetPixValue(xbin + m_x0, ybin + m_y0);
+    }
+
+    virtual bool AssessPixel(int xbin, int ybin)
+    {
+        int x = xbin + m_x0;
+        int y = ybin + m_y0;
+        int cell = (y / m_binning) * m_xcells + (x / m_binning);
+        return (m_cell_label[cell] == m_label) && m_parent.AssessPixel(x, y);
+    }
+
+    virtual bool HasDirectRows(void) const
+    {
+        return false;
+    }
+
+    std::vector<ObjectInfo> m_found;    //!< Objects found in the window
+
+protected:
+
+    virtual void WriteObject(ObjectInfo& obj)
+    {
+        if (obj.empty()) return;
+
+        // Move the pixels into the parent image's frame
+        obj.translate(m_x0, m_y0);
+        m_found.push_back(ObjectInfo());
+        m_found.back().merge(obj);
+    }
+
+    lutzPyramid&            m_parent;
+    const std::vector<int>& m_cell_label;
+    int m_xcells;
+    int m_binning;
+    int m_label;
+    int m_x0;
+    int m_y0;
+};
+
+} // namespace
+
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzPyramid::lutzPyramid() :
+    lutzOnePass(),
+    m_binning(8),
+    m_padding(0),
+    m_reduction(REDUCE_MAX),
+    m_coarse_threshold(0.0),
+    m_coarse_threshold_set(false),
+    m_xcells(0),
+    m_ycells(0)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from a vector
+ *
+ * @param[in] image         1D vector containing image data
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ ****************************************************************/
+lutzPyramid::lutzPyramid(double* image,
+                         int xpixels, int ypixels) :
+    lutzOnePass(image, xpixels, ypixels),
+    m_binning(8),
+    m_padding(0),
+    m_reduction(REDUCE_MAX),
+    m_coarse_threshold(0.0),
+    m_coarse_threshold_set(false),
+    m_xcells(0),
+    m_ycells(0)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzPyramid::~lutzPyramid()
+{}
+
+
+/************************************************************//**
+ * @brief Return whether the scan may read the rows of m_image directly
+ *
+ * @return Whether there is an m_image and this is a lutzPyramid itself,
+ *         whose pixel tests are those of m_image
+ ****************************************************************/
+bool lutzPyramid::HasDirectRows() const
+{
+    return (m_image != nullptr) && (typeid(*this) == typeid(lutzPyramid));
+}
+
+
+/************************************************************//**
+ * @brief Find candidates on the reduced image and scan each of them
+ ****************************************************************/
+void lutzPyramid::ScanImage()
+{
+    BuildCoarseImage();
+    FindCandidates();
+
+    lutzWindowPass window(*this, m_cell_label, m_xcells, m_binning);
+    window.SetThreshold(m_threshold);
+    if (m_limited) {
+        window.SetMaxObjectPixels(m_config.m_max_object_pixels);
+        window.SetMaxOpenObjects(m_config.m_max_open);
+    }
+
+    for (int c=0; c<m_candidates.size(); c++) {
+        // Bounding box of the candidate in full resolution pixels
+        int x0 = m_candidates[c].GetXMin() * m_binning;
+        int y0 = m_candidates[c].GetYMin() * m_binning;
+        int x1 = std::min((m_candidates[c].GetXMax() + 1) * m_binning, m_xpix);
+        int y1 = std::min((m_candidates[c].GetYMax() + 1) * m_binning, m_ypix);
+
+        window.SetWindow(c + 1, x0, y0, x1, y1);
+        window.m_found.clear();
+
+        // The window may only use what is left of the pixel budget
+        if (m_limited && (m_config.m_max_retained > 0)) {
+            window.SetMaxRetainedPixels((m_retained < m_config.m_max_retained) ?
+                                        (m_config.m_max_retained - m_retained) : 1);
+        }
+        window.run();
+
+        // Pass the objects through our own selection
+        for (int i=0; i<window.m_found.size(); i++) {
+            WriteObject(window.m_found[i]);
+        }
+    }
+}
+
+
+/************************************************************//**
+ * @brief Reduce the image into cells of m_binning x m_binning pixels
+ *
+ * Every pixel of the frame is read once. When the values are those of
+ * m_image (see HasDirectRows()) whole rows are read from it directly.
+ * Otherwise each row is first gathered through GetPixValue().
+ ****************************************************************/
+void lutzPyramid::BuildCoarseImage()
+{
+    m_xcells = (m_xpix + m_binning - 1) / m_binning;
+    m_ycells = (m_ypix + m_binning - 1) / m_binning;
+
+    if (m_reduction == REDUCE_MAX) {
+        m_coarse.assign(m_xcells * m_ycells, -1.0e30);
+    } else {
+        m_coarse.assign(m_xcells * m_ycells, 0.0);
+    }
+
+    bool direct = HasDirectRows();
+    if (!direct) m_rowvalues.resize(m_xpix);
+
+    // Accumulate each row into the cells it covers
+    for (int yindx=0; yindx < m_ypix; yindx++) {
+        const double* row;
+        if (direct) {
+            row = m_image + size_t(yindx) * m_xpix;
+        } else {
+            for (int xindx=0; xindx < m_xpix; xindx++) {
+                m_rowvalues[xindx] = GetPixValue(xindx, yindx);
+            }
+            row = m_rowvalues.data();
+        }
+        ReduceRow(row, &m_coarse[(yindx / m_binning) * m_xcells]);
+        if (m_adaptive) m_background.addRow(row, m_xpix, yindx);
+    }
+
+    // Convert sums into means, allowing for partial cells at the edges
+    if (m_reduction == REDUCE_MEAN) {
+        for (int cy=0; cy < m_ycells; cy++) {
+            int ny = std::min(m_binning, m_ypix - cy * m_binning);
+            for (int cx=0; cx < m_xcells; cx++) {
+                int nx = std::min(m_binning, m_xpix - cx * m_binning);
+                m_coarse[cy * m_xcells + cx] /= double(nx * ny);
+            }
+        }
+    }
+}
+
+
+/************************************************************//**
+ * @brief Accumulate one row of the image into a row of cells
+ *
+ * @param[in] row           m_xpix values
+ * @param[in,out] cells     m_xcells cells the row falls in
+ ****************************************************************/
+void lutzPyramid::ReduceRow(const double* row, double* cells) const
+{
+    for (int cx=0; cx < m_xcells; cx++) {
+        const double* pix  = row + cx * m_binning;
+        int           npix = std::min(m_binning, m_xpix - cx * m_binning);
+        double        cell = cells[cx];
+        if (m_reduction == REDUCE_MAX) {
+            for (int i=0; i < npix; i++) {
+                if (pix[i] > cell) cell = pix[i];
+            }
+        } else {
+            for (int i=0; i < npix; i++) cell += pix[i];
+        }
+        cells[cx] = cell;
+    }
+}
+
+
+/************************************************************//**
+ * @brief Run the one pass algorithm on the reduced image
+ *
+ * Fills m_candidates with the groups of connected cells that are above
+ * threshold (grown by m_padding cells) and labels each cell with the
+ * candidate it belongs to.
+ ****************************************************************/
+void lutzPyramid::FindCandidates()
+{
+    double threshold = m_threshold;
+    if ((m_reduction == REDUCE_MEAN) && m_coarse_threshold_set) {
+        threshold = m_coarse_threshold;
+    }
+
+    // Flag the cells that are above threshold, growing them by the padding
+    std::vector<double> flags(m_xcells * m_ycells, 0.0);
+    for (int cy=0; cy < m_ycells; cy++) {
+        for (int cx=0; cx < m_xcells; cx++) {
+            if (m_coarse[cy * m_xcells + cx] <= threshold) continue;
+
+            int ylo = std::max(cy - m_padding, 0);
+            int yhi = std::min(cy + m_padding, m_ycells - 1);
+            int xlo = std::max(cx - m_padding, 0);
+            int xhi = std::min(cx + m_padding, m_xcells - 1);
+            for (int y=ylo; y<=yhi; y++) {
+                for (int x=xlo; x<=xhi; x++) {
+                    flags[y * m_xcells + x] = 1.0;
+                }
+            }
+        }
+    }
+
+    // Group the flagged cells into candidates
+    lutzOnePass coarse(flags.data(), m_xcells, m_ycells);
+    coarse.SetThreshold(0.5);
+    coarse.run();
+    m_candidates = coarse.GetObjects();
+
+    // Label each cell with the candidate it belongs to
+    m_cell_label.assign(m_xcells * m_ycells, 0);
+    for (int c=0; c<m_candidates.size(); c++) {
+        for (int p=0; p<m_candidates[c].size(); p++) {
+            const lutzObject::pixData& cell = m_candidates[c][p];
+            m_cell_label[cell.m_ybin * m_xcells + cell.m_xbin] = c + 1;
+        }
+    }
+}
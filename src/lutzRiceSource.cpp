@@ -0,0 +1,329 @@
+/***************************************************************************
+ *  lutzRiceSource.cpp - Rows of a Rice coded frame                        *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzRiceSource.cpp
+ * @brief Implements the lutzRiceSource class
+ * @author Josh Cardenzana
+ */
+
+#include "lutzRiceSource.hpp"
+
+namespace {
+
+/************************************************************//**
+ * @brief Return the number of zero bits above the highest set bit of a
+ *        non-zero word
+ ****************************************************************/
+inline int count_leading_zeros(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(word);
+#else
+    int n = 0;
+    while (!(word & (uint64_t(1) << 63))) {
+        word <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Parameter of a block holding the pixel values themselves
+const int RICE_RAW = 15;
+
+// Largest unary part of a code before it escapes to 17 bits
+const int RICE_ESCAPE = 32;
+
+// Writes bits to a vector, most significant first
+struct BitWriter {
+    std::vector<uint8_t>& m_data;
+    uint64_t              m_acc;
+    int                   m_nbits;
+
+    BitWriter(std::vector<uint8_t>& data) : m_data(data), m_acc(0), m_nbits(0) {}
+
+    // Write the low nbits (at most 32) of value
+    void put(uint32_t value, int nbits)
+    {
+        m_acc = (m_acc << nbits) | (value & ((uint64_t(1) << nbits) - 1));
+        m_nbits += nbits;
+        while (m_nbits >= 8) {
+            m_nbits -= 8;
+            m_data.push_back(uint8_t(m_acc >> m_nbits));
+        }
+    }
+
+    // Pad the last byte with zeros
+    void flush()
+    {
+        if (m_nbits > 0) m_data.push_back(uint8_t(m_acc << (8 - m_nbits)));
+        m_acc   = 0;
+        m_nbits = 0;
+    }
+};
+
+// Reads bits from a buffer, most significant first, holding up to 64
+// of them in m_buf
+struct BitReader {
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+    uint64_t       m_buf;
+    int            m_nbits;
+
+    BitReader(const uint8_t* pos, const uint8_t* end) :
+        m_pos(pos), m_end(end), m_buf(0), m_nbits(0)
+    {}
+
+    void refill()
+    {
+        while ((m_nbits <= 56) && (m_pos < m_end)) {
+            m_buf |= uint64_t(*m_pos++) << (56 - m_nbits);
+            m_nbits += 8;
+        }
+    }
+
+    // Read nbits (1 to 32), returning false if the data runs out
+    bool get(int nbits, uint32_t& value)
+    {
+        if (m_nbits < nbits) {
+            refill();
+            if (m_nbits < nbits) return false;
+        }
+        value = uint32_t(m_buf >> (64 - nbits));
+        m_buf <<= nbits;
+        m_nbits -= nbits;
+        return true;
+    }
+
+    // Read one pixel code with parameter k (below RICE_RAW). A code is
+    // at most 50 bits long, so one refill covers it.
+    bool code(int k, uint32_t& zz)
+    {
+        if (m_nbits < 50) refill();
+        if (m_buf == 0) return false;
+        int count = count_leading_zeros(m_buf);
+        if (count > RICE_ESCAPE) return false;
+        int extra  = (count == RICE_ESCAPE) ? 17 : k;
+        int length = count + 1 + extra;
+        if (length > m_nbits) return false;
+
+        uint64_t rest = m_buf << (count + 1);
+        uint32_t low  = (extra > 0) ? uint32_t(rest >> (64 - extra)) : 0;
+        zz = (count == RICE_ESCAPE) ? low : ((uint32_t(count) << k) | low);
+        m_buf <<= length;
+        m_nbits -= length;
+        return true;
+    }
+
+    // Position of the byte after the last one read from
+    const uint8_t* end_of_bytes() const
+    {
+        return m_pos - m_nbits / 8;
+    }
+};
+
+} // namespace
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzRiceSource::lutzRiceSource() :
+    lutzRowSource(),
+    m_data(nullptr),
+    m_nbytes(0),
+    m_pos(0),
+    m_block(32)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from a coded frame
+ *
+ * @param[in] data          Coded frame
+ * @param[in] nbytes        Number of bytes in data
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ * @param[in] block         Pixels per block, as given to Encode(). With
+ *                          less than 1 the data are refused.
+ ****************************************************************/
+lutzRiceSource::lutzRiceSource(const uint8_t* data, size_t nbytes,
+                               int xpixels, int ypixels, int block) :
+    lutzRowSource(xpixels, ypixels),
+    m_data(data),
+    m_nbytes(nbytes),
+    m_pos(0),
+    m_block(block)
+{
+    // A block of no pixels would never get to the end of a row
+    if (m_block < 1) {
+        m_data   = nullptr;
+        m_nbytes = 0;
+    }
+}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzRiceSource::~lutzRiceSource()
+{}
+
+
+/************************************************************//**
+ * @brief Set the coded frame
+ *
+ * @param[in] data          Coded frame
+ * @param[in] nbytes        Number of bytes in data
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ * @param[in] block         Pixels per block, as given to Encode(). With
+ *                          less than 1 the data are refused.
+ ****************************************************************/
+void lutzRiceSource::SetData(const uint8_t* data, size_t nbytes,
+                             int xpixels, int ypixels, int block)
+{
+    bool valid = (block >= 1);
+    m_data   = valid ? data : nullptr;
+    m_nbytes = valid ? nbytes : 0;
+    m_xpix   = xpixels;
+    m_ypix   = ypixels;
+    m_block  = block;
+    m_pos    = 0;
+}
+
+
+/************************************************************//**
+ * @brief Go back to the first row of the frame
+ ****************************************************************/
+void lutzRiceSource::Rewind()
+{
+    m_pos = 0;
+}
+
+
+/************************************************************//**
+ * @brief Decode the next row
+ *
+ * @param[out] row          m_xpix values to be filled
+ * @return Whether a whole row could be decoded
+ ****************************************************************/
+bool lutzRiceSource::ReadRow(uint16_t* row)
+{
+    if (m_xpix <= 0) return true;
+    BitReader bits(m_data + m_pos, m_data + m_nbytes);
+
+    uint32_t value;
+    if (!bits.get(16, value)) return false;
+    row[0] = uint16_t(value);
+
+    for (int start=1; start < m_xpix; start += m_block) {
+        int end = (start + m_block < m_xpix) ? start + m_block : m_xpix;
+        uint32_t k;
+        if (!bits.get(4, k)) return false;
+
+        if (k == RICE_RAW) {
+            for (int xindx=start; xindx < end; xindx++) {
+                if (!bits.get(16, value)) return false;
+                row[xindx] = uint16_t(value);
+            }
+            continue;
+        }
+
+        for (int xindx=start; xindx < end; xindx++) {
+            uint32_t zz;
+            if (!bits.code(k, zz)) return false;
+            value += (zz >> 1) ^ (0u - (zz & 1));
+            row[xindx] = uint16_t(value);
+        }
+    }
+
+    m_pos = bits.end_of_bytes() - m_data;
+    return true;
+}
+
+
+/************************************************************//**
+ * @brief Code a frame
+ *
+ * @param[in] image         xpixels x ypixels values
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ * @param[out] data         Coded frame (replaces any contents)
+ * @param[in] block         Pixels per block
+ * @return Whether the frame was coded. A block of less than 1 pixel is
+ *         refused, leaving data empty.
+ ****************************************************************/
+bool lutzRiceSource::Encode(const uint16_t* image, int xpixels, int ypixels,
+                            std::vector<uint8_t>& data, int block)
+{
+    data.clear();
+    if (block < 1) return false;
+    BitWriter bits(data);
+    std::vector<uint32_t> zz(block);
+
+    for (int yindx=0; yindx < ypixels; yindx++) {
+        const uint16_t* row = image + size_t(yindx) * xpixels;
+        if (xpixels <= 0) continue;
+        bits.put(row[0], 16);
+
+        for (int start=1; start < xpixels; start += block) {
+            int end = (start + block < xpixels) ? start + block : xpixels;
+            int n   = end - start;
+
+            // Map the differences and pick k from their mean
+            uint64_t sum = 0;
+            for (int i=0; i < n; i++) {
+                int32_t diff = int32_t(row[start + i]) - int32_t(row[start + i - 1]);
+                zz[i] = (uint32_t(diff) << 1) ^ uint32_t(diff >> 31);
+                sum += zz[i];
+            }
+            int k = 0;
+            while ((k < RICE_RAW - 1) && ((uint64_t(n) << (k + 1)) <= sum)) k++;
+
+            // Fall back to the values themselves if that is no longer
+            uint64_t cost = 0;
+            for (int i=0; i < n; i++) {
+                uint32_t q = zz[i] >> k;
+                cost += (q < RICE_ESCAPE) ? (q + 1 + k) : (RICE_ESCAPE + 1 + 17);
+            }
+            if (cost >= uint64_t(16) * n) {
+                bits.put(RICE_RAW, 4);
+                for (int i=0; i < n; i++) bits.put(row[start + i], 16);
+                continue;
+            }
+
+            bits.put(k, 4);
+            for (int i=0; i < n; i++) {
+                uint32_t q = zz[i] >> k;
+                if (q < RICE_ESCAPE) {
+                    bits.put(1, q + 1);
+                    if (k > 0) bits.put(zz[i], k);
+                } else {
+                    bits.put(0, RICE_ESCAPE);
+                    bits.put(1, 1);
+                    bits.put(zz[i], 17);
+                }
+            }
+        }
+        bits.flush();
+    }
+    return true;
+}
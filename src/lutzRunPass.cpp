@@ -0,0 +1,448 @@
+/***************************************************************************
+ *  lutzRunPass.cpp - Run based labelling with a choice of engine          *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzRunPass.cpp
+ * @brief Implements the lutzRunPass class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "lutzRunPass.hpp"
+#include "lutzTrace.hpp"
+
+namespace {
+
+/************************************************************//**
+ * @brief Return the position of the lowest set bit of a non-zero word
+ ****************************************************************/
+inline int count_trailing_zeros(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int n = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/************************************************************//**
+ * @brief Return whether a pixel comes before another in raster order
+ ****************************************************************/
+inline bool raster_order(const lutzObject::pixData& a, const lutzObject::pixData& b)
+{
+    return (a.m_ybin < b.m_ybin) || ((a.m_ybin == b.m_ybin) && (a.m_xbin < b.m_xbin));
+}
+
+// Pixel lists from which SortPixels() counts rather than sorts
+const size_t SORT_COUNT_PIXELS = 64;
+
+// Rows and pixels between the samples taken by ENGINE_AUTO
+const int DENSITY_ROW_STEP   = 16;
+const int DENSITY_PIXEL_STEP = 4;
+
+} // namespace
+
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzRunPass::lutzRunPass() :
+    lutzOnePass(),
+    m_engine(ENGINE_AUTO),
+    m_density(0.3),
+    m_last_engine(ENGINE_LUTZ),
+    m_last_density(-1.0)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from a vector
+ *
+ * @param[in] image         1D vector containing image data
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ ****************************************************************/
+lutzRunPass::lutzRunPass(double* image, int xpixels, int ypixels) :
+    lutzOnePass(image, xpixels, ypixels),
+    m_engine(ENGINE_AUTO),
+    m_density(0.3),
+    m_last_engine(ENGINE_LUTZ),
+    m_last_density(-1.0)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzRunPass::~lutzRunPass()
+{}
+
+
+/************************************************************//**
+ * @brief Give back the memory kept from one run to the next
+ ****************************************************************/
+void lutzRunPass::ReleaseMemory()
+{
+    lutzOnePass::ReleaseMemory();
+    std::vector<Run>().swap(m_runs);
+    std::vector<int>().swap(m_root);
+    std::vector<uint64_t>().swap(m_bits);
+    std::vector<ObjectInfo>().swap(m_objects);
+    std::vector<int>().swap(m_finish);
+    Object().swap(m_sorted);
+    std::vector<int>().swap(m_count);
+}
+
+
+/************************************************************//**
+ * @brief Return whether the scan may read the rows of m_image directly
+ *
+ * @return Whether there is an m_image and this is a lutzRunPass itself,
+ *         whose pixel tests are those of m_image
+ ****************************************************************/
+bool lutzRunPass::HasDirectRows() const
+{
+    return (m_image != nullptr) && (typeid(*this) == typeid(lutzRunPass));
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Find the objects with the chosen engine
+ *
+ * ENGINE_RUNS holds every object until the end of the frame, so the
+ * Lutz engine is used whenever memory limits or an object filter are
+ * set, whichever engine was asked for. Without rows of m_image to read
+ * (no image, or a subclass with its own pixel tests) the scan is that
+ * of lutzOnePass.
+ ****************************************************************/
+void lutzRunPass::ScanImage()
+{
+    m_last_engine  = m_engine;
+    m_last_density = -1.0;
+    if (!HasDirectRows() || m_limited || m_config.m_filter) {
+        m_last_engine = ENGINE_LUTZ;
+    } else if (m_engine == ENGINE_AUTO) {
+        m_last_density = SampleDensity();
+        m_last_engine  = (m_last_density >= m_density) ? ENGINE_RUNS : ENGINE_LUTZ;
+    }
+
+    if (m_last_engine == ENGINE_RUNS) {
+        ScanRuns();
+    } else if (HasDirectRows()) {
+        ScanImageDirect();
+    } else {
+        lutzOnePass::ScanImage();
+    }
+}
+
+
+/************************************************************//**
+ * @brief Write an object with its pixels in raster order
+ *
+ * @param[in] obj           Completed object
+ *
+ * The Lutz scan appends the pieces of an object in the order they join,
+ * so its pixels are put in the order ENGINE_RUNS gathers them. Most
+ * objects never join another piece and are already in order.
+ ****************************************************************/
+void lutzRunPass::WriteObject(ObjectInfo& obj)
+{
+    if ((m_last_engine == ENGINE_LUTZ) &&
+        !std::is_sorted(obj.m_pixels.begin(), obj.m_pixels.end(), raster_order)) {
+        SortPixels(obj);
+    }
+    lutzOnePass::WriteObject(obj);
+}
+
+
+/************************************************************//**
+ * @brief Put the pixels of an object in raster order
+ *
+ * @param[in,out] obj       Object with its pixel list
+ *
+ * Small lists are simply sorted. Large ones are counted into place by x
+ * and then by y within the bounding box, which takes two passes however
+ * many pieces the object was joined from.
+ ****************************************************************/
+void lutzRunPass::SortPixels(ObjectInfo& obj)
+{
+    Object& pixels = obj.m_pixels;
+    if (pixels.size() < SORT_COUNT_PIXELS) {
+        std::sort(pixels.begin(), pixels.end(), raster_order);
+        return;
+    }
+
+    m_sorted.resize(pixels.size());
+    m_count.assign(obj.m_xmax - obj.m_xmin + 2, 0);
+    for (size_t i=0; i < pixels.size(); i++) m_count[pixels[i].m_xbin - obj.m_xmin + 1]++;
+    for (size_t c=1; c < m_count.size(); c++) m_count[c] += m_count[c - 1];
+    for (size_t i=0; i < pixels.size(); i++) {
+        m_sorted[m_count[pixels[i].m_xbin - obj.m_xmin]++] = pixels[i];
+    }
+
+    m_count.assign(obj.m_ymax - obj.m_ymin + 2, 0);
+    for (size_t i=0; i < m_sorted.size(); i++) m_count[m_sorted[i].m_ybin - obj.m_ymin + 1]++;
+    for (size_t c=1; c < m_count.size(); c++) m_count[c] += m_count[c - 1];
+    for (size_t i=0; i < m_sorted.size(); i++) {
+        pixels[m_count[m_sorted[i].m_ybin - obj.m_ymin]++] = m_sorted[i];
+    }
+}
+
+
+/************************************************************//**
+ * @brief Estimate the fraction of the image above threshold
+ *
+ * @return Fraction of a sparse grid of pixels above threshold
+ ****************************************************************/
+double lutzRunPass::SampleDensity()
+{
+    size_t nsample = 0;
+    size_t nabove  = 0;
+    for (int yindx=DENSITY_ROW_STEP / 2; yindx < m_ypix; yindx += DENSITY_ROW_STEP) {
+        const double* row = m_image + size_t(yindx) * m_xpix;
+        for (int xindx=0; xindx < m_xpix; xindx += DENSITY_PIXEL_STEP) {
+            nabove += (row[xindx] > m_threshold);
+            nsample++;
+        }
+    }
+    return (nsample > 0) ? double(nabove) / nsample : 0.0;
+}
+
+
+/************************************************************//**
+ * @brief Label the image by joining runs of image pixels
+ ****************************************************************/
+void lutzRunPass::ScanRuns()
+{
+    int nwords = (m_xpix + 63) / 64;
+    m_bits.assign(nwords, 0);
+    m_runs.clear();
+    m_root.clear();
+
+    {
+        LUTZ_TRACE_SCOPE("find_runs");
+        LUTZ_TRACE_ROWS();
+        int prev_start = 0;
+        for (int yindx=0; yindx < m_ypix; yindx++) {
+
+            LUTZ_TRACE_ROW(yindx);
+
+            // Threshold this row into bits, as the direct scan does
+            const double* row = m_image + size_t(yindx) * m_xpix;
+            ThresholdRow(row, m_bits.data());
+            if (m_adaptive) m_background.addRow(row, m_xpix, yindx);
+            if (m_bad_rows) {
+                if (m_check_bad) FindNaNs(row, m_NANBITS.data());
+                ApplyBadPixels(yindx, m_check_bad ? m_NANBITS.data() : nullptr,
+                               m_bits.data());
+            }
+
+            // Cut the row into runs and join them to the row above
+            int cur_start = m_runs.size();
+            FindRuns(m_bits.data(), yindx);
+            JoinRows(prev_start, cur_start, m_runs.size());
+            prev_start = cur_start;
+        }
+    }
+
+    LUTZ_TRACE_SCOPE("gather_objects");
+    GatherObjects();
+}
+
+
+/************************************************************//**
+ * @brief Append the runs of set bits on a row
+ *
+ * @param[in] bits          Thresholded bits of the row
+ * @param[in] yindx         Row
+ *
+ * Each set bit of bits ^ (bits << 1) marks where a run starts or where
+ * the pixel after a run is.
+ ****************************************************************/
+void lutzRunPass::FindRuns(const uint64_t* bits, int yindx)
+{
+    int nwords = (m_xpix + 63) / 64;
+    int      nlast    = m_xpix - 64 * (nwords - 1);
+    uint64_t lastmask = (nlast == 64) ? ~uint64_t(0) : ((uint64_t(1) << nlast) - 1);
+
+    uint64_t carry  = 0;
+    bool     in_run = false;
+    Run      run;
+    run.m_y = yindx;
+
+    for (int w=0; w < nwords; w++) {
+        uint64_t c = bits[w];
+        if (w == nwords - 1) c &= lastmask;
+        uint64_t edges = c ^ ((c << 1) | carry);
+        carry = c >> 63;
+
+        while (edges) {
+            int x = 64 * w + count_trailing_zeros(edges);
+            edges &= edges - 1;
+            if (in_run) {
+                run.m_xend = x - 1;
+                m_runs.push_back(run);
+                m_root.push_back(m_root.size());
+            } else {
+                run.m_xstart = x;
+            }
+            in_run = !in_run;
+        }
+    }
+
+    // A run reaching the end of the row
+    if (in_run) {
+        run.m_xend = m_xpix - 1;
+        m_runs.push_back(run);
+        m_root.push_back(m_root.size());
+    }
+}
+
+
+/************************************************************//**
+ * @brief Join the runs of a row to the runs they touch on the row above
+ *
+ * @param[in] prev_start    First run of the previous row
+ * @param[in] cur_start     First run of this row (one past the last of
+ *                          the previous row)
+ * @param[in] cur_end       One past the last run of this row
+ *
+ * Runs touch when they overlap or meet at a corner (8-connectivity). The
+ * root of a set is always its earliest run.
+ ****************************************************************/
+void lutzRunPass::JoinRows(int prev_start, int cur_start, int cur_end)
+{
+    int p = prev_start;
+    for (int c=cur_start; c < cur_end; c++) {
+        const Run& run = m_runs[c];
+
+        // Skip the runs above that end before this one can touch them
+        while ((p < cur_start) && (m_runs[p].m_xend < run.m_xstart - 1)) p++;
+
+        for (int q=p; (q < cur_start) && (m_runs[q].m_xstart <= run.m_xend + 1); q++) {
+            int a = FindRoot(c);
+            int b = FindRoot(q);
+            if (a < b) std::swap(a, b);
+            m_root[a] = b;
+        }
+    }
+}
+
+
+/************************************************************//**
+ * @brief Return the earliest run of the set a run belongs to
+ *
+ * @param[in] run           Run
+ * @return Root run of the set
+ ****************************************************************/
+int lutzRunPass::FindRoot(int run)
+{
+    while (m_root[run] != run) {
+        m_root[run] = m_root[m_root[run]];
+        run = m_root[run];
+    }
+    return run;
+}
+
+
+/************************************************************//**
+ * @brief Collect the pixels of every object and write the objects
+ *
+ * The objects are written in the order the Lutz scan completes them. It
+ * closes an object on the row below its last one, at the pixel after
+ * its last run there, and closes the objects that reach the bottom row
+ * at the end of the frame, in the order of their first run on that row.
+ * Either way that is the order of one run of each object, its finishing
+ * run, among the runs of the frame.
+ ****************************************************************/
+void lutzRunPass::GatherObjects()
+{
+    // Number the objects in the order of their first run. A parent always
+    // comes before its child, so it has already been given its number,
+    // which is stored as -(number + 1).
+    int nobjects = 0;
+    for (int r=0; r < m_runs.size(); r++) {
+        int parent = m_root[r];
+        m_root[r] = (parent == r) ? -(++nobjects) : m_root[parent];
+    }
+
+    m_objects.resize(std::max<size_t>(m_objects.size(), nobjects));
+    m_finish.assign(nobjects, -1);
+    for (int i=0; i < nobjects; i++) {
+        m_objects[i].clear();
+        if (m_provisional) m_objects[i].m_label = NewLabel();
+    }
+
+    // Add the pixels run by run, treating bad pixels as the Lutz scan does
+    const int ylast = m_ypix - 1;
+    for (int r=0; r < m_runs.size(); r++) {
+        const Run&    run  = m_runs[r];
+        int           obj  = -m_root[r] - 1;
+        ObjectInfo&   info = m_objects[obj];
+        const double* row  = m_image + size_t(run.m_y) * m_xpix;
+
+        // The last run so far, unless the object has reached the bottom row
+        int& finish = m_finish[obj];
+        if ((finish < 0) || (run.m_y < ylast) || (m_runs[finish].m_y < ylast)) {
+            finish = r;
+        }
+
+        for (int xindx=run.m_xstart; xindx <= run.m_xend; xindx++) {
+            double value = row[xindx];
+            if (m_check_bad) {
+                bool is_nan = std::isnan(value);
+                if (is_nan || IsMaskedPixel(xindx, run.m_y)) {
+                    info.m_flags |= lutzObject::FLAG_BAD_PIXEL;
+                    if (is_nan || (m_config.m_bad_action == BAD_BRIDGE)) {
+                        info.m_nbad++;
+                        continue;
+                    }
+                }
+            }
+            info.add(lutzObject::pixData(xindx, run.m_y, value), m_keep_pixels);
+            if (m_provisional) {
+                m_labels[size_t(run.m_y) * m_xpix + xindx] = -info.m_label;
+            }
+        }
+        if (m_flag_excluded) {
+            FlagExcluded(info, run.m_xstart, run.m_xend, run.m_y - 1,
+                         std::min(run.m_y + 1, ylast));
+        }
+    }
+
+    for (int r=0; r < m_runs.size(); r++) {
+        int obj = -m_root[r] - 1;
+        if (m_finish[obj] != r) continue;
+        WriteObject(m_objects[obj]);
+        m_objects[obj].clear();
+    }
+}
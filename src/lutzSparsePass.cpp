@@ -0,0 +1,300 @@
+/***************************************************************************
+ *  lutzSparsePass.cpp - Lutz one pass algorithm on a sparse hit list      *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzSparsePass.cpp
+ * @brief Implements the lutzSparsePass class
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "lutzSparsePass.hpp"
+#include "lutzTrace.hpp"
+
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzSparsePass::lutzSparsePass() :
+    lutzOnePass(),
+    m_row_start(nullptr),
+    m_xpos(nullptr),
+    m_values(nullptr),
+    m_cursor(-1)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from a list of hits
+ *
+ * @param[in] row_start     Index of the first hit of each row, followed
+ *                          by the total number of hits
+ * @param[in] xpos          x position of each hit
+ * @param[in] values        Value of each hit
+ * @param[in] xpixels       Number of pixels in x
+ * @param[in] ypixels       Number of pixels in y
+ ****************************************************************/
+lutzSparsePass::lutzSparsePass(const int* row_start, const int* xpos,
+                               const double* values,
+                               int xpixels, int ypixels) :
+    lutzOnePass(nullptr, xpixels, ypixels),
+    m_row_start(row_start),
+    m_xpos(xpos),
+    m_values(values),
+    m_cursor(-1)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzSparsePass::~lutzSparsePass()
+{}
+
+
+/************************************************************//**
+ * @brief Return value of given pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Value of the hit at this pixel, or 0 if there is none
+ *
+ * During the scan the hit being processed is remembered, so looking up
+ * its value does not need a search.
+ ****************************************************************/
+double lutzSparsePass::GetPixValue(int xbin, int ybin)
+{
+    int first = m_row_start[ybin];
+    int last  = m_row_start[ybin + 1];
+
+    if ((m_cursor >= first) && (m_cursor < last) && (m_xpos[m_cursor] == xbin)) {
+        return m_values[m_cursor];
+    }
+
+    const int* hit = std::lower_bound(m_xpos + first, m_xpos + last, xbin);
+    if ((hit != m_xpos + last) && (*hit == xbin)) {
+        return m_values[hit - m_xpos];
+    }
+    return 0.0;
+}
+
+
+/************************************************************//**
+ * @brief Assess whether or not this pixel is an image pixel
+ *
+ * @param[in] xbin          x bin of pixel
+ * @param[in] ybin          y bin of pixel
+ * @return Whether or not this bin is significant
+ ****************************************************************/
+bool lutzSparsePass::AssessPixel(int xbin, int ybin)
+{
+    return (GetPixValue(xbin, ybin) > m_threshold);
+}
+
+
+/************************************************************//**
+ * @brief Return whether the scan may read the rows of m_image directly
+ *
+ * @return Always false, since the pixel values come from the list of hits
+ ****************************************************************/
+bool lutzSparsePass::HasDirectRows() const
+{
+    return false;
+}
+
+
+/************************************************************//**
+ * @brief Return whether a span of a row holds a NaN hit
+ *
+ * @param[in] xlo           First pixel of the span
+ * @param[in] xhi           Last pixel of the span
+ * @param[in] yindx         Row of the image
+ * @return Whether any hit in the span has a NaN value
+ *
+ * Pixels without a hit are 0, so only the hits need looking at for
+ * NaNs. The bad pixel mask is read in full.
+ ****************************************************************/
+bool lutzSparsePass::HasExcludedPixel(int xlo, int xhi, int yindx)
+{
+    if (m_bad_mask || m_bad_bits) {
+        for (int xindx=xlo; xindx <= xhi; xindx++) {
+            if (IsMaskedPixel(xindx, yindx)) return true;
+        }
+    }
+    
+    int first = m_row_start[yindx];
+    int last  = m_row_start[yindx + 1];
+    int hit   = std::lower_bound(m_xpos + first, m_xpos + last, xlo) - m_xpos;
+    for (; (hit < last) && (m_xpos[hit] <= xhi); hit++) {
+        if (std::isnan(m_values[hit])) return true;
+    }
+    return false;
+}
+
+
+/************************************************************//**
+ * @brief Scan the hits, visiting only the pixels that matter
+ ****************************************************************/
+void lutzSparsePass::ScanImage()
+{
+    int co(0), pstop(0);
+    m_cur_pix.clear();
+    m_prev_pix.clear();
+    LUTZ_TRACE_ROWS();
+
+    for (int yindx=0; yindx < m_ypix; yindx++) {
+
+        // Collect the image pixels of this row
+        m_prev_pix.swap(m_cur_pix);
+        FindImagePixels(yindx);
+        if (m_adaptive) SampleHits(yindx);
+
+        // Nothing on this row and no markers left by the previous one
+        if (m_cur_pix.empty() && m_prev_pix.empty()) continue;
+
+        LUTZ_TRACE_ROW(yindx);
+        StartRow();
+        FillRowEvents();
+
+        size_t k = 0;
+        for (size_t e=0; e < m_events.size(); e++) {
+            int xindx = m_events[e];
+            if (xindx >= m_xpix) break;
+
+            // Find whether this position is one of our image pixels
+            while ((k < m_cur_pix.size()) && (m_cur_pix[k] < xindx)) k++;
+            bool is_image_pixel = (k < m_cur_pix.size()) && (m_cur_pix[k] == xindx);
+
+            m_cursor = is_image_pixel ? m_cur_hits[k] : -1;
+            ProcessPixel(xindx, yindx, is_image_pixel, co, pstop);
+        }
+        m_cursor = -1;
+
+        // Handle the markers beyond the last pixel of the row
+        ProcessPixel(m_xpix, yindx, false, co, pstop);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Collect the image pixels of a row
+ *
+ * @param[in] yindx         Row of the image
+ *
+ * These are the hits above threshold, with the bad pixel treatment
+ * applied to each of them. With BAD_BRIDGE the masked pixels without a
+ * hit are image pixels as well, which means reading the whole row of
+ * the mask.
+ ****************************************************************/
+void lutzSparsePass::FindImagePixels(int yindx)
+{
+    m_cur_pix.clear();
+    m_cur_hits.clear();
+
+    m_masked.clear();
+    if ((m_config.m_bad_action == BAD_BRIDGE) && (m_bad_mask || m_bad_bits)) {
+        for (int xindx=0; xindx < m_xpix; xindx++) {
+            if (IsMaskedPixel(xindx, yindx)) m_masked.push_back(xindx);
+        }
+    }
+
+    size_t m = 0;
+    for (int h=m_row_start[yindx]; h < m_row_start[yindx + 1]; h++) {
+        int xindx = m_xpos[h];
+
+        // Masked pixels before this hit have no hit of their own
+        for (; (m < m_masked.size()) && (m_masked[m] < xindx); m++) {
+            m_cur_pix.push_back(m_masked[m]);
+            m_cur_hits.push_back(-1);
+        }
+        if ((m < m_masked.size()) && (m_masked[m] == xindx)) m++;
+
+        bool is_image_pixel = (m_values[h] > m_threshold);
+        if (m_bad_rows) {
+            m_cursor = h;
+            is_image_pixel = AssessBadPixel(xindx, yindx, is_image_pixel);
+        }
+        if (is_image_pixel) {
+            m_cur_pix.push_back(xindx);
+            m_cur_hits.push_back(h);
+        }
+    }
+    for (; m < m_masked.size(); m++) {
+        m_cur_pix.push_back(m_masked[m]);
+        m_cur_hits.push_back(-1);
+    }
+    m_cursor = -1;
+}
+
+
+/************************************************************//**
+ * @brief Add the sampled pixels of a row to the background estimate
+ *
+ * @param[in] yindx         Row of the image
+ *
+ * The samples are those the dense image would give, 0 where there is
+ * no hit, found by walking the hits of the row alongside them.
+ ****************************************************************/
+void lutzSparsePass::SampleHits(int yindx)
+{
+    int step = m_background.GetSampleStep();
+    int hit  = m_row_start[yindx];
+    int last = m_row_start[yindx + 1];
+    for (int xindx=m_background.FirstSample(yindx); xindx < m_xpix; xindx += step) {
+        while ((hit < last) && (m_xpos[hit] < xindx)) hit++;
+        m_background.add(((hit < last) && (m_xpos[hit] == xindx)) ? m_values[hit] : 0.0);
+    }
+}
+
+
+/************************************************************//**
+ * @brief Build the sorted list of positions to visit on this row
+ *
+ * These are the image pixels on this row and the previous row, together
+ * with the pixel after each of them.
+ ****************************************************************/
+void lutzSparsePass::FillRowEvents()
+{
+    m_events.clear();
+
+    size_t c = 0;
+    size_t p = 0;
+    while ((c < m_cur_pix.size()) || (p < m_prev_pix.size())) {
+        // Take the smaller of the next pixel from each row
+        int xindx;
+        if (p == m_prev_pix.size()) {
+            xindx = m_cur_pix[c++];
+        } else if (c == m_cur_pix.size()) {
+            xindx = m_prev_pix[p++];
+        } else {
+            int xc = m_cur_pix[c];
+            int xp = m_prev_pix[p];
+            xindx = std::min(xc, xp);
+            if (xc == xindx) c++;
+            if (xp == xindx) p++;
+        }
+
+        if (m_events.empty() || (xindx > m_events.back())) {
+            m_events.push_back(xindx);
+        }
+        m_events.push_back(xindx + 1);
+    }
+}
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *  lutzStreamPass.cpp - Lutz one pass algorithm on a stream of rows       *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzStreamPass.cpp
+ * @brief Implements the lutzStreamPass class
+ * @author Josh Cardenzana
+ */
+
+#include "lutzStreamPass.hpp"
+#include "lutzTrace.hpp"
+
+
+/************************************************************//**
+ * @brief Default constructor
+ ****************************************************************/
+lutzStreamPass::lutzStreamPass() :
+    lutzSamplePass<uint16_t>(),
+    m_source(nullptr),
+    m_rows_read(0)
+{}
+
+
+/************************************************************//**
+ * @brief Primary constructor from a row source
+ *
+ * @param[in] source        Source of the rows (the frame size is taken
+ *                          from it)
+ ****************************************************************/
+lutzStreamPass::lutzStreamPass(lutzRowSource* source) :
+    lutzSamplePass<uint16_t>(nullptr, source->GetXpixels(),
+                             source->GetYpixels()),
+    m_source(source),
+    m_rows_read(0)
+{}
+
+
+/************************************************************//**
+ * @brief Destructor
+ ****************************************************************/
+lutzStreamPass::~lutzStreamPass()
+{}
+
+
+/************************************************************//**
+ * @brief Set the source of the rows
+ *
+ * @param[in] source        Source of the rows (the frame size is taken
+ *                          from it)
+ ****************************************************************/
+void lutzStreamPass::SetSource(lutzRowSource* source)
+{
+    m_source = source;
+    SetXpixels(source->GetXpixels());
+    SetYpixels(source->GetYpixels());
+}
+
+
+/*==========================================================================
+ =                                                                         =
+ =                           Protected methods                             =
+ =                                                                         =
+ ==========================================================================*/
+
+/************************************************************//**
+ * @brief Decode and scan the frame one row at a time
+ ****************************************************************/
+void lutzStreamPass::ScanImage()
+{
+    int co(0), pstop(0);
+    int nwords = (m_xpix + 63) / 64;
+    m_ROWBITS.assign(2 * nwords, 0);
+    m_row.resize(m_xpix);
+    m_rows_read = 0;
+    if (m_source == nullptr) return;
+    m_source->Rewind();
+    LUTZ_TRACE_ROWS();
+
+    for (int yindx=0; yindx < m_ypix; yindx++) {
+
+        LUTZ_TRACE_ROW(yindx);
+        uint64_t* cur  = &m_ROWBITS[(yindx & 1) * nwords];
+        uint64_t* prev = (yindx > 0) ? &m_ROWBITS[((yindx - 1) & 1) * nwords] : nullptr;
+
+        // Decode the row into the buffer the threshold reads
+        if (!m_source->ReadRow(m_row.data())) break;
+        m_rows_read++;
+
+        ThresholdPixels(m_row.data(), cur, nwords);
+        if (m_adaptive) m_background.addRow(m_row.data(), m_xpix, yindx);
+        if (m_bad_rows) ApplyBadPixels(yindx, nullptr, cur);
+        ScanBits(cur, prev, nwords, yindx, co, pstop);
+    }
+}
@@ -0,0 +1,233 @@
+/***************************************************************************
+ *  lutzTrace.cpp - Timeline tracing of detection runs                     *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzTrace.cpp
+ * @brief Implements the lutzTrace class
+ * @author Josh Cardenzana
+ */
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lutzTrace.hpp"
+
+namespace {
+
+// A single completed event
+struct TraceEvent {
+    const char* m_name;
+    uint64_t    m_start;
+    uint64_t    m_end;
+    int64_t     m_arg;
+};
+
+// Events recorded by one thread
+struct TraceBuffer {
+    int                     m_tid;
+    std::vector<TraceEvent> m_events;
+};
+
+// Every buffer ever created. Buffers are never freed, so a thread's
+// events can still be written after the thread has finished.
+struct TraceRegistry {
+    std::mutex                                m_mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> m_buffers;
+    std::atomic<int>                          m_cutoff;
+    std::chrono::steady_clock::time_point     m_epoch;
+
+    TraceRegistry() : m_cutoff(100), m_epoch(std::chrono::steady_clock::now()) {}
+};
+
+TraceRegistry& registry()
+{
+    static TraceRegistry reg;
+    return reg;
+}
+
+thread_local TraceBuffer* t_buffer = nullptr;
+
+// Return the buffer of the calling thread, creating it on first use
+TraceBuffer& thread_buffer()
+{
+    if (t_buffer == nullptr) {
+        TraceRegistry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.m_mutex);
+        reg.m_buffers.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer));
+        t_buffer = reg.m_buffers.back().get();
+        t_buffer->m_tid = int(reg.m_buffers.size());
+        t_buffer->m_events.reserve(4096);
+    }
+    return *t_buffer;
+}
+
+// Write a time in nanoseconds as microseconds with three decimals
+void write_micro(std::ostream& out, uint64_t nanosec)
+{
+    char fill = out.fill('0');
+    out << nanosec / 1000 << '.' << std::setw(3) << nanosec % 1000;
+    out.fill(fill);
+}
+
+} // namespace
+
+
+/************************************************************//**
+ * @brief Return the current time
+ *
+ * @return Nanoseconds since the first call in this process
+ ****************************************************************/
+uint64_t lutzTrace::Now()
+{
+    std::chrono::steady_clock::duration since =
+        std::chrono::steady_clock::now() - registry().m_epoch;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(since).count();
+}
+
+
+/************************************************************//**
+ * @brief Record a completed event on the calling thread
+ *
+ * @param[in] name          Name of the event (a string literal)
+ * @param[in] start         Start time from Now()
+ * @param[in] end           End time from Now()
+ * @param[in] arg           Argument shown with the event (-1 for none)
+ ****************************************************************/
+void lutzTrace::Record(const char* name, uint64_t start, uint64_t end,
+                       int64_t arg)
+{
+    TraceEvent event = {name, start, end, arg};
+    thread_buffer().m_events.push_back(event);
+}
+
+
+/************************************************************//**
+ * @brief Write all recorded events as Chrome trace JSON
+ *
+ * @param[in] out           Stream to write to
+ ****************************************************************/
+void lutzTrace::Write(std::ostream& out)
+{
+    TraceRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.m_mutex);
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (size_t b=0; b<reg.m_buffers.size(); b++) {
+        const TraceBuffer& buffer = *reg.m_buffers[b];
+        if (buffer.m_events.empty()) continue;
+
+        // Name the thread so the timeline rows are labelled
+        out << (first ? "\n" : ",\n");
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffer.m_tid << ",\"args\":{\"name\":\"lutz thread "
+            << buffer.m_tid << "\"}}";
+        first = false;
+
+        // Chrome expects times in microseconds
+        for (size_t e=0; e<buffer.m_events.size(); e++) {
+            const TraceEvent& event = buffer.m_events[e];
+            out << ",\n{\"name\":\"" << event.m_name
+                << "\",\"cat\":\"lutz\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << buffer.m_tid
+                << ",\"ts\":";
+            write_micro(out, event.m_start);
+            out << ",\"dur\":";
+            write_micro(out, event.m_end - event.m_start);
+            if (event.m_arg >= 0) {
+                out << ",\"args\":{\"value\":" << event.m_arg << '}';
+            }
+            out << '}';
+        }
+    }
+    out << "\n]}\n";
+}
+
+
+/************************************************************//**
+ * @brief Write all recorded events to a Chrome trace file
+ *
+ * @param[in] filename      Name of the file to write
+ * @return Whether the file could be written
+ ****************************************************************/
+bool lutzTrace::Write(const std::string& filename)
+{
+    std::ofstream out(filename.c_str());
+    if (!out) return false;
+    Write(out);
+    return bool(out);
+}
+
+
+/************************************************************//**
+ * @brief Drop all recorded events
+ ****************************************************************/
+void lutzTrace::clear()
+{
+    TraceRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.m_mutex);
+    for (size_t b=0; b<reg.m_buffers.size(); b++) {
+        reg.m_buffers[b]->m_events.clear();
+    }
+}
+
+
+/************************************************************//**
+ * @brief Return the number of recorded events
+ *
+ * @return Number of events across all threads
+ ****************************************************************/
+size_t lutzTrace::size()
+{
+    TraceRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.m_mutex);
+    size_t nevents = 0;
+    for (size_t b=0; b<reg.m_buffers.size(); b++) {
+        nevents += reg.m_buffers[b]->m_events.size();
+    }
+    return nevents;
+}
+
+
+/************************************************************//**
+ * @brief Set the minimum object size for per-object events
+ *
+ * @param[in] npix          Minimum number of pixels (default 100)
+ ****************************************************************/
+void lutzTrace::SetObjectCutoff(int npix)
+{
+    registry().m_cutoff = npix;
+}
+
+
+/************************************************************//**
+ * @brief Return the minimum object size for per-object events
+ *
+ * @return Minimum number of pixels
+ ****************************************************************/
+int lutzTrace::GetObjectCutoff()
+{
+    return registry().m_cutoff.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,212 @@
+/***************************************************************************
+ *  lutzTest.hpp - Helpers shared by the lutzop tests                      *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file lutzTest.hpp
+ * @brief Helpers shared by the lutzop tests
+ * @author Josh Cardenzana
+ */
+
+#ifndef LUTZTEST_HPP
+#define LUTZTEST_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lutzObject.hpp"
+
+// Record a failed check along with where it was made
+#define LUTZ_CHECK(cond) lutzTest::Check((cond), #cond, __FILE__, __LINE__)
+
+namespace lutzTest {
+
+// A catalog reduced to something that can be compared: the positions of
+// each object's pixels in increasing order, with the objects ordered by
+// their first pixel
+typedef std::vector<std::vector<long> > Catalog;
+
+
+/***************************************************************//**
+ * @brief Return the number of failed checks so far
+ *******************************************************************/
+inline int& Failures()
+{
+    static int nfailures = 0;
+    return nfailures;
+}
+
+
+/***************************************************************//**
+ * @brief Record the result of a check
+ *
+ * @param[in] passed        Whether the check passed
+ * @param[in] what          Text of the check
+ * @param[in] file          File the check is in
+ * @param[in] line          Line the check is on
+ * @return Whether the check passed
+ *******************************************************************/
+inline bool Check(bool passed, const char* what, const char* file, int line)
+{
+    if (!passed) {
+        std::cerr << file << ":" << line << ": check failed: " << what << std::endl;
+        Failures()++;
+    }
+    return passed;
+}
+
+
+/***************************************************************//**
+ * @brief Report the outcome of a test program
+ *
+ * @param[in] name          Name of the test
+ * @return Exit code for main()
+ *******************************************************************/
+inline int Result(const char* name)
+{
+    if (Failures() > 0) {
+        std::cerr << name << ": " << Failures() << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << name << ": passed" << std::endl;
+    return 0;
+}
+
+
+/***************************************************************//**
+ * @brief Make a frame with a given fraction of pixels above 1
+ *
+ * @param[in] xpix          Number of pixels in x
+ * @param[in] ypix          Number of pixels in y
+ * @param[in] density       Fraction of pixels set above 1
+ * @param[in] seed          Seed of the random numbers
+ * @return xpix x ypix values, between 0 and 1 for the background and
+ *         between 1 and 2 for the rest
+ *******************************************************************/
+inline std::vector<double> RandomImage(int xpix, int ypix, double density,
+                                       unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<double> image(size_t(xpix) * ypix);
+    for (size_t i=0; i<image.size(); i++) {
+        double value = uniform(random);
+        image[i] = (uniform(random) < density) ? 1.0 + value : value;
+    }
+    return image;
+}
+
+
+/***************************************************************//**
+ * @brief Make a frame from a picture drawn with characters
+ *
+ * @param[in] rows          ypix rows of equal length, '#' for a pixel of
+ *                          value 1 and anything else for 0
+ * @param[in] ypix          Number of rows
+ * @return Frame values
+ *******************************************************************/
+inline std::vector<double> DrawImage(const char* const rows[], int ypix)
+{
+    int xpix = std::string(rows[0]).size();
+    std::vector<double> image(size_t(xpix) * ypix, 0.0);
+    for (int y=0; y<ypix; y++) {
+        for (int x=0; x<xpix; x++) {
+            if (rows[y][x] == '#') image[size_t(y) * xpix + x] = 1.0;
+        }
+    }
+    return image;
+}
+
+
+/***************************************************************//**
+ * @brief Reduce a list of objects to a comparable catalog
+ *
+ * @param[in] objects       Objects with their pixel lists
+ * @param[in] xpix          Number of pixels in x
+ * @return Sorted catalog
+ *******************************************************************/
+inline Catalog MakeCatalog(const std::vector<lutzObject>& objects, int xpix)
+{
+    Catalog catalog(objects.size());
+    for (size_t i=0; i<objects.size(); i++) {
+        for (int p=0; p<objects[i].size(); p++) {
+            catalog[i].push_back(long(objects[i][p].m_ybin) * xpix + objects[i][p].m_xbin);
+        }
+        std::sort(catalog[i].begin(), catalog[i].end());
+    }
+    std::sort(catalog.begin(), catalog.end());
+    return catalog;
+}
+
+
+/***************************************************************//**
+ * @brief Find the objects of a frame by flood filling it
+ *
+ * @param[in] image         Frame values
+ * @param[in] xpix          Number of pixels in x
+ * @param[in] ypix          Number of pixels in y
+ * @param[in] threshold     Pixels above this value are image pixels
+ * @return Sorted catalog of the 8-connected groups of image pixels
+ *
+ * This is slow but simple, and so serves as the reference the scans are
+ * checked against.
+ *******************************************************************/
+inline Catalog FloodFill(const std::vector<double>& image, int xpix, int ypix,
+                         double threshold)
+{
+    Catalog catalog;
+    std::vector<char> seen(image.size(), 0);
+    std::vector<long> stack;
+    for (long start=0; start < long(image.size()); start++) {
+        if (seen[start] || !(image[start] > threshold)) continue;
+        
+        catalog.push_back(std::vector<long>());
+        seen[start] = 1;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            long pix = stack.back();
+            stack.pop_back();
+            catalog.back().push_back(pix);
+            int x = pix % xpix;
+            int y = pix / xpix;
+            for (int dy=-1; dy<=1; dy++) {
+                for (int dx=-1; dx<=1; dx++) {
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if ((nx < 0) || (nx >= xpix) || (ny < 0) || (ny >= ypix)) continue;
+                    long next = long(ny) * xpix + nx;
+                    if (seen[next] || !(image[next] > threshold)) continue;
+                    seen[next] = 1;
+                    stack.push_back(next);
+                }
+            }
+        }
+        std::sort(catalog.back().begin(), catalog.back().end());
+    }
+    std::sort(catalog.begin(), catalog.end());
+    return catalog;
+}
+
+} // namespace lutzTest
+
+#endif /* LUTZTEST_HPP */
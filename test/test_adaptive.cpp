@@ -0,0 +1,140 @@
+/***************************************************************************
+ *  test_adaptive.cpp - Tests of the adaptive threshold                    *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_adaptive.cpp
+ * @brief Tests that the adaptive threshold follows the background without
+ *        touching the configuration
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "lutzOnePass.hpp"
+#include "lutzRunPass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+const int    XPIX   = 200;
+const int    YPIX   = 150;
+const double LEVEL  = 100.0;   // Background level of every frame
+const double SIGMA  = 10.0;    // Background noise of every frame
+const double NSIGMA = 5.0;     // Adaptive threshold, in units of SIGMA
+
+
+/***************************************************************//**
+ * @brief Make a frame of background noise with a few bright squares
+ *
+ * @param[in] seed          Seed of the random numbers
+ * @return XPIX x YPIX values
+ *******************************************************************/
+std::vector<double> NoiseImage(unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::normal_distribution<double> noise(LEVEL, SIGMA);
+    std::vector<double> image(size_t(XPIX) * YPIX);
+    for (size_t i=0; i<image.size(); i++) image[i] = noise(random);
+    
+    for (int s=0; s<6; s++) {
+        int x0 = 10 + 30 * s;
+        int y0 = 20 + 20 * s;
+        for (int y=y0; y<y0+5; y++) {
+            for (int x=x0; x<x0+5; x++) image[size_t(y) * XPIX + x] += 20.0 * SIGMA;
+        }
+    }
+    return image;
+}
+
+
+/***************************************************************//**
+ * @brief Run a detector over a sequence of frames
+ *
+ * The first frame is cut at the configured threshold, later ones at
+ * the background level plus NSIGMA times the noise, and a reset of the
+ * background goes back to the configured threshold. The configuration
+ * never changes, and each frame gives the objects a flood fill finds at
+ * the threshold the run reports.
+ *******************************************************************/
+void CheckSequence(lutzOnePass& detector, std::vector<double>& image)
+{
+    const double configured = 1.0e6;
+    detector.SetThreshold(configured);
+    detector.SetAdaptiveThreshold(NSIGMA);
+    
+    for (int frame=0; frame<5; frame++) {
+        if (frame == 3) detector.GetBackground().Reset();
+        std::vector<double> noise = NoiseImage(frame + 1);
+        std::copy(noise.begin(), noise.end(), image.begin());
+        detector.run();
+        
+        LUTZ_CHECK(detector.GetConfig().m_threshold == configured);
+        double threshold = detector.GetRunThreshold();
+        if ((frame == 0) || (frame == 3)) {
+            LUTZ_CHECK(threshold == configured);
+            LUTZ_CHECK(detector.NumObjects() == 0);
+        } else {
+            LUTZ_CHECK(std::fabs(threshold - (LEVEL + NSIGMA * SIGMA)) < SIGMA);
+            LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), XPIX) ==
+                       lutzTest::FloodFill(image, XPIX, YPIX, threshold));
+        }
+    }
+    
+    // Switching it off goes straight back to the configured threshold
+    detector.SetAdaptiveThreshold(0.0);
+    detector.run();
+    LUTZ_CHECK(detector.GetRunThreshold() == configured);
+}
+
+
+/***************************************************************//**
+ * @brief The Lutz scan follows the background
+ *******************************************************************/
+void TestOnePass()
+{
+    std::vector<double> image(size_t(XPIX) * YPIX, 0.0);
+    lutzOnePass detector(image.data(), XPIX, YPIX);
+    CheckSequence(detector, image);
+}
+
+
+/***************************************************************//**
+ * @brief The run based scan follows the background
+ *******************************************************************/
+void TestRunPass()
+{
+    std::vector<double> image(size_t(XPIX) * YPIX, 0.0);
+    lutzRunPass detector(image.data(), XPIX, YPIX);
+    detector.SetEngine(lutzRunPass::ENGINE_RUNS);
+    CheckSequence(detector, image);
+}
+
+} // namespace
+
+
+int main()
+{
+    TestOnePass();
+    TestRunPass();
+    return lutzTest::Result("test_adaptive");
+}
@@ -0,0 +1,259 @@
+/***************************************************************************
+ *  test_bad.cpp - Tests of the bad pixel treatment                        *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_bad.cpp
+ * @brief Tests that masked and NaN pixels are treated, and recorded, as
+ *        the bad pixel action asks
+ * @author Josh Cardenzana
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "lutzSamplePass.hpp"
+#include "lutzOnePass.hpp"
+#include "lutzRunPass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+// Sorted pixel positions of each object, with whether it was flagged
+typedef std::map<std::vector<long>, bool> FlagCatalog;
+
+
+/***************************************************************//**
+ * @brief Detector that tests every pixel through the virtual methods
+ *******************************************************************/
+class PixelPass : public lutzOnePass {
+public:
+    PixelPass(double* image, int xpixels, int ypixels) :
+        lutzOnePass(image, xpixels, ypixels)
+    {}
+};
+
+
+/***************************************************************//**
+ * @brief Reduce a list of objects to their pixels and flags
+ *******************************************************************/
+FlagCatalog MakeFlagCatalog(const std::vector<lutzObject>& objects, int xpix)
+{
+    FlagCatalog catalog;
+    for (size_t i=0; i<objects.size(); i++) {
+        std::vector<long> pixels;
+        for (int p=0; p<objects[i].size(); p++) {
+            pixels.push_back(long(objects[i][p].m_ybin) * xpix + objects[i][p].m_xbin);
+        }
+        std::sort(pixels.begin(), pixels.end());
+        catalog[pixels] = (objects[i].GetFlags() & lutzObject::FLAG_BAD_PIXEL) != 0;
+    }
+    return catalog;
+}
+
+
+/***************************************************************//**
+ * @brief Find the objects of a frame by flood filling it
+ *
+ * @param[in] image         Frame values
+ * @param[in] mask          One flag per pixel (non-zero = bad)
+ * @param[in] xpix          Number of pixels in x
+ * @param[in] ypix          Number of pixels in y
+ * @param[in] threshold     Pixels above this value are image pixels
+ * @param[in] action        Bad pixel action
+ * @return Objects and flags, following the description of
+ *         lutzOnePass::SetBadPixelAction()
+ *******************************************************************/
+FlagCatalog Reference(const std::vector<double>& image,
+                      const std::vector<uint8_t>& mask,
+                      int xpix, int ypix, double threshold,
+                      lutzOnePass::LUTZ_BAD_ACTION action)
+{
+    long npix = long(xpix) * ypix;
+    std::vector<char> bad(npix), joins(npix), counts(npix);
+    for (long i=0; i<npix; i++) {
+        bool nan   = std::isnan(image[i]);
+        bool above = image[i] > threshold;
+        bad[i] = nan || mask[i];
+        if (action == lutzOnePass::BAD_EXCLUDE) {
+            joins[i]  = above && !mask[i];
+            counts[i] = true;
+        } else if (action == lutzOnePass::BAD_BRIDGE) {
+            joins[i]  = above || bad[i];
+            counts[i] = !bad[i];
+        } else {
+            joins[i]  = above || nan;
+            counts[i] = !nan;
+        }
+    }
+    
+    FlagCatalog catalog;
+    std::vector<char> seen(npix, 0);
+    for (long start=0; start < npix; start++) {
+        if (seen[start] || !joins[start]) continue;
+        
+        std::vector<long> pixels;
+        std::vector<long> stack(1, start);
+        bool flagged = false;
+        seen[start] = 1;
+        while (!stack.empty()) {
+            long pix = stack.back();
+            stack.pop_back();
+            if (counts[pix]) pixels.push_back(pix);
+            if ((action != lutzOnePass::BAD_EXCLUDE) && bad[pix]) flagged = true;
+            int x = pix % xpix;
+            int y = pix / xpix;
+            for (int dy=-1; dy<=1; dy++) {
+                for (int dx=-1; dx<=1; dx++) {
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if ((nx < 0) || (nx >= xpix) || (ny < 0) || (ny >= ypix)) continue;
+                    long next = long(ny) * xpix + nx;
+                    // An excluded neighbour marks the object
+                    if ((action == lutzOnePass::BAD_EXCLUDE) && bad[next]) flagged = true;
+                    if (seen[next] || !joins[next]) continue;
+                    seen[next] = 1;
+                    stack.push_back(next);
+                }
+            }
+        }
+        if (pixels.empty()) continue;
+        std::sort(pixels.begin(), pixels.end());
+        catalog[pixels] = flagged;
+    }
+    return catalog;
+}
+
+
+/***************************************************************//**
+ * @brief Set up a detector and return what it finds
+ *******************************************************************/
+FlagCatalog Detect(lutzOnePass& detector, const std::vector<uint8_t>& mask,
+                   int xpix, lutzOnePass::LUTZ_BAD_ACTION action)
+{
+    detector.SetThreshold(1.0);
+    detector.SetBadPixelMask(mask.data());
+    detector.SetBadPixelAction(action);
+    detector.run();
+    return MakeFlagCatalog(detector.GetObjects(), xpix);
+}
+
+
+/***************************************************************//**
+ * @brief Excluded pixels flag the objects next to them, and only those
+ *
+ * '#' is an image pixel, 'm' a masked pixel and 'n' a NaN. The object
+ * below the NaN is flagged through the check made on the next row, and
+ * the one on the last row has no row below it.
+ *******************************************************************/
+void TestExcludeFlags()
+{
+    const int xpix = 9;
+    const int ypix = 4;
+    const char* rows[ypix] = {
+        "#.#...#..",
+        ".m....n..",
+        ".#.#.....",
+        "........#"
+    };
+    std::vector<double>  image(xpix * ypix, 0.0);
+    std::vector<uint8_t> mask(xpix * ypix, 0);
+    for (int y=0; y<ypix; y++) {
+        for (int x=0; x<xpix; x++) {
+            if (rows[y][x] == '#') image[y * xpix + x] = 2.0;
+            if (rows[y][x] == 'm') mask[y * xpix + x]  = 1;
+            if (rows[y][x] == 'n') image[y * xpix + x] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    
+    lutzOnePass detector(image.data(), xpix, ypix);
+    FlagCatalog catalog = Detect(detector, mask, xpix, lutzOnePass::BAD_EXCLUDE);
+    LUTZ_CHECK(catalog.size() == 6);
+    
+    // Objects are keyed by their single pixel
+    const long flagged[]   = {0, 2, 6, 19};
+    const long unflagged[] = {21, 35};
+    for (int i=0; i<4; i++) {
+        LUTZ_CHECK(catalog.count(std::vector<long>(1, flagged[i])) &&
+                   catalog[std::vector<long>(1, flagged[i])]);
+    }
+    for (int i=0; i<2; i++) {
+        LUTZ_CHECK(catalog.count(std::vector<long>(1, unflagged[i])) &&
+                   !catalog[std::vector<long>(1, unflagged[i])]);
+    }
+    LUTZ_CHECK(catalog == Reference(image, mask, xpix, ypix, 1.0,
+                                    lutzOnePass::BAD_EXCLUDE));
+}
+
+
+/***************************************************************//**
+ * @brief Every scan treats bad pixels as the flood fill does
+ *
+ * Random frames with scattered masked pixels, NaNs and a masked column
+ * are run through each action and each scan.
+ *******************************************************************/
+void TestRandomFrames()
+{
+    const lutzOnePass::LUTZ_BAD_ACTION actions[] = {
+        lutzOnePass::BAD_EXCLUDE, lutzOnePass::BAD_BRIDGE, lutzOnePass::BAD_FLAG};
+    std::mt19937 random(17);
+    for (int t=0; t<60; t++) {
+        int xpix = 1 + random() % 140;
+        int ypix = 1 + random() % 40;
+        std::vector<double>  image = lutzTest::RandomImage(xpix, ypix, 0.3, t + 1);
+        std::vector<uint8_t> mask(size_t(xpix) * ypix, 0);
+        for (size_t i=0; i<image.size(); i++) {
+            if (random() % 12 == 0) mask[i] = 1;
+            if (random() % 30 == 0) image[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+        int column = random() % xpix;
+        for (int y=0; y<ypix; y++) mask[y * xpix + column] = 1;
+        
+        for (int a=0; a<3; a++) {
+            FlagCatalog expected = Reference(image, mask, xpix, ypix, 1.0, actions[a]);
+            
+            lutzOnePass direct(image.data(), xpix, ypix);
+            LUTZ_CHECK(Detect(direct, mask, xpix, actions[a]) == expected);
+            
+            PixelPass pixel(image.data(), xpix, ypix);
+            LUTZ_CHECK(Detect(pixel, mask, xpix, actions[a]) == expected);
+            
+            lutzRunPass runs(image.data(), xpix, ypix);
+            runs.SetEngine(lutzRunPass::ENGINE_RUNS);
+            LUTZ_CHECK(Detect(runs, mask, xpix, actions[a]) == expected);
+            
+            lutzSamplePass<double> samples(image.data(), xpix, ypix);
+            LUTZ_CHECK(Detect(samples, mask, xpix, actions[a]) == expected);
+        }
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestExcludeFlags();
+    TestRandomFrames();
+    return lutzTest::Result("test_bad");
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *  test_boxes.cpp - Tests of the count and bounding box mode              *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_boxes.cpp
+ * @brief Tests that the boxes summarise the objects a full run writes
+ * @author Josh Cardenzana
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "lutzBox.hpp"
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Return whether a box summarises an object
+ *******************************************************************/
+bool Summarises(const lutzBox& box, const lutzObject& object)
+{
+    int peak = 0;
+    for (int p=1; p<object.size(); p++) {
+        if (object[p].m_value > object[peak].m_value) peak = p;
+    }
+    return (box.m_npix == object.NumPixels()) &&
+           (box.m_xmin == object.GetXMin()) && (box.m_xmax == object.GetXMax()) &&
+           (box.m_ymin == object.GetYMin()) && (box.m_ymax == object.GetYMax()) &&
+           (box.m_xpeak == object[peak].m_xbin) &&
+           (box.m_ypeak == object[peak].m_ybin) &&
+           (box.m_peak == object.GetMaximum()) &&
+           (box.m_flags == object.GetFlags());
+}
+
+
+/***************************************************************//**
+ * @brief Each box summarises the object written in its place
+ *
+ * Masked pixels are flagged rather than excluded, so the flags are
+ * compared as well, and objects under the minimum size are dropped in
+ * both modes.
+ *******************************************************************/
+void TestSummaries()
+{
+    const int sizes[][2] = {{1, 1}, {1, 30}, {40, 1}, {65, 40}, {160, 120}};
+    const double densities[] = {0.05, 0.4, 0.7};
+    unsigned seed = 150;
+    for (int s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        for (int d=0; d < sizeof(densities)/sizeof(densities[0]); d++) {
+            int xpix = sizes[s][0];
+            int ypix = sizes[s][1];
+            std::vector<double> image = lutzTest::RandomImage(xpix, ypix,
+                                                              densities[d], seed++);
+            std::vector<uint8_t> mask(image.size(), 0);
+            for (size_t i=0; i<mask.size(); i+=13) mask[i] = 1;
+            
+            for (int npixmin=1; npixmin<=3; npixmin+=2) {
+                lutzOnePass full(image.data(), xpix, ypix);
+                lutzOnePass boxes(image.data(), xpix, ypix);
+                lutzOnePass* detectors[] = {&full, &boxes};
+                for (int i=0; i<2; i++) {
+                    detectors[i]->SetThreshold(1.0);
+                    detectors[i]->SetNPixelMin(npixmin);
+                    detectors[i]->SetBadPixelMask(mask.data());
+                    detectors[i]->SetBadPixelAction(lutzOnePass::BAD_FLAG);
+                }
+                boxes.SetBoxesOnly(true);
+                full.run();
+                boxes.run();
+                
+                std::vector<lutzObject> objects = full.GetObjects();
+                const std::vector<lutzBox>& found = boxes.GetBoxes();
+                LUTZ_CHECK(boxes.NumObjects() == 0);
+                LUTZ_CHECK(boxes.NumBoxes() == objects.size());
+                if (found.size() != objects.size()) continue;
+                for (size_t b=0; b<found.size(); b++) {
+                    LUTZ_CHECK(Summarises(found[b], objects[b]));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestSummaries();
+    return lutzTest::Result("test_boxes");
+}
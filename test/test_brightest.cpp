@@ -0,0 +1,133 @@
+/***************************************************************************
+ *  test_brightest.cpp - Tests of the brightest objects mode               *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_brightest.cpp
+ * @brief Tests that SetMaxObjects() keeps the objects a full run ranks
+ *        highest, in order
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Return the value an object is ranked by
+ *******************************************************************/
+double Rank(const lutzObject& object, lutzOnePass::LUTZ_RANK rank)
+{
+    return (rank == lutzOnePass::RANK_SUM) ? object.Sum() : object.GetMaximum();
+}
+
+
+/***************************************************************//**
+ * @brief The kept objects are the first of all objects sorted by rank
+ *
+ * Asking for more objects than there are keeps them all.
+ *******************************************************************/
+void TestRanks()
+{
+    const int xpix = 140;
+    const int ypix = 90;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.2, 21);
+    
+    lutzOnePass full(image.data(), xpix, ypix);
+    full.SetThreshold(1.0);
+    full.run();
+    std::vector<lutzObject> all = full.GetObjects();
+    
+    const lutzOnePass::LUTZ_RANK ranks[] = {lutzOnePass::RANK_SUM,
+                                           lutzOnePass::RANK_MAXIMUM};
+    const int counts[] = {1, 10, 100, 100000};
+    for (int r=0; r<2; r++) {
+        std::vector<lutzObject> sorted = all;
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [&](const lutzObject& a, const lutzObject& b) {
+                             return Rank(a, ranks[r]) > Rank(b, ranks[r]);
+                         });
+        
+        for (int c=0; c<4; c++) {
+            lutzOnePass detector(image.data(), xpix, ypix);
+            detector.SetThreshold(1.0);
+            detector.SetMaxObjects(counts[c], ranks[r]);
+            detector.run();
+            
+            std::vector<lutzObject> kept = detector.GetObjects();
+            size_t nkept = std::min<size_t>(counts[c], sorted.size());
+            LUTZ_CHECK(kept.size() == nkept);
+            if (kept.size() != nkept) continue;
+            
+            // Brightest first, and the same objects as the full run
+            std::vector<lutzObject> expected(sorted.begin(), sorted.begin() + nkept);
+            for (size_t i=0; i<nkept; i++) {
+                LUTZ_CHECK(Rank(kept[i], ranks[r]) == Rank(expected[i], ranks[r]));
+            }
+            LUTZ_CHECK(lutzTest::MakeCatalog(kept, xpix) ==
+                       lutzTest::MakeCatalog(expected, xpix));
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Labels follow the brightness order of the kept objects
+ *
+ * Objects that were not kept leave no label behind.
+ *******************************************************************/
+void TestLabels()
+{
+    const int xpix = 100;
+    const int ypix = 80;
+    const int nkeep = 15;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.15, 22);
+    std::vector<int32_t> labels(image.size(), -1);
+    
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetThreshold(1.0);
+    detector.SetMaxObjects(nkeep);
+    detector.SetLabelImage(labels.data());
+    detector.run();
+    
+    std::vector<lutzObject> kept = detector.GetObjects();
+    LUTZ_CHECK(kept.size() == nkeep);
+    std::vector<int32_t> expected(image.size(), 0);
+    for (size_t i=0; i<kept.size(); i++) {
+        for (int p=0; p<kept[i].size(); p++) {
+            expected[size_t(kept[i][p].m_ybin) * xpix + kept[i][p].m_xbin] = i + 1;
+        }
+    }
+    LUTZ_CHECK(labels == expected);
+}
+
+} // namespace
+
+
+int main()
+{
+    TestRanks();
+    TestLabels();
+    return lutzTest::Result("test_brightest");
+}
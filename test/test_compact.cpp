@@ -0,0 +1,185 @@
+/***************************************************************************
+ *  test_compact.cpp - Tests of the compact object storage                 *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_compact.cpp
+ * @brief Tests that compact objects hold the same pixels, and give the
+ *        same measurements, as lutzObjects
+ * @author Josh Cardenzana
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "lutzCompactObject.hpp"
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Return whether two numbers agree to rounding
+ *******************************************************************/
+bool Close(double a, double b)
+{
+    return std::fabs(a - b) <= 1.0e-9 * (1.0 + std::fabs(a) + std::fabs(b));
+}
+
+
+/***************************************************************//**
+ * @brief Compact mode finds the same objects, and they measure the same
+ *
+ * The reductions of lutzCompactObject sum in a different order from
+ * those of lutzObject, so sums and centroids agree to rounding only.
+ *******************************************************************/
+void TestCompactMode()
+{
+    const int xpix = 150;
+    const int ypix = 110;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.45, 3);
+    
+    lutzOnePass plain(image.data(), xpix, ypix);
+    lutzOnePass compact(image.data(), xpix, ypix);
+    plain.SetThreshold(1.0);
+    compact.SetThreshold(1.0);
+    compact.SetCompactObjects(true);
+    plain.run();
+    compact.run();
+    
+    const std::vector<lutzObject>&          objects = plain.GetObjects();
+    const std::vector<lutzCompactObject32>& records = compact.GetCompactObjects();
+    LUTZ_CHECK(compact.GetObjects().empty());
+    LUTZ_CHECK(objects.size() == records.size());
+    if (objects.size() != records.size()) return;
+    
+    // Both detectors write the objects in the same order
+    std::vector<lutzObject> converted(records.size());
+    for (size_t i=0; i<objects.size(); i++) {
+        const lutzObject&          obj = objects[i];
+        const lutzCompactObject32& rec = records[i];
+        records[i].to_object(converted[i]);
+        
+        LUTZ_CHECK(rec.size() == obj.size());
+        LUTZ_CHECK(rec.GetXMin() == obj.GetXMin());
+        LUTZ_CHECK(rec.GetXMax() == obj.GetXMax());
+        LUTZ_CHECK(rec.GetYMin() == obj.GetYMin());
+        LUTZ_CHECK(rec.GetYMax() == obj.GetYMax());
+        LUTZ_CHECK(rec.GetMinimum() == obj.GetMinimum());
+        LUTZ_CHECK(rec.GetMaximum() == obj.GetMaximum());
+        LUTZ_CHECK(Close(rec.Sum(), obj.Sum()));
+        
+        for (int weighted=0; weighted<2; weighted++) {
+            double x1, y1, x2, y2;
+            obj.centroid(x1, y1, weighted);
+            rec.centroid(x2, y2, weighted);
+            LUTZ_CHECK(Close(x1, x2) && Close(y1, y2));
+        }
+        LUTZ_CHECK(!rec.HasScales());
+        LUTZ_CHECK(rec.MemoryUsage() >= 16 * rec.size());
+    }
+    LUTZ_CHECK(lutzTest::MakeCatalog(converted, xpix) ==
+               lutzTest::MakeCatalog(objects, xpix));
+}
+
+
+/***************************************************************//**
+ * @brief Records copy into smaller variants without losing anything
+ *        their types can hold
+ *******************************************************************/
+void TestVariants()
+{
+    lutzCompactObject32 record;
+    for (int i=0; i<37; i++) record.append(3 * i, 1000 + i, 0.5 * i);
+    record.SetScale(5, 2.0);
+    
+    lutzCompactObject16 short_coords(record);
+    lutzCompactObject<int16_t, float> small(record);
+    LUTZ_CHECK(short_coords.size() == record.size());
+    LUTZ_CHECK(small.size() == record.size());
+    for (size_t i=0; i<record.size(); i++) {
+        LUTZ_CHECK(short_coords.GetX(i) == record.GetX(i));
+        LUTZ_CHECK(short_coords.GetY(i) == record.GetY(i));
+        LUTZ_CHECK(short_coords.GetValue(i) == record.GetValue(i));
+        LUTZ_CHECK(small.GetX(i) == record.GetX(i));
+        LUTZ_CHECK(small.GetValue(i) == float(record.GetValue(i)));
+        LUTZ_CHECK(small.GetScale(i) == record.GetScale(i));
+    }
+    LUTZ_CHECK(small.HasScales() && (small.GetScale(5) == 2.0));
+    
+    double x1, y1, x2, y2;
+    record.centroid(x1, y1);
+    small.centroid(x2, y2);
+    LUTZ_CHECK(Close(x1, x2) && Close(y1, y2));
+    LUTZ_CHECK(Close(record.Sum(), small.Sum()));
+    
+    // Without scales: 4 + 4 + 8, 2 + 2 + 8 and 2 + 2 + 4 bytes a pixel
+    lutzCompactObject32 plain;
+    plain.reserve(100);
+    for (int i=0; i<100; i++) plain.append(i, i, 1.0);
+    LUTZ_CHECK(plain.MemoryUsage() == 16 * 100);
+    LUTZ_CHECK(lutzCompactObject16(plain).MemoryUsage() == 12 * 100);
+    LUTZ_CHECK((lutzCompactObject<int16_t, float>(plain).MemoryUsage() == 8 * 100));
+}
+
+
+
+/***************************************************************//**
+ * @brief A large record converts to a lutzObject pixel for pixel
+ *
+ * The object's old pixels are replaced, not added to.
+ *******************************************************************/
+void TestToObject()
+{
+    lutzCompactObject32 record;
+    for (int y=0; y<300; y++) {
+        for (int x=0; x<300; x++) record.append(x, y, 0.001 * (x + y));
+    }
+    record.SetScale(12345, 3.0);
+    
+    lutzObject object;
+    object.append(lutzObject::pixData(1000, 1000, 5.0));
+    record.to_object(object);
+    LUTZ_CHECK(object.size() == record.size());
+    LUTZ_CHECK(object.GetXMax() == 299);
+    LUTZ_CHECK(object.GetYMax() == 299);
+    LUTZ_CHECK(object.GetMaximum() == record.GetMaximum());
+    LUTZ_CHECK(Close(object.Sum(), record.Sum()));
+    
+    bool same = true;
+    for (size_t i=0; i<record.size(); i++) {
+        same = same && (object[i].m_xbin == record.GetX(i)) &&
+                       (object[i].m_ybin == record.GetY(i)) &&
+                       (object[i].m_value == record.GetValue(i)) &&
+                       (object[i].m_scale == record.GetScale(i));
+    }
+    LUTZ_CHECK(same);
+}
+
+} // namespace
+
+
+int main()
+{
+    TestCompactMode();
+    TestVariants();
+    TestToObject();
+    return lutzTest::Result("test_compact");
+}
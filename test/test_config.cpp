@@ -0,0 +1,163 @@
+/***************************************************************************
+ *  test_config.cpp - Tests of shared configurations and reused detectors  *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_config.cpp
+ * @brief Tests that a Config can be shared between threads and that a
+ *        detector reused across frames gives what a new one gives
+ * @author Josh Cardenzana
+ */
+
+#include <thread>
+#include <vector>
+
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Return the catalog a new detector finds with a given Config
+ *******************************************************************/
+lutzTest::Catalog Fresh(std::vector<double>& image, int xpix, int ypix,
+                        const lutzOnePass::Config& config)
+{
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetConfig(config);
+    detector.run();
+    return lutzTest::MakeCatalog(detector.GetObjects(), xpix);
+}
+
+
+/***************************************************************//**
+ * @brief The setters and SetConfig() fill in the same parameters
+ *******************************************************************/
+void TestSetters()
+{
+    lutzOnePass detector;
+    detector.SetThreshold(2.5);
+    detector.SetNPixelMin(4);
+    detector.SetMaxObjects(9, lutzOnePass::RANK_MAXIMUM);
+    detector.SetBadPixelAction(lutzOnePass::BAD_BRIDGE);
+    
+    const lutzOnePass::Config& config = detector.GetConfig();
+    LUTZ_CHECK(config.m_threshold == 2.5);
+    LUTZ_CHECK(config.m_npixelmin == 4);
+    LUTZ_CHECK(config.m_maxobjects == 9);
+    LUTZ_CHECK(config.m_rank == lutzOnePass::RANK_MAXIMUM);
+    LUTZ_CHECK(config.m_bad_action == lutzOnePass::BAD_BRIDGE);
+    
+    lutzOnePass copy;
+    copy.SetConfig(config);
+    LUTZ_CHECK(copy.GetConfig().m_threshold == 2.5);
+    LUTZ_CHECK(copy.GetConfig().m_maxobjects == 9);
+}
+
+
+/***************************************************************//**
+ * @brief Threads sharing one Config find what a single thread finds
+ *
+ * Each thread runs its own detector over several frames, and the Config
+ * they all copied from is left as it was.
+ *******************************************************************/
+void TestThreads()
+{
+    const int xpix = 120;
+    const int ypix = 90;
+    const int nthreads = 4;
+    const int nframes = 5;
+    
+    lutzOnePass::Config config;
+    config.m_threshold  = 1.0;
+    config.m_npixelmin  = 2;
+    config.m_maxobjects = 20;
+    
+    std::vector<std::vector<double> > frames;
+    std::vector<lutzTest::Catalog> expected;
+    for (int f=0; f<nframes; f++) {
+        frames.push_back(lutzTest::RandomImage(xpix, ypix, 0.1 + 0.1 * f, 210 + f));
+        expected.push_back(Fresh(frames.back(), xpix, ypix, config));
+    }
+    
+    std::vector<std::vector<lutzTest::Catalog> > found(nthreads);
+    std::vector<std::thread> threads;
+    for (int t=0; t<nthreads; t++) {
+        threads.push_back(std::thread([&, t]() {
+            lutzOnePass detector;
+            detector.SetConfig(config);
+            detector.SetXpixels(xpix);
+            detector.SetYpixels(ypix);
+            for (int f=0; f<nframes; f++) {
+                detector.SetImage(frames[(f + t) % nframes].data());
+                detector.run();
+                found[t].push_back(lutzTest::MakeCatalog(detector.GetObjects(), xpix));
+            }
+        }));
+    }
+    for (int t=0; t<nthreads; t++) threads[t].join();
+    
+    for (int t=0; t<nthreads; t++) {
+        for (int f=0; f<nframes; f++) {
+            LUTZ_CHECK(found[t][f] == expected[(f + t) % nframes]);
+        }
+    }
+    LUTZ_CHECK((config.m_threshold == 1.0) && (config.m_npixelmin == 2) &&
+               (config.m_maxobjects == 20));
+}
+
+
+/***************************************************************//**
+ * @brief A detector reused across frames of different sizes, and after
+ *        ReleaseMemory(), gives what a new detector gives
+ *******************************************************************/
+void TestReuse()
+{
+    const int sizes[][2] = {{200, 150}, {30, 20}, {64, 300}, {200, 150}};
+    lutzOnePass::Config config;
+    config.m_threshold = 1.0;
+    
+    lutzOnePass detector;
+    detector.SetConfig(config);
+    for (int s=0; s<4; s++) {
+        int xpix = sizes[s][0];
+        int ypix = sizes[s][1];
+        std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.3, 230 + s);
+        detector.SetImage(image.data());
+        detector.SetXpixels(xpix);
+        detector.SetYpixels(ypix);
+        for (int release=0; release<2; release++) {
+            if (release) detector.ReleaseMemory();
+            detector.run();
+            LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), xpix) ==
+                       Fresh(image, xpix, ypix, config));
+        }
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestSetters();
+    TestThreads();
+    TestReuse();
+    return lutzTest::Result("test_config");
+}
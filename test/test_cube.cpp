@@ -0,0 +1,162 @@
+/***************************************************************************
+ *  test_cube.cpp - Tests of 3D detection on data cubes                    *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_cube.cpp
+ * @brief Tests that lutzCube finds the 26-connected objects of a cube,
+ *        whether it is given whole or one plane at a time
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "lutzCube.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Reduce a list of cube objects to a comparable catalog
+ *******************************************************************/
+lutzTest::Catalog MakeCatalog(const std::vector<lutzCubeObject>& objects,
+                              int xpix, int ypix)
+{
+    lutzTest::Catalog catalog(objects.size());
+    for (size_t i=0; i<objects.size(); i++) {
+        for (size_t v=0; v<objects[i].size(); v++) {
+            const lutzCubeObject::voxData& voxel = objects[i][v];
+            catalog[i].push_back((long(voxel.m_zbin) * ypix + voxel.m_ybin) * xpix +
+                                 voxel.m_xbin);
+        }
+        std::sort(catalog[i].begin(), catalog[i].end());
+    }
+    std::sort(catalog.begin(), catalog.end());
+    return catalog;
+}
+
+
+/***************************************************************//**
+ * @brief Find the 26-connected objects of a cube by flood filling it
+ *******************************************************************/
+lutzTest::Catalog FloodFill(const std::vector<double>& cube, int xpix, int ypix,
+                            int zpix, double threshold, size_t npixmin)
+{
+    lutzTest::Catalog catalog;
+    std::vector<char> seen(cube.size(), 0);
+    std::vector<long> stack;
+    for (long start=0; start < long(cube.size()); start++) {
+        if (seen[start] || !(cube[start] > threshold)) continue;
+        
+        std::vector<long> voxels;
+        seen[start] = 1;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            long vox = stack.back();
+            stack.pop_back();
+            voxels.push_back(vox);
+            int x = vox % xpix;
+            int y = (vox / xpix) % ypix;
+            int z = vox / (long(xpix) * ypix);
+            for (int dz=-1; dz<=1; dz++) {
+                for (int dy=-1; dy<=1; dy++) {
+                    for (int dx=-1; dx<=1; dx++) {
+                        int nx = x + dx;
+                        int ny = y + dy;
+                        int nz = z + dz;
+                        if ((nx < 0) || (nx >= xpix) || (ny < 0) || (ny >= ypix) ||
+                            (nz < 0) || (nz >= zpix)) continue;
+                        long next = (long(nz) * ypix + ny) * xpix + nx;
+                        if (seen[next] || !(cube[next] > threshold)) continue;
+                        seen[next] = 1;
+                        stack.push_back(next);
+                    }
+                }
+            }
+        }
+        if (voxels.size() < npixmin) continue;
+        std::sort(voxels.begin(), voxels.end());
+        catalog.push_back(voxels);
+    }
+    std::sort(catalog.begin(), catalog.end());
+    return catalog;
+}
+
+
+/***************************************************************//**
+ * @brief Whole cubes and cubes fed plane by plane give the objects a
+ *        flood fill finds
+ *
+ * Objects collected after each plane must be complete: none may have
+ * a voxel in the plane just added, since they could still grow.
+ *******************************************************************/
+void TestCubes()
+{
+    const int sizes[][3] = {{1, 1, 1}, {7, 1, 9}, {1, 6, 8}, {12, 10, 1},
+                            {20, 17, 15}, {65, 9, 6}};
+    const double densities[] = {0.03, 0.15, 0.4};
+    unsigned seed = 190;
+    for (int s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        for (int d=0; d < sizeof(densities)/sizeof(densities[0]); d++) {
+            int xpix = sizes[s][0];
+            int ypix = sizes[s][1];
+            int zpix = sizes[s][2];
+            std::vector<double> cube = lutzTest::RandomImage(xpix, ypix * zpix,
+                                                             densities[d], seed++);
+            for (int npixmin=1; npixmin<=3; npixmin+=2) {
+                lutzTest::Catalog expected = FloodFill(cube, xpix, ypix, zpix,
+                                                       1.0, npixmin);
+                
+                lutzCube whole(cube.data(), xpix, ypix, zpix);
+                whole.SetThreshold(1.0);
+                whole.SetNPixelMin(npixmin);
+                whole.run();
+                LUTZ_CHECK(MakeCatalog(whole.GetObjects(), xpix, ypix) == expected);
+                LUTZ_CHECK(whole.NumOpenObjects() == 0);
+                
+                lutzCube planes;
+                planes.SetXpixels(xpix);
+                planes.SetYpixels(ypix);
+                planes.SetThreshold(1.0);
+                planes.SetNPixelMin(npixmin);
+                planes.StartCube();
+                for (int z=0; z<zpix; z++) {
+                    planes.AddPlane(cube.data() + size_t(z) * xpix * ypix);
+                    std::vector<lutzCubeObject> done = planes.GetObjects();
+                    for (size_t i=0; i<done.size(); i++) {
+                        LUTZ_CHECK(done[i].GetZMax() < z);
+                    }
+                }
+                planes.FinishCube();
+                LUTZ_CHECK(MakeCatalog(planes.GetObjects(), xpix, ypix) == expected);
+                LUTZ_CHECK(planes.NumOpenObjects() == 0);
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestCubes();
+    return lutzTest::Result("test_cube");
+}
@@ -0,0 +1,224 @@
+/***************************************************************************
+ *  test_diff.cpp - Tests of detection on the difference of two frames     *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_diff.cpp
+ * @brief Tests that the objects found on the difference of two frames,
+ *        above the threshold and below minus the threshold, are those
+ *        found on the difference image itself
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "lutzDiffPass.hpp"
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Reduce objects to their sorted pixel positions, in order
+ *******************************************************************/
+lutzTest::Catalog Positions(const std::vector<lutzObject>& objects, int xpix)
+{
+    lutzTest::Catalog catalog(objects.size());
+    for (size_t i=0; i<objects.size(); i++) {
+        for (int p=0; p<objects[i].size(); p++) {
+            catalog[i].push_back(long(objects[i][p].m_ybin) * xpix + objects[i][p].m_xbin);
+        }
+        std::sort(catalog[i].begin(), catalog[i].end());
+    }
+    return catalog;
+}
+
+
+/***************************************************************//**
+ * @brief Return whether every pixel carries its value in a frame
+ *******************************************************************/
+bool SameValues(const std::vector<lutzObject>& objects,
+                const std::vector<double>& image, int xpix)
+{
+    for (size_t i=0; i<objects.size(); i++) {
+        for (int p=0; p<objects[i].size(); p++) {
+            size_t index = size_t(objects[i][p].m_ybin) * xpix + objects[i][p].m_xbin;
+            if (objects[i][p].m_value != image[index]) return false;
+        }
+    }
+    return true;
+}
+
+
+/***************************************************************//**
+ * @brief Compare a detector with a plain run on a frame
+ *
+ * @param[in] detector      Detector that has been run
+ * @param[in] image         Frame it should have seen
+ * @param[in] xpix          Number of pixels in x
+ * @param[in] ypix          Number of pixels in y
+ * @param[in] threshold     Threshold of the run
+ * @param[in] mask          Bad pixel mask of the run (nullptr = none)
+ *******************************************************************/
+void CheckAgainst(lutzOnePass& detector, const std::vector<double>& image,
+                  int xpix, int ypix, double threshold,
+                  const uint8_t* mask=nullptr)
+{
+    std::vector<double> frame(image);
+    lutzOnePass plain(frame.data(), xpix, ypix);
+    plain.SetThreshold(threshold);
+    plain.SetBadPixelMask(mask);
+    plain.run();
+    
+    std::vector<lutzObject> objects = detector.GetObjects();
+    LUTZ_CHECK(Positions(objects, xpix) == Positions(plain.GetObjects(), xpix));
+    LUTZ_CHECK(SameValues(objects, image, xpix));
+    if (mask == nullptr) {
+        LUTZ_CHECK(lutzTest::MakeCatalog(objects, xpix) ==
+                   lutzTest::FloodFill(image, xpix, ypix, threshold));
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Make the difference of two frames, and its negation
+ *******************************************************************/
+void Difference(const std::vector<double>& science,
+                const std::vector<double>& reference,
+                const std::vector<double>* noise,
+                double scale, double offset,
+                std::vector<double>& positive, std::vector<double>& negative)
+{
+    positive.resize(science.size());
+    negative.resize(science.size());
+    for (size_t i=0; i<science.size(); i++) {
+        double value = science[i] - scale * reference[i] - offset;
+        if (noise) value = ((*noise)[i] > 0.0) ? value / (*noise)[i] : 0.0;
+        positive[i] = value;
+        negative[i] = -value;
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Both signs match plain runs on the difference image
+ *
+ * The widths straddle the 64 pixels packed into each word of a row.
+ *******************************************************************/
+void TestSigns()
+{
+    const int sizes[][2] = {{1, 40}, {63, 30}, {64, 30}, {130, 70}};
+    unsigned seed = 310;
+    for (int s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        int xpix = sizes[s][0];
+        int ypix = sizes[s][1];
+        std::vector<double> science   = lutzTest::RandomImage(xpix, ypix, 0.4, seed++);
+        std::vector<double> reference = lutzTest::RandomImage(xpix, ypix, 0.4, seed++);
+        std::vector<double> positive, negative;
+        Difference(science, reference, nullptr, 0.7, 0.2, positive, negative);
+        
+        lutzDiffPass detector(science.data(), reference.data(), xpix, ypix);
+        detector.SetScale(0.7, 0.2);
+        detector.SetThreshold(0.6);
+        detector.run();
+        CheckAgainst(detector, positive, xpix, ypix, 0.6);
+        LUTZ_CHECK(detector.GetNegative().NumObjects() == 0);
+        
+        detector.SetNegative(true);
+        detector.run();
+        CheckAgainst(detector, positive, xpix, ypix, 0.6);
+        CheckAgainst(detector.GetNegative(), negative, xpix, ypix, 0.6);
+        LUTZ_CHECK(detector.GetNegative().NumObjects() > 0);
+    }
+}
+
+
+/***************************************************************//**
+ * @brief A noise map makes the values significances
+ *
+ * Pixels with no noise, or a negative one, are 0 and so are never
+ * detected with either sign.
+ *******************************************************************/
+void TestNoise()
+{
+    const int xpix = 100;
+    const int ypix = 80;
+    std::vector<double> science   = lutzTest::RandomImage(xpix, ypix, 0.5, 320);
+    std::vector<double> reference = lutzTest::RandomImage(xpix, ypix, 0.5, 321);
+    std::vector<double> noise     = lutzTest::RandomImage(xpix, ypix, 0.0, 322);
+    for (size_t i=0; i<noise.size(); i+=7) noise[i] = (i % 2) ? 0.0 : -0.5;
+    std::vector<double> positive, negative;
+    Difference(science, reference, &noise, 1.0, 0.0, positive, negative);
+    
+    lutzDiffPass detector;
+    detector.SetXpixels(xpix);
+    detector.SetYpixels(ypix);
+    detector.SetScience(science.data());
+    detector.SetReference(reference.data());
+    detector.SetNoiseMap(noise.data());
+    detector.SetNegative(true);
+    detector.SetThreshold(2.0);
+    detector.run();
+    CheckAgainst(detector, positive, xpix, ypix, 2.0);
+    CheckAgainst(detector.GetNegative(), negative, xpix, ypix, 2.0);
+    for (int i=0; i<detector.NumObjects(); i++) {
+        lutzObject object = detector.GetObject(i);
+        for (int p=0; p<object.size(); p++) {
+            LUTZ_CHECK(noise[size_t(object[p].m_ybin) * xpix + object[p].m_xbin] > 0.0);
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Masked pixels are left out of the objects of both signs
+ *******************************************************************/
+void TestBadPixels()
+{
+    const int xpix = 90;
+    const int ypix = 60;
+    std::vector<double> science   = lutzTest::RandomImage(xpix, ypix, 0.5, 330);
+    std::vector<double> reference = lutzTest::RandomImage(xpix, ypix, 0.5, 331);
+    std::vector<double> positive, negative;
+    Difference(science, reference, nullptr, 1.0, 0.0, positive, negative);
+    std::vector<uint8_t> mask(science.size(), 0);
+    for (size_t i=0; i<mask.size(); i+=5) mask[i] = 1;
+    
+    lutzDiffPass detector(science.data(), reference.data(), xpix, ypix);
+    detector.SetNegative(true);
+    detector.SetThreshold(0.5);
+    detector.SetBadPixelMask(mask.data());
+    detector.run();
+    CheckAgainst(detector, positive, xpix, ypix, 0.5, mask.data());
+    CheckAgainst(detector.GetNegative(), negative, xpix, ypix, 0.5, mask.data());
+}
+
+} // namespace
+
+
+int main()
+{
+    TestSigns();
+    TestNoise();
+    TestBadPixels();
+    return lutzTest::Result("test_diff");
+}
@@ -0,0 +1,364 @@
+/***************************************************************************
+ *  test_engines.cpp - Tests that the labelling engines agree              *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_engines.cpp
+ * @brief Tests that the Lutz and run engines of lutzRunPass write the
+ *        same objects, in the same order, with their pixels in the same
+ *        order
+ * @author Josh Cardenzana
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "lutzObjectFilter.hpp"
+#include "lutzRunPass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Detector with no image that supplies its own pixel values
+ *******************************************************************/
+class ValuePass : public lutzRunPass {
+public:
+    ValuePass(const std::vector<double>& values, int xpixels, int ypixels) :
+        lutzRunPass(nullptr, xpixels, ypixels),
+        m_values(values)
+    {}
+    virtual double GetPixValue(int xbin, int ybin)
+    {
+        return m_values[size_t(ybin) * m_xpix + xbin];
+    }
+private:
+    const std::vector<double>& m_values;
+};
+
+
+/***************************************************************//**
+ * @brief Detector that overrides only the pixel test
+ *******************************************************************/
+class DipPass : public lutzRunPass {
+public:
+    DipPass(double* image, int xpixels, int ypixels) :
+        lutzRunPass(image, xpixels, ypixels)
+    {}
+    virtual bool AssessPixel(int xbin, int ybin)
+    {
+        return (GetPixValue(xbin, ybin) < -0.5);
+    }
+};
+
+
+/***************************************************************//**
+ * @brief Return whether two lists of objects are identical
+ *******************************************************************/
+bool SameObjects(const std::vector<lutzObject>& a, const std::vector<lutzObject>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i=0; i<a.size(); i++) {
+        if ((a[i].size() != b[i].size()) || (a[i].GetFlags() != b[i].GetFlags())) {
+            return false;
+        }
+        for (int p=0; p<a[i].size(); p++) {
+            if ((a[i][p].m_xbin != b[i][p].m_xbin) ||
+                (a[i][p].m_ybin != b[i][p].m_ybin) ||
+                (a[i][p].m_value != b[i][p].m_value)) return false;
+        }
+    }
+    return true;
+}
+
+
+/***************************************************************//**
+ * @brief Set up a detector for one engine
+ *******************************************************************/
+void Setup(lutzRunPass& detector, lutzRunPass::LUTZ_ENGINE engine)
+{
+    detector.SetEngine(engine);
+    detector.SetThreshold(1.0);
+}
+
+
+/***************************************************************//**
+ * @brief Frames of every shape and density give identical objects
+ *
+ * Objects on the bottom row are written at the end of the frame, in a
+ * different order from the others, so frames of one row and frames
+ * dense enough for many objects to reach the bottom are included.
+ *******************************************************************/
+void TestRandomFrames()
+{
+    const int sizes[][2] = {{1, 1}, {1, 40}, {40, 1}, {3, 17}, {63, 20},
+                            {64, 20}, {65, 33}, {200, 90}};
+    const double densities[] = {0.02, 0.1, 0.3, 0.45, 0.8};
+    unsigned seed = 1;
+    for (int s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        for (int d=0; d < sizeof(densities)/sizeof(densities[0]); d++) {
+            int xpix = sizes[s][0];
+            int ypix = sizes[s][1];
+            std::vector<double> image = lutzTest::RandomImage(xpix, ypix,
+                                                              densities[d], seed++);
+            lutzRunPass lutz(image.data(), xpix, ypix);
+            lutzRunPass runs(image.data(), xpix, ypix);
+            Setup(lutz, lutzRunPass::ENGINE_LUTZ);
+            Setup(runs, lutzRunPass::ENGINE_RUNS);
+            lutz.run();
+            runs.run();
+            LUTZ_CHECK(SameObjects(lutz.GetObjects(), runs.GetObjects()));
+            LUTZ_CHECK(lutzTest::MakeCatalog(runs.GetObjects(), xpix) ==
+                       lutzTest::FloodFill(image, xpix, ypix, 1.0));
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Masked and NaN pixels are treated the same by both engines
+ *******************************************************************/
+void TestBadPixels()
+{
+    const int xpix = 90;
+    const int ypix = 70;
+    std::mt19937 random(17);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    
+    const lutzOnePass::LUTZ_BAD_ACTION actions[] = {
+        lutzOnePass::BAD_EXCLUDE, lutzOnePass::BAD_BRIDGE, lutzOnePass::BAD_FLAG};
+    for (int frame=0; frame<6; frame++) {
+        std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.4, 40 + frame);
+        std::vector<uint8_t> mask(image.size(), 0);
+        for (size_t i=0; i<image.size(); i++) {
+            double u = uniform(random);
+            if (u < 0.03) {
+                image[i] = std::numeric_limits<double>::quiet_NaN();
+            } else if (u < 0.06) {
+                mask[i] = 1;
+            }
+        }
+        for (int a=0; a<3; a++) {
+            lutzRunPass lutz(image.data(), xpix, ypix);
+            lutzRunPass runs(image.data(), xpix, ypix);
+            Setup(lutz, lutzRunPass::ENGINE_LUTZ);
+            Setup(runs, lutzRunPass::ENGINE_RUNS);
+            lutz.SetBadPixelMask(mask.data());
+            runs.SetBadPixelMask(mask.data());
+            lutz.SetBadPixelAction(actions[a]);
+            runs.SetBadPixelAction(actions[a]);
+            lutz.run();
+            runs.run();
+            LUTZ_CHECK(SameObjects(lutz.GetObjects(), runs.GetObjects()));
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Boxes, compact records and label images agree as well
+ *
+ * The brightest pixel of a box could only differ if two pixels of an
+ * object had the same value, which the random frame does not have.
+ *******************************************************************/
+void TestOutputModes()
+{
+    const int xpix = 150;
+    const int ypix = 120;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.45, 8);
+    
+    // Boxes
+    {
+        lutzRunPass lutz(image.data(), xpix, ypix);
+        lutzRunPass runs(image.data(), xpix, ypix);
+        Setup(lutz, lutzRunPass::ENGINE_LUTZ);
+        Setup(runs, lutzRunPass::ENGINE_RUNS);
+        lutz.SetBoxesOnly(true);
+        runs.SetBoxesOnly(true);
+        lutz.run();
+        runs.run();
+        const std::vector<lutzBox>& a = lutz.GetBoxes();
+        const std::vector<lutzBox>& b = runs.GetBoxes();
+        LUTZ_CHECK(a.size() == b.size());
+        for (size_t i=0; (i < a.size()) && (i < b.size()); i++) {
+            LUTZ_CHECK((a[i].m_npix == b[i].m_npix) &&
+                       (a[i].m_xmin == b[i].m_xmin) && (a[i].m_xmax == b[i].m_xmax) &&
+                       (a[i].m_ymin == b[i].m_ymin) && (a[i].m_ymax == b[i].m_ymax) &&
+                       (a[i].m_xpeak == b[i].m_xpeak) && (a[i].m_ypeak == b[i].m_ypeak) &&
+                       (a[i].m_peak == b[i].m_peak));
+        }
+    }
+    
+    // Compact records
+    {
+        lutzRunPass lutz(image.data(), xpix, ypix);
+        lutzRunPass runs(image.data(), xpix, ypix);
+        Setup(lutz, lutzRunPass::ENGINE_LUTZ);
+        Setup(runs, lutzRunPass::ENGINE_RUNS);
+        lutz.SetCompactObjects(true);
+        runs.SetCompactObjects(true);
+        lutz.run();
+        runs.run();
+        const std::vector<lutzCompactObject32>& a = lutz.GetCompactObjects();
+        const std::vector<lutzCompactObject32>& b = runs.GetCompactObjects();
+        LUTZ_CHECK(a.size() == b.size());
+        for (size_t i=0; (i < a.size()) && (i < b.size()); i++) {
+            LUTZ_CHECK(a[i].size() == b[i].size());
+            for (size_t p=0; (p < a[i].size()) && (p < b[i].size()); p++) {
+                LUTZ_CHECK((a[i].GetX(p) == b[i].GetX(p)) &&
+                           (a[i].GetY(p) == b[i].GetY(p)));
+            }
+            LUTZ_CHECK(a[i].Sum() == b[i].Sum());
+        }
+    }
+    
+    // Label images, with and without the pixel lists
+    for (int keep=0; keep<2; keep++) {
+        std::vector<int32_t> lutz_labels(image.size(), -1);
+        std::vector<int32_t> runs_labels(image.size(), -1);
+        lutzRunPass lutz(image.data(), xpix, ypix);
+        lutzRunPass runs(image.data(), xpix, ypix);
+        Setup(lutz, lutzRunPass::ENGINE_LUTZ);
+        Setup(runs, lutzRunPass::ENGINE_RUNS);
+        lutz.SetLabelImage(lutz_labels.data(), keep);
+        runs.SetLabelImage(runs_labels.data(), keep);
+        lutz.run();
+        runs.run();
+        LUTZ_CHECK(lutz.NumLabels() == runs.NumLabels());
+        LUTZ_CHECK(lutz_labels == runs_labels);
+    }
+}
+
+
+/***************************************************************//**
+ * @brief ENGINE_AUTO switches engine between frames without changing
+ *        what is written
+ *******************************************************************/
+void TestAuto()
+{
+    const int xpix = 120;
+    const int ypix = 100;
+    const double densities[] = {0.01, 0.6, 0.01};
+    
+    std::vector<double> image;
+    lutzRunPass detector;
+    Setup(detector, lutzRunPass::ENGINE_AUTO);
+    for (int f=0; f<3; f++) {
+        image = lutzTest::RandomImage(xpix, ypix, densities[f], 60 + f);
+        detector.SetImage(image.data());
+        detector.SetXpixels(xpix);
+        detector.SetYpixels(ypix);
+        detector.run();
+        LUTZ_CHECK(detector.GetLastEngine() ==
+                   ((densities[f] > 0.5) ? lutzRunPass::ENGINE_RUNS :
+                                           lutzRunPass::ENGINE_LUTZ));
+        
+        lutzRunPass lutz(image.data(), xpix, ypix);
+        Setup(lutz, lutzRunPass::ENGINE_LUTZ);
+        lutz.run();
+        LUTZ_CHECK(SameObjects(detector.GetObjects(), lutz.GetObjects()));
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Without rows of an image to read, either engine falls back to
+ *        the scan of lutzOnePass
+ *******************************************************************/
+void TestFallback()
+{
+    const int xpix = 60;
+    const int ypix = 50;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.5, 70);
+    std::vector<double> negated(image.size());
+    for (size_t i=0; i<image.size(); i++) negated[i] = -image[i];
+    
+    const lutzRunPass::LUTZ_ENGINE engines[] = {lutzRunPass::ENGINE_RUNS,
+                                                lutzRunPass::ENGINE_AUTO};
+    for (int e=0; e<2; e++) {
+        ValuePass values(image, xpix, ypix);
+        Setup(values, engines[e]);
+        values.run();
+        LUTZ_CHECK(values.GetLastEngine() == lutzRunPass::ENGINE_LUTZ);
+        LUTZ_CHECK(lutzTest::MakeCatalog(values.GetObjects(), xpix) ==
+                   lutzTest::FloodFill(image, xpix, ypix, 1.0));
+        
+        DipPass dips(negated.data(), xpix, ypix);
+        Setup(dips, engines[e]);
+        dips.run();
+        LUTZ_CHECK(dips.GetLastEngine() == lutzRunPass::ENGINE_LUTZ);
+        LUTZ_CHECK(lutzTest::MakeCatalog(dips.GetObjects(), xpix) ==
+                   lutzTest::FloodFill(image, xpix, ypix, 0.5));
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Memory limits and object filters always take the Lutz engine,
+ *        even when ENGINE_RUNS is asked for
+ *******************************************************************/
+void TestLimits()
+{
+    const int xpix = 120;
+    const int ypix = 100;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.6, 80);
+    lutzObjectFilter filter;
+    filter.SetPixelRange(3);
+    
+    const lutzRunPass::LUTZ_ENGINE engines[] = {lutzRunPass::ENGINE_RUNS,
+                                                lutzRunPass::ENGINE_AUTO};
+    for (int mode=0; mode<3; mode++) {
+        for (int e=0; e<2; e++) {
+            lutzRunPass lutz(image.data(), xpix, ypix);
+            lutzRunPass runs(image.data(), xpix, ypix);
+            Setup(lutz, lutzRunPass::ENGINE_LUTZ);
+            Setup(runs, engines[e]);
+            if (mode == 1) {
+                lutz.SetMaxObjectPixels(20);
+                runs.SetMaxObjectPixels(20);
+            } else if (mode == 2) {
+                lutz.SetObjectFilter(&filter);
+                runs.SetObjectFilter(&filter);
+            }
+            lutz.run();
+            runs.run();
+            LUTZ_CHECK(runs.GetLastEngine() == ((mode == 0) ? lutzRunPass::ENGINE_RUNS :
+                                                              lutzRunPass::ENGINE_LUTZ));
+            LUTZ_CHECK(SameObjects(lutz.GetObjects(), runs.GetObjects()));
+            LUTZ_CHECK(lutz.NumTruncated() == runs.NumTruncated());
+        }
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestRandomFrames();
+    TestBadPixels();
+    TestOutputModes();
+    TestAuto();
+    TestFallback();
+    TestLimits();
+    return lutzTest::Result("test_engines");
+}
@@ -0,0 +1,271 @@
+/***************************************************************************
+ *  test_filter.cpp - Tests of the object filter                           *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_filter.cpp
+ * @brief Tests that a filter applied during the scan keeps the same
+ *        objects as filtering the complete catalog afterwards, and that
+ *        the objects it gives up on stop holding their pixels
+ * @author Josh Cardenzana
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "lutzObjectFilter.hpp"
+#include "lutzOnePass.hpp"
+#include "lutzRunPass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Filter with a cut that needs the whole object
+ *
+ * Keeps objects with an even number of pixels, which no partial object
+ * can rule out, and gives up on anything taller than 4 pixels.
+ *******************************************************************/
+class EvenFilter : public lutzObjectFilter {
+public:
+    virtual bool Accept(const lutzOnePass::ObjectInfo& obj,
+                        int xpixels, int ypixels) const
+    {
+        return !Abort(obj, xpixels, ypixels) && (obj.m_npix % 2 == 0);
+    }
+    
+    virtual bool Abort(const lutzOnePass::ObjectInfo& obj,
+                       int xpixels, int ypixels) const
+    {
+        return (obj.m_ymax - obj.m_ymin + 1 > 4);
+    }
+};
+
+
+/***************************************************************//**
+ * @brief Filter that applies its cuts only to complete objects
+ *******************************************************************/
+class LateFilter : public lutzObjectFilter {
+public:
+    virtual bool Accept(const lutzOnePass::ObjectInfo& obj,
+                        int xpixels, int ypixels) const
+    {
+        return !lutzObjectFilter::Abort(obj, xpixels, ypixels);
+    }
+    
+    virtual bool Abort(const lutzOnePass::ObjectInfo& obj,
+                       int xpixels, int ypixels) const
+    {
+        return false;
+    }
+};
+
+
+/***************************************************************//**
+ * @brief Reduce objects to their sorted pixel positions, in order
+ *******************************************************************/
+lutzTest::Catalog Positions(const std::vector<lutzObject>& objects, int xpix)
+{
+    lutzTest::Catalog catalog(objects.size());
+    for (size_t i=0; i<objects.size(); i++) {
+        for (int p=0; p<objects[i].size(); p++) {
+            catalog[i].push_back(long(objects[i][p].m_ybin) * xpix + objects[i][p].m_xbin);
+        }
+        std::sort(catalog[i].begin(), catalog[i].end());
+    }
+    return catalog;
+}
+
+
+/***************************************************************//**
+ * @brief Apply a filter to the objects of a complete run
+ *******************************************************************/
+std::vector<lutzObject> Filter(const std::vector<lutzObject>& objects,
+                               const lutzObjectFilter& filter,
+                               int xpix, int ypix)
+{
+    std::vector<lutzObject> kept;
+    for (size_t i=0; i<objects.size(); i++) {
+        lutzOnePass::ObjectInfo info;
+        for (int p=0; p<objects[i].size(); p++) info.add(objects[i][p], false);
+        if (filter.Accept(info, xpix, ypix)) kept.push_back(objects[i]);
+    }
+    return kept;
+}
+
+
+/***************************************************************//**
+ * @brief Each cut keeps what filtering the full catalog keeps
+ *
+ * The objects are compared in order, for the Lutz scan and for both
+ * engines of the run-length scan.
+ *******************************************************************/
+void TestCuts()
+{
+    const int xpix = 120;
+    const int ypix = 90;
+    const double densities[] = {0.1, 0.45, 0.6};
+    
+    std::vector<lutzObjectFilter> filters(7);
+    filters[0].SetPixelRange(3);
+    filters[1].SetPixelRange(2, 6);
+    filters[2].SetMaxExtent(4, 0);
+    filters[3].SetMaxExtent(0, 3);
+    filters[4].SetMaxElongation(1.8);
+    filters[5].SetPeakRange(1.5, 1.95);
+    filters[6].SetRejectEdges(true);
+    filters[6].SetMaxExtent(8, 8);
+    filters[6].SetPixelRange(2);
+    
+    for (int d=0; d < sizeof(densities)/sizeof(densities[0]); d++) {
+        std::vector<double> image = lutzTest::RandomImage(xpix, ypix, densities[d], 210 + d);
+        lutzOnePass full(image.data(), xpix, ypix);
+        full.SetThreshold(1.0);
+        full.run();
+        std::vector<lutzObject> all = full.GetObjects();
+        
+        std::vector<const lutzObjectFilter*> tried;
+        for (size_t f=0; f<filters.size(); f++) tried.push_back(&filters[f]);
+        EvenFilter even;
+        tried.push_back(&even);
+        
+        for (size_t f=0; f<tried.size(); f++) {
+            lutzTest::Catalog expected = Positions(Filter(all, *tried[f], xpix, ypix), xpix);
+            LUTZ_CHECK(expected.size() < all.size());
+            
+            lutzOnePass lutz(image.data(), xpix, ypix);
+            lutz.SetThreshold(1.0);
+            lutz.SetObjectFilter(tried[f]);
+            lutz.run();
+            LUTZ_CHECK(Positions(lutz.GetObjects(), xpix) == expected);
+            LUTZ_CHECK(lutz.NumTruncated() == 0);
+            
+            const lutzRunPass::LUTZ_ENGINE engines[] = {lutzRunPass::ENGINE_LUTZ,
+                                                        lutzRunPass::ENGINE_RUNS};
+            for (int e=0; e<2; e++) {
+                lutzRunPass runs(image.data(), xpix, ypix);
+                runs.SetThreshold(1.0);
+                runs.SetEngine(engines[e]);
+                runs.SetObjectFilter(tried[f]);
+                runs.run();
+                LUTZ_CHECK(Positions(runs.GetObjects(), xpix) == expected);
+            }
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Rejected objects leave no labels and no boxes
+ *******************************************************************/
+void TestOutputs()
+{
+    const int xpix = 80;
+    const int ypix = 60;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.5, 220);
+    lutzObjectFilter filter;
+    filter.SetMaxExtent(5, 5);
+    filter.SetPixelRange(2);
+    
+    lutzOnePass full(image.data(), xpix, ypix);
+    full.SetThreshold(1.0);
+    full.run();
+    std::vector<lutzObject> kept = Filter(full.GetObjects(), filter, xpix, ypix);
+    
+    std::vector<int32_t> expected(image.size(), 0);
+    for (size_t i=0; i<kept.size(); i++) {
+        for (int p=0; p<kept[i].size(); p++) {
+            expected[size_t(kept[i][p].m_ybin) * xpix + kept[i][p].m_xbin] = i + 1;
+        }
+    }
+    
+    for (int keep_pixels=0; keep_pixels<2; keep_pixels++) {
+        std::vector<int32_t> labels(image.size(), -1);
+        lutzOnePass detector(image.data(), xpix, ypix);
+        detector.SetThreshold(1.0);
+        detector.SetObjectFilter(&filter);
+        detector.SetLabelImage(labels.data(), keep_pixels);
+        detector.run();
+        LUTZ_CHECK(labels == expected);
+        LUTZ_CHECK(detector.NumLabels() == int(kept.size()));
+    }
+    
+    lutzOnePass boxes(image.data(), xpix, ypix);
+    boxes.SetThreshold(1.0);
+    boxes.SetObjectFilter(&filter);
+    boxes.SetBoxesOnly(true);
+    boxes.run();
+    LUTZ_CHECK(boxes.NumBoxes() == int(kept.size()));
+    for (int b=0; (b < boxes.NumBoxes()) && (b < int(kept.size())); b++) {
+        LUTZ_CHECK(boxes.GetBoxes()[b].m_npix == kept[b].size());
+    }
+}
+
+
+/***************************************************************//**
+ * @brief An object given up on no longer counts as holding pixels
+ *
+ * A wide block is open alongside a column of dots, and only one open
+ * object may keep its pixels. Once the filter gives up on the block the
+ * dots keep theirs; a filter that waits for the block to end leaves
+ * every dot beside it without its pixels.
+ *******************************************************************/
+void TestAbort()
+{
+    const int xpix = 40;
+    const int ypix = 12;
+    std::vector<double> image(size_t(xpix) * ypix, 0.0);
+    for (int y=0; y<10; y++) {
+        for (int x=0; x<20; x++) image[size_t(y) * xpix + x] = 1.0;
+    }
+    for (int y=0; y<ypix; y+=2) image[size_t(y) * xpix + 30] = 1.0;
+    
+    lutzObjectFilter early;
+    early.SetMaxExtent(10, 0);
+    LateFilter late;
+    late.SetMaxExtent(10, 0);
+    
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetThreshold(0.5);
+    detector.SetMaxOpenObjects(1);
+    detector.SetObjectFilter(&early);
+    detector.run();
+    LUTZ_CHECK(detector.NumObjects() == 6);
+    LUTZ_CHECK(detector.NumTruncated() == 0);
+    for (int i=0; i<detector.NumObjects(); i++) {
+        LUTZ_CHECK(detector.GetObject(i).size() == 1);
+    }
+    
+    detector.SetObjectFilter(&late);
+    detector.run();
+    LUTZ_CHECK(detector.NumObjects() == 6);
+    LUTZ_CHECK(detector.NumTruncated() == 5);
+}
+
+} // namespace
+
+
+int main()
+{
+    TestCuts();
+    TestOutputs();
+    TestAbort();
+    return lutzTest::Result("test_filter");
+}
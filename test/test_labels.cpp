@@ -0,0 +1,134 @@
+/***************************************************************************
+ *  test_labels.cpp - Tests of the label image output                      *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_labels.cpp
+ * @brief Tests that the label image numbers the pixels of each object
+ *        in the order the objects are written, with or without the
+ *        pixel lists
+ * @author Josh Cardenzana
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Paint the labels that a list of objects should give
+ *******************************************************************/
+std::vector<int32_t> PaintObjects(const std::vector<lutzObject>& objects,
+                                  int xpix, int ypix)
+{
+    std::vector<int32_t> labels(size_t(xpix) * ypix, 0);
+    for (size_t i=0; i<objects.size(); i++) {
+        for (int p=0; p<objects[i].size(); p++) {
+            labels[size_t(objects[i][p].m_ybin) * xpix + objects[i][p].m_xbin] = i + 1;
+        }
+    }
+    return labels;
+}
+
+
+/***************************************************************//**
+ * @brief Label n covers the pixels of object n-1
+ *
+ * The provisional labels used without pixel lists end up the same, and
+ * objects dropped for being too small are left as background. The
+ * buffer starts out full of junk, which run() must clear.
+ *******************************************************************/
+void TestLabels()
+{
+    const int sizes[][2] = {{1, 1}, {1, 30}, {40, 1}, {65, 40}, {160, 120}};
+    const double densities[] = {0.05, 0.4, 0.7};
+    unsigned seed = 110;
+    for (int s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        for (int d=0; d < sizeof(densities)/sizeof(densities[0]); d++) {
+            int xpix = sizes[s][0];
+            int ypix = sizes[s][1];
+            std::vector<double> image = lutzTest::RandomImage(xpix, ypix,
+                                                              densities[d], seed++);
+            for (int npixmin=1; npixmin<=3; npixmin+=2) {
+                std::vector<int32_t> kept(image.size(), 77);
+                std::vector<int32_t> provisional(image.size(), -77);
+                
+                lutzOnePass full(image.data(), xpix, ypix);
+                full.SetThreshold(1.0);
+                full.SetNPixelMin(npixmin);
+                full.SetLabelImage(kept.data());
+                full.run();
+                
+                lutzOnePass labels_only(image.data(), xpix, ypix);
+                labels_only.SetThreshold(1.0);
+                labels_only.SetNPixelMin(npixmin);
+                labels_only.SetLabelImage(provisional.data(), false);
+                labels_only.run();
+                
+                LUTZ_CHECK(kept == PaintObjects(full.GetObjects(), xpix, ypix));
+                LUTZ_CHECK(full.NumLabels() == full.NumObjects());
+                LUTZ_CHECK(provisional == kept);
+                LUTZ_CHECK(labels_only.NumLabels() == full.NumLabels());
+                LUTZ_CHECK(labels_only.NumObjects() == 0);
+            }
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief A second frame leaves nothing of the first behind
+ *******************************************************************/
+void TestReuse()
+{
+    const int xpix = 90;
+    const int ypix = 70;
+    std::vector<int32_t> labels(size_t(xpix) * ypix);
+    std::vector<double>  image;
+    lutzOnePass detector;
+    detector.SetXpixels(xpix);
+    detector.SetYpixels(ypix);
+    detector.SetThreshold(1.0);
+    detector.SetLabelImage(labels.data(), false);
+    
+    const double densities[] = {0.6, 0.05};
+    for (int f=0; f<2; f++) {
+        image = lutzTest::RandomImage(xpix, ypix, densities[f], 130 + f);
+        detector.SetImage(image.data());
+        detector.run();
+        
+        lutzOnePass reference(image.data(), xpix, ypix);
+        reference.SetThreshold(1.0);
+        reference.run();
+        LUTZ_CHECK(labels == PaintObjects(reference.GetObjects(), xpix, ypix));
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestLabels();
+    TestReuse();
+    return lutzTest::Result("test_labels");
+}
@@ -0,0 +1,242 @@
+/***************************************************************************
+ *  test_limits.cpp - Tests of the memory limits and the join rules        *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_limits.cpp
+ * @brief Tests of the memory limits, of how objects are joined and of
+ *        skipping the background in the per-pixel scan
+ * @author Josh Cardenzana
+ */
+
+#include <vector>
+
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Detector that tests every pixel through the virtual methods
+ *******************************************************************/
+class PixelPass : public lutzOnePass {
+public:
+    PixelPass(double* image, int xpixels, int ypixels) :
+        lutzOnePass(image, xpixels, ypixels)
+    {}
+};
+
+
+/***************************************************************//**
+ * @brief Make an object slot holding a single pixel
+ *******************************************************************/
+lutzOnePass::ObjectInfo OnePixel(int x, int y, double value)
+{
+    lutzOnePass::ObjectInfo info;
+    info.add(lutzObject::pixData(x, y, value));
+    return info;
+}
+
+
+/***************************************************************//**
+ * @brief An empty object takes nothing from, and gives nothing to, a join
+ *******************************************************************/
+void TestMergeEmpty()
+{
+    // A segment that has only just been opened may already be marked
+    // as truncated or rejected. Joining it must not pass that on.
+    lutzOnePass::ObjectInfo object = OnePixel(3, 4, 2.0);
+    lutzOnePass::ObjectInfo opened;
+    opened.m_truncated = true;
+    opened.m_rejected  = true;
+    opened.m_label     = 7;
+    object.m_label     = 2;
+    object.merge(opened);
+    LUTZ_CHECK(!object.m_truncated);
+    LUTZ_CHECK(!object.m_rejected);
+    LUTZ_CHECK(object.m_label == 2);
+    LUTZ_CHECK(object.m_npix == 1);
+    LUTZ_CHECK((object.m_xmin == 3) && (object.m_xmax == 3));
+    LUTZ_CHECK(opened.empty() && !opened.m_truncated);
+    
+    // The other way round the opened segment takes the object's place
+    lutzOnePass::ObjectInfo fresh;
+    fresh.m_truncated = true;
+    fresh.merge(object);
+    LUTZ_CHECK(!fresh.m_truncated);
+    LUTZ_CHECK(fresh.m_label == 2);
+    LUTZ_CHECK((fresh.m_npix == 1) && (fresh.m_pixels.size() == 1));
+    LUTZ_CHECK(object.empty());
+}
+
+
+/***************************************************************//**
+ * @brief Joining two objects keeps every pixel and all the statistics
+ *******************************************************************/
+void TestMergeObjects()
+{
+    lutzOnePass::ObjectInfo small = OnePixel(0, 0, 1.0);
+    lutzOnePass::ObjectInfo large = OnePixel(5, 2, 3.0);
+    large.add(lutzObject::pixData(6, 2, 4.0));
+    large.add(lutzObject::pixData(7, 3, 0.5));
+    
+    small.merge(large);
+    LUTZ_CHECK(small.m_npix == 4);
+    LUTZ_CHECK(small.m_pixels.size() == 4);
+    LUTZ_CHECK((small.m_xmin == 0) && (small.m_xmax == 7));
+    LUTZ_CHECK((small.m_ymin == 0) && (small.m_ymax == 3));
+    LUTZ_CHECK((small.m_xpeak == 6) && (small.m_ypeak == 2));
+    LUTZ_CHECK(small.m_min == 0.5);
+    LUTZ_CHECK(small.m_sum == 8.5);
+    
+    // The longer list is kept and the shorter one appended to it
+    LUTZ_CHECK(small.m_pixels[0].m_xbin == 5);
+    LUTZ_CHECK(small.m_pixels[3].m_xbin == 0);
+    LUTZ_CHECK(large.empty() && large.m_pixels.empty());
+}
+
+
+/***************************************************************//**
+ * @brief Pieces of one object are joined without using up open slots
+ *
+ * Only one object is ever open at a time, but the rows of each one open
+ * segments that are then joined to it. With room for a single open
+ * object nothing may be truncated.
+ *******************************************************************/
+void TestOpenLimitJoins()
+{
+    const int ypix = 10;
+    const char* rows[ypix] = {
+        "#########.",
+        "#.......#.",
+        "#.......#.",
+        "#########.",
+        "..........",
+        "#########.",
+        "#...#...#.",
+        "##..##..##",
+        "..........",
+        "##########"
+    };
+    std::vector<double> image = lutzTest::DrawImage(rows, ypix);
+    int xpix = image.size() / ypix;
+    
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetThreshold(0.5);
+    detector.SetMaxOpenObjects(1);
+    detector.run();
+    LUTZ_CHECK(detector.NumTruncated() == 0);
+    LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), xpix) ==
+               lutzTest::FloodFill(image, xpix, ypix, 0.5));
+}
+
+
+/***************************************************************//**
+ * @brief Objects over a limit keep their statistics but not their pixels
+ *******************************************************************/
+void TestLimits()
+{
+    int xpix = 96;
+    int ypix = 64;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.35, 17);
+    lutzTest::Catalog reference = lutzTest::FloodFill(image, xpix, ypix, 1.0);
+    
+    for (int mode=0; mode<3; mode++) {
+        lutzOnePass detector(image.data(), xpix, ypix);
+        detector.SetThreshold(1.0);
+        if (mode == 0) detector.SetMaxObjectPixels(20);
+        if (mode == 1) detector.SetMaxRetainedPixels(300);
+        if (mode == 2) detector.SetMaxOpenObjects(3);
+        detector.run();
+        std::vector<lutzObject> objects = detector.GetObjects();
+        LUTZ_CHECK(objects.size() == reference.size());
+        
+        // Kept objects are exact, truncated ones have the right size
+        std::vector<lutzObject> kept;
+        std::vector<int> sizes;
+        std::vector<int> reference_sizes;
+        int ntruncated = 0;
+        for (int i=0; i<objects.size(); i++) {
+            sizes.push_back(objects[i].NumPixels());
+            if (objects[i].GetFlags() & lutzObject::FLAG_TRUNCATED) {
+                LUTZ_CHECK(objects[i].size() == 0);
+                ntruncated++;
+            } else {
+                kept.push_back(objects[i]);
+                if (mode == 0) LUTZ_CHECK(objects[i].size() <= 20);
+            }
+        }
+        for (int i=0; i<reference.size(); i++) {
+            reference_sizes.push_back(reference[i].size());
+        }
+        std::sort(sizes.begin(), sizes.end());
+        std::sort(reference_sizes.begin(), reference_sizes.end());
+        LUTZ_CHECK(sizes == reference_sizes);
+        LUTZ_CHECK(ntruncated == detector.NumTruncated());
+        LUTZ_CHECK(ntruncated > 0);
+        
+        lutzTest::Catalog catalog = lutzTest::MakeCatalog(kept, xpix);
+        for (int i=0; i<catalog.size(); i++) {
+            LUTZ_CHECK(std::binary_search(reference.begin(), reference.end(),
+                                          catalog[i]));
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Skipping the background gives the objects of a full scan
+ *
+ * The per-pixel scan leaves out background pixels with no marker above
+ * them while no segment is open. Objects touching either edge of the
+ * frame, and frames of one or two columns, are where a wrongly skipped
+ * pixel would show.
+ *******************************************************************/
+void TestSkipBackground()
+{
+    const int sizes[][2] = {{1, 30}, {2, 30}, {7, 9}, {64, 32}, {101, 50}};
+    const double densities[] = {0.1, 0.4, 0.7};
+    unsigned seed = 40;
+    for (int s=0; s<5; s++) {
+        for (int d=0; d<3; d++) {
+            int xpix = sizes[s][0];
+            int ypix = sizes[s][1];
+            std::vector<double> image =
+                lutzTest::RandomImage(xpix, ypix, densities[d], seed++);
+            PixelPass detector(image.data(), xpix, ypix);
+            detector.SetThreshold(1.0);
+            detector.run();
+            LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), xpix) ==
+                       lutzTest::FloodFill(image, xpix, ypix, 1.0));
+        }
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestMergeEmpty();
+    TestMergeObjects();
+    TestOpenLimitJoins();
+    TestLimits();
+    TestSkipBackground();
+    return lutzTest::Result("test_limits");
+}
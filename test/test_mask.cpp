@@ -0,0 +1,151 @@
+/***************************************************************************
+ *  test_mask.cpp - Tests of detection on a bit-packed mask                *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_mask.cpp
+ * @brief Tests that lutzMaskPass finds the objects of thresholding the
+ *        image the mask was made from
+ * @author Josh Cardenzana
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "lutzMaskPass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Pack the pixels above threshold into a mask
+ *
+ * @param[in] image         Frame values
+ * @param[in] xpix          Number of pixels in x
+ * @param[in] ypix          Number of pixels in y
+ * @param[in] stride        Words per row
+ * @param[in] junk          Bits set in the words and bits past the end
+ *                          of each row, which the scan must ignore
+ * @return Mask of ypix x stride words
+ *******************************************************************/
+std::vector<uint64_t> MakeMask(const std::vector<double>& image, int xpix, int ypix,
+                               int stride, uint64_t junk)
+{
+    int nwords = lutzMaskPass::WordsPerRow(xpix);
+    std::vector<uint64_t> mask(size_t(ypix) * stride, junk);
+    for (int y=0; y<ypix; y++) {
+        uint64_t* row = &mask[size_t(y) * stride];
+        for (int w=0; w<nwords; w++) row[w] = 0;
+        if (xpix % 64) row[nwords - 1] = junk << (xpix % 64);
+        for (int x=0; x<xpix; x++) {
+            if (image[size_t(y) * xpix + x] > 1.0) row[x / 64] |= uint64_t(1) << (x % 64);
+        }
+    }
+    return mask;
+}
+
+
+/***************************************************************//**
+ * @brief Return whether two lists of objects are identical
+ *******************************************************************/
+bool SameObjects(const std::vector<lutzObject>& a, const std::vector<lutzObject>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i=0; i<a.size(); i++) {
+        if (a[i].size() != b[i].size()) return false;
+        for (int p=0; p<a[i].size(); p++) {
+            if ((a[i][p].m_xbin != b[i][p].m_xbin) ||
+                (a[i][p].m_ybin != b[i][p].m_ybin) ||
+                (a[i][p].m_value != b[i][p].m_value)) return false;
+        }
+    }
+    return true;
+}
+
+
+/***************************************************************//**
+ * @brief The mask gives the objects, in the same order and with the
+ *        same values, that the threshold gives
+ *
+ * Each frame is packed tightly with clean tails, and with a wider
+ * stride whose spare bits and words are all set.
+ *******************************************************************/
+void TestThreshold()
+{
+    const int sizes[][2] = {{1, 1}, {1, 30}, {5, 7}, {63, 20}, {64, 20},
+                            {65, 25}, {130, 40}};
+    const double densities[] = {0.05, 0.3, 0.6};
+    unsigned seed = 30;
+    for (int s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        for (int d=0; d < sizeof(densities)/sizeof(densities[0]); d++) {
+            int xpix = sizes[s][0];
+            int ypix = sizes[s][1];
+            std::vector<double> image = lutzTest::RandomImage(xpix, ypix,
+                                                              densities[d], seed++);
+            lutzOnePass direct(image.data(), xpix, ypix);
+            direct.SetThreshold(1.0);
+            direct.run();
+            
+            for (int padded=0; padded<2; padded++) {
+                int stride = lutzMaskPass::WordsPerRow(xpix) + padded;
+                uint64_t junk = padded ? ~uint64_t(0) : 0;
+                std::vector<uint64_t> mask = MakeMask(image, xpix, ypix, stride, junk);
+                
+                lutzMaskPass pass(mask.data(), xpix, ypix);
+                pass.SetMask(mask.data(), padded ? stride : 0);
+                pass.SetImage(image.data());
+                pass.run();
+                LUTZ_CHECK(SameObjects(pass.GetObjects(), direct.GetObjects()));
+            }
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Without an image every object pixel has a value of 1
+ *******************************************************************/
+void TestNoImage()
+{
+    const int xpix = 100;
+    const int ypix = 50;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.3, 37);
+    std::vector<uint64_t> mask = MakeMask(image, xpix, ypix,
+                                          lutzMaskPass::WordsPerRow(xpix), 0);
+    
+    lutzMaskPass pass(mask.data(), xpix, ypix);
+    pass.run();
+    std::vector<lutzObject> objects = pass.GetObjects();
+    LUTZ_CHECK(lutzTest::MakeCatalog(objects, xpix) ==
+               lutzTest::FloodFill(image, xpix, ypix, 1.0));
+    for (size_t i=0; i<objects.size(); i++) {
+        LUTZ_CHECK((objects[i].Sum() == objects[i].size()) &&
+                   (objects[i].GetMaximum() == 1.0));
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestThreshold();
+    TestNoImage();
+    return lutzTest::Result("test_mask");
+}
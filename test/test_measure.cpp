@@ -0,0 +1,207 @@
+/***************************************************************************
+ *  test_measure.cpp - Tests of the parallel catalog measurement           *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_measure.cpp
+ * @brief Tests that lutzMeasure gives the same catalog on any number of
+ *        threads, and the values a plain serial loop gives
+ * @author Josh Cardenzana
+ */
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "lutzCatalog.hpp"
+#include "lutzMeasure.hpp"
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+const lutzCatalog::LUTZ_COLUMN COLUMNS[] = {
+    lutzCatalog::COL_X, lutzCatalog::COL_Y, lutzCatalog::COL_XX,
+    lutzCatalog::COL_YY, lutzCatalog::COL_XY, lutzCatalog::COL_A,
+    lutzCatalog::COL_B, lutzCatalog::COL_THETA, lutzCatalog::COL_FLUX,
+    lutzCatalog::COL_NPIX, lutzCatalog::COL_PEAK, lutzCatalog::COL_XPEAK,
+    lutzCatalog::COL_YPEAK};
+const int NCOLUMNS = sizeof(COLUMNS) / sizeof(COLUMNS[0]);
+
+
+/***************************************************************//**
+ * @brief Return whether two numbers agree to rounding
+ *******************************************************************/
+bool Close(double a, double b)
+{
+    return std::fabs(a - b) <= 1.0e-9 * (1.0 + std::fabs(a) + std::fabs(b));
+}
+
+
+/***************************************************************//**
+ * @brief Return whether two catalogs hold the same bits
+ *******************************************************************/
+bool Identical(const lutzCatalog& a, const lutzCatalog& b)
+{
+    if (a.size() != b.size()) return false;
+    for (int c=0; c<NCOLUMNS; c++) {
+        if (a.HasColumn(COLUMNS[c]) != b.HasColumn(COLUMNS[c])) return false;
+        const std::vector<double>& ca = a.GetColumn(COLUMNS[c]);
+        const std::vector<double>& cb = b.GetColumn(COLUMNS[c]);
+        if ((ca.size() != cb.size()) ||
+            (!ca.empty() && std::memcmp(ca.data(), cb.data(),
+                                        ca.size() * sizeof(double)))) return false;
+    }
+    return true;
+}
+
+
+/***************************************************************//**
+ * @brief Objects of a frame with one giant object and many small ones
+ *******************************************************************/
+std::vector<lutzObject> MakeObjects()
+{
+    const int xpix = 200;
+    const int ypix = 150;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.5, 250);
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetThreshold(1.0);
+    detector.run();
+    return detector.GetObjects();
+}
+
+
+/***************************************************************//**
+ * @brief Any number of threads gives the same bits, however finely
+ *        the giant object is sliced
+ *******************************************************************/
+void TestThreads()
+{
+    std::vector<lutzObject> objects = MakeObjects();
+    const int grains[] = {1, 37, 4096, 1000000};
+    const int threads[] = {2, 3, 8};
+    for (int g=0; g<4; g++) {
+        lutzMeasure serial;
+        serial.SetThreads(1);
+        serial.SetGrain(grains[g]);
+        lutzCatalog expected;
+        serial.run(objects, expected);
+        LUTZ_CHECK(expected.size() == objects.size());
+        
+        for (int t=0; t<3; t++) {
+            lutzMeasure parallel;
+            parallel.SetThreads(threads[t]);
+            parallel.SetGrain(grains[g]);
+            lutzCatalog catalog;
+            parallel.run(objects, catalog);
+            LUTZ_CHECK(Identical(catalog, expected));
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief The catalog holds what a plain loop over the pixels gives
+ *******************************************************************/
+void TestValues()
+{
+    std::vector<lutzObject> objects = MakeObjects();
+    lutzMeasure measure;
+    measure.SetThreads(4);
+    measure.SetGrain(50);
+    lutzCatalog catalog;
+    measure.run(objects, catalog);
+    
+    for (size_t i=0; i<objects.size(); i++) {
+        const lutzObject& object = objects[i];
+        double w = 0, wx = 0, wy = 0;
+        int peak = 0;
+        for (int p=0; p<object.size(); p++) {
+            w  += object[p].m_value;
+            wx += object[p].m_value * object[p].m_xbin;
+            wy += object[p].m_value * object[p].m_ybin;
+            if (object[p].m_value > object[peak].m_value) peak = p;
+        }
+        double x = wx / w;
+        double y = wy / w;
+        double xx = 0, yy = 0, xy = 0;
+        for (int p=0; p<object.size(); p++) {
+            double dx = object[p].m_xbin - x;
+            double dy = object[p].m_ybin - y;
+            xx += object[p].m_value * dx * dx;
+            yy += object[p].m_value * dy * dy;
+            xy += object[p].m_value * dx * dy;
+        }
+        xx /= w;
+        yy /= w;
+        xy /= w;
+        double root = std::sqrt(0.25 * (xx - yy) * (xx - yy) + xy * xy);
+        
+        LUTZ_CHECK(Close(catalog.GetValue(lutzCatalog::COL_X, i), x));
+        LUTZ_CHECK(Close(catalog.GetValue(lutzCatalog::COL_Y, i), y));
+        LUTZ_CHECK(Close(catalog.GetValue(lutzCatalog::COL_XX, i), xx));
+        LUTZ_CHECK(Close(catalog.GetValue(lutzCatalog::COL_YY, i), yy));
+        LUTZ_CHECK(Close(catalog.GetValue(lutzCatalog::COL_XY, i), xy));
+        LUTZ_CHECK(Close(catalog.GetValue(lutzCatalog::COL_A, i),
+                         std::sqrt(0.5 * (xx + yy) + root)));
+        LUTZ_CHECK(Close(catalog.GetValue(lutzCatalog::COL_FLUX, i), object.Sum()));
+        LUTZ_CHECK(catalog.GetValue(lutzCatalog::COL_NPIX, i) == object.size());
+        LUTZ_CHECK(catalog.GetValue(lutzCatalog::COL_PEAK, i) == object.GetMaximum());
+        LUTZ_CHECK(catalog.GetValue(lutzCatalog::COL_XPEAK, i) == object[peak].m_xbin);
+        LUTZ_CHECK(catalog.GetValue(lutzCatalog::COL_YPEAK, i) == object[peak].m_ybin);
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Only the chosen features get columns, and a truncated object
+ *        gets what its summary holds
+ *******************************************************************/
+void TestFeatures()
+{
+    std::vector<lutzObject> objects(1);
+    objects[0].SetSummary(40, 10, 20, 4, 8, 1.5, 9.0, 123.0);
+    
+    lutzMeasure measure(lutzMeasure::FEATURE_CENTROID | lutzMeasure::FEATURE_FLUX |
+                        lutzMeasure::FEATURE_MOMENTS);
+    lutzCatalog catalog;
+    measure.run(objects, catalog);
+    LUTZ_CHECK(catalog.size() == 1);
+    LUTZ_CHECK(catalog.HasColumn(lutzCatalog::COL_X) &&
+               catalog.HasColumn(lutzCatalog::COL_FLUX) &&
+               catalog.HasColumn(lutzCatalog::COL_XX));
+    LUTZ_CHECK(!catalog.HasColumn(lutzCatalog::COL_A) &&
+               !catalog.HasColumn(lutzCatalog::COL_PEAK));
+    LUTZ_CHECK(catalog.GetValue(lutzCatalog::COL_X, 0) == 15.0);
+    LUTZ_CHECK(catalog.GetValue(lutzCatalog::COL_Y, 0) == 6.0);
+    LUTZ_CHECK(catalog.GetValue(lutzCatalog::COL_FLUX, 0) == 123.0);
+    LUTZ_CHECK(catalog.GetValue(lutzCatalog::COL_NPIX, 0) == 40);
+    LUTZ_CHECK(std::isnan(catalog.GetValue(lutzCatalog::COL_XX, 0)));
+}
+
+} // namespace
+
+
+int main()
+{
+    TestThreads();
+    TestValues();
+    TestFeatures();
+    return lutzTest::Result("test_measure");
+}
@@ -0,0 +1,171 @@
+/***************************************************************************
+ *  test_memory.cpp - Tests that repeated runs reuse their memory          *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_memory.cpp
+ * @brief Tests that a detector run on frame after frame stops allocating
+ * @author Josh Cardenzana
+ */
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+// Number of allocations made by the program so far
+long g_allocations = 0;
+
+}
+
+// Count every allocation the program makes
+void* operator new(std::size_t size)
+{
+    g_allocations++;
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+
+namespace {
+
+/***************************************************************//**
+ * @brief Run a detector on the same frame and count the allocations
+ *
+ * @param[in] detector      Detector set up on the frame
+ * @param[in] warmup        Number of runs allowed to allocate
+ * @param[in] nruns         Number of runs counted after the warm-up
+ * @return Allocations made by the counted runs
+ *******************************************************************/
+long CountAllocations(lutzOnePass& detector, int warmup, int nruns)
+{
+    detector.run();
+    int nobjects = detector.NumObjects();
+    for (int i=1; i<warmup; i++) detector.run();
+    
+    long before = g_allocations;
+    for (int i=0; i<nruns; i++) {
+        detector.run();
+        LUTZ_CHECK(detector.NumObjects() == nobjects);
+    }
+    return g_allocations - before;
+}
+
+
+/***************************************************************//**
+ * @brief Objects kept with their pixel lists
+ *******************************************************************/
+void TestPixelList()
+{
+    int xpix = 256;
+    int ypix = 256;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.1, 61);
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetThreshold(1.0);
+    LUTZ_CHECK(CountAllocations(detector, 5, 10) == 0);
+    LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), xpix) ==
+               lutzTest::FloodFill(image, xpix, ypix, 1.0));
+}
+
+
+/***************************************************************//**
+ * @brief Objects of thousands of pixels
+ *
+ * The pixel lists keep their storage from one run to the next however
+ * large they grew, unless SetMaxSparePixels() caps it.
+ *******************************************************************/
+void TestLargeObjects()
+{
+    int xpix = 300;
+    int ypix = 200;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.02, 64);
+    for (int y=0; y<ypix; y++) {
+        for (int x=0; x<xpix; x++) {
+            int dx = (x % 100) - 50;
+            int dy = (y % 100) - 50;
+            if (dx * dx + dy * dy < 28 * 28) image[size_t(y) * xpix + x] = 1.5;
+        }
+    }
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetThreshold(1.0);
+    LUTZ_CHECK(CountAllocations(detector, 5, 10) == 0);
+    LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), xpix) ==
+               lutzTest::FloodFill(image, xpix, ypix, 1.0));
+    
+    detector.SetMaxSparePixels(256);
+    LUTZ_CHECK(CountAllocations(detector, 5, 10) > 0);
+    LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), xpix) ==
+               lutzTest::FloodFill(image, xpix, ypix, 1.0));
+}
+
+
+/***************************************************************//**
+ * @brief Only the brightest objects are kept
+ *
+ * The heap of kept objects shifts their storage around, so this takes a
+ * few more runs to settle than the plain pixel lists.
+ *******************************************************************/
+void TestMaxObjects()
+{
+    int xpix = 256;
+    int ypix = 256;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.1, 62);
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetThreshold(1.0);
+    detector.SetMaxObjects(50);
+    LUTZ_CHECK(CountAllocations(detector, 30, 10) == 0);
+    LUTZ_CHECK(detector.NumObjects() == 50);
+}
+
+
+/***************************************************************//**
+ * @brief Objects recorded by their bounding boxes only
+ *******************************************************************/
+void TestBoxes()
+{
+    int xpix = 256;
+    int ypix = 256;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.1, 63);
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetThreshold(1.0);
+    detector.SetBoxesOnly(true);
+    LUTZ_CHECK(CountAllocations(detector, 2, 10) == 0);
+}
+
+} // namespace
+
+
+int main()
+{
+    TestPixelList();
+    TestLargeObjects();
+    TestMaxObjects();
+    TestBoxes();
+    return lutzTest::Result("test_memory");
+}
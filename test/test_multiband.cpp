@@ -0,0 +1,125 @@
+/***************************************************************************
+ *  test_multiband.cpp - Tests of detection on several bands               *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_multiband.cpp
+ * @brief Tests of lutzMultiBand
+ * @author Josh Cardenzana
+ */
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "lutzMultiBand.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Bands without a usable noise level are refused
+ *******************************************************************/
+void TestNoise()
+{
+    std::vector<double> image(16, 1.0);
+    std::vector<double> noise_map(16, 0.0);
+    lutzMultiBand detector(4, 4);
+    LUTZ_CHECK(!detector.AddBand(image.data(), 1.0, 0.0));
+    LUTZ_CHECK(!detector.AddBand(image.data(), 1.0, -2.0));
+    LUTZ_CHECK(!detector.AddBand(image.data(), 1.0,
+                                 std::numeric_limits<double>::quiet_NaN()));
+    LUTZ_CHECK(detector.NumBands() == 0);
+    
+    // With a noise map the scalar noise is not used
+    LUTZ_CHECK(detector.AddBand(image.data(), 1.0, 0.0, noise_map.data()));
+    LUTZ_CHECK(detector.AddBand(image.data(), 1.0, 2.0));
+    LUTZ_CHECK(detector.NumBands() == 2);
+    
+    // The map's pixels of zero noise add nothing, the other band adds
+    // (1 / 2)^2 at every pixel
+    detector.SetThreshold(0.2);
+    detector.run();
+    LUTZ_CHECK(detector.NumObjects() == 1);
+    if (detector.NumObjects() == 1) {
+        lutzObject object = detector.GetObjects()[0];
+        LUTZ_CHECK(object.size() == 16);
+        LUTZ_CHECK(std::isfinite(object.Sum()));
+        LUTZ_CHECK(std::fabs(object[0].m_value - 0.25) < 1.0e-12);
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Objects are those of the combined statistic
+ *******************************************************************/
+void TestCombine()
+{
+    int xpix = 70;
+    int ypix = 40;
+    std::vector<double> band1 = lutzTest::RandomImage(xpix, ypix, 0.2, 81);
+    std::vector<double> band2 = lutzTest::RandomImage(xpix, ypix, 0.2, 82);
+    std::vector<double> noise2(band2.size(), 0.5);
+    
+    for (int c=0; c<2; c++) {
+        lutzMultiBand::LUTZ_COMBINE combine = (c == 0) ?
+            lutzMultiBand::COMBINE_CHI2 : lutzMultiBand::COMBINE_WEIGHTED_SUM;
+        
+        // The statistic worked out by hand
+        std::vector<double> statistic(band1.size());
+        for (size_t i=0; i<band1.size(); i++) {
+            double snr1 = band1[i] / 2.0;
+            double snr2 = band2[i] / 0.5;
+            statistic[i] = (c == 0) ?
+                (snr1 * snr1 + 3.0 * snr2 * snr2) :
+                (snr1 + 3.0 * snr2) / std::sqrt(10.0);
+        }
+        double threshold = (c == 0) ? 12.0 : 2.5;
+        
+        lutzMultiBand detector(xpix, ypix);
+        detector.SetCombination(combine);
+        detector.AddBand(band1.data(), 1.0, 2.0);
+        detector.AddBand(band2.data(), 3.0, 1.0, noise2.data());
+        detector.SetThreshold(threshold);
+        detector.run();
+        std::vector<lutzObject> objects = detector.GetObjects();
+        LUTZ_CHECK(lutzTest::MakeCatalog(objects, xpix) ==
+                   lutzTest::FloodFill(statistic, xpix, ypix, threshold));
+        
+        // Every pixel also carries its value in each band
+        for (int i=0; i<objects.size(); i++) {
+            LUTZ_CHECK(objects[i].NumBands() == 2);
+            for (int p=0; p<objects[i].size(); p++) {
+                size_t index = size_t(objects[i][p].m_ybin) * xpix + objects[i][p].m_xbin;
+                LUTZ_CHECK(objects[i].GetBandValue(p, 0) == band1[index]);
+                LUTZ_CHECK(objects[i].GetBandValue(p, 1) == band2[index]);
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestNoise();
+    TestCombine();
+    return lutzTest::Result("test_multiband");
+}
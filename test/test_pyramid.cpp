@@ -0,0 +1,116 @@
+/***************************************************************************
+ *  test_pyramid.cpp - Tests of coarse-to-fine detection                   *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_pyramid.cpp
+ * @brief Tests that lutzPyramid finds the same objects as lutzOnePass
+ * @author Josh Cardenzana
+ */
+
+#include <vector>
+
+#include "lutzPyramid.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Pyramid that reads its rows through GetPixValue()
+ *******************************************************************/
+class PixelPyramid : public lutzPyramid {
+public:
+    PixelPyramid(double* image, int xpixels, int ypixels) :
+        lutzPyramid(image, xpixels, ypixels)
+    {}
+};
+
+
+/***************************************************************//**
+ * @brief REDUCE_MAX finds exactly the objects of the full scan
+ *
+ * Frame sizes that are not a multiple of the binning leave partial
+ * cells along the edges.
+ *******************************************************************/
+void TestExact()
+{
+    const int sizes[][2] = {{64, 64}, {100, 37}, {33, 129}};
+    const int binnings[] = {2, 5, 8};
+    const double densities[] = {0.002, 0.02, 0.2};
+    unsigned seed = 10;
+    for (int s=0; s < 3; s++) {
+        for (int b=0; b < 3; b++) {
+            for (int d=0; d < 3; d++) {
+                int xpix = sizes[s][0];
+                int ypix = sizes[s][1];
+                std::vector<double> image = lutzTest::RandomImage(xpix, ypix,
+                                                                  densities[d], seed++);
+                lutzTest::Catalog expected = lutzTest::FloodFill(image, xpix, ypix, 1.0);
+                
+                lutzPyramid  pyramid(image.data(), xpix, ypix);
+                PixelPyramid pixel(image.data(), xpix, ypix);
+                pyramid.SetBinning(binnings[b]);
+                pixel.SetBinning(binnings[b]);
+                pyramid.SetThreshold(1.0);
+                pixel.SetThreshold(1.0);
+                pyramid.run();
+                pixel.run();
+                
+                LUTZ_CHECK(lutzTest::MakeCatalog(pyramid.GetObjects(), xpix) == expected);
+                LUTZ_CHECK(lutzTest::MakeCatalog(pixel.GetObjects(), xpix) == expected);
+                LUTZ_CHECK(pyramid.NumCandidates() == pixel.NumCandidates());
+            }
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief REDUCE_MEAN with a high coarse threshold skips faint objects
+ *******************************************************************/
+void TestMean()
+{
+    const int npix = 32;
+    std::vector<double> image(npix * npix, 0.0);
+    
+    // A bright 4x4 block fills a cell, a single faint pixel does not
+    for (int y=8; y<12; y++) {
+        for (int x=8; x<12; x++) image[y * npix + x] = 10.0;
+    }
+    image[25 * npix + 25] = 2.0;
+    
+    lutzPyramid pyramid(image.data(), npix, npix);
+    pyramid.SetBinning(4);
+    pyramid.SetReduction(lutzPyramid::REDUCE_MEAN);
+    pyramid.SetCoarseThreshold(1.0);
+    pyramid.SetThreshold(1.0);
+    pyramid.run();
+    LUTZ_CHECK(pyramid.NumCandidates() == 1);
+    LUTZ_CHECK((pyramid.NumObjects() == 1) && (pyramid.GetObject(0).size() == 16));
+}
+
+} // namespace
+
+
+int main()
+{
+    TestExact();
+    TestMean();
+    return lutzTest::Result("test_pyramid");
+}
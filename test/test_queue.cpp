@@ -0,0 +1,188 @@
+/***************************************************************************
+ *  test_queue.cpp - Tests of the object queue                             *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_queue.cpp
+ * @brief Tests of lutzObjectQueue and of handing objects to it from a scan
+ * @author Josh Cardenzana
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "lutzObjectQueue.hpp"
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Make an object of one pixel
+ *******************************************************************/
+lutzObject OnePixel(int x, int y)
+{
+    lutzObject object;
+    object.append(lutzObject::pixData(x, y, 1.0));
+    return object;
+}
+
+
+/***************************************************************//**
+ * @brief Objects are handed out in order and the frame ends after them
+ *******************************************************************/
+void TestSingleFrame()
+{
+    lutzObjectQueue queue(4);
+    size_t frame = queue.open();
+    LUTZ_CHECK(frame == 1);
+    LUTZ_CHECK(!queue.closed(frame));
+    
+    // The ring holds 4 objects, so a fifth does not fit
+    for (int i=0; i<4; i++) {
+        lutzObject object = OnePixel(i, 0);
+        LUTZ_CHECK(queue.try_push(object));
+        LUTZ_CHECK(object.size() == 0);
+    }
+    lutzObject extra = OnePixel(4, 0);
+    LUTZ_CHECK(!queue.try_push(extra));
+    LUTZ_CHECK(queue.size() == 4);
+    queue.close();
+    LUTZ_CHECK(queue.closed(frame));
+    
+    lutzObject object;
+    for (int i=0; i<4; i++) {
+        LUTZ_CHECK(queue.pop(object, frame));
+        LUTZ_CHECK((object.size() == 1) && (object[0].m_xbin == i));
+    }
+    LUTZ_CHECK(!queue.pop(object, frame));
+}
+
+
+/***************************************************************//**
+ * @brief A consumer that falls behind does not mix two frames
+ *
+ * The producer closes frame 1 and opens frame 2 before the consumer
+ * has looked at the queue at all. The consumer must still see the end
+ * of frame 1 in the right place.
+ *******************************************************************/
+void TestSlowConsumer()
+{
+    lutzObjectQueue queue(16);
+    size_t first = queue.open();
+    for (int i=0; i<3; i++) {
+        lutzObject object = OnePixel(i, 1);
+        queue.push(object);
+    }
+    queue.close();
+    size_t second = queue.open();
+    LUTZ_CHECK(second == first + 1);
+    for (int i=0; i<2; i++) {
+        lutzObject object = OnePixel(i, 2);
+        queue.push(object);
+    }
+    
+    lutzObject object;
+    int nfirst = 0;
+    while (queue.pop(object, first)) {
+        LUTZ_CHECK(object[0].m_ybin == 1);
+        nfirst++;
+    }
+    LUTZ_CHECK(nfirst == 3);
+    
+    // Frame 2 is still open, so its objects are there but it has not ended
+    LUTZ_CHECK(queue.try_pop(object, second) && (object[0].m_ybin == 2));
+    LUTZ_CHECK(queue.try_pop(object, second) && (object[0].m_ybin == 2));
+    LUTZ_CHECK(!queue.try_pop(object, second));
+    LUTZ_CHECK(!queue.closed(second));
+    queue.close();
+    LUTZ_CHECK(!queue.pop(object, second));
+}
+
+
+/***************************************************************//**
+ * @brief Several consumers drain repeated scans, frame by frame
+ *
+ * Each run() is one frame. The consumers are slowed down so that the
+ * detector is usually a frame or more ahead of them, and every frame
+ * must still reach them whole and on its own.
+ *******************************************************************/
+void TestScanFrames()
+{
+    const int xpix = 64;
+    const int ypix = 64;
+    const int nframes = 20;
+    const int nconsumers = 3;
+    
+    // Each frame has a different number of isolated single pixels
+    std::vector<std::vector<double> > images(nframes);
+    for (int f=0; f<nframes; f++) {
+        images[f].assign(xpix * ypix, 0.0);
+        for (int i=0; i<=f; i++) {
+            images[f][(2 * (i / 16)) * xpix + 2 * (i % 16)] = f + 1.0;
+        }
+    }
+    
+    lutzObjectQueue queue(4);
+    std::vector<std::atomic<int> > counts(nframes);
+    std::atomic<int> nwrong(0);
+    for (int f=0; f<nframes; f++) counts[f].store(0);
+    
+    std::vector<std::thread> consumers;
+    for (int c=0; c<nconsumers; c++) {
+        consumers.push_back(std::thread([&]() {
+            lutzObject object;
+            for (size_t frame=1; frame <= nframes; frame++) {
+                while (queue.pop(object, frame)) {
+                    if (object.GetMaximum() != double(frame)) nwrong++;
+                    counts[frame - 1]++;
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        }));
+    }
+    
+    lutzOnePass detector(nullptr, xpix, ypix);
+    detector.SetThreshold(0.5);
+    detector.SetObjectQueue(&queue);
+    for (int f=0; f<nframes; f++) {
+        detector.SetImage(images[f].data());
+        detector.run();
+    }
+    for (int c=0; c<nconsumers; c++) consumers[c].join();
+    
+    LUTZ_CHECK(nwrong == 0);
+    for (int f=0; f<nframes; f++) {
+        LUTZ_CHECK(counts[f] == f + 1);
+    }
+    LUTZ_CHECK(detector.NumObjects() == 0);
+}
+
+} // namespace
+
+
+int main()
+{
+    TestSingleFrame();
+    TestSlowConsumer();
+    TestScanFrames();
+    return lutzTest::Result("test_queue");
+}
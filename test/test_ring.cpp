@@ -0,0 +1,194 @@
+/***************************************************************************
+ *  test_ring.cpp - Tests of the shared memory catalog ring                *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_ring.cpp
+ * @brief Tests of lutzCatalogRing and lutzCatalogReader
+ * @author Josh Cardenzana
+ */
+
+#include <cmath>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include "lutzCatalogReader.hpp"
+#include "lutzCatalogRing.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Return a ring name no other test run is using
+ *******************************************************************/
+std::string RingName()
+{
+    return "/lutz_test_ring_" + std::to_string(getpid());
+}
+
+
+/***************************************************************//**
+ * @brief Make a catalog of nobjects single pixel objects
+ *
+ * @param[in] nobjects      Number of objects
+ * @param[in] value         Value of every pixel, to tell frames apart
+ *******************************************************************/
+std::vector<lutzObject> MakeObjects(int nobjects, double value)
+{
+    std::vector<lutzObject> objects(nobjects);
+    for (int i=0; i<nobjects; i++) {
+        objects[i].append(lutzObject::pixData(i, 2 * i, value));
+    }
+    return objects;
+}
+
+
+/***************************************************************//**
+ * @brief Frames are read in order, and a slow reader skips ahead
+ *******************************************************************/
+void TestFrames()
+{
+    lutzCatalogRing ring;
+    LUTZ_CHECK(ring.Create(RingName(), 4, 3));
+    lutzCatalogReader reader;
+    LUTZ_CHECK(reader.Open(RingName()));
+    
+    lutzCatalogReader::Frame frame;
+    LUTZ_CHECK(!reader.Next(frame));
+    LUTZ_CHECK(!reader.Latest(frame));
+    
+    // Objects beyond the room of a slot are dropped and counted
+    LUTZ_CHECK(ring.Publish(10, MakeObjects(2, 1.0)));
+    LUTZ_CHECK(ring.Publish(11, MakeObjects(5, 2.0)));
+    LUTZ_CHECK(reader.Next(frame));
+    LUTZ_CHECK((frame.m_frame == 10) && (frame.m_nrecords == 2));
+    LUTZ_CHECK((frame.m_records[1].m_xmin == 1) && (frame.m_records[1].m_ymin == 2));
+    LUTZ_CHECK(frame.m_records[1].m_sum == 1.0);
+    LUTZ_CHECK(reader.End(frame));
+    LUTZ_CHECK(reader.Next(frame));
+    LUTZ_CHECK((frame.m_frame == 11) && (frame.m_nrecords == 3) &&
+               (frame.m_ndropped == 2));
+    std::vector<lutzRingRecord> records;
+    LUTZ_CHECK(reader.Copy(frame, records) && (records.size() == 3));
+    LUTZ_CHECK(!reader.Next(frame));
+    
+    // Six more frames overwrite the two the reader has not yet seen
+    for (int f=12; f<18; f++) ring.Publish(f, MakeObjects(1, f));
+    LUTZ_CHECK(reader.Next(frame) && (frame.m_frame == 14));
+    LUTZ_CHECK(reader.NumMissed() == 2);
+    LUTZ_CHECK(reader.Latest(frame) && (frame.m_frame == 17));
+    LUTZ_CHECK(reader.NumPublished() == 8);
+}
+
+
+/***************************************************************//**
+ * @brief A reader follows the writer onto a ring made in its place
+ *
+ * The old ring is unlinked rather than truncated, so a reader still
+ * reading it in place is never cut short.
+ *******************************************************************/
+void TestReplace()
+{
+    lutzCatalogRing ring;
+    LUTZ_CHECK(ring.Create(RingName(), 4, 8));
+    LUTZ_CHECK(ring.Generation() == 0);
+    for (int f=0; f<3; f++) ring.Publish(f, MakeObjects(2, f + 1.0));
+    
+    lutzCatalogReader reader;
+    LUTZ_CHECK(reader.Open(RingName()));
+    lutzCatalogReader::Frame frame;
+    LUTZ_CHECK(reader.Next(frame) && (frame.m_frame == 0));
+    
+    // The writer starts again, with a larger ring, while a frame is open
+    LUTZ_CHECK(ring.Create(RingName(), 16, 64));
+    LUTZ_CHECK(ring.Generation() == 1);
+    LUTZ_CHECK(reader.IsRetired());
+    LUTZ_CHECK(frame.m_records[1].m_sum == 1.0);
+    LUTZ_CHECK(reader.End(frame));
+    ring.Publish(100, MakeObjects(1, 100.0));
+    
+    // What was left of the old ring comes first, then the new one
+    LUTZ_CHECK(reader.Next(frame) && (frame.m_frame == 1));
+    LUTZ_CHECK(reader.Next(frame) && (frame.m_frame == 2));
+    LUTZ_CHECK(reader.Next(frame) && (frame.m_frame == 100));
+    LUTZ_CHECK(reader.Generation() == 1);
+    LUTZ_CHECK(!reader.IsRetired());
+    LUTZ_CHECK(!reader.Next(frame));
+    
+    // A ring made by another writer retires this one as well
+    lutzCatalogRing other;
+    LUTZ_CHECK(other.Create(RingName(), 2, 2));
+    LUTZ_CHECK(other.Generation() == 2);
+    other.Publish(200, MakeObjects(1, 200.0));
+    LUTZ_CHECK(reader.Next(frame) && (frame.m_frame == 200));
+    
+    // Once the ring is closed and gone the reader simply runs dry
+    other.Close();
+    LUTZ_CHECK(reader.IsRetired());
+    LUTZ_CHECK(!reader.Next(frame));
+    LUTZ_CHECK(reader.Latest(frame) && (frame.m_frame == 200));
+    ring.Close(false);
+}
+
+
+/***************************************************************//**
+ * @brief A box is published without the fields it does not know
+ *******************************************************************/
+void TestBoxes()
+{
+    lutzCatalogRing ring;
+    LUTZ_CHECK(ring.Create(RingName(), 4, 8));
+    lutzCatalogReader reader;
+    LUTZ_CHECK(reader.Open(RingName()));
+    
+    std::vector<lutzBox> boxes(1);
+    boxes[0].m_npix  = 5;
+    boxes[0].m_xmin  = 3;
+    boxes[0].m_xmax  = 8;
+    boxes[0].m_ymin  = 1;
+    boxes[0].m_ymax  = 2;
+    boxes[0].m_xpeak = 8;
+    boxes[0].m_ypeak = 2;
+    boxes[0].m_flags = 0;
+    boxes[0].m_peak  = 4.0;
+    LUTZ_CHECK(ring.Publish(0, boxes));
+    
+    lutzCatalogReader::Frame frame;
+    LUTZ_CHECK(reader.Next(frame) && (frame.m_nrecords == 1));
+    const lutzRingRecord& record = frame.m_records[0];
+    LUTZ_CHECK((record.m_npix == 5) && (record.m_xmin == 3) && (record.m_xmax == 8) &&
+               (record.m_ymin == 1) && (record.m_ymax == 2) && (record.m_peak == 4.0));
+    LUTZ_CHECK(std::isnan(record.m_x) && std::isnan(record.m_y));
+    LUTZ_CHECK(std::isnan(record.m_sum) && std::isnan(record.m_min));
+    ring.Close();
+}
+
+} // namespace
+
+
+int main()
+{
+    TestFrames();
+    TestReplace();
+    TestBoxes();
+    shm_unlink(RingName().c_str());
+    return lutzTest::Result("test_ring");
+}
@@ -0,0 +1,139 @@
+/***************************************************************************
+ *  test_samples.cpp - Tests of the scan on typed samples                  *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_samples.cpp
+ * @brief Tests that lutzSamplePass finds the objects of lutzOnePass for
+ *        several widths and sample types
+ * @author Josh Cardenzana
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "lutzSamplePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Run a detector over a frame and return its catalog
+ *******************************************************************/
+lutzTest::Catalog Detect(lutzOnePass& detector, int xpix, double threshold)
+{
+    detector.SetThreshold(threshold);
+    detector.run();
+    return lutzTest::MakeCatalog(detector.GetObjects(), xpix);
+}
+
+
+/***************************************************************//**
+ * @brief Check one width against a flood fill and the plain scan, for
+ *        samples of type PixelT
+ *
+ * The frame is scaled by 1000 so that integer samples keep the pixels
+ * apart, and the fractional cut checks the integer comparison.
+ *******************************************************************/
+template <typename PixelT>
+void CheckWidth(int xpix, int ypix, double density, unsigned seed)
+{
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, density, seed);
+    std::vector<PixelT> samples(image.size());
+    std::vector<double> values(image.size());
+    for (size_t i=0; i<image.size(); i++) {
+        samples[i] = PixelT(1000.0 * image[i]);
+        values[i]  = double(samples[i]);
+    }
+    
+    const double cuts[] = {1000.0, 999.5, -1.0};
+    for (int c=0; c < sizeof(cuts)/sizeof(cuts[0]); c++) {
+        lutzTest::Catalog expected = lutzTest::FloodFill(values, xpix, ypix, cuts[c]);
+        
+        lutzSamplePass<PixelT> typed(samples.data(), xpix, ypix);
+        LUTZ_CHECK(Detect(typed, xpix, cuts[c]) == expected);
+        
+        // The same frame as doubles through the plain scan, pixel values
+        // included
+        lutzOnePass plain(values.data(), xpix, ypix);
+        Detect(plain, xpix, cuts[c]);
+        std::vector<lutzObject> found    = typed.GetObjects();
+        std::vector<lutzObject> reported = plain.GetObjects();
+        LUTZ_CHECK(found.size() == reported.size());
+        if (found.size() != reported.size()) continue;
+        for (size_t i=0; i<found.size(); i++) {
+            LUTZ_CHECK(found[i].size() == reported[i].size());
+            LUTZ_CHECK(found[i].Sum() == reported[i].Sum());
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Widths that fill whole words and widths that do not
+ *******************************************************************/
+void TestWidths()
+{
+    CheckWidth<double>(1, 30, 0.5, 1);
+    CheckWidth<uint16_t>(63, 40, 0.3, 2);
+    CheckWidth<float>(64, 40, 0.3, 3);
+    CheckWidth<uint16_t>(65, 40, 0.45, 4);
+    CheckWidth<double>(128, 50, 0.05, 5);
+    CheckWidth<uint8_t>(200, 50, 0.6, 6);
+}
+
+
+/***************************************************************//**
+ * @brief A detector can be run again on a frame of another width
+ *******************************************************************/
+void TestReuse()
+{
+    const int ypix = 16;
+    std::vector<double> wide   = lutzTest::RandomImage(300, ypix, 0.2, 10);
+    std::vector<double> narrow = lutzTest::RandomImage(70, ypix, 0.4, 11);
+    
+    lutzSamplePass<double> samples(wide.data(), 300, ypix);
+    LUTZ_CHECK(Detect(samples, 300, 1.0) ==
+               lutzTest::FloodFill(wide, 300, ypix, 1.0));
+    samples.SetPixels(narrow.data());
+    samples.SetXpixels(70);
+    LUTZ_CHECK(Detect(samples, 70, 1.0) ==
+               lutzTest::FloodFill(narrow, 70, ypix, 1.0));
+    
+    // The same samples read at half the width land on other pixels
+    std::vector<double> image(2048 * ypix, 0.0);
+    image[1500] = 2.0;
+    samples.SetPixels(image.data());
+    samples.SetXpixels(1024);
+    LUTZ_CHECK(Detect(samples, 1024, 1.0) ==
+               lutzTest::Catalog(1, std::vector<long>(1, 1500)));
+    LUTZ_CHECK((samples.NumObjects() == 1) &&
+               (samples.GetObject(0)[0].m_xbin == 1500 - 1024) &&
+               (samples.GetObject(0)[0].m_ybin == 1));
+}
+
+} // namespace
+
+
+int main()
+{
+    TestWidths();
+    TestReuse();
+    return lutzTest::Result("test_samples");
+}
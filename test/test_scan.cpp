@@ -0,0 +1,243 @@
+/***************************************************************************
+ *  test_scan.cpp - Tests of the Lutz scan                                 *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_scan.cpp
+ * @brief Tests that lutzOnePass finds the connected groups of image pixels
+ * @author Josh Cardenzana
+ */
+
+#include <vector>
+
+#include "lutzOnePass.hpp"
+#include "lutzPyramid.hpp"
+#include "lutzRunPass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Detector that tests every pixel through the virtual methods
+ *******************************************************************/
+class PixelPass : public lutzOnePass {
+public:
+    PixelPass(double* image, int xpixels, int ypixels) :
+        lutzOnePass(image, xpixels, ypixels)
+    {}
+};
+
+
+/***************************************************************//**
+ * @brief Detector that finds the pixels below the negated threshold
+ *******************************************************************/
+class InvertedPass : public PixelPass {
+public:
+    InvertedPass(double* image, int xpixels, int ypixels) :
+        PixelPass(image, xpixels, ypixels)
+    {}
+    virtual double GetPixValue(int xbin, int ybin)
+    {
+        return -lutzOnePass::GetPixValue(xbin, ybin);
+    }
+};
+
+
+/***************************************************************//**
+ * @brief Detector that overrides only the pixel test
+ *******************************************************************/
+class DipPass : public lutzOnePass {
+public:
+    DipPass(double* image, int xpixels, int ypixels) :
+        lutzOnePass(image, xpixels, ypixels)
+    {}
+    virtual bool AssessPixel(int xbin, int ybin)
+    {
+        return (GetPixValue(xbin, ybin) < -0.5);
+    }
+};
+
+
+/***************************************************************//**
+ * @brief Run a detector over a frame and return its catalog
+ *******************************************************************/
+lutzTest::Catalog Detect(std::vector<double>& image, int xpix, int ypix,
+                         double threshold)
+{
+    lutzOnePass detector(image.data(), xpix, ypix);
+    detector.SetThreshold(threshold);
+    detector.run();
+    return lutzTest::MakeCatalog(detector.GetObjects(), xpix);
+}
+
+
+/***************************************************************//**
+ * @brief Pieces that only meet further down are joined into one object
+ *
+ * Each comb has several teeth that start as separate objects and are
+ * joined on the bottom row, which goes through the 's' marker join
+ * of the scan. No pixel of any tooth may be lost.
+ *******************************************************************/
+void TestJoin()
+{
+    const int xpix = 12;
+    const int ypix = 6;
+    const char* rows[ypix] = {
+        "#.#.#...#..#",
+        "#.#.#...#..#",
+        "#.#.#...#..#",
+        "#####...#..#",
+        "........####",
+        "#..........."
+    };
+    std::vector<double> image = lutzTest::DrawImage(rows, ypix);
+    
+    lutzTest::Catalog catalog = Detect(image, xpix, ypix, 0.5);
+    LUTZ_CHECK(catalog.size() == 3);
+    LUTZ_CHECK(catalog == lutzTest::FloodFill(image, xpix, ypix, 0.5));
+    
+    // The first comb has three teeth of 3 pixels on a bar of 5
+    if (catalog.size() == 3) LUTZ_CHECK(catalog[0].size() == 14);
+}
+
+
+/***************************************************************//**
+ * @brief Frames of every shape give the objects a flood fill finds
+ *
+ * Narrow frames are included, since the scan keeps state for one more
+ * position than there are pixels in a row.
+ *******************************************************************/
+void TestRandomFrames()
+{
+    const int sizes[][2] = {{1, 1}, {1, 40}, {2, 30}, {3, 17}, {5, 5},
+                            {40, 1}, {63, 20}, {64, 20}, {65, 20},
+                            {129, 70}};
+    const double densities[] = {0.05, 0.3, 0.5, 0.8};
+    unsigned seed = 1;
+    for (int s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        for (int d=0; d < sizeof(densities)/sizeof(densities[0]); d++) {
+            int xpix = sizes[s][0];
+            int ypix = sizes[s][1];
+            std::vector<double> image = lutzTest::RandomImage(xpix, ypix,
+                                                              densities[d], seed++);
+            LUTZ_CHECK(Detect(image, xpix, ypix, 1.0) ==
+                       lutzTest::FloodFill(image, xpix, ypix, 1.0));
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Every pixel of a dense frame ends up in exactly one object
+ *******************************************************************/
+void TestDenseFrame()
+{
+    const int npix = 256;
+    std::vector<double> image = lutzTest::RandomImage(npix, npix, 0.45, 99);
+    lutzOnePass detector(image.data(), npix, npix);
+    detector.SetThreshold(1.0);
+    detector.run();
+    
+    size_t nfound = 0;
+    for (int i=0; i<detector.NumObjects(); i++) {
+        lutzObject object = detector.GetObject(i);
+        LUTZ_CHECK(object.NumPixels() == object.size());
+        nfound += object.size();
+    }
+    size_t nabove = 0;
+    for (size_t i=0; i<image.size(); i++) nabove += (image[i] > 1.0);
+    LUTZ_CHECK(nfound == nabove);
+    LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), npix) ==
+               lutzTest::FloodFill(image, npix, npix, 1.0));
+}
+
+
+/***************************************************************//**
+ * @brief The row scan and the pixel by pixel scan agree
+ *
+ * A subclass that supplies its own pixel values is scanned through
+ * them, and one that does not gets the same objects either way.
+ *******************************************************************/
+void TestDirectRows()
+{
+    const int xpix = 97;
+    const int ypix = 61;
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.3, 5);
+    
+    lutzOnePass direct(image.data(), xpix, ypix);
+    PixelPass   pixel(image.data(), xpix, ypix);
+    LUTZ_CHECK(direct.HasDirectRows());
+    LUTZ_CHECK(!pixel.HasDirectRows());
+    direct.SetThreshold(1.0);
+    pixel.SetThreshold(1.0);
+    direct.run();
+    pixel.run();
+    LUTZ_CHECK(lutzTest::MakeCatalog(direct.GetObjects(), xpix) ==
+               lutzTest::MakeCatalog(pixel.GetObjects(), xpix));
+    
+    // Values below 1 become the image pixels once they are negated
+    InvertedPass inverted(image.data(), xpix, ypix);
+    inverted.SetThreshold(-1.0);
+    inverted.run();
+    std::vector<double> negated(image.size());
+    for (size_t i=0; i<image.size(); i++) negated[i] = -image[i];
+    LUTZ_CHECK(lutzTest::MakeCatalog(inverted.GetObjects(), xpix) ==
+               lutzTest::FloodFill(negated, xpix, ypix, -1.0));
+}
+
+
+/***************************************************************//**
+ * @brief A subclass is scanned through its own pixel test
+ *
+ * Overriding AssessPixel() alone is enough; the row scan is only taken
+ * by the classes that read m_image themselves.
+ *******************************************************************/
+void TestSubclass()
+{
+    const int npix = 16;
+    std::vector<double> image(npix * npix, 0.0);
+    image[3 * npix + 4]  = -1.0;
+    image[10 * npix + 12] = -2.0;
+    
+    DipPass dips(image.data(), npix, npix);
+    LUTZ_CHECK(!dips.HasDirectRows());
+    dips.run();
+    LUTZ_CHECK(dips.NumObjects() == 2);
+    
+    lutzRunPass runs(image.data(), npix, npix);
+    lutzPyramid pyramid(image.data(), npix, npix);
+    LUTZ_CHECK(runs.HasDirectRows());
+    LUTZ_CHECK(pyramid.HasDirectRows());
+    
+    lutzOnePass empty;
+    LUTZ_CHECK(!empty.HasDirectRows());
+}
+
+} // namespace
+
+
+int main()
+{
+    TestJoin();
+    TestRandomFrames();
+    TestDenseFrame();
+    TestDirectRows();
+    TestSubclass();
+    return lutzTest::Result("test_scan");
+}
@@ -0,0 +1,264 @@
+/***************************************************************************
+ *  test_sparse.cpp - Tests of detection on a list of hits                 *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_sparse.cpp
+ * @brief Tests that lutzSparsePass finds the objects of lutzOnePass on
+ *        the dense image the hits make up
+ * @author Josh Cardenzana
+ */
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "lutzSparsePass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief A frame given both as hits and as a dense image
+ *******************************************************************/
+struct Hits {
+    std::vector<int>    m_row_start;    //!< First hit of each row, then the total
+    std::vector<int>    m_xpos;         //!< x position of each hit
+    std::vector<double> m_values;       //!< Value of each hit
+    std::vector<double> m_image;        //!< Dense image, 0 where there is no hit
+};
+
+
+/***************************************************************//**
+ * @brief Make a random list of hits
+ *
+ * @param[in] xpix          Number of pixels in x
+ * @param[in] ypix          Number of pixels in y
+ * @param[in] occupancy     Fraction of pixels with a hit
+ * @param[in] seed          Seed of the random numbers
+ * @return Hits with values between 0 and 2, about half above 1
+ *
+ * Whole bands of rows are left empty, so the scan has to carry markers
+ * across rows without hits and start again after them.
+ *******************************************************************/
+Hits MakeHits(int xpix, int ypix, double occupancy, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    Hits hits;
+    hits.m_image.assign(size_t(xpix) * ypix, 0.0);
+    for (int y=0; y<ypix; y++) {
+        hits.m_row_start.push_back(hits.m_xpos.size());
+        if ((y / 4) % 3 == 2) continue;
+        for (int x=0; x<xpix; x++) {
+            if (uniform(random) >= occupancy) continue;
+            double value = 2.0 * uniform(random);
+            hits.m_xpos.push_back(x);
+            hits.m_values.push_back(value);
+            hits.m_image[size_t(y) * xpix + x] = value;
+        }
+    }
+    hits.m_row_start.push_back(hits.m_xpos.size());
+    return hits;
+}
+
+
+/***************************************************************//**
+ * @brief Return whether two lists of objects are identical
+ *******************************************************************/
+bool SameObjects(const std::vector<lutzObject>& a, const std::vector<lutzObject>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i=0; i<a.size(); i++) {
+        if ((a[i].size() != b[i].size()) || (a[i].GetFlags() != b[i].GetFlags())) {
+            return false;
+        }
+        for (int p=0; p<a[i].size(); p++) {
+            if ((a[i][p].m_xbin != b[i][p].m_xbin) ||
+                (a[i][p].m_ybin != b[i][p].m_ybin) ||
+                (a[i][p].m_value != b[i][p].m_value)) return false;
+        }
+    }
+    return true;
+}
+
+
+/***************************************************************//**
+ * @brief For non-negative thresholds the objects are identical, in the
+ *        same order, to those of the dense image
+ *******************************************************************/
+void TestDense()
+{
+    const int sizes[][2] = {{1, 1}, {1, 40}, {30, 1}, {64, 30}, {65, 30},
+                            {200, 120}};
+    const double occupancies[] = {0.01, 0.2, 0.7};
+    const double thresholds[] = {0.0, 1.0};
+    unsigned seed = 70;
+    for (int s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        for (int o=0; o < sizeof(occupancies)/sizeof(occupancies[0]); o++) {
+            int xpix = sizes[s][0];
+            int ypix = sizes[s][1];
+            Hits hits = MakeHits(xpix, ypix, occupancies[o], seed++);
+            for (int t=0; t<2; t++) {
+                lutzSparsePass sparse(hits.m_row_start.data(), hits.m_xpos.data(),
+                                      hits.m_values.data(), xpix, ypix);
+                lutzOnePass    dense(hits.m_image.data(), xpix, ypix);
+                sparse.SetThreshold(thresholds[t]);
+                dense.SetThreshold(thresholds[t]);
+                sparse.run();
+                dense.run();
+                LUTZ_CHECK(SameObjects(sparse.GetObjects(), dense.GetObjects()));
+                LUTZ_CHECK(lutzTest::MakeCatalog(sparse.GetObjects(), xpix) ==
+                           lutzTest::FloodFill(hits.m_image, xpix, ypix,
+                                               thresholds[t]));
+            }
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief The same detector can be pointed at a new list of hits
+ *******************************************************************/
+void TestSetHits()
+{
+    const int xpix = 80;
+    const int ypix = 60;
+    lutzSparsePass sparse;
+    sparse.SetXpixels(xpix);
+    sparse.SetYpixels(ypix);
+    sparse.SetThreshold(1.0);
+    for (int frame=0; frame<3; frame++) {
+        Hits hits = MakeHits(xpix, ypix, 0.3, 90 + frame);
+        sparse.SetHits(hits.m_row_start.data(), hits.m_xpos.data(),
+                       hits.m_values.data());
+        sparse.run();
+        LUTZ_CHECK(lutzTest::MakeCatalog(sparse.GetObjects(), xpix) ==
+                   lutzTest::FloodFill(hits.m_image, xpix, ypix, 1.0));
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Masked pixels and NaN hits are treated as in the dense image
+ *
+ * Both mask formats are tried with every action. The NaN hits and the
+ * masked pixels fall both on hits and between them.
+ *******************************************************************/
+void TestBadPixels()
+{
+    const int xpix = 90;
+    const int ypix = 70;
+    std::mt19937 random(31);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    
+    const lutzOnePass::LUTZ_BAD_ACTION actions[] = {
+        lutzOnePass::BAD_EXCLUDE, lutzOnePass::BAD_BRIDGE, lutzOnePass::BAD_FLAG};
+    for (int frame=0; frame<4; frame++) {
+        Hits hits = MakeHits(xpix, ypix, 0.4, 110 + frame);
+        for (size_t h=0; h<hits.m_values.size(); h++) {
+            if (uniform(random) < 0.04) {
+                hits.m_values[h] = std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+        for (int y=0; y<ypix; y++) {
+            for (int h=hits.m_row_start[y]; h < hits.m_row_start[y + 1]; h++) {
+                hits.m_image[size_t(y) * xpix + hits.m_xpos[h]] = hits.m_values[h];
+            }
+        }
+        
+        int nwords = (xpix + 63) / 64;
+        std::vector<uint8_t>  mask(hits.m_image.size(), 0);
+        std::vector<uint64_t> bits(size_t(nwords) * ypix, 0);
+        for (int y=0; y<ypix; y++) {
+            for (int x=0; x<xpix; x++) {
+                if (uniform(random) >= 0.05) continue;
+                mask[size_t(y) * xpix + x] = 1;
+                bits[size_t(y) * nwords + x / 64] |= uint64_t(1) << (x % 64);
+            }
+        }
+        
+        for (int a=0; a<3; a++) {
+            for (int format=0; format<2; format++) {
+                lutzSparsePass sparse(hits.m_row_start.data(), hits.m_xpos.data(),
+                                      hits.m_values.data(), xpix, ypix);
+                lutzOnePass    dense(hits.m_image.data(), xpix, ypix);
+                sparse.SetThreshold(1.0);
+                dense.SetThreshold(1.0);
+                if (format == 0) {
+                    sparse.SetBadPixelMask(mask.data());
+                    dense.SetBadPixelMask(mask.data());
+                } else {
+                    sparse.SetBadPixelBits(bits.data());
+                    dense.SetBadPixelBits(bits.data());
+                }
+                sparse.SetBadPixelAction(actions[a]);
+                dense.SetBadPixelAction(actions[a]);
+                sparse.run();
+                dense.run();
+                LUTZ_CHECK(sparse.NumObjects() > 0);
+                LUTZ_CHECK(SameObjects(sparse.GetObjects(), dense.GetObjects()));
+            }
+        }
+    }
+}
+
+
+/***************************************************************//**
+ * @brief The adaptive threshold follows the dense image frame by frame
+ *******************************************************************/
+void TestAdaptive()
+{
+    const int xpix = 200;
+    const int ypix = 150;
+    lutzSparsePass sparse;
+    lutzOnePass    dense;
+    sparse.SetXpixels(xpix);
+    sparse.SetYpixels(ypix);
+    dense.SetXpixels(xpix);
+    dense.SetYpixels(ypix);
+    sparse.SetAdaptiveThreshold(2.0);
+    dense.SetAdaptiveThreshold(2.0);
+    
+    for (int frame=0; frame<4; frame++) {
+        Hits hits = MakeHits(xpix, ypix, 0.8, 130 + frame);
+        sparse.SetHits(hits.m_row_start.data(), hits.m_xpos.data(),
+                       hits.m_values.data());
+        dense.SetImage(hits.m_image.data());
+        sparse.run();
+        dense.run();
+        LUTZ_CHECK(sparse.GetBackground().IsReady());
+        LUTZ_CHECK(sparse.GetBackground().GetMedian() == dense.GetBackground().GetMedian());
+        LUTZ_CHECK(sparse.GetBackground().GetSigma() == dense.GetBackground().GetSigma());
+        LUTZ_CHECK(SameObjects(sparse.GetObjects(), dense.GetObjects()));
+    }
+}
+
+} // namespace
+
+
+int main()
+{
+    TestDense();
+    TestSetHits();
+    TestBadPixels();
+    TestAdaptive();
+    return lutzTest::Result("test_sparse");
+}
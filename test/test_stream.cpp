@@ -0,0 +1,171 @@
+/***************************************************************************
+ *  test_stream.cpp - Tests of scanning frames decoded row by row          *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_stream.cpp
+ * @brief Tests of the row sources and of lutzStreamPass
+ * @author Josh Cardenzana
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "lutzDeltaSource.hpp"
+#include "lutzRiceSource.hpp"
+#include "lutzStreamPass.hpp"
+#include "lutzTest.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Make a 16 bit frame of noise around 1000 with bright objects
+ *
+ * Some pixels jump to the top of the range, so that the coders have to
+ * escape them.
+ *******************************************************************/
+std::vector<uint16_t> MakeFrame(int xpix, int ypix, unsigned seed)
+{
+    std::vector<double> image = lutzTest::RandomImage(xpix, ypix, 0.15, seed);
+    std::vector<uint16_t> frame(image.size());
+    for (size_t i=0; i<image.size(); i++) {
+        frame[i] = uint16_t(1000.0 * image[i]);
+        if ((i % 97) == 5) frame[i] = 65535;
+    }
+    return frame;
+}
+
+
+/***************************************************************//**
+ * @brief Read every row of a source
+ *******************************************************************/
+bool ReadAll(lutzRowSource& source, int xpix, int ypix,
+             std::vector<uint16_t>& frame)
+{
+    frame.assign(size_t(xpix) * ypix, 0);
+    for (int y=0; y<ypix; y++) {
+        if (!source.ReadRow(&frame[size_t(y) * xpix])) return false;
+    }
+    return true;
+}
+
+
+/***************************************************************//**
+ * @brief Frames come back exactly as they were coded
+ *******************************************************************/
+void TestRoundTrip()
+{
+    const int widths[] = {1, 2, 33, 200};
+    const int blocks[] = {1, 7, 32, 500};
+    for (int w=0; w<4; w++) {
+        int xpix = widths[w];
+        int ypix = 17;
+        std::vector<uint16_t> frame = MakeFrame(xpix, ypix, 90 + w);
+        std::vector<uint16_t> decoded;
+        std::vector<uint8_t>  data;
+        
+        for (int b=0; b<4; b++) {
+            LUTZ_CHECK(lutzRiceSource::Encode(frame.data(), xpix, ypix, data, blocks[b]));
+            lutzRiceSource rice(data.data(), data.size(), xpix, ypix, blocks[b]);
+            LUTZ_CHECK(ReadAll(rice, xpix, ypix, decoded) && (decoded == frame));
+            
+            // Rewinding starts the frame again
+            rice.Rewind();
+            LUTZ_CHECK(ReadAll(rice, xpix, ypix, decoded) && (decoded == frame));
+        }
+        
+        lutzDeltaSource::Encode(frame.data(), xpix, ypix, data);
+        lutzDeltaSource delta(data.data(), data.size(), xpix, ypix);
+        LUTZ_CHECK(ReadAll(delta, xpix, ypix, decoded) && (decoded == frame));
+    }
+}
+
+
+/***************************************************************//**
+ * @brief Blocks of no pixels are refused rather than looping forever
+ *******************************************************************/
+void TestBadBlock()
+{
+    std::vector<uint16_t> frame = MakeFrame(20, 4, 95);
+    std::vector<uint8_t>  data;
+    LUTZ_CHECK(!lutzRiceSource::Encode(frame.data(), 20, 4, data, 0));
+    LUTZ_CHECK(data.empty());
+    LUTZ_CHECK(!lutzRiceSource::Encode(frame.data(), 20, 4, data, -3));
+    
+    LUTZ_CHECK(lutzRiceSource::Encode(frame.data(), 20, 4, data, 8));
+    std::vector<uint16_t> row(20);
+    lutzRiceSource rice(data.data(), data.size(), 20, 4, 0);
+    LUTZ_CHECK(!rice.ReadRow(row.data()));
+    rice.SetData(data.data(), data.size(), 20, 4, -1);
+    LUTZ_CHECK(!rice.ReadRow(row.data()));
+    rice.SetData(data.data(), data.size(), 20, 4, 8);
+    LUTZ_CHECK(rice.ReadRow(row.data()));
+}
+
+
+/***************************************************************//**
+ * @brief Scanning the coded frame finds the objects of the decoded one
+ *******************************************************************/
+void TestStreamPass()
+{
+    int xpix = 150;
+    int ypix = 60;
+    std::vector<uint16_t> frame = MakeFrame(xpix, ypix, 96);
+    std::vector<double> values(frame.begin(), frame.end());
+    lutzTest::Catalog reference = lutzTest::FloodFill(values, xpix, ypix, 999.5);
+    
+    std::vector<uint8_t> data;
+    lutzRiceSource::Encode(frame.data(), xpix, ypix, data);
+    lutzRiceSource rice(data.data(), data.size(), xpix, ypix);
+    lutzStreamPass detector(&rice);
+    detector.SetThreshold(999.5);
+    detector.run();
+    LUTZ_CHECK(detector.NumRowsRead() == ypix);
+    LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), xpix) == reference);
+    
+    // The pixel values are those of the frame
+    std::vector<lutzObject> objects = detector.GetObjects();
+    for (int i=0; i<objects.size(); i++) {
+        for (int p=0; p<objects[i].size(); p++) {
+            const lutzObject::pixData& pixel = objects[i][p];
+            LUTZ_CHECK(pixel.m_value == values[size_t(pixel.m_ybin) * xpix + pixel.m_xbin]);
+        }
+    }
+    
+    // A second run reads the frame again from the start
+    detector.run();
+    LUTZ_CHECK(lutzTest::MakeCatalog(detector.GetObjects(), xpix) == reference);
+    
+    // Data that run out end the frame early
+    lutzRiceSource cut(data.data(), data.size() / 2, xpix, ypix);
+    detector.SetSource(&cut);
+    detector.run();
+    LUTZ_CHECK((detector.NumRowsRead() > 0) && (detector.NumRowsRead() < ypix));
+}
+
+} // namespace
+
+
+int main()
+{
+    TestRoundTrip();
+    TestBadBlock();
+    TestStreamPass();
+    return lutzTest::Result("test_stream");
+}
@@ -0,0 +1,165 @@
+/***************************************************************************
+ *  test_trace.cpp - Tests of the Chrome trace recorder                    *
+ * ----------------------------------------------------------------------- *
+ *  copyright (C) 2018 by Josh Cardenzana                                  *
+ * ----------------------------------------------------------------------- *
+ *                                                                         *
+ *  This program is free software: you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, either version 3 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.  *
+ *                                                                         *
+ ***************************************************************************/
+/**
+ * @file test_trace.cpp
+ * @brief Tests that lutzTrace records events on every thread and writes
+ *        them as Chrome trace JSON
+ * @author Josh Cardenzana
+ */
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lutzOnePass.hpp"
+#include "lutzTest.hpp"
+#include "lutzTrace.hpp"
+
+namespace {
+
+/***************************************************************//**
+ * @brief Count the occurrences of a string in a text
+ *******************************************************************/
+size_t Count(const std::string& text, const std::string& what)
+{
+    size_t n = 0;
+    for (size_t pos=text.find(what); pos != std::string::npos;
+         pos=text.find(what, pos + what.size())) n++;
+    return n;
+}
+
+
+/***************************************************************//**
+ * @brief Return the trace as a string
+ *******************************************************************/
+std::string Written()
+{
+    std::ostringstream out;
+    lutzTrace::Write(out);
+    return out.str();
+}
+
+
+/***************************************************************//**
+ * @brief Events from several threads are all written, each thread
+ *        under its own name
+ *
+ * Times are written in microseconds with three decimals, and only
+ * events with an argument carry one.
+ *******************************************************************/
+void TestRecord()
+{
+    lutzTrace::clear();
+    LUTZ_CHECK(lutzTrace::size() == 0);
+    
+    lutzTrace::Record("first", 1500, 4000, 7);
+    std::vector<std::thread> threads;
+    for (int t=0; t<2; t++) {
+        threads.push_back(std::thread([]() {
+            for (int i=0; i<5; i++) lutzTrace::Record("worker", 10, 20);
+        }));
+    }
+    for (size_t t=0; t<threads.size(); t++) threads[t].join();
+    LUTZ_CHECK(lutzTrace::size() == 11);
+    
+    std::string trace = Written();
+    LUTZ_CHECK(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+    LUTZ_CHECK(Count(trace, "\"ph\":\"X\"") == 11);
+    LUTZ_CHECK(Count(trace, "\"ph\":\"M\"") == 3);
+    LUTZ_CHECK(Count(trace, "\"name\":\"worker\"") == 10);
+    LUTZ_CHECK(trace.find("\"name\":\"first\",\"cat\":\"lutz\",\"ph\":\"X\"") !=
+               std::string::npos);
+    LUTZ_CHECK(trace.find("\"ts\":1.500,\"dur\":2.500,\"args\":{\"value\":7}") !=
+               std::string::npos);
+    LUTZ_CHECK(trace.find("\"ts\":0.010,\"dur\":0.010}") != std::string::npos);
+    LUTZ_CHECK(Count(trace, "{") == Count(trace, "}"));
+    LUTZ_CHECK(Count(trace, "[") == 1 && Count(trace, "]") == 1);
+    
+    lutzTrace::clear();
+    LUTZ_CHECK(lutzTrace::size() == 0);
+    LUTZ_CHECK(Written() == "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n]}\n");
+}
+
+
+/***************************************************************//**
+ * @brief Scopes and row bands record what they cover
+ *******************************************************************/
+void TestScopes()
+{
+    lutzTrace::clear();
+    {
+        lutzTrace::Scope scope("scope", 3);
+        lutzTrace::Scope skipped("skipped", 3, false);
+    }
+    {
+        lutzTrace::RowBands bands;
+        for (int y=0; y<150; y++) bands.row(y);
+    }
+    std::string trace = Written();
+    LUTZ_CHECK(lutzTrace::size() == 1 + (150 + LUTZ_TRACE_ROW_BAND - 1) / LUTZ_TRACE_ROW_BAND);
+    LUTZ_CHECK(Count(trace, "\"name\":\"scope\"") == 1);
+    LUTZ_CHECK(Count(trace, "\"name\":\"skipped\"") == 0);
+    for (int first=0; first<150; first+=LUTZ_TRACE_ROW_BAND) {
+        std::ostringstream arg;
+        arg << "\"args\":{\"value\":" << first << "}";
+        LUTZ_CHECK(Count(trace, arg.str()) == 1);
+    }
+    
+    lutzTrace::SetObjectCutoff(25);
+    LUTZ_CHECK(lutzTrace::GetObjectCutoff() == 25);
+    lutzTrace::clear();
+}
+
+
+/***************************************************************//**
+ * @brief A detection records its phases only in a tracing build
+ *******************************************************************/
+void TestRun()
+{
+    const int npix = 64;
+    std::vector<double> image = lutzTest::RandomImage(npix, npix, 0.2, 170);
+    lutzTrace::clear();
+    lutzOnePass detector(image.data(), npix, npix);
+    detector.SetThreshold(1.0);
+    detector.run();
+    
+    std::string trace = Written();
+#ifdef LUTZ_TRACE
+    LUTZ_CHECK(Count(trace, "\"name\":\"run\"") == 1);
+    LUTZ_CHECK(Count(trace, "\"name\":\"scan\"") == 1);
+    LUTZ_CHECK(Count(trace, "\"name\":\"rows\"") == 1);
+#else
+    LUTZ_CHECK(lutzTrace::size() == 0);
+#endif
+    lutzTrace::clear();
+}
+
+} // namespace
+
+
+int main()
+{
+    TestRecord();
+    TestScopes();
+    TestRun();
+    return lutzTest::Result("test_trace");
+}